@@ -0,0 +1,19 @@
+export module sml:Allocator;
+
+#ifdef SML_NO_IMPORT_STD
+
+import <cstddef>;
+import <limits>;
+import <new>;
+import <type_traits>;
+
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+#define SML_MODULE_ALLOCATOR
+#include "Allocator.hpp"
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef SML_ALLOCATOR_HPP
+#define SML_ALLOCATOR_HPP
+
+#ifndef SML_MODULE_ALLOCATOR
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#endif // !SML_MODULE_ALLOCATOR
+
+namespace sml {
+
+	// Default alignment of heap storage: a full cache line, which also satisfies the widest SIMD loads
+	sml_export inline constexpr size_t default_heap_alignment = 64;
+
+	// Standard allocator returning storage aligned to at least alignment bytes
+	sml_export template<class T, size_t alignment = default_heap_alignment>
+	class aligned_allocator {
+		static_assert((alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+	public:
+		using value_type = T;
+		using size_type = size_t;
+		using difference_type = std::ptrdiff_t;
+		using propagate_on_container_move_assignment = std::true_type;
+		using is_always_equal = std::true_type;
+
+		template<class T2>
+		struct rebind {
+			using other = aligned_allocator<T2, alignment>;
+		};
+
+		static constexpr size_t align = (alignment > alignof(T)) ? alignment : alignof(T);
+
+		constexpr aligned_allocator() noexcept {}
+		template<class T2>
+		constexpr aligned_allocator(const aligned_allocator<T2, alignment>&) noexcept {}
+
+		[[nodiscard]] T* allocate(size_t n) {
+			if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+				throw std::bad_array_new_length();
+			}
+			return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(align)));
+		}
+		void deallocate(T* p, size_t) noexcept {
+			::operator delete(p, std::align_val_t(align));
+		}
+
+		template<class T2>
+		constexpr bool operator == (const aligned_allocator<T2, alignment>&) const noexcept { return true; }
+	};
+
+}
+#endif // !SML_ALLOCATOR_HPP
\ No newline at end of file
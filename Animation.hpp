@@ -0,0 +1,339 @@
+#ifndef SML_ANIMATION_HPP
+#define SML_ANIMATION_HPP
+
+#ifndef SML_MODULE_ANIMATION
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#include "Simd.hpp"
+#include "Parallel.hpp"
+
+#endif // !SML_MODULE_ANIMATION
+
+#include "Config.hpp"
+
+// Interpolate whole buffers of rotations, such as two poses of a skeleton being blended
+//
+//     sml::slerp(std::span<const sml::Quatf>(walk), run, 0.3f, std::span<sml::Quatf>(blended));
+//     sml::nlerp(sml::execution::par, walk, run, 0.3f, blended);
+//
+// and sample keyframed rotations, one track per bone
+//
+//     sml::RotationTrack<float> track(sml::interpolation::squad);
+//     track.add(0.0f, q0);
+//     track.add(0.5f, q1);
+//     sml::Quatf q = track.sample(0.2f);
+//
+//     std::vector<sml::RotationTrack<float>::cursor> cursors(tracks.size());
+//     sml::sample(sml::execution::par, std::span<const sml::RotationTrack<float>>(tracks), time, cursors, pose);
+//
+// Keys are normalised as they are added, and each is stored on the same side of the hypersphere as the one before it,
+// so that sampling never has to choose between the two arcs joining a pair of keys. A track is sampled by binary search
+// over its key times, or through a cursor that remembers the last key sampled: as playback moves forward, the next
+// sample is usually found within the same pair of keys or the pair after it, without a search. Sampling allocates
+// nothing, and times outside a track are clamped to its first and last keys.
+
+namespace sml {
+
+	namespace detail {
+
+		// Fewest quaternions worth handing to a thread of their own
+		inline constexpr size_t interpolate_parallel_grain = size_t(1) << 14;
+
+		// Fewest tracks worth handing to a thread of their own
+		inline constexpr size_t track_parallel_grain = size_t(1) << 12;
+
+		// out[i] = nlerp(a[i], b[i], t)
+		template<std::floating_point T>
+		inline void nlerp_each(const Quaternion<T>* a, const Quaternion<T>* b, T t, Quaternion<T>* out, size_t n) {
+			const T wa = T(1) - t;
+			size_t i = 0;
+#if (defined(SML_SIMD_SSE) || defined(SML_SIMD_NEON)) && defined(SML_QUATERNION_LANES)
+			// Four quaternions at a time, transposed so that each register holds one component of all four. The
+			// compiler cannot do this itself, as std::sqrt may set errno
+			if constexpr (std::same_as<T, float>) {
+				using simd = simd_ops<float, 4>;
+				using reg = simd::reg;
+				const reg vt = simd::broadcast(t);
+				const reg vwa = simd::broadcast(wa);
+				const reg one = simd::broadcast(1.0f);
+				for (; i + 4 <= n; i += 4) {
+					reg as = simd::load(a[i].data()), ai = simd::load(a[i + 1].data());
+					reg aj = simd::load(a[i + 2].data()), ak = simd::load(a[i + 3].data());
+					reg bs = simd::load(b[i].data()), bi = simd::load(b[i + 1].data());
+					reg bj = simd::load(b[i + 2].data()), bk = simd::load(b[i + 3].data());
+					simd::transpose4(as, ai, aj, ak);
+					simd::transpose4(bs, bi, bj, bk);
+					const reg d = simd::fma(as, bs, simd::fma(ai, bi, simd::fma(aj, bj, simd::mul(ak, bk))));
+					const reg wb = simd::copysign(vt, d);
+					reg s = simd::fma(vwa, as, simd::mul(wb, bs));
+					reg x = simd::fma(vwa, ai, simd::mul(wb, bi));
+					reg y = simd::fma(vwa, aj, simd::mul(wb, bj));
+					reg z = simd::fma(vwa, ak, simd::mul(wb, bk));
+					const reg inv_length = simd::div(one, simd::sqrt(simd::fma(s, s, simd::fma(x, x, simd::fma(y, y, simd::mul(z, z))))));
+					s = simd::mul(s, inv_length);
+					x = simd::mul(x, inv_length);
+					y = simd::mul(y, inv_length);
+					z = simd::mul(z, inv_length);
+					simd::transpose4(s, x, y, z);
+					simd::store(out[i].data(), s);
+					simd::store(out[i + 1].data(), x);
+					simd::store(out[i + 2].data(), y);
+					simd::store(out[i + 3].data(), z);
+				}
+			}
+#endif
+			SML_IVDEP
+			for (; i < n; i++) {
+				const T as = a[i][0], ai = a[i][1], aj = a[i][2], ak = a[i][3];
+				const T bs = b[i][0], bi = b[i][1], bj = b[i][2], bk = b[i][3];
+				const T d = (as * bs) + (ai * bi) + (aj * bj) + (ak * bk);
+				const T wb = std::copysign(t, d);
+				const T s = (wa * as) + (wb * bs);
+				const T x = (wa * ai) + (wb * bi);
+				const T y = (wa * aj) + (wb * bj);
+				const T z = (wa * ak) + (wb * bk);
+				const T inv_length = T(1) / std::sqrt((s * s) + (x * x) + (y * y) + (z * z));
+				out[i][0] = s * inv_length;
+				out[i][1] = x * inv_length;
+				out[i][2] = y * inv_length;
+				out[i][3] = z * inv_length;
+			}
+		}
+
+		template<bool spherical, execution_policy Policy, std::floating_point T>
+		inline void interpolate_span(Policy&& policy, std::span<const Quaternion<T>> a, std::span<const Quaternion<T>> b, T t, std::span<Quaternion<T>> out) {
+			if (a.size() != b.size()) {
+				throw std::invalid_argument("interpolate: input spans differ in size");
+			}
+			if (out.size() < a.size()) {
+				throw std::invalid_argument("interpolate: output span is smaller than the input");
+			}
+			for_each_range(policy, a.size(), interpolate_parallel_grain, [&](size_t begin, size_t end) {
+				if constexpr (spherical) {
+					for (size_t i = begin; i < end; i++) {
+						out[i] = slerp<true>(a[i], b[i], t);
+					}
+				}
+				else {
+					nlerp_each(a.data() + begin, b.data() + begin, t, out.data() + begin, end - begin);
+				}
+			});
+		}
+
+	} // !namespace detail
+
+	// out[i] = nlerp(a[i], b[i], t), writing the results to the start of out. T is that of t, so that a, b and out may
+	// be any contiguous containers of Quaternion<T>
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void nlerp(Policy&& policy, std::type_identity_t<std::span<const Quaternion<T>>> a, std::type_identity_t<std::span<const Quaternion<T>>> b, T t, std::type_identity_t<std::span<Quaternion<T>>> out) {
+		detail::interpolate_span<false>(policy, a, b, t, out);
+	}
+	sml_export template<std::floating_point T>
+	void nlerp(std::type_identity_t<std::span<const Quaternion<T>>> a, std::type_identity_t<std::span<const Quaternion<T>>> b, T t, std::type_identity_t<std::span<Quaternion<T>>> out) {
+		detail::interpolate_span<false>(execution::seq, a, b, t, out);
+	}
+
+	// out[i] = slerp(a[i], b[i], t), writing the results to the start of out
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void slerp(Policy&& policy, std::type_identity_t<std::span<const Quaternion<T>>> a, std::type_identity_t<std::span<const Quaternion<T>>> b, T t, std::type_identity_t<std::span<Quaternion<T>>> out) {
+		detail::interpolate_span<true>(policy, a, b, t, out);
+	}
+	sml_export template<std::floating_point T>
+	void slerp(std::type_identity_t<std::span<const Quaternion<T>>> a, std::type_identity_t<std::span<const Quaternion<T>>> b, T t, std::type_identity_t<std::span<Quaternion<T>>> out) {
+		detail::interpolate_span<true>(execution::seq, a, b, t, out);
+	}
+
+	// How a RotationTrack interpolates between its keys: holding each key until the next, nlerp, slerp, or squad for a
+	// curve that is smooth across the keys
+	sml_export enum class interpolation : uint8_t { step, nlerp, slerp, squad };
+
+	// Rotations keyed at increasing times, sampled at any time between them
+	sml_export template<std::floating_point T>
+	class RotationTrack {
+	public:
+		// The pair of keys last sampled through it, from which the next sample's search starts
+		struct cursor {
+			size_t key = 0;
+		};
+
+		RotationTrack(interpolation mode = interpolation::slerp) : mode(mode) {}
+
+		inline size_t size() const noexcept { return times.size(); }
+		inline bool empty() const noexcept { return times.empty(); }
+		void reserve(size_t n) {
+			times.reserve(n);
+			keys.reserve(n);
+			controls.reserve(n);
+			arcs.reserve(n);
+			control_arcs.reserve(n);
+		}
+		void clear() {
+			times.clear();
+			keys.clear();
+			controls.clear();
+			arcs.clear();
+			control_arcs.clear();
+		}
+
+		inline interpolation interpolation_mode() const noexcept { return mode; }
+		inline void set_interpolation_mode(interpolation m) noexcept { mode = m; }
+
+		// Add a key after the last, at a later time than it. rotation need not be normalised
+		void add(T time, const Quaternion<T>& rotation) {
+			const size_t n = size();
+			if ((n > 0) && !(time > times.back())) {
+				throw std::invalid_argument("RotationTrack: keys must be added in increasing order of time");
+			}
+			Quaternion<T> q = rotation / std::sqrt(dot(rotation, rotation));
+			if ((n > 0) && (dot(keys.back(), q) < T(0))) {
+				q = -q;
+			}
+			times.push_back(time);
+			keys.push_back(q);
+			if (n == 0) {
+				controls.push_back(q);
+				return;
+			}
+			// The control point of the previous key depends on its neighbours, one of which is now q
+			controls[n - 1] = squad_control_point(keys[(n > 1) ? n - 2 : 0], keys[n - 1], q);
+			controls.push_back(squad_control_point(keys[n - 1], q, q));
+			arcs.emplace_back(dot(keys[n - 1], q));
+			if (n > 1) {
+				control_arcs[n - 2] = detail::slerp_arc<T>(dot(controls[n - 2], controls[n - 1]));
+			}
+			control_arcs.emplace_back(dot(controls[n - 1], controls[n]));
+		}
+
+		inline T time(size_t i) const { SML_CHECK_INDEX(i, size()); return times[i]; }
+		inline const Quaternion<T>& key(size_t i) const { SML_CHECK_INDEX(i, size()); return keys[i]; }
+		inline T start_time() const { return times.empty() ? T(0) : times.front(); }
+		inline T end_time() const { return times.empty() ? T(0) : times.back(); }
+		inline std::span<const T> key_times() const noexcept { return times; }
+		inline std::span<const Quaternion<T>> key_rotations() const noexcept { return keys; }
+
+		// The rotation at time, found by binary search. An empty track is the identity rotation
+		Quaternion<T> sample(T time) const {
+			if (const Quaternion<T>* end = clamp(time)) {
+				return *end;
+			}
+			const size_t k = static_cast<size_t>(std::upper_bound(times.begin() + 1, times.end() - 1, time) - times.begin()) - 1;
+			return interpolate(k, time);
+		}
+
+		// The rotation at time, searching from the keys last sampled through c and then leaving c at the keys found
+		Quaternion<T> sample(T time, cursor& c) const {
+			if (const Quaternion<T>* end = clamp(time)) {
+				return *end;
+			}
+			size_t k = c.key;
+			if ((k + 1 >= size()) || (time < times[k])) {
+				k = static_cast<size_t>(std::upper_bound(times.begin() + 1, times.end() - 1, time) - times.begin()) - 1;
+			}
+			else if (time >= times[k + 1]) {
+				// Playing forward, the next pair of keys is the most likely
+				k++;
+				if (time >= times[k + 1]) {
+					k = static_cast<size_t>(std::upper_bound(times.begin() + k + 1, times.end() - 1, time) - times.begin()) - 1;
+				}
+			}
+			c.key = k;
+			return interpolate(k, time);
+		}
+
+	private:
+		// The first or last key if time is outside the track (or the identity if the track is empty), otherwise null
+		inline const Quaternion<T>* clamp(T time) const {
+			static constexpr Quaternion<T> identity(1, 0, 0, 0);
+			if (keys.empty()) {
+				return &identity;
+			}
+			if (!(time > times.front())) {
+				return &keys.front();
+			}
+			if (!(time < times.back())) {
+				return &keys.back();
+			}
+			return nullptr;
+		}
+
+		// The rotation at time, between keys k and k + 1
+		inline Quaternion<T> interpolate(size_t k, T time) const {
+			const T t = (time - times[k]) / (times[k + 1] - times[k]);
+			switch (mode) {
+			case interpolation::step:
+				return keys[k];
+			case interpolation::nlerp:
+				return detail::blend(keys[k], T(1) - t, keys[k + 1], t, true);
+			case interpolation::slerp:
+				return detail::slerp(keys[k], keys[k + 1], arcs[k], t);
+			default:
+				// squad, with the arcs between the keys and between their control points known in advance
+				return detail::slerp<false>(detail::slerp(keys[k], keys[k + 1], arcs[k], t),
+					detail::slerp(controls[k], controls[k + 1], control_arcs[k], t), T(2) * t * (T(1) - t));
+			}
+		}
+
+		std::vector<T> times;
+		std::vector<Quaternion<T>> keys;
+		// Control points of the keys for squad
+		std::vector<Quaternion<T>> controls;
+		// The arcs from each key, and from each control point, to the next
+		std::vector<detail::slerp_arc<T>> arcs;
+		std::vector<detail::slerp_arc<T>> control_arcs;
+		interpolation mode;
+	};
+
+	// out[i] = tracks[i].sample(time), writing the results to the start of out
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void sample(Policy&& policy, std::span<const RotationTrack<T>> tracks, std::type_identity_t<T> time, std::type_identity_t<std::span<Quaternion<T>>> out) {
+		if (out.size() < tracks.size()) {
+			throw std::invalid_argument("sample: output span is smaller than the input");
+		}
+		detail::for_each_range(policy, tracks.size(), detail::track_parallel_grain, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				out[i] = tracks[i].sample(time);
+			}
+		});
+	}
+	sml_export template<std::floating_point T>
+	void sample(std::span<const RotationTrack<T>> tracks, std::type_identity_t<T> time, std::type_identity_t<std::span<Quaternion<T>>> out) {
+		sample(execution::seq, tracks, time, out);
+	}
+
+	// out[i] = tracks[i].sample(time, cursors[i]), for playback that samples every track at steadily increasing times
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void sample(Policy&& policy, std::span<const RotationTrack<T>> tracks, std::type_identity_t<T> time, std::type_identity_t<std::span<typename RotationTrack<T>::cursor>> cursors, std::type_identity_t<std::span<Quaternion<T>>> out) {
+		if (cursors.size() != tracks.size()) {
+			throw std::invalid_argument("sample: there must be one cursor per track");
+		}
+		if (out.size() < tracks.size()) {
+			throw std::invalid_argument("sample: output span is smaller than the input");
+		}
+		detail::for_each_range(policy, tracks.size(), detail::track_parallel_grain, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				out[i] = tracks[i].sample(time, cursors[i]);
+			}
+		});
+	}
+	sml_export template<std::floating_point T>
+	void sample(std::span<const RotationTrack<T>> tracks, std::type_identity_t<T> time, std::type_identity_t<std::span<typename RotationTrack<T>::cursor>> cursors, std::type_identity_t<std::span<Quaternion<T>>> out) {
+		sample(execution::seq, tracks, time, cursors, out);
+	}
+
+	sml_export using RotationTrackf = RotationTrack<float>;
+	sml_export using RotationTrackd = RotationTrack<double>;
+
+}
+#endif // !SML_ANIMATION_HPP
\ No newline at end of file
@@ -0,0 +1,25 @@
+export module sml:Batch;
+
+#ifdef SML_NO_IMPORT_STD
+
+import <array>;
+import <cmath>;
+import <span>;
+import <stdexcept>;
+import <vector>;
+
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+import :Utility;
+import :Allocator;
+import :Vector;
+import :Quaternion;
+import :DynMatrix;
+#define SML_MODULE_BATCH
+#include "Batch.hpp"
\ No newline at end of file
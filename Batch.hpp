@@ -0,0 +1,476 @@
+#ifndef SML_BATCH_HPP
+#define SML_BATCH_HPP
+
+#ifndef SML_MODULE_BATCH
+
+#include <array>
+#include <cmath>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#endif // !SML_MODULE_BATCH
+
+#include "Config.hpp"
+
+// Structure-of-arrays containers for large streams of Vectors and Quaternions
+//
+// A VectorBatch<T, 3> keeps all x components in one array, all y components in another and so on, rather than
+// interleaving them as std::vector<Vector<T, 3>> does. The batch functions below then work on a full SIMD register's
+// worth of elements at a time, with each component loaded with a single contiguous load. Each has a form writing to
+// an existing batch, which avoids allocating (and faulting in) a new one for every call on large streams.
+//
+// Individual elements are reached through proxies which convert to and from Vector and Quaternion, so existing code
+// can keep working element by element:
+//
+//     sml::Vec3Batch<float> positions(n);
+//     positions[i] = sml::Vec3f(1, 2, 3);
+//     positions[i].y() += 1;
+//     sml::Vec3f p = positions[i];
+
+namespace sml {
+
+	namespace detail {
+
+		// Calls f(i) for every i in [0, n). f must only touch element i of each component array, so the loop can be
+		// vectorised as it stands, a full SIMD register of elements per component at a time. Outputs may alias
+		// inputs element for element, which is what allows the batch functions to work in place
+		template<class F>
+		inline void for_each_lane(size_t n, F f) {
+			SML_IVDEP
+			for (size_t i = 0; i < n; i++) {
+				f(i);
+			}
+		}
+
+		// Component arrays shared by the batch containers
+		template<arithmetic T, size_t ncomponents>
+		class soa_storage {
+		public:
+			inline size_t size() const noexcept { return count; }
+			inline bool empty() const noexcept { return count == 0; }
+			inline void clear() noexcept { resize(0); }
+			inline void reserve(size_t n) {
+				for (auto& c : arrays) {
+					c.reserve(n);
+				}
+			}
+			inline void resize(size_t n) {
+				for (auto& c : arrays) {
+					c.resize(n);
+				}
+				count = n;
+			}
+
+			// Direct access to the array holding component c of every element
+			inline T* component(size_t c) noexcept { return arrays[c].data(); }
+			inline const T* component(size_t c) const noexcept { return arrays[c].data(); }
+
+		protected:
+			inline void check_index(size_t i) const {
+				if (i >= count) {
+					throw std::out_of_range("Batch: index out of range");
+				}
+			}
+
+			std::array<std::vector<T, aligned_allocator<T>>, ncomponents> arrays;
+			size_t count = 0;
+		};
+
+		// Proxy for one element of a batch, reading and writing through to the component arrays
+		template<class Batch>
+		class batch_reference {
+		public:
+			using value_type = typename Batch::value_type;
+			using component_type = typename Batch::component_type;
+
+			batch_reference(Batch& b, size_t i) : batch(b), index(i) {}
+
+			inline operator value_type() const { return batch.get(index); }
+			inline value_type value() const { return batch.get(index); }
+
+			inline batch_reference& operator = (const value_type& v) {
+				batch.set(index, v);
+				return *this;
+			}
+			inline batch_reference& operator = (const batch_reference& r) {
+				return (*this) = r.value();
+			}
+
+			// Access components with b[i][c]
+			inline component_type& operator [] (size_t c) const { return batch.component(c)[index]; }
+
+			// Compound operators go through the element type, so they behave exactly as they do for it
+			template<class U>
+			inline batch_reference& operator += (const U& u) { return (*this) = (value() += u); }
+			template<class U>
+			inline batch_reference& operator -= (const U& u) { return (*this) = (value() -= u); }
+			template<class U>
+			inline batch_reference& operator *= (const U& u) { return (*this) = (value() *= u); }
+			template<class U>
+			inline batch_reference& operator /= (const U& u) { return (*this) = (value() /= u); }
+
+			// Named accessors, as on Vector and Quaternion
+			inline component_type& x() const requires (!Batch::is_quaternion) { return (*this)[0]; }
+			inline component_type& y() const requires (!Batch::is_quaternion) { return (*this)[1]; }
+			inline component_type& z() const requires (!Batch::is_quaternion && Batch::components >= 3) { return (*this)[2]; }
+			inline component_type& w() const requires (!Batch::is_quaternion && Batch::components >= 4) { return (*this)[3]; }
+			inline component_type& s() const requires (Batch::is_quaternion) { return (*this)[0]; }
+			inline component_type& i() const requires (Batch::is_quaternion) { return (*this)[1]; }
+			inline component_type& j() const requires (Batch::is_quaternion) { return (*this)[2]; }
+			inline component_type& k() const requires (Batch::is_quaternion) { return (*this)[3]; }
+			inline component_type& q0() const requires (Batch::is_quaternion) { return (*this)[0]; }
+			inline component_type& q1() const requires (Batch::is_quaternion) { return (*this)[1]; }
+			inline component_type& q2() const requires (Batch::is_quaternion) { return (*this)[2]; }
+			inline component_type& q3() const requires (Batch::is_quaternion) { return (*this)[3]; }
+
+		private:
+			Batch& batch;
+			size_t index;
+		};
+
+	} // !namespace detail
+
+	// Structure-of-arrays container of Vectors
+	sml_export template<arithmetic T, size_t elements>
+	class VectorBatch : public detail::soa_storage<T, elements> {
+		using base = detail::soa_storage<T, elements>;
+	public:
+		using value_type = Vector<T, elements>;
+		using component_type = T;
+		using reference = detail::batch_reference<VectorBatch>;
+		static constexpr size_t components = elements;
+		static constexpr bool is_quaternion = false;
+
+		VectorBatch() {}
+		explicit VectorBatch(size_t n) { this->resize(n); }
+		template<arithmetic T2>
+		VectorBatch(std::span<const Vector<T2, elements>> vs) {
+			this->resize(vs.size());
+			for (size_t i = 0; i < vs.size(); i++) {
+				set(i, vs[i]);
+			}
+		}
+		template<arithmetic T2>
+		VectorBatch(const std::vector<Vector<T2, elements>>& vs) : VectorBatch(std::span<const Vector<T2, elements>>(vs)) {}
+
+		// Access elements with b[i], through a proxy which converts to and from Vector
+		inline reference operator [] (size_t i) { return reference(*this, i); }
+		inline value_type operator [] (size_t i) const { return get(i); }
+
+		// Access elements with b.at(i)
+		inline reference at(size_t i) { this->check_index(i); return reference(*this, i); }
+		inline value_type at(size_t i) const { this->check_index(i); return get(i); }
+
+		inline value_type get(size_t i) const {
+			value_type ret;
+			for (size_t c = 0; c < elements; c++) {
+				ret[c] = this->arrays[c][i];
+			}
+			return ret;
+		}
+		template<arithmetic T2>
+		inline void set(size_t i, const Vector<T2, elements>& v) {
+			for (size_t c = 0; c < elements; c++) {
+				this->arrays[c][i] = static_cast<T>(v[c]);
+			}
+		}
+		template<arithmetic T2>
+		inline void push_back(const Vector<T2, elements>& v) {
+			for (size_t c = 0; c < elements; c++) {
+				this->arrays[c].push_back(static_cast<T>(v[c]));
+			}
+			this->count++;
+		}
+
+		// Copy the batch back out to an array of Vectors
+		inline std::vector<value_type> to_vectors() const {
+			std::vector<value_type> ret(this->count);
+			for (size_t i = 0; i < this->count; i++) {
+				ret[i] = get(i);
+			}
+			return ret;
+		}
+	};
+
+	// Structure-of-arrays container of Quaternions, with components stored in q0, q1, q2, q3 order
+	sml_export template<arithmetic T>
+	class QuaternionBatch : public detail::soa_storage<T, 4> {
+		using base = detail::soa_storage<T, 4>;
+	public:
+		using value_type = Quaternion<T>;
+		using component_type = T;
+		using reference = detail::batch_reference<QuaternionBatch>;
+		static constexpr size_t components = 4;
+		static constexpr bool is_quaternion = true;
+
+		QuaternionBatch() {}
+		explicit QuaternionBatch(size_t n) { this->resize(n); }
+		template<arithmetic T2>
+		QuaternionBatch(std::span<const Quaternion<T2>> qs) {
+			this->resize(qs.size());
+			for (size_t i = 0; i < qs.size(); i++) {
+				set(i, qs[i]);
+			}
+		}
+		template<arithmetic T2>
+		QuaternionBatch(const std::vector<Quaternion<T2>>& qs) : QuaternionBatch(std::span<const Quaternion<T2>>(qs)) {}
+
+		// Access elements with b[i], through a proxy which converts to and from Quaternion
+		inline reference operator [] (size_t i) { return reference(*this, i); }
+		inline value_type operator [] (size_t i) const { return get(i); }
+
+		// Access elements with b.at(i)
+		inline reference at(size_t i) { this->check_index(i); return reference(*this, i); }
+		inline value_type at(size_t i) const { this->check_index(i); return get(i); }
+
+		inline value_type get(size_t i) const {
+			return value_type(this->arrays[0][i], this->arrays[1][i], this->arrays[2][i], this->arrays[3][i]);
+		}
+		template<arithmetic T2>
+		inline void set(size_t i, const Quaternion<T2>& q) {
+			for (size_t c = 0; c < 4; c++) {
+				this->arrays[c][i] = static_cast<T>(q[c]);
+			}
+		}
+		template<arithmetic T2>
+		inline void push_back(const Quaternion<T2>& q) {
+			for (size_t c = 0; c < 4; c++) {
+				this->arrays[c].push_back(static_cast<T>(q[c]));
+			}
+			this->count++;
+		}
+
+		// Copy the batch back out to an array of Quaternions
+		inline std::vector<value_type> to_quaternions() const {
+			std::vector<value_type> ret(this->count);
+			for (size_t i = 0; i < this->count; i++) {
+				ret[i] = get(i);
+			}
+			return ret;
+		}
+	};
+
+	sml_export template<arithmetic T>
+	using Vec3Batch = VectorBatch<T, 3>;
+	sml_export template<arithmetic T>
+	using Vec4Batch = VectorBatch<T, 4>;
+	sml_export template<arithmetic T>
+	using QuatBatch = QuaternionBatch<T>;
+
+	namespace detail {
+
+		template<class B1, class B2>
+		inline void require_same_size(const B1& b1, const B2& b2) {
+			if (b1.size() != b2.size()) {
+				throw std::invalid_argument("Batch: sizes do not match");
+			}
+		}
+
+	} // !namespace detail
+
+	// Dot product of each pair of elements, written to out
+	sml_export template<arithmetic T, size_t elements>
+	void dot(const VectorBatch<T, elements>& b1, const VectorBatch<T, elements>& b2, DynVector<T>& out) {
+		detail::require_same_size(b1, b2);
+		out.resize(b1.size());
+		T* r = out.data.data();
+		std::array<const T*, elements> p1, p2;
+		for (size_t c = 0; c < elements; c++) {
+			p1[c] = b1.component(c);
+			p2[c] = b2.component(c);
+		}
+		detail::for_each_lane(b1.size(), [&](size_t i) {
+			T sum = p1[0][i] * p2[0][i];
+			for (size_t c = 1; c < elements; c++) {
+				sum += p1[c][i] * p2[c][i];
+			}
+			r[i] = sum;
+		});
+	}
+	sml_export template<arithmetic T, size_t elements>
+	DynVector<T> dot(const VectorBatch<T, elements>& b1, const VectorBatch<T, elements>& b2) {
+		DynVector<T> ret;
+		dot(b1, b2, ret);
+		return ret;
+	}
+
+	// Cross product of each pair of elements, written to out
+	sml_export template<arithmetic T>
+	void cross_product(const VectorBatch<T, 3>& b1, const VectorBatch<T, 3>& b2, VectorBatch<T, 3>& out) {
+		detail::require_same_size(b1, b2);
+		out.resize(b1.size());
+		const T* ax = b1.component(0); const T* ay = b1.component(1); const T* az = b1.component(2);
+		const T* bx = b2.component(0); const T* by = b2.component(1); const T* bz = b2.component(2);
+		T* rx = out.component(0); T* ry = out.component(1); T* rz = out.component(2);
+		detail::for_each_lane(b1.size(), [&](size_t i) {
+			const T x = (ay[i] * bz[i]) - (az[i] * by[i]);
+			const T y = (az[i] * bx[i]) - (ax[i] * bz[i]);
+			const T z = (ax[i] * by[i]) - (ay[i] * bx[i]);
+			rx[i] = x;
+			ry[i] = y;
+			rz[i] = z;
+		});
+	}
+	sml_export template<arithmetic T>
+	VectorBatch<T, 3> cross_product(const VectorBatch<T, 3>& b1, const VectorBatch<T, 3>& b2) {
+		VectorBatch<T, 3> ret;
+		cross_product(b1, b2, ret);
+		return ret;
+	}
+
+	// Normalise each element, written to out
+	sml_export template<arithmetic T, size_t elements>
+	void unit_vector(const VectorBatch<T, elements>& b, VectorBatch<T, elements>& out) {
+		out.resize(b.size());
+		std::array<const T*, elements> in;
+		std::array<T*, elements> r;
+		for (size_t c = 0; c < elements; c++) {
+			in[c] = b.component(c);
+			r[c] = out.component(c);
+		}
+		detail::for_each_lane(b.size(), [&](size_t i) {
+			T sum = in[0][i] * in[0][i];
+			for (size_t c = 1; c < elements; c++) {
+				sum += in[c][i] * in[c][i];
+			}
+			const T scale = T(1) / static_cast<T>(std::sqrt(sum));
+			for (size_t c = 0; c < elements; c++) {
+				r[c][i] = in[c][i] * scale;
+			}
+		});
+	}
+	sml_export template<arithmetic T, size_t elements>
+	VectorBatch<T, elements> unit_vector(const VectorBatch<T, elements>& b) {
+		VectorBatch<T, elements> ret;
+		unit_vector(b, ret);
+		return ret;
+	}
+
+	namespace detail {
+
+		// Rotates each position by the matching quaternion, which need not be normalised:
+		// q p q* = |q|^2 p + s t + v x t with t = 2 (v x p), so dividing by |q|^2 gives the rotation by q / |q|
+		// conjugate selects q* p q instead, the rotation by the conjugate quaternion
+		template<bool conjugate, arithmetic T, class Rotation>
+		inline void rotate_batch(const VectorBatch<T, 3>& positions, Rotation rotation, VectorBatch<T, 3>& out) {
+			out.resize(positions.size());
+			const T* px = positions.component(0); const T* py = positions.component(1); const T* pz = positions.component(2);
+			T* rx = out.component(0); T* ry = out.component(1); T* rz = out.component(2);
+			const T sign = conjugate ? T(-1) : T(1);
+			detail::for_each_lane(positions.size(), [&](size_t i) {
+				T qs, qi, qj, qk;
+				rotation(i, qs, qi, qj, qk);
+				qi *= sign; qj *= sign; qk *= sign;
+				const T x = px[i], y = py[i], z = pz[i];
+				const T inv_norm = T(1) / ((qs * qs) + (qi * qi) + (qj * qj) + (qk * qk));
+				const T tx = T(2) * ((qj * z) - (qk * y));
+				const T ty = T(2) * ((qk * x) - (qi * z));
+				const T tz = T(2) * ((qi * y) - (qj * x));
+				rx[i] = x + (((qs * tx) + (qj * tz) - (qk * ty)) * inv_norm);
+				ry[i] = y + (((qs * ty) + (qk * tx) - (qi * tz)) * inv_norm);
+				rz[i] = z + (((qs * tz) + (qi * ty) - (qj * tx)) * inv_norm);
+			});
+		}
+
+		template<arithmetic T, arithmetic T2>
+		inline auto batch_rotation(const QuaternionBatch<T2>& rots) {
+			return [s = rots.component(0), i = rots.component(1), j = rots.component(2), k = rots.component(3)]
+			(size_t n, T& qs, T& qi, T& qj, T& qk) {
+				qs = static_cast<T>(s[n]); qi = static_cast<T>(i[n]); qj = static_cast<T>(j[n]); qk = static_cast<T>(k[n]);
+			};
+		}
+
+		template<arithmetic T, arithmetic T2>
+		inline auto single_rotation(const Quaternion<T2>& rot) {
+			return [s = static_cast<T>(rot.s()), i = static_cast<T>(rot.i()), j = static_cast<T>(rot.j()), k = static_cast<T>(rot.k())]
+			(size_t, T& qs, T& qi, T& qj, T& qk) {
+				qs = s; qi = i; qj = j; qk = k;
+			};
+		}
+
+	} // !namespace detail
+
+	// Rotate each position as RotateActive does: Inverse(rot) * pos * rot, written to out
+	sml_export template<arithmetic T, arithmetic T2>
+	inline void RotateActive(const VectorBatch<T2, 3>& positions, const QuaternionBatch<T>& rots, VectorBatch<T2, 3>& out) {
+		detail::require_same_size(positions, rots);
+		detail::rotate_batch<true>(positions, detail::batch_rotation<T2>(rots), out);
+	}
+	sml_export template<arithmetic T, arithmetic T2>
+	inline void RotateActive(const VectorBatch<T2, 3>& positions, const Quaternion<T>& rot, VectorBatch<T2, 3>& out) {
+		detail::rotate_batch<true>(positions, detail::single_rotation<T2>(rot), out);
+	}
+	sml_export template<arithmetic T, arithmetic T2>
+	inline VectorBatch<T2, 3> RotateActive(const VectorBatch<T2, 3>& positions, const QuaternionBatch<T>& rots) {
+		VectorBatch<T2, 3> ret;
+		RotateActive(positions, rots, ret);
+		return ret;
+	}
+	sml_export template<arithmetic T, arithmetic T2>
+	inline VectorBatch<T2, 3> RotateActive(const VectorBatch<T2, 3>& positions, const Quaternion<T>& rot) {
+		VectorBatch<T2, 3> ret;
+		RotateActive(positions, rot, ret);
+		return ret;
+	}
+
+	// Rotate each position as RotatePassive does: rot * pos * Inverse(rot), written to out
+	sml_export template<arithmetic T, arithmetic T2>
+	inline void RotatePassive(const VectorBatch<T2, 3>& positions, const QuaternionBatch<T>& rots, VectorBatch<T2, 3>& out) {
+		detail::require_same_size(positions, rots);
+		detail::rotate_batch<false>(positions, detail::batch_rotation<T2>(rots), out);
+	}
+	sml_export template<arithmetic T, arithmetic T2>
+	inline void RotatePassive(const VectorBatch<T2, 3>& positions, const Quaternion<T>& rot, VectorBatch<T2, 3>& out) {
+		detail::rotate_batch<false>(positions, detail::single_rotation<T2>(rot), out);
+	}
+	sml_export template<arithmetic T, arithmetic T2>
+	inline VectorBatch<T2, 3> RotatePassive(const VectorBatch<T2, 3>& positions, const QuaternionBatch<T>& rots) {
+		VectorBatch<T2, 3> ret;
+		RotatePassive(positions, rots, ret);
+		return ret;
+	}
+	sml_export template<arithmetic T, arithmetic T2>
+	inline VectorBatch<T2, 3> RotatePassive(const VectorBatch<T2, 3>& positions, const Quaternion<T>& rot) {
+		VectorBatch<T2, 3> ret;
+		RotatePassive(positions, rot, ret);
+		return ret;
+	}
+
+	// Hamilton product of each pair of elements, written to out
+	sml_export template<arithmetic T, arithmetic T2>
+	void multiply(const QuaternionBatch<T>& b1, const QuaternionBatch<T2>& b2, QuaternionBatch<T>& out) {
+		detail::require_same_size(b1, b2);
+		out.resize(b1.size());
+		const T* a0 = b1.component(0); const T* a1 = b1.component(1); const T* a2 = b1.component(2); const T* a3 = b1.component(3);
+		const T2* c0 = b2.component(0); const T2* c1 = b2.component(1); const T2* c2 = b2.component(2); const T2* c3 = b2.component(3);
+		T* r0 = out.component(0); T* r1 = out.component(1); T* r2 = out.component(2); T* r3 = out.component(3);
+		detail::for_each_lane(b1.size(), [&](size_t i) {
+			const T a = a0[i], b = a1[i], c = a2[i], d = a3[i];
+			const T e = static_cast<T>(c0[i]), f = static_cast<T>(c1[i]), g = static_cast<T>(c2[i]), h = static_cast<T>(c3[i]);
+			r0[i] = (a * e) - (b * f) - (c * g) - (d * h);
+			r1[i] = (a * f) + (b * e) + (c * h) - (d * g);
+			r2[i] = (a * g) - (b * h) + (c * e) + (d * f);
+			r3[i] = (a * h) + (b * g) - (c * f) + (d * e);
+		});
+	}
+	sml_export template<arithmetic T, arithmetic T2>
+	QuaternionBatch<T> operator * (const QuaternionBatch<T>& b1, const QuaternionBatch<T2>& b2) {
+		QuaternionBatch<T> ret;
+		multiply(b1, b2, ret);
+		return ret;
+	}
+
+	sml_export using Vec3fBatch = VectorBatch<float, 3>;
+	sml_export using Vec3dBatch = VectorBatch<double, 3>;
+	sml_export using Vec4fBatch = VectorBatch<float, 4>;
+	sml_export using Vec4dBatch = VectorBatch<double, 4>;
+	sml_export using QuatfBatch = QuaternionBatch<float>;
+	sml_export using QuatdBatch = QuaternionBatch<double>;
+
+}
+#endif // !SML_BATCH_HPP
\ No newline at end of file
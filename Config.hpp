@@ -0,0 +1,79 @@
+#ifndef SML_CONFIG_HPP
+#define SML_CONFIG_HPP
+
+// Preprocessor configuration shared by every part of the library
+// Macros do not travel through module imports, so each header that needs these includes this file directly
+
+// Keep the compiler from fully unrolling the loop that follows, so that it is vectorised as written
+#if defined(__GNUC__)
+#define SML_NO_UNROLL _Pragma("GCC unroll 1")
+#else
+#define SML_NO_UNROLL
+#endif
+
+// Tell the compiler that iterations of the loop that follows are independent, so that it is vectorised without
+// runtime alias checks. Only for loops where each iteration reads and writes its own element of every array
+#if defined(__clang__)
+#define SML_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define SML_IVDEP _Pragma("GCC ivdep")
+#elif defined(_MSC_VER)
+#define SML_IVDEP __pragma(loop(ivdep))
+#else
+#define SML_IVDEP
+#endif
+
+// Promise the optimiser that cond holds, so that it can drop the branches and checks that follow from it
+// cond is not always evaluated, so it must be free of side effects; if it does not hold, the behaviour is undefined
+#if __has_cpp_attribute(assume)
+#define SML_ASSUME(cond) [[assume(cond)]]
+#elif defined(__clang__)
+#define SML_ASSUME(cond) __builtin_assume(cond)
+#elif defined(_MSC_VER)
+#define SML_ASSUME(cond) __assume(cond)
+#elif defined(__GNUC__)
+#define SML_ASSUME(cond) ((cond) ? void(0) : __builtin_unreachable())
+#else
+#define SML_ASSUME(cond) void(0)
+#endif
+
+// Index checking for operator[] and the other unchecked accessors that the kernels are built on. This is opt-in:
+// define SML_CHECKED (for example in debug builds) to have out-of-range indices throw std::out_of_range, as at()
+// always does. Otherwise the index is only assumed to be in range, which leaves no branch behind in the kernels
+#if defined(SML_CHECKED)
+#define SML_CHECK_INDEX(i, n) do { if (!((i) < (n))) { throw std::out_of_range("sml: index out of range"); } } while (false)
+#else
+#define SML_CHECK_INDEX(i, n) SML_ASSUME((i) < (n))
+#endif
+
+// Checks of preconditions that are too costly to test on every call, such as a quaternion being of unit length.
+// Also opt-in through SML_CHECKED, throwing std::invalid_argument with message when cond does not hold, and compiled
+// out otherwise
+#if defined(SML_CHECKED)
+#define SML_CHECK_ARGUMENT(cond, message) do { if (!(cond)) { throw std::invalid_argument(message); } } while (false)
+#else
+#define SML_CHECK_ARGUMENT(cond, message) void(0)
+#endif
+
+// Explicit SIMD backend for small Vectors. This is opt-in: define SML_SIMD before including the library
+// The instruction set is chosen at compile time from the target's ISA macros
+#if defined(SML_SIMD)
+#if defined(__AVX__)
+#define SML_SIMD_AVX
+#endif
+#if defined(__FMA__) || defined(__AVX2__)
+#define SML_SIMD_FMA
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SML_SIMD_SSE
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define SML_SIMD_NEON
+#endif
+#endif // SML_SIMD
+
+// Quaternion storage. This is opt-in and separate from SML_SIMD, as it changes the interface of Quaternion: define
+// SML_QUATERNION_LANES to have a Quaternion hold its lanes (s, i, j, k) in one aligned array, with its parts reached
+// through scalar() and vector() in place of the scalar and vector members. With SML_SIMD as well, the Quaternion
+// kernels then load the lanes straight in to the SIMD registers
+
+#endif // !SML_CONFIG_HPP
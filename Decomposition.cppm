@@ -0,0 +1,24 @@
+export module sml:Decomposition;
+
+#ifdef SML_NO_IMPORT_STD
+
+import <algorithm>;
+import <array>;
+import <cmath>;
+import <vector>;
+
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+import :Utility;
+import :Allocator;
+import :Vector;
+import :Matrix;
+import :DynMatrix;
+#define SML_MODULE_DECOMPOSITION
+#include "Decomposition.hpp"
\ No newline at end of file
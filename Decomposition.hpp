@@ -0,0 +1,646 @@
+#ifndef SML_DECOMPOSITION_HPP
+#define SML_DECOMPOSITION_HPP
+
+#ifndef SML_MODULE_DECOMPOSITION
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#endif // !SML_MODULE_DECOMPOSITION
+
+// Matrix factorisations, factored once and reused for any number of solves
+//
+//     sml::LUFactor<double, 6> lu(A);
+//     for (const auto& b : rhs) {
+//         x = lu.solve(b);
+//     }
+//
+// Factors are computed in the precision of the input, with integer matrices factored in float
+//
+// Symmetric positive-definite matrices, such as covariances and the normal equations, have a Cholesky factorisation
+// A = transpose(U) U and an LDL^T factorisation A = transpose(U) D U with U unit upper triangular. Either takes half
+// the work of LU and needs no pivoting, and either can be updated for A +- v transpose(v) without refactoring:
+//
+//     sml::CholeskyFactor<double, 6> s(S);           // or sml::cholesky(S), and DynCholeskyFactor for a DynMatrix
+//     const auto K = transpose(s.solve(H * P));      // Kalman gain P^T H^T S^-1, for symmetric P and S
+//     const double nll = 0.5 * (dot(y, s.solve(y)) + s.log_det());   // Gaussian likelihood, up to a constant
+
+namespace sml {
+
+	namespace detail {
+
+		// Width of the panels in the blocked LDL^T and Cholesky factorisations
+		inline constexpr size_t ldlt_block = 32;
+
+		// Blocked right-looking factorisation without pivoting, in place, of the symmetric n x n row-major matrix a,
+		// reading only its upper triangle. On return the upper triangle holds either the Cholesky factor U (if
+		// square_root) or D on the diagonal and the unit upper triangular U above it, and the lower triangle is left as
+		// it was. Returns false if a pivot was not positive (Cholesky) or zero (LDL^T); the factorisation then carries
+		// on past that row, with the row set to zero
+		// U = transpose(L) is computed rather than L so that every update runs along a contiguous row. A matrix that
+		// fits in one panel is factored in a single unblocked pass
+		template<bool square_root, std::floating_point T>
+		constexpr bool symmetric_factor_inplace(T* a, size_t n) {
+			bool ret = true;
+			const auto row = [a, n](size_t i) { return a + (i * n); };
+			// The multiplier of row k of U in the updates: U(k, i) for Cholesky, D(k) U(k, i) for LDL^T
+			const auto multiplier = [](const T* rk, size_t k, size_t i) {
+				if constexpr (square_root) {
+					return rk[i];
+				}
+				else {
+					return rk[k] * rk[i];
+				}
+			};
+
+			for (size_t kb = 0; kb < n; kb += ldlt_block) {
+				const size_t ke = std::min(n, kb + ldlt_block);
+
+				for (size_t k = kb; k < ke; k++) {
+					T* rk = row(k);
+					// The part of row k right of the panel, from the rows of the panel above it
+					for (size_t p = kb; p < k; p++) {
+						const T* rp = row(p);
+						const T u = multiplier(rp, p, k);
+						for (size_t j = ke; j < n; j++) {
+							rk[j] -= u * rp[j];
+						}
+					}
+
+					T pivot = rk[k];
+					if constexpr (square_root) {
+						if (!(pivot > T(0))) {
+							ret = false;
+							pivot = 0;
+						}
+						pivot = constexpr_sqrt(pivot);
+					}
+					else if (pivot == T(0)) {
+						ret = false;
+					}
+					rk[k] = pivot;
+					const T inv_pivot = (pivot != T(0)) ? (T(1) / pivot) : T(0);
+					for (size_t j = k + 1; j < n; j++) {
+						rk[j] *= inv_pivot;
+					}
+
+					// The rest of the panel below row k
+					for (size_t i = k + 1; i < ke; i++) {
+						T* ri = row(i);
+						const T u = multiplier(rk, k, i);
+						for (size_t j = i; j < ke; j++) {
+							ri[j] -= u * rk[j];
+						}
+					}
+				}
+
+				// Trailing update of the upper triangle, streaming along rows while the panel stays in cache
+				for (size_t i = ke; i < n; i++) {
+					T* ri = row(i);
+					for (size_t k = kb; k < ke; k++) {
+						const T* rk = row(k);
+						const T u = multiplier(rk, k, i);
+						for (size_t j = i; j < n; j++) {
+							ri[j] -= u * rk[j];
+						}
+					}
+				}
+			}
+			return ret;
+		}
+
+		// A = transpose(U) D U with U unit upper triangular, returning false if a pivot was zero
+		template<std::floating_point T>
+		constexpr bool ldlt_factor_inplace(T* a, size_t n) {
+			return symmetric_factor_inplace<false>(a, n);
+		}
+
+		// A = transpose(U) U, returning false if a is not positive definite
+		template<std::floating_point T>
+		constexpr bool cholesky_factor_inplace(T* a, size_t n) {
+			return symmetric_factor_inplace<true>(a, n);
+		}
+
+		// Zero the triangle below the diagonal, which the factorisations leave as it was
+		template<std::floating_point T>
+		constexpr void clear_lower(T* a, size_t n) {
+			for (size_t i = 1; i < n; i++) {
+				std::fill(a + (i * n), a + (i * n) + i, T(0));
+			}
+		}
+
+		// Solve transpose(U) D U X = B in place for a unit U with D on its diagonal (as from ldlt_factor_inplace), or
+		// transpose(U) U X = B for a Cholesky factor U, where B is n x nrhs row-major
+		template<std::floating_point T>
+		constexpr void symmetric_solve_inplace(const T* u, size_t n, T* b, size_t nrhs, bool unit) {
+			const auto row = [b, nrhs](size_t i) { return b + (i * nrhs); };
+			// Forward substitution with transpose(U), scattering each solved row of X to the rows below it, and then
+			// dividing it by D for LDL^T
+			for (size_t k = 0; k < n; k++) {
+				T* bk = row(k);
+				const T* uk = u + (k * n);
+				const T inv_pivot = T(1) / uk[k];
+				if (!unit) {
+					for (size_t j = 0; j < nrhs; j++) {
+						bk[j] *= inv_pivot;
+					}
+				}
+				for (size_t i = k + 1; i < n; i++) {
+					T* bi = row(i);
+					const T l = uk[i];
+					for (size_t j = 0; j < nrhs; j++) {
+						bi[j] -= l * bk[j];
+					}
+				}
+				if (unit) {
+					for (size_t j = 0; j < nrhs; j++) {
+						bk[j] *= inv_pivot;
+					}
+				}
+			}
+			// Back substitution with U
+			for (size_t i = n; i-- > 0;) {
+				T* bi = row(i);
+				const T* ui = u + (i * n);
+				for (size_t k = i + 1; k < n; k++) {
+					const T* bk = row(k);
+					for (size_t j = 0; j < nrhs; j++) {
+						bi[j] -= ui[k] * bk[j];
+					}
+				}
+				if (!unit) {
+					const T inv_pivot = T(1) / ui[i];
+					for (size_t j = 0; j < nrhs; j++) {
+						bi[j] *= inv_pivot;
+					}
+				}
+			}
+		}
+
+		// Update the Cholesky factor U of A to that of A + sigma x transpose(x), for sigma 1 (an update) or -1 (a
+		// downdate), overwriting x. Each row of U is turned by one rotation, in O(n^2) in all. Returns false if a
+		// downdate leaves a matrix that is not positive definite, after which U is meaningless
+		template<std::floating_point T>
+		constexpr bool cholesky_update_inplace(T* u, size_t n, T* x, T sigma) {
+			for (size_t k = 0; k < n; k++) {
+				T* uk = u + (k * n);
+				const T ukk = uk[k];
+				const T xk = x[k];
+				const T r2 = (ukk * ukk) + (sigma * xk * xk);
+				if (!(r2 > T(0))) {
+					return false;
+				}
+				const T r = constexpr_sqrt(r2);
+				const T c = r / ukk;
+				const T s = xk / ukk;
+				const T inv_c = T(1) / c;
+				uk[k] = r;
+				for (size_t j = k + 1; j < n; j++) {
+					uk[j] = (uk[j] + (sigma * s * x[j])) * inv_c;
+					x[j] = (c * x[j]) - (s * uk[j]);
+				}
+			}
+			return true;
+		}
+
+		// Update the LDL^T factorisation of A, as from ldlt_factor_inplace, to that of A + sigma w transpose(w), for
+		// sigma 1 or -1, overwriting w. Returns false if a pivot becomes zero
+		template<std::floating_point T>
+		constexpr bool ldlt_update_inplace(T* u, size_t n, T* w, T sigma) {
+			bool nonsingular = true;
+			T alpha = 1;
+			for (size_t j = 0; j < n; j++) {
+				T* uj = u + (j * n);
+				const T wj = w[j];
+				if (wj != T(0)) {
+					const T d = uj[j];
+					const T swj2 = sigma * wj * wj;
+					const T gamma = (d * alpha) + swj2;
+					uj[j] += swj2 / alpha;
+					alpha += swj2 / d;
+					const T g = (gamma != T(0)) ? ((sigma * wj) / gamma) : T(0);
+					for (size_t r = j + 1; r < n; r++) {
+						w[r] -= wj * uj[r];
+						uj[r] += g * w[r];
+					}
+				}
+				nonsingular = nonsingular && (uj[j] != T(0));
+			}
+			return nonsingular;
+		}
+
+		// Sum of the logarithms of the absolute values of the diagonal of the n x n row-major matrix a
+		template<std::floating_point T>
+		inline T log_diagonal(const T* a, size_t n) {
+			T ret = 0;
+			for (size_t i = 0; i < n; i++) {
+				ret += std::log(std::abs(a[(i * n) + i]));
+			}
+			return ret;
+		}
+
+		template<std::floating_point T>
+		constexpr T diagonal_product(const T* a, size_t n) {
+			T ret = 1;
+			for (size_t i = 0; i < n; i++) {
+				ret *= a[(i * n) + i];
+			}
+			return ret;
+		}
+
+	} // !namespace detail
+
+	// LU factorisation with partial pivoting, P A = L U, of a square Matrix
+	sml_export template<arithmetic T, size_t dim>
+	class LUFactor {
+	public:
+		using value_type = detail::decomposition_type<T>;
+
+		LUFactor() {}
+		explicit LUFactor(const Matrix<T, dim, dim>& m) { factor(m); }
+
+		// (Re)factor m, replacing any previous factors
+		inline void factor(const Matrix<T, dim, dim>& m) {
+			lu = m;
+			swaps = detail::lu_factor_inplace(lu.data.data(), dim, pivot_rows.data(), is_singular);
+		}
+
+		// True if the matrix had a zero pivot; solve() and det() are then meaningless, and inverse() returns zeros
+		inline bool singular() const { return is_singular; }
+
+		// Solve A x = b
+		template<arithmetic T2>
+		inline Vector<value_type, dim> solve(const Vector<T2, dim>& b) const {
+			Vector<value_type, dim> x(b);
+			detail::lu_solve_inplace(lu.data.data(), pivot_rows.data(), dim, &*x.begin(), 1);
+			return x;
+		}
+
+		// Solve A X = B, for every column of B at once
+		template<arithmetic T2, size_t nrhs>
+		inline Matrix<value_type, dim, nrhs> solve(const Matrix<T2, dim, nrhs>& B) const {
+			Matrix<value_type, dim, nrhs> X(B);
+			detail::lu_solve_inplace(lu.data.data(), pivot_rows.data(), dim, X.data.data(), nrhs);
+			return X;
+		}
+
+		inline value_type det() const {
+			return detail::lu_det(lu.data.data(), dim, swaps);
+		}
+
+		// As for the Gauss-Jordan inverse, a singular matrix gives a matrix of zeroes
+		inline Matrix<value_type, dim, dim> inverse() const {
+			if (is_singular) {
+				return Matrix<value_type, dim, dim>(0);
+			}
+			return solve(identity<value_type, dim>());
+		}
+
+		// L (below the diagonal, with an implicit unit diagonal) and U (on and above it), packed together
+		inline const Matrix<value_type, dim, dim>& factors() const { return lu; }
+		// pivots()[k] is the row exchanged with row k at step k of the factorisation
+		inline const std::array<size_t, dim>& pivots() const { return pivot_rows; }
+		inline size_t row_exchanges() const { return swaps; }
+
+	private:
+		Matrix<value_type, dim, dim> lu;
+		std::array<size_t, dim> pivot_rows = {};
+		size_t swaps = 0;
+		bool is_singular = false;
+	};
+
+	// Cholesky factorisation A = transpose(U) U of a symmetric positive-definite Matrix, with U upper triangular
+	// Only the upper triangle of the matrix is read
+	sml_export template<arithmetic T, size_t dim>
+	class CholeskyFactor {
+	public:
+		using value_type = detail::decomposition_type<T>;
+
+		CholeskyFactor() {}
+		explicit CholeskyFactor(const Matrix<T, dim, dim>& m) { factor(m); }
+
+		// (Re)factor m, replacing any previous factor
+		inline void factor(const Matrix<T, dim, dim>& m) {
+			u = m;
+			is_positive_definite = detail::cholesky_factor_inplace(u.data.data(), dim);
+			detail::clear_lower(u.data.data(), dim);
+		}
+
+		// False if the matrix was not positive definite; solve(), det() and log_det() are then meaningless
+		inline bool positive_definite() const { return is_positive_definite; }
+
+		// Solve A x = b
+		template<arithmetic T2>
+		inline Vector<value_type, dim> solve(const Vector<T2, dim>& b) const {
+			Vector<value_type, dim> x(b);
+			detail::symmetric_solve_inplace(u.data.data(), dim, &*x.begin(), 1, false);
+			return x;
+		}
+
+		// Solve A X = B, for every column of B at once
+		template<arithmetic T2, size_t nrhs>
+		inline Matrix<value_type, dim, nrhs> solve(const Matrix<T2, dim, nrhs>& B) const {
+			Matrix<value_type, dim, nrhs> X(B);
+			detail::symmetric_solve_inplace(u.data.data(), dim, X.data.data(), nrhs, false);
+			return X;
+		}
+
+		inline value_type det() const {
+			const value_type d = detail::diagonal_product(u.data.data(), dim);
+			return d * d;
+		}
+
+		// log(det(A)), which unlike det() does not overflow or underflow for large matrices
+		inline value_type log_det() const {
+			return 2 * detail::log_diagonal(u.data.data(), dim);
+		}
+
+		inline Matrix<value_type, dim, dim> inverse() const {
+			return solve(identity<value_type, dim>());
+		}
+
+		// Refactor for A + v transpose(v) or A - v transpose(v), in O(dim^2) rather than the O(dim^3) of factor()
+		// A downdate that leaves a matrix that is not positive definite returns false, as positive_definite() does
+		// from then on
+		template<arithmetic T2>
+		inline bool update(const Vector<T2, dim>& v) {
+			Vector<value_type, dim> x(v);
+			return is_positive_definite = detail::cholesky_update_inplace(u.data.data(), dim, &*x.begin(), value_type(1));
+		}
+		template<arithmetic T2>
+		inline bool downdate(const Vector<T2, dim>& v) {
+			Vector<value_type, dim> x(v);
+			return is_positive_definite = detail::cholesky_update_inplace(u.data.data(), dim, &*x.begin(), value_type(-1));
+		}
+
+		// U, with zeroes below the diagonal
+		inline const Matrix<value_type, dim, dim>& factors() const { return u; }
+
+	private:
+		Matrix<value_type, dim, dim> u;
+		bool is_positive_definite = false;
+	};
+
+	// LDL^T factorisation A = transpose(U) D U of a symmetric Matrix, with U unit upper triangular and D diagonal
+	// Unlike Cholesky it takes no square roots, and it does not pivot, so it is for positive-definite matrices and
+	// others (such as quasi-definite ones) that need no pivoting. Only the upper triangle of the matrix is read
+	sml_export template<arithmetic T, size_t dim>
+	class LDLTFactor {
+	public:
+		using value_type = detail::decomposition_type<T>;
+
+		LDLTFactor() {}
+		explicit LDLTFactor(const Matrix<T, dim, dim>& m) { factor(m); }
+
+		// (Re)factor m, replacing any previous factors
+		inline void factor(const Matrix<T, dim, dim>& m) {
+			ud = m;
+			is_singular = !detail::ldlt_factor_inplace(ud.data.data(), dim);
+			detail::clear_lower(ud.data.data(), dim);
+		}
+
+		// True if a pivot was zero; solve() is then meaningless
+		inline bool singular() const { return is_singular; }
+
+		// Solve A x = b
+		template<arithmetic T2>
+		inline Vector<value_type, dim> solve(const Vector<T2, dim>& b) const {
+			Vector<value_type, dim> x(b);
+			detail::symmetric_solve_inplace(ud.data.data(), dim, &*x.begin(), 1, true);
+			return x;
+		}
+
+		// Solve A X = B, for every column of B at once
+		template<arithmetic T2, size_t nrhs>
+		inline Matrix<value_type, dim, nrhs> solve(const Matrix<T2, dim, nrhs>& B) const {
+			Matrix<value_type, dim, nrhs> X(B);
+			detail::symmetric_solve_inplace(ud.data.data(), dim, X.data.data(), nrhs, true);
+			return X;
+		}
+
+		inline value_type det() const {
+			return detail::diagonal_product(ud.data.data(), dim);
+		}
+
+		// log(|det(A)|)
+		inline value_type log_det() const {
+			return detail::log_diagonal(ud.data.data(), dim);
+		}
+
+		inline Matrix<value_type, dim, dim> inverse() const {
+			return solve(identity<value_type, dim>());
+		}
+
+		// Refactor for A + v transpose(v) or A - v transpose(v) in O(dim^2), returning false if a pivot becomes zero
+		template<arithmetic T2>
+		inline bool update(const Vector<T2, dim>& v) {
+			Vector<value_type, dim> w(v);
+			is_singular = !detail::ldlt_update_inplace(ud.data.data(), dim, &*w.begin(), value_type(1));
+			return !is_singular;
+		}
+		template<arithmetic T2>
+		inline bool downdate(const Vector<T2, dim>& v) {
+			Vector<value_type, dim> w(v);
+			is_singular = !detail::ldlt_update_inplace(ud.data.data(), dim, &*w.begin(), value_type(-1));
+			return !is_singular;
+		}
+
+		inline Vector<value_type, dim> diagonal() const {
+			Vector<value_type, dim> ret;
+			for (size_t i = 0; i < dim; i++) {
+				ret[i] = ud[i][i];
+			}
+			return ret;
+		}
+
+		// D on the diagonal and U above it, packed together, with zeroes below the diagonal
+		inline const Matrix<value_type, dim, dim>& factors() const { return ud; }
+
+	private:
+		Matrix<value_type, dim, dim> ud;
+		bool is_singular = false;
+	};
+
+	// CholeskyFactor of a DynMatrix. Large matrices are factored a panel of rows at a time, so that the update of the
+	// rest of the matrix reads the panel from cache
+	sml_export template<arithmetic T>
+	class DynCholeskyFactor {
+	public:
+		using value_type = detail::decomposition_type<T>;
+
+		DynCholeskyFactor() {}
+		template<class Allocator>
+		explicit DynCholeskyFactor(const DynMatrix<T, Allocator>& m) { factor(m); }
+
+		// (Re)factor m, replacing any previous factor
+		template<class Allocator>
+		inline void factor(const DynMatrix<T, Allocator>& m) {
+			detail::require_dimensions(m.rows() == m.cols(), "DynCholeskyFactor: matrix is not square");
+			u = DynMatrix<value_type>(m);
+			is_positive_definite = detail::cholesky_factor_inplace(u.data.data(), size());
+			detail::clear_lower(u.data.data(), size());
+		}
+
+		inline bool positive_definite() const { return is_positive_definite; }
+
+		template<arithmetic T2, class Allocator2>
+		inline DynVector<value_type> solve(const DynVector<T2, Allocator2>& b) const {
+			detail::require_dimensions(b.size() == size(), "DynCholeskyFactor::solve: dimensions do not match");
+			DynVector<value_type> x(b);
+			detail::symmetric_solve_inplace(u.data.data(), size(), x.data.data(), 1, false);
+			return x;
+		}
+		template<arithmetic T2, class Allocator2>
+		inline DynMatrix<value_type> solve(const DynMatrix<T2, Allocator2>& B) const {
+			detail::require_dimensions(B.rows() == size(), "DynCholeskyFactor::solve: dimensions do not match");
+			DynMatrix<value_type> X(B);
+			detail::symmetric_solve_inplace(u.data.data(), size(), X.data.data(), X.cols(), false);
+			return X;
+		}
+
+		inline value_type det() const {
+			const value_type d = detail::diagonal_product(u.data.data(), size());
+			return d * d;
+		}
+		inline value_type log_det() const {
+			return 2 * detail::log_diagonal(u.data.data(), size());
+		}
+
+		inline DynMatrix<value_type> inverse() const {
+			return solve(identity<value_type>(size()));
+		}
+
+		template<arithmetic T2, class Allocator2>
+		inline bool update(const DynVector<T2, Allocator2>& v) {
+			return is_positive_definite = modify(v, value_type(1));
+		}
+		template<arithmetic T2, class Allocator2>
+		inline bool downdate(const DynVector<T2, Allocator2>& v) {
+			return is_positive_definite = modify(v, value_type(-1));
+		}
+
+		inline const DynMatrix<value_type>& factors() const { return u; }
+		inline size_t size() const noexcept { return u.rows(); }
+
+	private:
+		DynMatrix<value_type> u;
+		// The vector being rotated in to U by update() and downdate(), kept so that they do not allocate
+		std::vector<value_type> scratch;
+		bool is_positive_definite = false;
+
+		template<arithmetic T2, class Allocator2>
+		inline bool modify(const DynVector<T2, Allocator2>& v, value_type sigma) {
+			detail::require_dimensions(v.size() == size(), "DynCholeskyFactor: dimensions do not match");
+			scratch.assign(v.begin(), v.end());
+			return detail::cholesky_update_inplace(u.data.data(), size(), scratch.data(), sigma);
+		}
+	};
+
+	// LDLTFactor of a DynMatrix, factored a panel of rows at a time as for DynCholeskyFactor
+	sml_export template<arithmetic T>
+	class DynLDLTFactor {
+	public:
+		using value_type = detail::decomposition_type<T>;
+
+		DynLDLTFactor() {}
+		template<class Allocator>
+		explicit DynLDLTFactor(const DynMatrix<T, Allocator>& m) { factor(m); }
+
+		// (Re)factor m, replacing any previous factors
+		template<class Allocator>
+		inline void factor(const DynMatrix<T, Allocator>& m) {
+			detail::require_dimensions(m.rows() == m.cols(), "DynLDLTFactor: matrix is not square");
+			ud = DynMatrix<value_type>(m);
+			is_singular = !detail::ldlt_factor_inplace(ud.data.data(), size());
+			detail::clear_lower(ud.data.data(), size());
+		}
+
+		inline bool singular() const { return is_singular; }
+
+		template<arithmetic T2, class Allocator2>
+		inline DynVector<value_type> solve(const DynVector<T2, Allocator2>& b) const {
+			detail::require_dimensions(b.size() == size(), "DynLDLTFactor::solve: dimensions do not match");
+			DynVector<value_type> x(b);
+			detail::symmetric_solve_inplace(ud.data.data(), size(), x.data.data(), 1, true);
+			return x;
+		}
+		template<arithmetic T2, class Allocator2>
+		inline DynMatrix<value_type> solve(const DynMatrix<T2, Allocator2>& B) const {
+			detail::require_dimensions(B.rows() == size(), "DynLDLTFactor::solve: dimensions do not match");
+			DynMatrix<value_type> X(B);
+			detail::symmetric_solve_inplace(ud.data.data(), size(), X.data.data(), X.cols(), true);
+			return X;
+		}
+
+		inline value_type det() const {
+			return detail::diagonal_product(ud.data.data(), size());
+		}
+		inline value_type log_det() const {
+			return detail::log_diagonal(ud.data.data(), size());
+		}
+
+		inline DynMatrix<value_type> inverse() const {
+			return solve(identity<value_type>(size()));
+		}
+
+		template<arithmetic T2, class Allocator2>
+		inline bool update(const DynVector<T2, Allocator2>& v) {
+			is_singular = !modify(v, value_type(1));
+			return !is_singular;
+		}
+		template<arithmetic T2, class Allocator2>
+		inline bool downdate(const DynVector<T2, Allocator2>& v) {
+			is_singular = !modify(v, value_type(-1));
+			return !is_singular;
+		}
+
+		inline DynVector<value_type> diagonal() const {
+			DynVector<value_type> ret(size());
+			for (size_t i = 0; i < size(); i++) {
+				ret[i] = ud.data[(i * size()) + i];
+			}
+			return ret;
+		}
+
+		inline const DynMatrix<value_type>& factors() const { return ud; }
+		inline size_t size() const noexcept { return ud.rows(); }
+
+	private:
+		DynMatrix<value_type> ud;
+		std::vector<value_type> scratch;
+		bool is_singular = false;
+
+		template<arithmetic T2, class Allocator2>
+		inline bool modify(const DynVector<T2, Allocator2>& v, value_type sigma) {
+			detail::require_dimensions(v.size() == size(), "DynLDLTFactor: dimensions do not match");
+			scratch.assign(v.begin(), v.end());
+			return detail::ldlt_update_inplace(ud.data.data(), size(), scratch.data(), sigma);
+		}
+	};
+
+	// Factor a symmetric positive-definite matrix, as the constructors do
+	sml_export template<arithmetic T, size_t dim>
+	inline CholeskyFactor<T, dim> cholesky(const Matrix<T, dim, dim>& m) {
+		return CholeskyFactor<T, dim>(m);
+	}
+	sml_export template<arithmetic T, class Allocator>
+	inline DynCholeskyFactor<T> cholesky(const DynMatrix<T, Allocator>& m) {
+		return DynCholeskyFactor<T>(m);
+	}
+	sml_export template<arithmetic T, size_t dim>
+	inline LDLTFactor<T, dim> ldlt(const Matrix<T, dim, dim>& m) {
+		return LDLTFactor<T, dim>(m);
+	}
+	sml_export template<arithmetic T, class Allocator>
+	inline DynLDLTFactor<T> ldlt(const DynMatrix<T, Allocator>& m) {
+		return DynLDLTFactor<T>(m);
+	}
+
+}
+#endif // !SML_DECOMPOSITION_HPP
\ No newline at end of file
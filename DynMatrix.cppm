@@ -0,0 +1,30 @@
+export module sml:DynMatrix;
+
+#ifdef SML_NO_IMPORT_STD
+
+import <algorithm>;
+import <cmath>;
+import <initializer_list>;
+import <iostream>;
+import <memory>;
+import <span>;
+import <stdexcept>;
+import <tuple>;
+import <type_traits>;
+import <vector>;
+
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+import :Utility;
+import :Allocator;
+import :Parallel;
+import :Vector;
+import :Matrix;
+#define SML_MODULE_DYNMATRIX
+#include "DynMatrix.hpp"
\ No newline at end of file
@@ -0,0 +1,736 @@
+#ifndef SML_DYNMATRIX_HPP
+#define SML_DYNMATRIX_HPP
+
+#ifndef SML_MODULE_DYNMATRIX
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#include "Allocator.hpp"
+#include "Parallel.hpp"
+
+#endif // !SML_MODULE_DYNMATRIX
+
+#include "Config.hpp"
+
+// Runtime-sized counterparts of Vector and Matrix
+//
+// Elements live in a heap buffer (64-byte aligned by default, or from any standard allocator), so these can hold
+// point clouds, least-squares systems and other data whose size is only known at run time, or which is too large
+// for the stack. Operations between operands of mismatched sizes throw std::invalid_argument.
+//
+// view<...>() gives the buffer as a std::span of static extent, checked against the size, to hand to code that takes
+// a fixed number of elements without copying them. to_vector<...>() and to_matrix<...>() copy the elements out in to
+// a fixed-size Vector or Matrix, for the whole fixed-size API.
+
+namespace sml {
+
+	namespace detail {
+
+		// Allocator for elements of type T, from one for the elements of another operand
+		template<class Allocator, class T>
+		using rebind_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+		inline void require_dimensions(bool match, const char* message) {
+			if (!match) {
+				throw std::invalid_argument(message);
+			}
+		}
+
+		// Matrix product c = a * b for sizes only known at run time, choosing the kernel as operator* does for Matrix
+		template<arithmetic T, arithmetic T2>
+		inline void gemm(const T* a, const T2* b, T* c, size_t m, size_t k, size_t n) {
+			if ((m >= gemm_mr) && (n >= gemm_nr<T>) && ((m * k * n) >= gemm_tiled_threshold)) {
+				gemm_tiled(a, b, c, m, k, n);
+			}
+			else {
+				gemm_small(a, b, c, m, k, n);
+			}
+		}
+
+	} // !namespace detail
+
+	sml_export template<arithmetic T, class Allocator = aligned_allocator<T>>
+	class DynVector {
+	public:
+		DynVector() {}
+		explicit DynVector(size_t elements) : data(elements) {}
+		template<arithmetic T2>
+		DynVector(size_t elements, T2 t) : data(elements, static_cast<T>(t)) {}
+		DynVector(std::initializer_list<T> ts) : data(ts) {}
+		template<arithmetic T2, class Allocator2>
+		DynVector(const DynVector<T2, Allocator2>& v2) : data(v2.size()) {
+			std::transform(v2.begin(), v2.end(), data.begin(), [](T2 t)->T {return static_cast<T>(t); });
+		}
+		template<arithmetic T2, size_t elements>
+		DynVector(const Vector<T2, elements>& v2) : data(elements) {
+			std::transform(v2.begin(), v2.end(), data.begin(), [](T2 t)->T {return static_cast<T>(t); });
+		}
+
+		// Access elements with v[i]
+		inline T operator [] (size_t i) const {
+			SML_CHECK_INDEX(i, data.size());
+			return data[i];
+		}
+		inline T& operator [] (size_t i) {
+			SML_CHECK_INDEX(i, data.size());
+			return data[i];
+		}
+
+		// Access elements with v.at(i)
+		inline T at(size_t i) const { return data.at(i); }
+		inline T& at(size_t i) { return data.at(i); }
+
+		// View the elements as a span of fixed size, without copying
+		template<size_t elements>
+		inline std::span<T, elements> view() {
+			require_size(elements);
+			return std::span<T, elements>(data.data(), elements);
+		}
+		template<size_t elements>
+		inline std::span<const T, elements> view() const {
+			require_size(elements);
+			return std::span<const T, elements>(data.data(), elements);
+		}
+
+		// Copy the elements into a fixed-size Vector
+		template<size_t elements>
+		inline Vector<T, elements> to_vector() const {
+			Vector<T, elements> ret;
+			std::ranges::copy(view<elements>(), ret.begin());
+			return ret;
+		}
+
+		// Unary operators
+		inline const DynVector& operator + () const { return *this; }
+		inline DynVector operator - () const {
+			DynVector ret = *this;
+			std::transform(ret.begin(), ret.end(), ret.begin(), [](T t)->T {return -t; });
+			return ret;
+		}
+
+		// Comparison operators
+		template<class Allocator2>
+		inline bool operator == (const DynVector<T, Allocator2>& v2) const {
+			return std::equal(data.begin(), data.end(), v2.begin(), v2.end());
+		}
+		template<class Allocator2>
+		inline bool operator != (const DynVector<T, Allocator2>& v2) const {
+			return !(*this == v2);
+		}
+
+		// Arithmetic operators
+		template<arithmetic T2, class Allocator2>
+		inline DynVector& operator += (const DynVector<T2, Allocator2>& v2) {
+			return apply(v2, [](T a, T b) { return a + b; });
+		}
+		template<arithmetic T2>
+		inline DynVector& operator += (const T2& t) {
+			return apply_scalar(t, [](T a, T b) { return a + b; });
+		}
+		template<arithmetic T2, class Allocator2>
+		inline DynVector& operator -= (const DynVector<T2, Allocator2>& v2) {
+			return apply(v2, [](T a, T b) { return a - b; });
+		}
+		template<arithmetic T2>
+		inline DynVector& operator -= (const T2& t) {
+			return apply_scalar(t, [](T a, T b) { return a - b; });
+		}
+		template<arithmetic T2, class Allocator2>
+		inline DynVector& operator *= (const DynVector<T2, Allocator2>& v2) {
+			return apply(v2, [](T a, T b) { return a * b; });
+		}
+		template<arithmetic T2>
+		inline DynVector& operator *= (const T2& t) {
+			return apply_scalar(t, [](T a, T b) { return a * b; });
+		}
+		template<arithmetic T2, class Allocator2>
+		inline DynVector& operator /= (const DynVector<T2, Allocator2>& v2) {
+			return apply(v2, [](T a, T b) { return a / b; });
+		}
+		template<arithmetic T2>
+		inline DynVector& operator /= (const T2& t) {
+			return apply_scalar(t, [](T a, T b) { return a / b; });
+		}
+
+		// C++ container named requirements
+		inline auto begin() noexcept { return data.begin(); }
+		inline auto begin() const noexcept { return data.begin(); }
+		inline auto cbegin() const noexcept { return data.cbegin(); }
+		inline auto end() noexcept { return data.end(); }
+		inline auto end() const noexcept { return data.end(); }
+		inline auto cend() const noexcept { return data.cend(); }
+
+		inline size_t size() const noexcept { return data.size(); }
+		inline bool empty() const noexcept { return data.empty(); }
+		inline void resize(size_t elements) { data.resize(elements); }
+
+		std::vector<T, Allocator> data;
+
+	private:
+		inline void require_size(size_t elements) const {
+			detail::require_dimensions(data.size() == elements, "DynVector::view: size does not match");
+		}
+
+		template<arithmetic T2, class Allocator2, class Op>
+		inline DynVector& apply(const DynVector<T2, Allocator2>& v2, Op op) {
+			detail::require_dimensions(data.size() == v2.size(), "DynVector: sizes do not match");
+			for (size_t i = 0; i < data.size(); i++) {
+				data[i] = op(data[i], static_cast<T>(v2[i]));
+			}
+			return *this;
+		}
+		template<arithmetic T2, class Op>
+		inline DynVector& apply_scalar(const T2& t, Op op) {
+			const T s = static_cast<T>(t);
+			for (T& i : data) {
+				i = op(i, s);
+			}
+			return *this;
+		}
+	};
+
+	// This class uses row-major memory ordering
+	sml_export template<arithmetic T, class Allocator = aligned_allocator<T>>
+	class DynMatrix {
+	public:
+		DynMatrix() {}
+		DynMatrix(size_t rows, size_t cols) : nrows(rows), ncols(cols), data(rows * cols) {}
+		template<arithmetic T2>
+		DynMatrix(size_t rows, size_t cols, T2 t) : nrows(rows), ncols(cols), data(rows * cols, static_cast<T>(t)) {}
+		DynMatrix(size_t rows, size_t cols, std::initializer_list<T> ts) : nrows(rows), ncols(cols), data(ts) {
+			detail::require_dimensions(data.size() == rows * cols, "DynMatrix: number of elements does not match");
+		}
+		template<arithmetic T2, class Allocator2>
+		DynMatrix(const DynMatrix<T2, Allocator2>& m2) : nrows(m2.rows()), ncols(m2.cols()), data(m2.size()) {
+			std::transform(m2.begin(), m2.end(), data.begin(), [](T2 t)->T {return static_cast<T>(t); });
+		}
+		template<arithmetic T2, size_t rows, size_t cols>
+		DynMatrix(const Matrix<T2, rows, cols>& m2) : nrows(rows), ncols(cols), data(rows * cols) {
+			std::transform(m2.begin(), m2.end(), data.begin(), [](T2 t)->T {return static_cast<T>(t); });
+		}
+
+		// Access elements with M[row][column]
+		// (This class uses row-major memory ordering)
+		inline auto operator [] (size_t i) {
+			SML_CHECK_INDEX(i, nrows);
+			return data.begin() + (i * ncols);
+		}
+		inline auto operator [] (size_t i) const {
+			SML_CHECK_INDEX(i, nrows);
+			return data.begin() + (i * ncols);
+		}
+
+		// Access elements with m.at(i)
+		inline T at(size_t i) const { return data.at(i); }
+		inline T& at(size_t i) { return data.at(i); }
+		// Access elements with m.at(row, column)
+		inline T at(size_t r, size_t c) const { return data.at(index(r, c)); }
+		inline T& at(size_t r, size_t c) { return data.at(index(r, c)); }
+
+		// Fetch an individual row as a DynVector
+		inline DynVector<T, Allocator> row_vector(size_t r) const {
+			DynVector<T, Allocator> ret(ncols);
+			std::copy(data.begin() + index(r, 0), data.begin() + index(r, 0) + ncols, ret.begin());
+			return ret;
+		}
+
+		// Fetch an individual column as a DynVector
+		inline DynVector<T, Allocator> col_vector(size_t c) const {
+			DynVector<T, Allocator> ret(nrows);
+			for (size_t i = 0; i < nrows; i++) {
+				ret[i] = data[index(i, c)];
+			}
+			return ret;
+		}
+
+		// View the elements, row by row, as a span of fixed size, without copying
+		template<size_t rows, size_t cols>
+		inline std::span<T, rows * cols> view() {
+			require_shape(rows, cols);
+			return std::span<T, rows * cols>(data.data(), rows * cols);
+		}
+		template<size_t rows, size_t cols>
+		inline std::span<const T, rows * cols> view() const {
+			require_shape(rows, cols);
+			return std::span<const T, rows * cols>(data.data(), rows * cols);
+		}
+
+		// Copy the elements into a fixed-size Matrix
+		template<size_t rows, size_t cols>
+		inline Matrix<T, rows, cols> to_matrix() const {
+			Matrix<T, rows, cols> ret;
+			std::ranges::copy(view<rows, cols>(), ret.data.begin());
+			return ret;
+		}
+
+		// Unary operators
+		inline const DynMatrix& operator + () const { return *this; }
+		inline DynMatrix operator - () const {
+			DynMatrix ret = *this;
+			std::transform(ret.begin(), ret.end(), ret.begin(), [](T t)->T {return -t; });
+			return ret;
+		}
+
+		// Comparison operators
+		template<class Allocator2>
+		inline bool operator == (const DynMatrix<T, Allocator2>& m2) const {
+			return (nrows == m2.rows()) && (ncols == m2.cols()) && std::equal(data.begin(), data.end(), m2.begin(), m2.end());
+		}
+		template<class Allocator2>
+		inline bool operator != (const DynMatrix<T, Allocator2>& m2) const {
+			return !(*this == m2);
+		}
+
+		// Arithmetic operators
+
+		// Addition
+		template<arithmetic T2, class Allocator2>
+		inline DynMatrix& operator += (const DynMatrix<T2, Allocator2>& m2) {
+			return apply(m2, [](T a, T b) { return a + b; });
+		}
+		template<arithmetic T2>
+		inline DynMatrix& operator += (const T2& t) {
+			return apply_scalar(t, [](T a, T b) { return a + b; });
+		}
+
+		// Subtraction
+		template<arithmetic T2, class Allocator2>
+		inline DynMatrix& operator -= (const DynMatrix<T2, Allocator2>& m2) {
+			return apply(m2, [](T a, T b) { return a - b; });
+		}
+		template<arithmetic T2>
+		inline DynMatrix& operator -= (const T2& t) {
+			return apply_scalar(t, [](T a, T b) { return a - b; });
+		}
+
+		// Matrix product
+		template<arithmetic T2, class Allocator2>
+		inline DynMatrix& operator *= (const DynMatrix<T2, Allocator2>& m2);
+		template<arithmetic T2>
+		inline DynMatrix& operator *= (const T2& t) {
+			return apply_scalar(t, [](T a, T b) { return a * b; });
+		}
+
+		// Division
+		template<arithmetic T2>
+		inline DynMatrix& operator /= (const T2& t) {
+			return apply_scalar(t, [](T a, T b) { return a / b; });
+		}
+
+		// C++ container named requirements
+		inline auto begin() noexcept { return data.begin(); }
+		inline auto begin() const noexcept { return data.begin(); }
+		inline auto cbegin() const noexcept { return data.cbegin(); }
+		inline auto end() noexcept { return data.end(); }
+		inline auto end() const noexcept { return data.end(); }
+		inline auto cend() const noexcept { return data.cend(); }
+
+		inline size_t size() const noexcept { return data.size(); }
+		inline bool empty() const noexcept { return data.empty(); }
+
+		inline size_t rows() const noexcept { return nrows; }
+		inline size_t cols() const noexcept { return ncols; }
+
+		// Change the dimensions, keeping the elements in memory order
+		inline void resize(size_t rows, size_t cols) {
+			nrows = rows;
+			ncols = cols;
+			data.resize(rows * cols);
+		}
+
+	private:
+		size_t nrows = 0;
+		size_t ncols = 0;
+
+	public:
+		std::vector<T, Allocator> data;
+
+	private:
+		inline size_t index(size_t r, size_t c) const {
+			if (r >= nrows || c >= ncols) {
+				throw std::out_of_range("DynMatrix: index out of range");
+			}
+			return (r * ncols) + c;
+		}
+
+		inline void require_shape(size_t rows, size_t cols) const {
+			detail::require_dimensions((nrows == rows) && (ncols == cols), "DynMatrix::view: dimensions do not match");
+		}
+
+		template<arithmetic T2, class Allocator2, class Op>
+		inline DynMatrix& apply(const DynMatrix<T2, Allocator2>& m2, Op op) {
+			detail::require_dimensions((nrows == m2.rows()) && (ncols == m2.cols()), "DynMatrix: dimensions do not match");
+			for (size_t i = 0; i < data.size(); i++) {
+				data[i] = op(data[i], static_cast<T>(m2.data[i]));
+			}
+			return *this;
+		}
+		template<arithmetic T2, class Op>
+		inline DynMatrix& apply_scalar(const T2& t, Op op) {
+			const T s = static_cast<T>(t);
+			for (T& i : data) {
+				i = op(i, s);
+			}
+			return *this;
+		}
+	};
+
+	// Write vector to ostream
+	sml_export template<arithmetic T, class Allocator>
+	inline std::ostream& operator << (std::ostream& os, const DynVector<T, Allocator>& v) {
+		for (size_t i = 0; i < v.size(); i++) {
+			os << v[i];
+			if (i < (v.size() - 1))
+				os << " ";
+		}
+		return os;
+	}
+
+	// Write matrix to ostream, one row per line
+	sml_export template<arithmetic T, class Allocator>
+	inline std::ostream& operator << (std::ostream& os, const DynMatrix<T, Allocator>& m) {
+		for (size_t i = 0; i < m.rows(); i++) {
+			for (size_t j = 0; j < m.cols(); j++) {
+				os << m[i][j];
+				if (j < (m.cols() - 1))
+					os << " ";
+			}
+			os << "\n";
+		}
+		return os;
+	}
+
+	// Element-wise arithmetic
+	sml_export template<arithmetic T, class Allocator, arithmetic T2, class Allocator2>
+	inline DynVector<T, Allocator> operator + (DynVector<T, Allocator> v1, const DynVector<T2, Allocator2>& v2) {
+		return v1 += v2;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2>
+	inline DynVector<T, Allocator> operator + (DynVector<T, Allocator> v, const T2& t) {
+		return v += t;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2, class Allocator2>
+	inline DynVector<T, Allocator> operator - (DynVector<T, Allocator> v1, const DynVector<T2, Allocator2>& v2) {
+		return v1 -= v2;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2>
+	inline DynVector<T, Allocator> operator - (DynVector<T, Allocator> v, const T2& t) {
+		return v -= t;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2, class Allocator2>
+	inline DynVector<T, Allocator> operator * (DynVector<T, Allocator> v1, const DynVector<T2, Allocator2>& v2) {
+		return v1 *= v2;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2>
+	inline DynVector<T, Allocator> operator * (DynVector<T, Allocator> v, const T2& t) {
+		return v *= t;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2>
+	inline DynVector<T, Allocator> operator * (const T2& t, DynVector<T, Allocator> v) {
+		return v *= t;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2, class Allocator2>
+	inline DynVector<T, Allocator> operator / (DynVector<T, Allocator> v1, const DynVector<T2, Allocator2>& v2) {
+		return v1 /= v2;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2>
+	inline DynVector<T, Allocator> operator / (DynVector<T, Allocator> v, const T2& t) {
+		return v /= t;
+	}
+
+	sml_export template<arithmetic T, class Allocator, arithmetic T2, class Allocator2>
+	inline DynMatrix<T, Allocator> operator + (DynMatrix<T, Allocator> m1, const DynMatrix<T2, Allocator2>& m2) {
+		return m1 += m2;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2>
+	inline DynMatrix<T, Allocator> operator + (DynMatrix<T, Allocator> m, const T2& t) {
+		return m += t;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2, class Allocator2>
+	inline DynMatrix<T, Allocator> operator - (DynMatrix<T, Allocator> m1, const DynMatrix<T2, Allocator2>& m2) {
+		return m1 -= m2;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2>
+	inline DynMatrix<T, Allocator> operator - (DynMatrix<T, Allocator> m, const T2& t) {
+		return m -= t;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2>
+	inline DynMatrix<T, Allocator> operator * (DynMatrix<T, Allocator> m, const T2& t) {
+		return m *= t;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2>
+	inline DynMatrix<T, Allocator> operator * (const T2& t, DynMatrix<T, Allocator> m) {
+		return m *= t;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2>
+	inline DynMatrix<T, Allocator> operator / (DynMatrix<T, Allocator> m, const T2& t) {
+		return m /= t;
+	}
+
+	// Matrix product
+	sml_export template<arithmetic T, class Allocator, arithmetic T2, class Allocator2>
+	inline DynMatrix<T, Allocator> operator * (const DynMatrix<T, Allocator>& m1, const DynMatrix<T2, Allocator2>& m2) {
+		detail::require_dimensions(m1.cols() == m2.rows(), "DynMatrix product: inner dimensions do not match");
+		DynMatrix<T, Allocator> ret(m1.rows(), m2.cols());
+		detail::gemm(m1.data.data(), m2.data.data(), ret.data.data(), m1.rows(), m1.cols(), m2.cols());
+		return ret;
+	}
+	sml_export template<arithmetic T, class Allocator, arithmetic T2, size_t nrows, size_t ncols>
+	inline DynMatrix<T, Allocator> operator * (const DynMatrix<T, Allocator>& m1, const Matrix<T2, nrows, ncols>& m2) {
+		detail::require_dimensions(m1.cols() == nrows, "DynMatrix product: inner dimensions do not match");
+		DynMatrix<T, Allocator> ret(m1.rows(), ncols);
+		detail::gemm(m1.data.data(), m2.data.data(), ret.data.data(), m1.rows(), nrows, ncols);
+		return ret;
+	}
+	// The product keeps the allocator of the DynMatrix, rebound to the elements of the Matrix
+	sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2, class Allocator2>
+	inline DynMatrix<T, detail::rebind_allocator<Allocator2, T>> operator * (const Matrix<T, nrows, ncols>& m1, const DynMatrix<T2, Allocator2>& m2) {
+		detail::require_dimensions(ncols == m2.rows(), "DynMatrix product: inner dimensions do not match");
+		DynMatrix<T, detail::rebind_allocator<Allocator2, T>> ret(nrows, m2.cols());
+		detail::gemm(m1.data.data(), m2.data.data(), ret.data.data(), nrows, ncols, m2.cols());
+		return ret;
+	}
+
+	sml_export template<arithmetic T, class Allocator>
+		template<arithmetic T2, class Allocator2>
+	inline DynMatrix<T, Allocator>& DynMatrix<T, Allocator>::operator *= (const DynMatrix<T2, Allocator2>& m2) {
+		return (*this) = (*this) * m2;
+	}
+
+	// Matrix-vector product, treating v as a column vector
+	sml_export template<arithmetic T, class Allocator, arithmetic T2, class Allocator2>
+	inline DynVector<T, Allocator> operator * (const DynMatrix<T, Allocator>& m, const DynVector<T2, Allocator2>& v) {
+		detail::require_dimensions(m.cols() == v.size(), "DynMatrix-DynVector product: dimensions do not match");
+		DynVector<T, Allocator> ret(m.rows());
+		for (size_t i = 0; i < m.rows(); i++) {
+			const auto row = m[i];
+			T sum = 0;
+			for (size_t j = 0; j < m.cols(); j++) {
+				sum += row[j] * static_cast<T>(v[j]);
+			}
+			ret[i] = sum;
+		}
+		return ret;
+	}
+
+	// Dot product
+	sml_export template<arithmetic T, class Allocator, arithmetic T2, class Allocator2>
+	double dot(const DynVector<T, Allocator>& v1, const DynVector<T2, Allocator2>& v2) {
+		detail::require_dimensions(v1.size() == v2.size(), "DynVector dot product: sizes do not match");
+		double ret = 0;
+		for (size_t i = 0; i < v1.size(); i++) {
+			ret += static_cast<double>(v1[i]) * static_cast<double>(v2[i]);
+		}
+		return ret;
+	}
+
+	// Transpose
+	sml_export template<arithmetic T, class Allocator>
+	DynMatrix<T, Allocator> transpose(const DynMatrix<T, Allocator>& original) {
+		DynMatrix<T, Allocator> ret(original.cols(), original.rows());
+		detail::transpose_into(original.data.data(), ret.data.data(), original.rows(), original.cols());
+		return ret;
+	}
+
+	// Transpose a square matrix in place
+	sml_export template<arithmetic T, class Allocator>
+	DynMatrix<T, Allocator>& transpose_inplace(DynMatrix<T, Allocator>& m) {
+		detail::require_dimensions(m.rows() == m.cols(), "transpose_inplace: matrix is not square");
+		detail::transpose_square_inplace(m.data.data(), m.rows());
+		return m;
+	}
+
+	// Create an identity matrix of the given dimension
+	sml_export template<arithmetic T, class Allocator = aligned_allocator<T>>
+	DynMatrix<T, Allocator> identity(size_t dim) {
+		DynMatrix<T, Allocator> ret(dim, dim, 0);
+		for (size_t i = 0; i < dim; i++) {
+			ret[i][i] = 1;
+		}
+		return ret;
+	}
+
+	// Calculate the trace of a matrix
+	sml_export template<arithmetic T, class Allocator>
+	T trace(const DynMatrix<T, Allocator>& m) {
+		detail::require_dimensions(m.rows() == m.cols(), "trace: matrix is not square");
+		T ret = 0;
+		for (size_t i = 0; i < m.rows(); i++) {
+			ret += m[i][i];
+		}
+		return ret;
+	}
+
+	// Element-wise operations with an execution policy, for large matrices, as for Matrix
+
+	// m1 += m2 and m1 -= m2, element by element
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator, arithmetic T2, class Allocator2>
+	DynMatrix<T, Allocator>& add_assign(Policy&& policy, DynMatrix<T, Allocator>& m1, const DynMatrix<T2, Allocator2>& m2) {
+		detail::require_dimensions((m1.rows() == m2.rows()) && (m1.cols() == m2.cols()), "DynMatrix: dimensions do not match");
+		T* a = m1.data.data();
+		const T2* b = m2.data.data();
+		detail::for_each_element<T>(policy, m1.size(), [=](size_t i) { a[i] += static_cast<T>(b[i]); });
+		return m1;
+	}
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator, arithmetic T2, class Allocator2>
+	DynMatrix<T, Allocator>& sub_assign(Policy&& policy, DynMatrix<T, Allocator>& m1, const DynMatrix<T2, Allocator2>& m2) {
+		detail::require_dimensions((m1.rows() == m2.rows()) && (m1.cols() == m2.cols()), "DynMatrix: dimensions do not match");
+		T* a = m1.data.data();
+		const T2* b = m2.data.data();
+		detail::for_each_element<T>(policy, m1.size(), [=](size_t i) { a[i] -= static_cast<T>(b[i]); });
+		return m1;
+	}
+
+	// m += t, m -= t, m *= t and m /= t for a scalar t
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator, arithmetic T2>
+	DynMatrix<T, Allocator>& add_assign(Policy&& policy, DynMatrix<T, Allocator>& m, const T2& t) {
+		T* a = m.data.data();
+		const T s = static_cast<T>(t);
+		detail::for_each_element<T>(policy, m.size(), [=](size_t i) { a[i] += s; });
+		return m;
+	}
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator, arithmetic T2>
+	DynMatrix<T, Allocator>& sub_assign(Policy&& policy, DynMatrix<T, Allocator>& m, const T2& t) {
+		T* a = m.data.data();
+		const T s = static_cast<T>(t);
+		detail::for_each_element<T>(policy, m.size(), [=](size_t i) { a[i] -= s; });
+		return m;
+	}
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator, arithmetic T2>
+	DynMatrix<T, Allocator>& mul_assign(Policy&& policy, DynMatrix<T, Allocator>& m, const T2& t) {
+		T* a = m.data.data();
+		const T s = static_cast<T>(t);
+		detail::for_each_element<T>(policy, m.size(), [=](size_t i) { a[i] *= s; });
+		return m;
+	}
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator, arithmetic T2>
+	DynMatrix<T, Allocator>& div_assign(Policy&& policy, DynMatrix<T, Allocator>& m, const T2& t) {
+		T* a = m.data.data();
+		const T s = static_cast<T>(t);
+		detail::for_each_element<T>(policy, m.size(), [=](size_t i) { a[i] /= s; });
+		return m;
+	}
+
+	// Element-wise matrix multiplication (Hadamard product)
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator, arithmetic T2, class Allocator2>
+	DynMatrix<T, Allocator> multiply_elements(Policy&& policy, DynMatrix<T, Allocator> m1, const DynMatrix<T2, Allocator2>& m2) {
+		detail::require_dimensions((m1.rows() == m2.rows()) && (m1.cols() == m2.cols()), "DynMatrix: dimensions do not match");
+		T* a = m1.data.data();
+		const T2* b = m2.data.data();
+		detail::for_each_element<T>(policy, m1.size(), [=](size_t i) { a[i] *= static_cast<T>(b[i]); });
+		return m1;
+	}
+
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator>
+	DynMatrix<T, Allocator> clamp(Policy&& policy, DynMatrix<T, Allocator> m, const T& t1, const T& t2) {
+		T* a = m.data.data();
+		detail::for_each_element<T>(policy, m.size(), [=](size_t i) { a[i] = std::clamp(a[i], t1, t2); });
+		return m;
+	}
+
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator>
+	DynMatrix<T, Allocator> abs(Policy&& policy, DynMatrix<T, Allocator> m) {
+		T* a = m.data.data();
+		detail::for_each_element<T>(policy, m.size(), [=](size_t i) { a[i] = std::abs(a[i]); });
+		return m;
+	}
+
+	// Index of the largest and smallest elements in memory order, the first if there are several, and their values
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator>
+	size_t max_element(Policy&& policy, const DynMatrix<T, Allocator>& m) {
+		return detail::extreme_element(policy, m.data.data(), m.size(), [](T a, T b) { return a > b; });
+	}
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator>
+	size_t min_element(Policy&& policy, const DynMatrix<T, Allocator>& m) {
+		return detail::extreme_element(policy, m.data.data(), m.size(), [](T a, T b) { return a < b; });
+	}
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator>
+	T max(Policy&& policy, const DynMatrix<T, Allocator>& m) {
+		detail::require_dimensions(!m.empty(), "max: matrix is empty");
+		return m.data[max_element(policy, m)];
+	}
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator>
+	T min(Policy&& policy, const DynMatrix<T, Allocator>& m) {
+		detail::require_dimensions(!m.empty(), "min: matrix is empty");
+		return m.data[min_element(policy, m)];
+	}
+
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator>
+	T trace(Policy&& policy, const DynMatrix<T, Allocator>& m) {
+		detail::require_dimensions(m.rows() == m.cols(), "trace: matrix is not square");
+		return detail::parallel_trace(policy, m.data.data(), m.rows());
+	}
+
+	// LU decomposition with partial pivoting, in the same form as for Matrix: L and U are packed into one matrix
+	// (L with an implicit unit diagonal), and the pivot vector holds the row permutation followed by dim plus the
+	// number of row exchanges
+	sml_export template<arithmetic T, class Allocator>
+	std::tuple<DynMatrix<detail::decomposition_type<T>>, DynVector<size_t>> LUPDecomposition(const DynMatrix<T, Allocator>& m) {
+		detail::require_dimensions(m.rows() == m.cols(), "LUPDecomposition: matrix is not square");
+		const size_t dim = m.rows();
+
+		DynMatrix<detail::decomposition_type<T>> A(m);
+		std::vector<size_t> pivots(dim);
+		bool singular;
+		const size_t swaps = detail::lu_factor_inplace(A.data.data(), dim, pivots.data(), singular);
+
+		DynVector<size_t> pivot_matrix(dim + 1);
+		for (size_t i = 0; i < dim; i++) {
+			pivot_matrix[i] = i;
+		}
+		for (size_t i = 0; i < dim; i++) {
+			std::swap(pivot_matrix[i], pivot_matrix[pivots[i]]);
+		}
+		pivot_matrix[dim] = dim + swaps;
+
+		return std::make_tuple(std::move(A), std::move(pivot_matrix));
+	}
+
+	// Returns the determinant of matrix m from its LU decomposition, computed in double whatever the type of m
+	sml_export template<arithmetic T, class Allocator>
+	double det(const DynMatrix<T, Allocator>& m) {
+		detail::require_dimensions(m.rows() == m.cols(), "det: matrix is not square");
+		const size_t dim = m.rows();
+
+		DynMatrix<double> A(m);
+		std::vector<size_t> pivots(dim);
+		bool singular;
+		const size_t swaps = detail::lu_factor_inplace(A.data.data(), dim, pivots.data(), singular);
+		return detail::lu_det(A.data.data(), dim, swaps);
+	}
+
+	// Inverse from the LU decomposition, solving for every column of the identity at once
+	// As for Matrix, a singular matrix gives a matrix of zeroes
+	sml_export template<arithmetic T, class Allocator>
+	DynMatrix<T, Allocator> inverse(const DynMatrix<T, Allocator>& m) {
+		detail::require_dimensions(m.rows() == m.cols(), "inverse: matrix is not square");
+		const size_t dim = m.rows();
+
+		DynMatrix<detail::decomposition_type<T>> A(m);
+		std::vector<size_t> pivots(dim);
+		bool singular;
+		detail::lu_factor_inplace(A.data.data(), dim, pivots.data(), singular);
+		if (singular) {
+			return DynMatrix<T, Allocator>(dim, dim, 0);
+		}
+
+		DynMatrix<detail::decomposition_type<T>> X = identity<detail::decomposition_type<T>>(dim);
+		detail::lu_solve_inplace(A.data.data(), pivots.data(), dim, X.data.data(), dim);
+		return DynMatrix<T, Allocator>(X);
+	}
+
+}
+#endif // !SML_DYNMATRIX_HPP
\ No newline at end of file
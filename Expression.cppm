@@ -0,0 +1,21 @@
+export module sml:Expression;
+
+#ifdef SML_NO_IMPORT_STD
+
+import <type_traits>;
+import <utility>;
+
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+import :Utility;
+import :Vector;
+import :Matrix;
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+#define SML_MODULE_EXPRESSION
+#include "Expression.hpp"
\ No newline at end of file
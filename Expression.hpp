@@ -0,0 +1,275 @@
+#ifndef SML_EXPRESSION_HPP
+#define SML_EXPRESSION_HPP
+
+#ifndef SML_MODULE_EXPRESSION
+
+#include <type_traits>
+#include <utility>
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#endif // !SML_MODULE_EXPRESSION
+
+// Opt-in lazy evaluation of element-wise Vector and Matrix arithmetic
+//
+// The regular operators return a new object at every step, so a + b * s - c creates a temporary per operator
+// Wrapping any operand in lazy() makes +, -, * and / build a lightweight expression instead, which is evaluated
+// element by element in a single pass when it is assigned to a Vector or Matrix, or passed to evaluate()
+//
+//     sml::Vec4f r = sml::lazy(a) + sml::lazy(b) * s - c;
+//
+// Operands that are not wrapped are evaluated as usual before they join the expression, so b * s in place of
+// sml::lazy(b) * s would still create a temporary. Expressions refer to the Vector and Matrix variables they are
+// built from rather than copying them, so they must be evaluated while those variables are alive. Temporaries,
+// such as the result of a regular operator, are moved into the expression instead, so that an expression kept in
+// an auto variable never refers to one. Only element-wise operations are available: for Matrices, * and / take
+// scalars
+
+namespace sml {
+
+	namespace detail {
+
+		// Shape information for the containers that can appear in a lazy expression
+		template<class C>
+		struct lazy_operand_traits {
+			static constexpr bool is_operand = false;
+		};
+
+		template<arithmetic T, size_t elements>
+		struct lazy_operand_traits<Vector<T, elements>> {
+			static constexpr bool is_operand = true;
+			static constexpr bool is_matrix = false;
+			static constexpr size_t size = elements;
+			using value_type = T;
+			template<arithmetic T2>
+			using result_type = Vector<T2, elements>;
+		};
+
+		template<arithmetic T, size_t nrows, size_t ncols>
+		struct lazy_operand_traits<Matrix<T, nrows, ncols>> {
+			static constexpr bool is_operand = true;
+			static constexpr bool is_matrix = true;
+			static constexpr size_t size = nrows * ncols;
+			using value_type = T;
+			template<arithmetic T2>
+			using result_type = Matrix<T2, nrows, ncols>;
+		};
+
+		template<class C>
+		concept lazy_container = lazy_operand_traits<std::remove_cvref_t<C>>::is_operand;
+
+		// Element-wise operations
+		struct lazy_add { template<class T> static constexpr T apply(T a, T b) { return a + b; } };
+		struct lazy_sub { template<class T> static constexpr T apply(T a, T b) { return a - b; } };
+		struct lazy_mul { template<class T> static constexpr T apply(T a, T b) { return a * b; } };
+		struct lazy_div { template<class T> static constexpr T apply(T a, T b) { return a / b; } };
+
+	} // !namespace detail
+
+	// Leaf of an expression, referring to an existing Vector or Matrix
+	sml_export template<class Container>
+	class LazyOperand {
+		using traits = detail::lazy_operand_traits<Container>;
+	public:
+		using value_type = typename traits::value_type;
+		template<arithmetic T2>
+		using result_type = typename traits::template result_type<T2>;
+		static constexpr size_t lazy_size = traits::size;
+		static constexpr bool is_matrix = traits::is_matrix;
+
+		explicit LazyOperand(const Container& c) : elements(&*c.begin()) {}
+		inline value_type operator [] (size_t i) const { return elements[i]; }
+
+	private:
+		const value_type* elements;
+	};
+
+	// Leaf of an expression that owns a temporary Vector or Matrix, which would not outlive a reference to it
+	sml_export template<class Container>
+	class LazyValue {
+		using traits = detail::lazy_operand_traits<Container>;
+	public:
+		using value_type = typename traits::value_type;
+		template<arithmetic T2>
+		using result_type = typename traits::template result_type<T2>;
+		static constexpr size_t lazy_size = traits::size;
+		static constexpr bool is_matrix = traits::is_matrix;
+
+		explicit LazyValue(Container&& c) : container(std::move(c)) {}
+		inline value_type operator [] (size_t i) const { return container.begin()[i]; }
+
+	private:
+		Container container;
+	};
+
+	// Element-wise combination of two expressions of the same shape
+	// As with the regular operators, the result takes the element type of the left-hand operand
+	sml_export template<class L, class R, class Op>
+	class LazyBinary {
+	public:
+		using value_type = typename L::value_type;
+		template<arithmetic T2>
+		using result_type = typename L::template result_type<T2>;
+		static constexpr size_t lazy_size = L::lazy_size;
+		static constexpr bool is_matrix = L::is_matrix;
+
+		LazyBinary(L l, R r) : lhs(std::move(l)), rhs(std::move(r)) {}
+		inline value_type operator [] (size_t i) const {
+			return Op::apply(lhs[i], static_cast<value_type>(rhs[i]));
+		}
+
+	private:
+		L lhs;
+		R rhs;
+	};
+
+	// Element-wise combination of an expression with a scalar, on either side
+	sml_export template<class E, arithmetic S, class Op, bool scalar_on_left>
+	class LazyScalar {
+	public:
+		using value_type = typename E::value_type;
+		template<arithmetic T2>
+		using result_type = typename E::template result_type<T2>;
+		static constexpr size_t lazy_size = E::lazy_size;
+		static constexpr bool is_matrix = E::is_matrix;
+
+		LazyScalar(E e, S s) : expr(std::move(e)), scalar(static_cast<value_type>(s)) {}
+		inline value_type operator [] (size_t i) const {
+			if constexpr (scalar_on_left) {
+				return Op::apply(scalar, expr[i]);
+			}
+			else {
+				return Op::apply(expr[i], scalar);
+			}
+		}
+
+	private:
+		E expr;
+		value_type scalar;
+	};
+
+	// Start a lazy expression from a Vector or Matrix, referring to a variable and taking ownership of a temporary
+	sml_export template<arithmetic T, size_t elements>
+	inline LazyOperand<Vector<T, elements>> lazy(const Vector<T, elements>& v) {
+		return LazyOperand<Vector<T, elements>>(v);
+	}
+	sml_export template<arithmetic T, size_t elements>
+	inline LazyValue<Vector<T, elements>> lazy(Vector<T, elements>&& v) {
+		return LazyValue<Vector<T, elements>>(std::move(v));
+	}
+	sml_export template<arithmetic T, size_t nrows, size_t ncols>
+	inline LazyOperand<Matrix<T, nrows, ncols>> lazy(const Matrix<T, nrows, ncols>& m) {
+		return LazyOperand<Matrix<T, nrows, ncols>>(m);
+	}
+	sml_export template<arithmetic T, size_t nrows, size_t ncols>
+	inline LazyValue<Matrix<T, nrows, ncols>> lazy(Matrix<T, nrows, ncols>&& m) {
+		return LazyValue<Matrix<T, nrows, ncols>>(std::move(m));
+	}
+
+	// Evaluate an expression into a new Vector or Matrix, with the element type of its left-most operand
+	sml_export template<detail::lazy_expression E>
+	inline typename E::template result_type<typename E::value_type> evaluate(const E& e) {
+		return typename E::template result_type<typename E::value_type>(e);
+	}
+
+	namespace detail {
+
+		// Vectors and Matrices mixed into an expression become leaves; expressions are used as they are
+		template<class X>
+		inline auto as_lazy(X&& x) {
+			if constexpr (lazy_container<X>) {
+				return lazy(std::forward<X>(x));
+			}
+			else {
+				return std::remove_cvref_t<X>(std::forward<X>(x));
+			}
+		}
+
+		template<class X>
+		concept lazy_term = lazy_expression<std::remove_cvref_t<X>> || lazy_container<X>;
+
+		// An element-wise operation between two terms, at least one of which is already an expression
+		template<class L, class R>
+		concept lazy_pair = lazy_term<L> && lazy_term<R>
+			&& (lazy_expression<std::remove_cvref_t<L>> || lazy_expression<std::remove_cvref_t<R>>)
+			&& (decltype(as_lazy(std::declval<L>()))::lazy_size == decltype(as_lazy(std::declval<R>()))::lazy_size);
+
+		// Element-wise products and quotients of two non-scalar terms are only defined for Vectors
+		template<class L, class R>
+		concept lazy_vector_pair = lazy_pair<L, R>
+			&& !decltype(as_lazy(std::declval<L>()))::is_matrix && !decltype(as_lazy(std::declval<R>()))::is_matrix;
+
+		template<class Op, class L, class R>
+		inline auto make_lazy_binary(L&& l, R&& r) {
+			using LE = decltype(as_lazy(std::forward<L>(l)));
+			using RE = decltype(as_lazy(std::forward<R>(r)));
+			return LazyBinary<LE, RE, Op>(as_lazy(std::forward<L>(l)), as_lazy(std::forward<R>(r)));
+		}
+
+	} // !namespace detail
+
+	// Addition
+	sml_export template<class L, class R>
+		requires detail::lazy_pair<L, R>
+	inline auto operator + (L&& l, R&& r) {
+		return detail::make_lazy_binary<detail::lazy_add>(std::forward<L>(l), std::forward<R>(r));
+	}
+	sml_export template<detail::lazy_expression E, arithmetic S>
+	inline auto operator + (E e, const S& s) {
+		return LazyScalar<E, S, detail::lazy_add, false>(std::move(e), s);
+	}
+	sml_export template<arithmetic S, detail::lazy_expression E>
+	inline auto operator + (const S& s, E e) {
+		return LazyScalar<E, S, detail::lazy_add, true>(std::move(e), s);
+	}
+
+	// Subtraction
+	sml_export template<class L, class R>
+		requires detail::lazy_pair<L, R>
+	inline auto operator - (L&& l, R&& r) {
+		return detail::make_lazy_binary<detail::lazy_sub>(std::forward<L>(l), std::forward<R>(r));
+	}
+	sml_export template<detail::lazy_expression E, arithmetic S>
+	inline auto operator - (E e, const S& s) {
+		return LazyScalar<E, S, detail::lazy_sub, false>(std::move(e), s);
+	}
+	sml_export template<arithmetic S, detail::lazy_expression E>
+	inline auto operator - (const S& s, E e) {
+		return LazyScalar<E, S, detail::lazy_sub, true>(std::move(e), s);
+	}
+
+	// Multiplication - element-wise between Vectors, by scalars for both Vectors and Matrices
+	sml_export template<class L, class R>
+		requires detail::lazy_vector_pair<L, R>
+	inline auto operator * (L&& l, R&& r) {
+		return detail::make_lazy_binary<detail::lazy_mul>(std::forward<L>(l), std::forward<R>(r));
+	}
+	sml_export template<detail::lazy_expression E, arithmetic S>
+	inline auto operator * (E e, const S& s) {
+		return LazyScalar<E, S, detail::lazy_mul, false>(std::move(e), s);
+	}
+	sml_export template<arithmetic S, detail::lazy_expression E>
+	inline auto operator * (const S& s, E e) {
+		return LazyScalar<E, S, detail::lazy_mul, true>(std::move(e), s);
+	}
+
+	// Division - element-wise between Vectors, by scalars for both Vectors and Matrices
+	sml_export template<class L, class R>
+		requires detail::lazy_vector_pair<L, R>
+	inline auto operator / (L&& l, R&& r) {
+		return detail::make_lazy_binary<detail::lazy_div>(std::forward<L>(l), std::forward<R>(r));
+	}
+	sml_export template<detail::lazy_expression E, arithmetic S>
+	inline auto operator / (E e, const S& s) {
+		return LazyScalar<E, S, detail::lazy_div, false>(std::move(e), s);
+	}
+	sml_export template<arithmetic S, detail::lazy_expression E>
+	inline auto operator / (const S& s, E e) {
+		return LazyScalar<E, S, detail::lazy_div, true>(std::move(e), s);
+	}
+
+} // !namespace sml
+
+#endif // !SML_EXPRESSION_HPP
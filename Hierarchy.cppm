@@ -0,0 +1,32 @@
+module;
+
+#include "Config.hpp"
+
+export module sml:Hierarchy;
+
+#ifdef SML_NO_IMPORT_STD
+
+import <algorithm>;
+import <concepts>;
+import <span>;
+import <stdexcept>;
+import <vector>;
+
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+import :Utility;
+import :Allocator;
+import :Parallel;
+import :Vector;
+import :Matrix;
+import :Transform;
+import :Quaternion;
+import :Batch;
+#define SML_MODULE_HIERARCHY
+#include "Hierarchy.hpp"
\ No newline at end of file
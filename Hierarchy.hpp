@@ -0,0 +1,302 @@
+#ifndef SML_HIERARCHY_HPP
+#define SML_HIERARCHY_HPP
+
+#ifndef SML_MODULE_HIERARCHY
+
+#include <algorithm>
+#include <concepts>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#include "Allocator.hpp"
+#include "Parallel.hpp"
+#include "Transform.hpp"
+
+#endif // !SML_MODULE_HIERARCHY
+
+#include "Config.hpp"
+
+// Scene hierarchies of translation, rotation and scale transforms, propagated to world matrices in bulk
+//
+//     sml::TransformHierarchy<float> scene;
+//     size_t body = scene.add(scene.no_parent, sml::Vec3f(0, 1, 0));
+//     size_t arm = scene.add(body, sml::Vec3f(0.5f, 0, 0), sml::Quatf(1, 0, 0, 0));
+//     scene.set_rotation(arm, q);
+//     scene.update(sml::execution::par);
+//     const sml::Mat44f& hand = scene.world(arm);
+//
+// Local transforms are kept in structure-of-arrays batches and world matrices in one contiguous array, with every
+// node stored after its parent, so a single forward pass over the arrays computes each world matrix from its parent's.
+// Nodes whose local transform has changed since the last update are dirty, and only they and their descendants are
+// recomputed. When the nodes are also in breadth-first order (as they are when a hierarchy is built a level at a time,
+// or after sort()), each level is contiguous and the nodes of a wide level are shared among threads.
+
+namespace sml {
+
+	namespace detail {
+
+		// Fewest nodes of one level worth sharing among threads
+		inline constexpr size_t hierarchy_parallel_grain = 1024;
+
+		// The matrix scaling by (sx, sy, sz), then rotating by the unit quaternion (s, i, j, k), then translating by
+		// (tx, ty, tz): the columns of the rotation matrix scaled by the scale, with the translation in the last column
+		template<std::floating_point T>
+		constexpr Matrix<T, 4, 4> compose_transform(T tx, T ty, T tz, T s, T i, T j, T k, T sx, T sy, T sz) {
+			const T ii = T(2) * i * i, jj = T(2) * j * j, kk = T(2) * k * k;
+			const T si = T(2) * s * i, sj = T(2) * s * j, sk = T(2) * s * k;
+			const T ij = T(2) * i * j, ik = T(2) * i * k, jk = T(2) * j * k;
+			return Matrix<T, 4, 4>((T(1) - jj - kk) * sx, (ij - sk) * sy, (ik + sj) * sz, tx,
+				(ij + sk) * sx, (T(1) - ii - kk) * sy, (jk - si) * sz, ty,
+				(ik - sj) * sx, (jk + si) * sy, (T(1) - ii - jj) * sz, tz,
+				T(0), T(0), T(0), T(1));
+		}
+
+	} // !namespace detail
+
+	// The matrix of the transform scaling by scale, then rotating by rotation (a unit quaternion), then translating by
+	// translation, as applied to column vectors
+	sml_export template<std::floating_point T>
+	constexpr Matrix<T, 4, 4> ComposeTransform(const Vector<T, 3>& translation, const Quaternion<T>& rotation, const Vector<T, 3>& scale) {
+		return detail::compose_transform(translation[0], translation[1], translation[2],
+			rotation.s(), rotation.i(), rotation.j(), rotation.k(), scale[0], scale[1], scale[2]);
+	}
+
+	// A forest of nodes, each with a local transform relative to its parent, and the world matrices they compose to
+	sml_export template<std::floating_point T>
+	class TransformHierarchy {
+	public:
+		// Parent of the roots of the hierarchy
+		static constexpr size_t no_parent = static_cast<size_t>(-1);
+
+		TransformHierarchy() {}
+
+		inline size_t size() const noexcept { return parents.size(); }
+		inline bool empty() const noexcept { return parents.empty(); }
+		void reserve(size_t n) {
+			parents.reserve(n);
+			depths.reserve(n);
+			dirty.reserve(n);
+			worlds.reserve(n);
+			translations.reserve(n);
+			rotations.reserve(n);
+			scales.reserve(n);
+		}
+		void clear() {
+			parents.clear();
+			depths.clear();
+			dirty.clear();
+			worlds.clear();
+			translations.clear();
+			rotations.clear();
+			scales.clear();
+			level_begins.clear();
+			sorted = true;
+			first_dirty = 0;
+		}
+
+		// Add a node under parent (or no_parent for a root), returning its index. Its world matrix is computed by the
+		// next update()
+		size_t add(size_t parent, const Vector<T, 3>& translation = Vector<T, 3>(0), const Quaternion<T>& rotation = Quaternion<T>(1, 0, 0, 0), const Vector<T, 3>& scale = Vector<T, 3>(1)) {
+			const size_t n = size();
+			if ((parent != no_parent) && (parent >= n)) {
+				throw std::out_of_range("TransformHierarchy: parent index out of range");
+			}
+			const size_t depth = (parent == no_parent) ? 0 : depths[parent] + 1;
+			// The nodes stay breadth-first as long as no node is shallower than the one before it
+			if (sorted) {
+				if ((n > 0) && (depth < depths.back())) {
+					sorted = false;
+					level_begins.clear();
+				}
+				else if (depth == level_begins.size()) {
+					level_begins.push_back(n);
+				}
+			}
+			parents.push_back(parent);
+			depths.push_back(depth);
+			dirty.push_back(1);
+			worlds.emplace_back();
+			translations.push_back(translation);
+			rotations.push_back(rotation);
+			scales.push_back(scale);
+			first_dirty = std::min(first_dirty, n);
+			return n;
+		}
+
+		inline size_t parent(size_t i) const { SML_CHECK_INDEX(i, size()); return parents[i]; }
+		// Number of ancestors of node i
+		inline size_t depth(size_t i) const { SML_CHECK_INDEX(i, size()); return depths[i]; }
+		// Whether the nodes are in breadth-first order, so that update() can work on each level in parallel
+		inline bool is_sorted() const noexcept { return sorted; }
+
+		// Local transform of node i
+		inline Vector<T, 3> translation(size_t i) const { SML_CHECK_INDEX(i, size()); return translations[i]; }
+		inline Quaternion<T> rotation(size_t i) const { SML_CHECK_INDEX(i, size()); return rotations[i]; }
+		inline Vector<T, 3> scale(size_t i) const { SML_CHECK_INDEX(i, size()); return scales[i]; }
+		inline Matrix<T, 4, 4> local(size_t i) const { SML_CHECK_INDEX(i, size()); return local_matrix(i); }
+
+		// Change the local transform of node i, marking it and its descendants for the next update()
+		inline void set_translation(size_t i, const Vector<T, 3>& t) { mark_dirty(i); translations.set(i, t); }
+		inline void set_rotation(size_t i, const Quaternion<T>& r) { mark_dirty(i); rotations.set(i, r); }
+		inline void set_scale(size_t i, const Vector<T, 3>& s) { mark_dirty(i); scales.set(i, s); }
+		inline void set_local(size_t i, const Vector<T, 3>& t, const Quaternion<T>& r, const Vector<T, 3>& s) {
+			mark_dirty(i);
+			translations.set(i, t);
+			rotations.set(i, r);
+			scales.set(i, s);
+		}
+		inline void mark_dirty(size_t i) {
+			SML_CHECK_INDEX(i, size());
+			dirty[i] = 1;
+			first_dirty = std::min(first_dirty, i);
+		}
+
+		// The local transforms as batches, for bulk edits; call mark_dirty() for each node changed through them
+		inline Vec3Batch<T>& local_translations() noexcept { return translations; }
+		inline QuatBatch<T>& local_rotations() noexcept { return rotations; }
+		inline Vec3Batch<T>& local_scales() noexcept { return scales; }
+		inline const Vec3Batch<T>& local_translations() const noexcept { return translations; }
+		inline const QuatBatch<T>& local_rotations() const noexcept { return rotations; }
+		inline const Vec3Batch<T>& local_scales() const noexcept { return scales; }
+
+		// World matrix of node i as of the last update()
+		inline const Matrix<T, 4, 4>& world(size_t i) const { SML_CHECK_INDEX(i, size()); return worlds[i]; }
+		inline std::span<const Matrix<T, 4, 4>> world_matrices() const noexcept { return worlds; }
+
+		// Recompute the world matrices of the dirty nodes and their descendants. With a parallel policy, the nodes of
+		// each wide level are shared among threads, provided the nodes are in breadth-first order
+		template<execution_policy Policy>
+		void update(Policy&& policy) {
+			const size_t n = size();
+			if (first_dirty >= n) {
+				return;
+			}
+			if constexpr (detail::is_parallel_policy<Policy>) {
+				if (sorted) {
+					// Levels wholly before the first dirty node are unchanged
+					for (size_t level = depths[first_dirty]; level < level_begins.size(); level++) {
+						const size_t begin = std::max(level_begins[level], first_dirty);
+						const size_t end = (level + 1 < level_begins.size()) ? level_begins[level + 1] : n;
+						detail::for_each_range(policy, end - begin, detail::hierarchy_parallel_grain, [&](size_t b, size_t e) {
+							update_range(begin + b, begin + e);
+						});
+					}
+					clean();
+					return;
+				}
+			}
+			update_range(first_dirty, n);
+			clean();
+		}
+		void update() {
+			update(execution::seq);
+		}
+
+		// Reorder the nodes breadth-first, by depth and then by parent, so that each level is contiguous and siblings
+		// are adjacent. Returns the new index of each node, by its old index
+		std::vector<size_t> sort() {
+			const size_t n = size();
+			// Children of each node, by their (ascending) old indices
+			std::vector<size_t> child_begins(n + 1, 0), children(n);
+			for (size_t i = 0; i < n; i++) {
+				if (parents[i] != no_parent) {
+					child_begins[parents[i] + 1]++;
+				}
+			}
+			for (size_t i = 0; i < n; i++) {
+				child_begins[i + 1] += child_begins[i];
+			}
+			std::vector<size_t> fill(child_begins.begin(), child_begins.end() - 1);
+			std::vector<size_t> order;
+			order.reserve(n);
+			for (size_t i = 0; i < n; i++) {
+				if (parents[i] == no_parent) {
+					order.push_back(i);
+				}
+				else {
+					children[fill[parents[i]]++] = i;
+				}
+			}
+			// The order grows as it is walked: each node's children follow all of the nodes of its level
+			for (size_t k = 0; k < order.size(); k++) {
+				const size_t i = order[k];
+				order.insert(order.end(), children.begin() + child_begins[i], children.begin() + child_begins[i + 1]);
+			}
+
+			std::vector<size_t> remap(n);
+			for (size_t k = 0; k < n; k++) {
+				remap[order[k]] = k;
+			}
+			TransformHierarchy ret;
+			ret.reserve(n);
+			for (size_t k = 0; k < n; k++) {
+				const size_t i = order[k];
+				ret.add((parents[i] == no_parent) ? no_parent : remap[parents[i]], translations[i], rotations[i], scales[i]);
+				ret.worlds[k] = worlds[i];
+				ret.dirty[k] = dirty[i];
+			}
+			ret.first_dirty = n;
+			for (size_t k = 0; k < n; k++) {
+				if (ret.dirty[k]) {
+					ret.first_dirty = k;
+					break;
+				}
+			}
+			*this = std::move(ret);
+			return remap;
+		}
+
+	private:
+		inline Matrix<T, 4, 4> local_matrix(size_t i) const {
+			return detail::compose_transform(translations.component(0)[i], translations.component(1)[i], translations.component(2)[i],
+				rotations.component(0)[i], rotations.component(1)[i], rotations.component(2)[i], rotations.component(3)[i],
+				scales.component(0)[i], scales.component(1)[i], scales.component(2)[i]);
+		}
+
+		// Recompute nodes [begin, end), whose parents are all either before begin or already recomputed
+		inline void update_range(size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const size_t p = parents[i];
+				if ((p != no_parent) && dirty[p]) {
+					dirty[i] = 1;
+				}
+				if (dirty[i]) {
+					const Matrix<T, 4, 4> l = local_matrix(i);
+					if (p == no_parent) {
+						worlds[i] = l;
+					}
+					else {
+						detail::batch_multiply_kernel(&worlds[p], 0, &l, 0, &worlds[i], 1);
+					}
+				}
+			}
+		}
+
+		inline void clean() {
+			std::fill(dirty.begin() + first_dirty, dirty.end(), 0);
+			first_dirty = size();
+		}
+
+		std::vector<size_t> parents;
+		std::vector<size_t> depths;
+		std::vector<unsigned char> dirty;
+		std::vector<Matrix<T, 4, 4>, aligned_allocator<Matrix<T, 4, 4>>> worlds;
+		Vec3Batch<T> translations;
+		QuatBatch<T> rotations;
+		Vec3Batch<T> scales;
+		// Index of the first node of each level, while the nodes are breadth-first
+		std::vector<size_t> level_begins;
+		bool sorted = true;
+		size_t first_dirty = 0;
+	};
+
+	sml_export using TransformHierarchyf = TransformHierarchy<float>;
+	sml_export using TransformHierarchyd = TransformHierarchy<double>;
+
+}
+#endif // !SML_HIERARCHY_HPP
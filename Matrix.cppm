@@ -4,7 +4,9 @@ export module sml:Matrix;
 
 export import <array>;
 export import <algorithm>;
+export import <cmath>;
 export import <iostream>;
+export import <stdexcept>;
 export import <string>;
 export import <tuple>;
 export import <vector>;
@@ -18,6 +20,8 @@ import std;
 #endif
 
 import :Utility;
+import :Simd;
+import :Parallel;
 import :Vector;
 #define SML_MODULE_MATRIX
 #include "Matrix.hpp"
\ No newline at end of file
@@ -4,7 +4,9 @@
 #ifndef SML_MODULE_MATRIX
 #include <array>
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -13,64 +15,87 @@
 #define sml_export
 #endif // !sml_export
 
+#include "Simd.hpp"
+#include "Parallel.hpp"
+
 #endif // !SML_MODULE_MATRIX
 
+#include "Config.hpp"
+
 namespace sml {
 
 // This class uses row-major memory ordering
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 class Matrix {
 public:
-	Matrix() {};
+	constexpr Matrix() {};
 	template<arithmetic T2>
-	Matrix(T2 t) {
+	constexpr Matrix(T2 t) {
 		for (size_t i = 0; i < nrows*ncols; i++) {
 			data[i] = static_cast<T>(t);
 		}
 	}
 	template<arithmetic ... T2>
-	Matrix(T2 ...ts) : data{ static_cast<T>(ts)... } {}
+	constexpr Matrix(T2 ...ts) : data{ static_cast<T>(ts)... } {}
 	template<arithmetic T2>
-	Matrix(const Matrix<T2, nrows, ncols>& m2) {
-		std::transform(m2.begin(), m2.end(), data.begin(), [](T2 t)->T {return static_cast<T>(t); });
+	constexpr Matrix(const Matrix<T2, nrows, ncols>& m2) {
+		for (size_t i = 0; i < nrows * ncols; i++) {
+			data[i] = static_cast<T>(m2.data[i]);
+		}
 	}
 	template<arithmetic T2>
-	Matrix(const T2 arr[nrows][ncols]) {
+	constexpr Matrix(const T2 arr[nrows][ncols]) {
 		for (size_t i = 0; i < nrows; i++) {
 			for (size_t j = 0; j < ncols; j++) {
-				data.at((i * ncols) + j) = static_cast<T>(arr[i][j]);
+				data[(i * ncols) + j] = static_cast<T>(arr[i][j]);
 			}
 		}
 	}
 	template<arithmetic T2>
-	Matrix(const T2 arr[nrows * ncols]) {
+	constexpr Matrix(const T2 arr[nrows * ncols]) {
 		for (size_t i = 0; i < nrows; i++) {
 			for (size_t j = 0; j < ncols; j++) {
-				data.at((i * ncols) + j) = static_cast<T>(arr[(i * ncols) + j]);
+				data[(i * ncols) + j] = static_cast<T>(arr[(i * ncols) + j]);
 			}
 		}
 	}
 	template<arithmetic T2>
-	Matrix(const std::array<T2, nrows* ncols> arr) {
-		std::transform(arr.begin(), arr.end(), data.begin(), [](T2 t)->T {return static_cast<T>(t); });
+	constexpr Matrix(const std::array<T2, nrows* ncols> arr) {
+		for (size_t i = 0; i < nrows * ncols; i++) {
+			data[i] = static_cast<T>(arr[i]);
+		}
+	}
+	// Evaluate a lazy expression (see lazy() in Expression.hpp) in a single pass
+	template<detail::lazy_expression E>
+		requires (E::lazy_size == nrows * ncols)
+	constexpr Matrix(const E& e) {
+		for (size_t i = 0; i < nrows * ncols; i++) {
+			data[i] = static_cast<T>(e[i]);
+		}
 	}
 	
 	// TODO: Construct from sub-matricecs (rows/column vectors, squares eg. Pauli matrices)
 
 	// Access elements with M[row][column]
-	inline std::array<T, nrows * ncols>::iterator operator [] (size_t i) { return data.begin() + (i * ncols); }
-	inline std::array<T, nrows* ncols>::const_iterator operator [] (size_t i) const { return data.begin() + (i * ncols); }
+	inline constexpr std::array<T, nrows * ncols>::iterator operator [] (size_t i) {
+		SML_CHECK_INDEX(i, nrows);
+		return data.begin() + (i * ncols);
+	}
+	inline constexpr std::array<T, nrows* ncols>::const_iterator operator [] (size_t i) const {
+		SML_CHECK_INDEX(i, nrows);
+		return data.begin() + (i * ncols);
+	}
 	// (This class uses row-major memory ordering)
 
 	// Access elements with m.at(i)
-	inline T at(size_t i) const { return data.at(i); }
-	inline T& at(size_t i) { return data.at(i); }
+	inline constexpr T at(size_t i) const { return data.at(i); }
+	inline constexpr T& at(size_t i) { return data.at(i); }
 	// Access elements with m.at(row, column)
-	inline T at(size_t r, size_t c) const { return data.at((r * ncols) + c); }
-	inline T& at(size_t r, size_t c) { return data.at((r * ncols) + c); }
+	inline constexpr T at(size_t r, size_t c) const { return data.at((r * ncols) + c); }
+	inline constexpr T& at(size_t r, size_t c) { return data.at((r * ncols) + c); }
 
 	// Fetch an individual row as a Matrix
-	inline Matrix<T, 1, ncols> row_matrix(int r) const {
+	inline constexpr Matrix<T, 1, ncols> row_matrix(int r) const {
 		Matrix<T, 1, ncols> ret;
 		for (size_t i = 0; i < ncols; i++) {
 			ret[0][i] = data[(r * ncols) + i];
@@ -79,7 +104,7 @@ public:
 	}
 
 	// Fetch an individual row as a Vector
-	inline Vector<T, ncols> row_vector(int r) const {
+	inline constexpr Vector<T, ncols> row_vector(int r) const {
 		Vector<T, ncols> ret;
 		for (size_t i = 0; i < ncols; i++) {
 			ret[i] = data[(r * ncols) + i];
@@ -88,7 +113,7 @@ public:
 	}
 
 	// Fetch an individual column as a Matrix
-	inline Matrix<T, nrows, 1> col_matrix(int c) const {
+	inline constexpr Matrix<T, nrows, 1> col_matrix(int c) const {
 		Matrix<T, nrows, 1> ret;
 		for (size_t i = 0; i < nrows; i++) {
 			ret[i][0] = data[(i * ncols) + c];
@@ -97,7 +122,7 @@ public:
 	}
 
 	// Fetch an individual column as a Vector
-	inline Vector<T, nrows> col_vector(int c) const {
+	inline constexpr Vector<T, nrows> col_vector(int c) const {
 		Vector<T, nrows> ret;
 		for (size_t i = 0; i < nrows; i++) {
 			ret[i] = data[(i * ncols) + c];
@@ -106,18 +131,20 @@ public:
 	}
 
 	// Unary operators
-	inline const Matrix& operator + () const { return *this; }
-	inline Matrix operator - () const {
-		Matrix<T, nrows, ncols> ret = *this;
-		std::transform(ret.begin(), ret.end(), ret.begin(), [](T t)->T {return -t; });
+	inline constexpr const Matrix& operator + () const { return *this; }
+	inline constexpr Matrix operator - () const {
+		Matrix<T, nrows, ncols> ret;
+		for (size_t i = 0; i < nrows * ncols; i++) {
+			ret.data[i] = -data[i];
+		}
 		return ret;
 	}
 
 	// Comparison operators
-	inline bool operator == (const Matrix<T, nrows, ncols>& m2) const {
+	inline constexpr bool operator == (const Matrix<T, nrows, ncols>& m2) const {
 		return std::equal(data.begin(), data.end(), m2.begin(), m2.end());
 	}
-	inline bool operator != (const Matrix<T, nrows, ncols>& m2) const {
+	inline constexpr bool operator != (const Matrix<T, nrows, ncols>& m2) const {
 		return !(*this == m2);
 	}
 
@@ -125,90 +152,101 @@ public:
 
 	// Addition
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& operator += (const Matrix<T2, nrows, ncols>& m2);
+	inline constexpr Matrix<T, nrows, ncols>& operator += (const Matrix<T2, nrows, ncols>& m2);
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& operator += (const T2& t);
+	inline constexpr Matrix<T, nrows, ncols>& operator += (const T2& t);
 
 	// Subtraction
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& operator -= (const Matrix<T2, nrows, ncols>& m2);
+	inline constexpr Matrix<T, nrows, ncols>& operator -= (const Matrix<T2, nrows, ncols>& m2);
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& operator -= (const T2& t);
+	inline constexpr Matrix<T, nrows, ncols>& operator -= (const T2& t);
 
 	// Matrix product
 	template<arithmetic T2, size_t ncols2>
-	inline Matrix<T, nrows, ncols>& operator *= (const Matrix<T2, ncols, ncols2>& m2);
+	inline constexpr Matrix<T, nrows, ncols>& operator *= (const Matrix<T2, ncols, ncols2>& m2);
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& operator *= (const T2& t);
+	inline constexpr Matrix<T, nrows, ncols>& operator *= (const T2& t);
 	
 	// Division
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& operator /= (const T2& t);
+	inline constexpr Matrix<T, nrows, ncols>& operator /= (const T2& t);
 
 	// Modulus - requires integer operands
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& operator %= (const Matrix<T2, nrows, ncols>& m2);
+	inline constexpr Matrix<T, nrows, ncols>& operator %= (const Matrix<T2, nrows, ncols>& m2);
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& operator %= (const T2& t);
+	inline constexpr Matrix<T, nrows, ncols>& operator %= (const T2& t);
 
 	// Assignment operator
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& operator = (const Matrix<T2, nrows, ncols>& m2) {
-		std::transform(m2.begin(), m2.end(), data.begin(), [](T2 t)->T {return static_cast<T>(t); });
+	inline constexpr Matrix<T, nrows, ncols>& operator = (const Matrix<T2, nrows, ncols>& m2) {
+		for (size_t i = 0; i < nrows * ncols; i++) {
+			data[i] = static_cast<T>(m2.data[i]);
+		}
+		return *this;
+	}
+
+	template<detail::lazy_expression E>
+		requires (E::lazy_size == nrows * ncols)
+	inline constexpr Matrix<T, nrows, ncols>& operator = (const E& e) {
+		for (size_t i = 0; i < nrows * ncols; i++) {
+			data[i] = static_cast<T>(e[i]);
+		}
 		return *this;
 	}
 
 	// Add a row to each row of a Matrix
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& add_row(const Matrix<T2, 1, ncols>& m2);
+	inline constexpr Matrix<T, nrows, ncols>& add_row(const Matrix<T2, 1, ncols>& m2);
 	// Subtract a row from each row of a Matrix
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& sub_row(const Matrix<T2, 1, ncols>& m2);
+	inline constexpr Matrix<T, nrows, ncols>& sub_row(const Matrix<T2, 1, ncols>& m2);
 	// Multiply each row of a Matrix with a row
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& mul_row(const Matrix<T2, 1, ncols>& m2);
+	inline constexpr Matrix<T, nrows, ncols>& mul_row(const Matrix<T2, 1, ncols>& m2);
 	// Divide a each row of a Matrix by a row
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& div_row(const Matrix<T2, 1, ncols>& m2);
+	inline constexpr Matrix<T, nrows, ncols>& div_row(const Matrix<T2, 1, ncols>& m2);
 
 	// Add a column to each column of a Matrix
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& add_col(const Matrix<T2, nrows, 1>& m2);
+	inline constexpr Matrix<T, nrows, ncols>& add_col(const Matrix<T2, nrows, 1>& m2);
 	// Subtract a column from each column of a Matrix
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& sub_col(const Matrix<T2, nrows, 1>& m2);
+	inline constexpr Matrix<T, nrows, ncols>& sub_col(const Matrix<T2, nrows, 1>& m2);
 	// Multiply each column of a Matrix with a column
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& mul_col(const Matrix<T2, nrows, 1>& m2);
+	inline constexpr Matrix<T, nrows, ncols>& mul_col(const Matrix<T2, nrows, 1>& m2);
 	// Divide a each column of a Matrix by a column
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& div_col(const Matrix<T2, nrows, 1>& m2);
+	inline constexpr Matrix<T, nrows, ncols>& div_col(const Matrix<T2, nrows, 1>& m2);
 
 	// Add a Vector to each row of a Matrix
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& add_row(const Vector<T2, ncols>& v);
+	inline constexpr Matrix<T, nrows, ncols>& add_row(const Vector<T2, ncols>& v);
 	// Subtract a Vector from each row of a Matrix
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& sub_row(const Vector<T2, ncols>& v);
+	inline constexpr Matrix<T, nrows, ncols>& sub_row(const Vector<T2, ncols>& v);
 	// Multiply each row of a Matrix with a Vector
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& mul_row(const Vector<T2, ncols>& v);
+	inline constexpr Matrix<T, nrows, ncols>& mul_row(const Vector<T2, ncols>& v);
 	// Divide a each row of a Matrix by a Vector
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& div_row(const Vector<T2, ncols>& v);
+	inline constexpr Matrix<T, nrows, ncols>& div_row(const Vector<T2, ncols>& v);
 
 	// Add a Vector to each column of a Matrix
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& add_col(const Vector<T2, nrows>& v);
+	inline constexpr Matrix<T, nrows, ncols>& add_col(const Vector<T2, nrows>& v);
 	// Subtract a Vector from each column of a Matrix
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& sub_col(const Vector<T2, nrows>& v);
+	inline constexpr Matrix<T, nrows, ncols>& sub_col(const Vector<T2, nrows>& v);
 	// Multiply each column of a Matrix with a Vector
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& mul_col(const Vector<T2, nrows>& v);
+	inline constexpr Matrix<T, nrows, ncols>& mul_col(const Vector<T2, nrows>& v);
 	// Divide a each column of a Matrix by a Vector
 	template<arithmetic T2>
-	inline Matrix<T, nrows, ncols>& div_col(const Vector<T2, nrows>& v);
+	inline constexpr Matrix<T, nrows, ncols>& div_col(const Vector<T2, nrows>& v);
 
 	// C++ container named requirements
 	inline constexpr std::array<T, nrows * ncols>::iterator begin() noexcept { return data.begin(); }
@@ -227,109 +265,72 @@ public:
 	std::array<T, nrows * ncols> data = {};
 };
 
-// Ostream << operator. Allows matrices to be printed to the console using eg cout
-sml_export template<class T, size_t nrows, size_t ncols>
-inline std::ostream& operator << (std::ostream& os, const Matrix<T, nrows, ncols> m) {
-	// For each column, find the longest element
-
-	std::vector<size_t> column_widths(ncols);
-	Matrix<std::string, nrows, ncols> stringMatrix;
-
-	// Find the longest element in each column to determine their widths
-	for (int i = 0; i < ncols; i++) {
-		std::vector<std::string> stringVector(0);
-		// Convert Ts to std::strings
-		for (int j = 0; j < nrows; j++) {
-			stringMatrix[j][i] = std::to_string(m[j][i]);
-			// Trim trailing zeroes / decimal points from floating point types
-			if (std::is_floating_point_v<T>) {
-				stringMatrix[j][i].erase(stringMatrix[j][i].find_last_not_of('0') + 1, std::string::npos);
-				stringMatrix[j][i].erase(stringMatrix[j][i].find_last_not_of('.') + 1, std::string::npos);
+namespace detail {
+
+	// Write m one row per line, each element in its shortest round-trip form and padded to the width of its column
+	// Elements are formatted in a single pass that also measures the columns, into a buffer on the stack for matrices
+	// small enough, and otherwise formatted a second time as they are written rather than held in strings
+	template<class CharT, class T, size_t nrows, size_t ncols>
+	inline void write_matrix(std::basic_ostream<CharT>& os, const Matrix<T, nrows, ncols>& m) {
+		constexpr bool buffered = (nrows * ncols * max_scalar_chars) <= 8192;
+		std::array<size_t, ncols> column_widths = {};
+		std::array<char, buffered ? nrows * ncols * max_scalar_chars : max_scalar_chars> text;
+		std::array<unsigned char, buffered ? nrows * ncols : 1> widths;
+		const auto format = [&](size_t k) {
+			char* first = buffered ? text.data() + (k * max_scalar_chars) : text.data();
+			return static_cast<size_t>(scalar_to_chars(first, first + max_scalar_chars, m.data[k]).ptr - first);
+		};
+		for (size_t k = 0; k < nrows * ncols; k++) {
+			const size_t width = format(k);
+			if constexpr (buffered) {
+				widths[k] = static_cast<unsigned char>(width);
 			}
-			stringVector.push_back(stringMatrix[j][i]);
+			column_widths[k % ncols] = std::max(column_widths[k % ncols], width);
 		}
-		column_widths[i] = std::max_element(stringVector.begin(), stringVector.end(), [](std::string& const lhs, std::string& const rhs) {
-			return lhs.size() < rhs.size();
-			}
-		)->size();
-	}
 
-	// Write matrix to os
-	for (int i = 0; i < nrows; i++) {
-		for (int j = 0; j < ncols; j++) {
-			// Pad extra spaces to ensure correct column spacing
-			while (stringMatrix[i][j].size() < column_widths[j])
-			{
-				stringMatrix[i][j] += " ";
+		text_writer<CharT> out(os);
+		for (size_t i = 0; i < nrows; i++) {
+			for (size_t j = 0; j < ncols; j++) {
+				const size_t k = (i * ncols) + j;
+				const size_t width = buffered ? widths[k] : format(k);
+				out.put(buffered ? text.data() + (k * max_scalar_chars) : text.data(), width);
+				out.put(' ', column_widths[j] - width + 1);
 			}
-
-			os << stringMatrix[i][j] << " ";
+			if (i < (nrows - 1))
+				out.put('\n');
 		}
-		if (i < (nrows - 1))
-			os << "\n";
+		out.flush();
 	}
 
+} // !namespace detail
+
+// Ostream << operator. Allows matrices to be printed to the console using eg cout
+sml_export template<class T, size_t nrows, size_t ncols>
+inline std::ostream& operator << (std::ostream& os, const Matrix<T, nrows, ncols>& m) {
+	detail::write_matrix(os, m);
 	return os;
 }
 
 // Wostream << operator. Allows matrices to be printed to the console using eg wcout
 sml_export template<class T, size_t nrows, size_t ncols>
-inline std::wostream& operator << (std::wostream& os, const Matrix<T, nrows, ncols> m) {
-	// For each column, find the longest element
-
-	std::vector<size_t> column_widths(ncols);
-	Matrix<std::wstring, nrows, ncols> stringMatrix;
-
-	// Find the longest element in each column to determine their widths
-	for (int i = 0; i < ncols; i++) {
-		std::vector<std::wstring> stringVector(0);
-		// Convert Ts to std::strings
-		for (int j = 0; j < nrows; j++) {
-			stringMatrix[j][i] = std::to_wstring(m[j][i]);
-			// Trim trailing zeroes / decimal points from floating point types
-			if (std::is_floating_point_v<T>) {
-				stringMatrix[j][i].erase(stringMatrix[j][i].find_last_not_of('0') + 1, std::wstring::npos);
-				stringMatrix[j][i].erase(stringMatrix[j][i].find_last_not_of('.') + 1, std::wstring::npos);
-			}
-			stringVector.push_back(stringMatrix[j][i]);
-		}
-		column_widths[i] = std::max_element(stringVector.begin(), stringVector.end(), [](std::wstring& const lhs, std::wstring& const rhs) {
-			return lhs.size() < rhs.size();
-			}
-		)->size();
-	}
-
-	// Write matrix to os
-	for (int i = 0; i < nrows; i++) {
-		for (int j = 0; j < ncols; j++) {
-			// Pad extra spaces to ensure correct column spacing
-			while (stringMatrix[i][j].size() < column_widths[j])
-			{
-				stringMatrix[i][j] += L" ";
-			}
-
-			os << stringMatrix[i][j] << L" ";
-		}
-		if (i < (nrows - 1))
-			os << L"\n";
-	}
-
+inline std::wostream& operator << (std::wostream& os, const Matrix<T, nrows, ncols>& m) {
+	detail::write_matrix(os, m);
 	return os;
 }
 
 // Matrix addition
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator += (const Matrix<T2, nrows, ncols>& m2) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator += (const Matrix<T2, nrows, ncols>& m2) {
 	for (int i = 0; i < nrows; i++) {
 		for (int j = 0; j < ncols; j++) {
-			data[(i * ncols) + j] += static_cast<T>(m2.at(i,j));
+			data[(i * ncols) + j] += static_cast<T>(m2[i][j]);
 		}
 	}
 	return *this;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator + (Matrix<T, nrows, ncols> m1, const Matrix<T2, nrows, ncols>& m2) {
+inline constexpr Matrix<T, nrows, ncols> operator + (Matrix<T, nrows, ncols> m1, const Matrix<T2, nrows, ncols>& m2) {
 	m1 += m2;
 	return m1;
 }
@@ -337,7 +338,7 @@ inline Matrix<T, nrows, ncols>& operator + (Matrix<T, nrows, ncols> m1, const Ma
 // Scalar addition
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator += (const T2& t) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator += (const T2& t) {
 	for (int i = 0; i < nrows; i++) {
 		for (int j = 0; j < ncols; j++) {
 			data[(i * ncols) + j] += static_cast<T>(t);
@@ -346,12 +347,12 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator += (const T2&
 	return *this;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator + (Matrix<T, nrows, ncols> m1, const T2& t) {
+inline constexpr Matrix<T, nrows, ncols> operator + (Matrix<T, nrows, ncols> m1, const T2& t) {
 	m1 += t;
 	return m1;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator + (const T2& t, Matrix<T, nrows, ncols> m1) {
+inline constexpr Matrix<T, nrows, ncols> operator + (const T2& t, Matrix<T, nrows, ncols> m1) {
 	m1 += t;
 	return m1;
 }
@@ -359,16 +360,16 @@ inline Matrix<T, nrows, ncols>& operator + (const T2& t, Matrix<T, nrows, ncols>
 // Matrix subtraction
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator -= (const Matrix<T2, nrows, ncols>& m2) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator -= (const Matrix<T2, nrows, ncols>& m2) {
 	for (int i = 0; i < nrows; i++) {
 		for (int j = 0; j < ncols; j++) {
-			data[(i * ncols) + j] -= static_cast<T>(m2.at(i, j));
+			data[(i * ncols) + j] -= static_cast<T>(m2[i][j]);
 		}
 	}
 	return *this;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator - (Matrix<T, nrows, ncols> m1, const Matrix<T2, nrows, ncols>& m2) {
+inline constexpr Matrix<T, nrows, ncols> operator - (Matrix<T, nrows, ncols> m1, const Matrix<T2, nrows, ncols>& m2) {
 	m1 -= m2;
 	return m1;
 }
@@ -376,7 +377,7 @@ inline Matrix<T, nrows, ncols>& operator - (Matrix<T, nrows, ncols> m1, const Ma
 // Scalar subtraction
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator -= (const T2& t) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator -= (const T2& t) {
 	for (int i = 0; i < nrows; i++) {
 		for (int j = 0; j < ncols; j++) {
 			data[(i * ncols) + j] -= static_cast<T>(t);
@@ -385,12 +386,12 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator -= (const T2&
 	return *this;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator - (Matrix<T, nrows, ncols> m1, const T2& t) {
+inline constexpr Matrix<T, nrows, ncols> operator - (Matrix<T, nrows, ncols> m1, const T2& t) {
 	m1 -= t;
 	return m1;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator - (const T2& t, Matrix<T, nrows, ncols> m1) {
+inline constexpr Matrix<T, nrows, ncols> operator - (const T2& t, Matrix<T, nrows, ncols> m1) {
 	m1 -= t;
 	return m1;
 }
@@ -398,49 +399,161 @@ inline Matrix<T, nrows, ncols>& operator - (const T2& t, Matrix<T, nrows, ncols>
 // Matrix product
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2, size_t ncols2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator *= (const Matrix<T2, ncols, ncols2>& m2) {
-	return (*this) * m2;
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator *= (const Matrix<T2, ncols, ncols2>& m2) {
+	// The product replaces this Matrix, so m2 must be square. The assignment is left out for any other shape, so that
+	// the assertion is the only error reported
+	static_assert(ncols == ncols2, "operator*= needs a square right-hand Matrix, so that the product has the shape of this one");
+	if constexpr (ncols == ncols2) {
+		*this = (*this) * m2;
+	}
+	return *this;
 }
-sml_export template<arithmetic T, size_t outside_rows, size_t inside_dim, size_t outside_cols, arithmetic T2>
-inline Matrix<T, outside_rows, outside_cols>& operator * (const Matrix<T, outside_rows, inside_dim>& m1, const Matrix<T2, inside_dim, outside_cols>& m2) {
-	Matrix<T, outside_rows, outside_cols> ret(0);
-	for (int i = 0; i < outside_rows; i++) {
-		for (int j = 0; j < outside_cols; j++) {
-			for (int k = 0; k < inside_dim; k++) {
-				ret[i][j] += (m1[i][k] * static_cast<T>(m2[k][j]));
+
+namespace detail {
+
+	// Register block of the tiled matrix product: gemm_mr rows by gemm_nr columns of the result are accumulated
+	// in registers, with each row of the block spanning two SIMD registers
+	inline constexpr size_t gemm_mr = 4;
+	template<arithmetic T>
+	inline constexpr size_t gemm_nr = 2 * simd_lanes<T>;
+
+	// Depth of each packed panel of the right-hand matrix, small enough for the panel to stay resident in L1
+	inline constexpr size_t gemm_kc = 128;
+
+	// Products with fewer multiply-adds than this use the plain i-k-j loop, as packing would cost more than it saves
+	inline constexpr size_t gemm_tiled_threshold = 8 * 8 * 8;
+
+	// c[mr x ncols] += a[mr x kc] * panel[kc x nr], where panel is a packed, zero-padded slice of the right-hand matrix
+	template<size_t mr, size_t nr, arithmetic T>
+	inline void gemm_micro_kernel(const T* a, size_t lda, const T* panel, size_t kc, T* c, size_t ldc, size_t ncols) {
+		T acc[mr][nr] = {};
+		// The row loop is unrolled with a fold expression so the accumulators can be kept in registers,
+		// while the column loop is left rolled so that it is vectorised across the columns of the block
+		const auto accumulate = [&]<size_t... r>(std::index_sequence<r...>, const T* b, size_t k) {
+			([&] {
+				const T ar = a[(r * lda) + k];
+				SML_NO_UNROLL
+				for (size_t j = 0; j < nr; j++) {
+					acc[r][j] += ar * b[j];
+				}
+			}(), ...);
+		};
+		for (size_t k = 0; k < kc; k++) {
+			accumulate(std::make_index_sequence<mr>{}, panel + (k * nr), k);
+		}
+		if (ncols == nr) {
+			for (size_t r = 0; r < mr; r++) {
+				for (size_t j = 0; j < nr; j++) {
+					c[(r * ldc) + j] += acc[r][j];
+				}
+			}
+		}
+		else {
+			for (size_t r = 0; r < mr; r++) {
+				for (size_t j = 0; j < ncols; j++) {
+					c[(r * ldc) + j] += acc[r][j];
+				}
+			}
+		}
+	}
+
+	// Cache-blocked, register-tiled matrix product c = a * b, for row-major a (m x k), b (k x n) and c (m x n)
+	// Panels of b are packed contiguously (converting to T on the way) and multiplied in i-k-j order
+	template<arithmetic T, arithmetic T2>
+	void gemm_tiled(const T* a, const T2* b, T* c, size_t m, size_t k, size_t n) {
+		constexpr size_t mr = gemm_mr;
+		constexpr size_t nr = gemm_nr<T>;
+		alignas(64) T panel[gemm_kc * nr];
+
+		std::fill(c, c + (m * n), T(0));
+		for (size_t jj = 0; jj < n; jj += nr) {
+			const size_t ncols = std::min(nr, n - jj);
+			for (size_t kk = 0; kk < k; kk += gemm_kc) {
+				const size_t kc = std::min(gemm_kc, k - kk);
+
+				// Pack a kc x nr panel of b, zero-padding any columns past the edge of the matrix
+				for (size_t p = 0; p < kc; p++) {
+					const T2* brow = b + ((kk + p) * n) + jj;
+					T* prow = panel + (p * nr);
+					for (size_t j = 0; j < ncols; j++) {
+						prow[j] = static_cast<T>(brow[j]);
+					}
+					for (size_t j = ncols; j < nr; j++) {
+						prow[j] = T(0);
+					}
+				}
+
+				// Whole blocks of mr rows, then the fewer than mr rows left over one at a time
+				const size_t full_rows = m - (m % mr);
+				for (size_t i = 0; i < full_rows; i += mr) {
+					gemm_micro_kernel<mr, nr>(a + (i * k) + kk, k, panel, kc, c + (i * n) + jj, n, ncols);
+				}
+				for (size_t r = 0; r < m % mr; r++) {
+					const size_t i = full_rows + r;
+					gemm_micro_kernel<1, nr>(a + (i * k) + kk, k, panel, kc, c + (i * n) + jj, n, ncols);
+				}
+			}
+		}
+	}
+
+	// Plain i-k-j matrix product c = a * b, streaming along the rows of b and c
+	template<arithmetic T, arithmetic T2>
+	constexpr void gemm_small(const T* a, const T2* b, T* c, size_t m, size_t k, size_t n) {
+		std::fill(c, c + (m * n), T(0));
+		for (size_t i = 0; i < m; i++) {
+			for (size_t p = 0; p < k; p++) {
+				const T aip = a[(i * k) + p];
+				for (size_t j = 0; j < n; j++) {
+					c[(i * n) + j] += aip * static_cast<T>(b[(p * n) + j]);
+				}
 			}
 		}
 	}
+
+} // !namespace detail
+
+sml_export template<arithmetic T, size_t outside_rows, size_t inside_dim, size_t outside_cols, arithmetic T2>
+inline constexpr Matrix<T, outside_rows, outside_cols> operator * (const Matrix<T, outside_rows, inside_dim>& m1, const Matrix<T2, inside_dim, outside_cols>& m2) {
+	Matrix<T, outside_rows, outside_cols> ret;
+	// Choose the kernel at compile time from the dimensions of the product
+	if !consteval {
+		if constexpr ((outside_rows >= detail::gemm_mr) && (outside_cols >= detail::gemm_nr<T>)
+			&& ((outside_rows * inside_dim * outside_cols) >= detail::gemm_tiled_threshold)) {
+			detail::gemm_tiled(m1.data.data(), m2.data.data(), ret.data.data(), outside_rows, inside_dim, outside_cols);
+			return ret;
+		}
+	}
+	detail::gemm_small(m1.data.data(), m2.data.data(), ret.data.data(), outside_rows, inside_dim, outside_cols);
 	return ret;
 }
 
 // Unrolled for small, common combinations
 sml_export template<class T>
-inline Matrix<T, 2, 2> operator * (const Matrix<T, 2, 2>& m1, const Matrix<T, 2, 2>& m2) {
+inline constexpr Matrix<T, 2, 2> operator * (const Matrix<T, 2, 2>& m1, const Matrix<T, 2, 2>& m2) {
 	return Matrix<T, 2, 2>({
-		m1.at(0) * m2.at(0) + m1.at(1) * m2.at(2), m1.at(0) * m2.at(1) + m1.at(1) * m2.at(3),
-		m1.at(2) * m2.at(0) + m1.at(3) * m2.at(2), m1.at(2) * m2.at(1) + m1.at(3) * m2.at(3) });
+		m1.data[0] * m2.data[0] + m1.data[1] * m2.data[2], m1.data[0] * m2.data[1] + m1.data[1] * m2.data[3],
+		m1.data[2] * m2.data[0] + m1.data[3] * m2.data[2], m1.data[2] * m2.data[1] + m1.data[3] * m2.data[3] });
 }
 sml_export template<class T>
-inline Matrix<T, 3, 3> operator * (const Matrix<T, 3, 3>& m1, const Matrix<T, 3, 3>& m2) {
+inline constexpr Matrix<T, 3, 3> operator * (const Matrix<T, 3, 3>& m1, const Matrix<T, 3, 3>& m2) {
 	return Matrix<T, 3, 3>({
-		m1.at(0) * m2.at(0) + m1.at(1) * m2.at(3) + m1.at(2) * m2.at(6), m1.at(0) * m2.at(1) + m1.at(1) * m2.at(4) + m1.at(2) * m2.at(7), m1.at(0) * m2.at(2) + m1.at(1) * m2.at(5) + m1.at(2) * m2.at(8),
-		m1.at(3) * m2.at(0) + m1.at(4) * m2.at(3) + m1.at(5) * m2.at(6), m1.at(3) * m2.at(1) + m1.at(4) * m2.at(4) + m1.at(5) * m2.at(7), m1.at(3) * m2.at(2) + m1.at(4) * m2.at(5) + m1.at(5) * m2.at(8),
-		m1.at(6) * m2.at(0) + m1.at(7) * m2.at(3) + m1.at(8) * m2.at(6), m1.at(6) * m2.at(1) + m1.at(7) * m2.at(4) + m1.at(8) * m2.at(7), m1.at(6) * m2.at(2) + m1.at(7) * m2.at(5) + m1.at(8) * m2.at(8) });
+		m1.data[0] * m2.data[0] + m1.data[1] * m2.data[3] + m1.data[2] * m2.data[6], m1.data[0] * m2.data[1] + m1.data[1] * m2.data[4] + m1.data[2] * m2.data[7], m1.data[0] * m2.data[2] + m1.data[1] * m2.data[5] + m1.data[2] * m2.data[8],
+		m1.data[3] * m2.data[0] + m1.data[4] * m2.data[3] + m1.data[5] * m2.data[6], m1.data[3] * m2.data[1] + m1.data[4] * m2.data[4] + m1.data[5] * m2.data[7], m1.data[3] * m2.data[2] + m1.data[4] * m2.data[5] + m1.data[5] * m2.data[8],
+		m1.data[6] * m2.data[0] + m1.data[7] * m2.data[3] + m1.data[8] * m2.data[6], m1.data[6] * m2.data[1] + m1.data[7] * m2.data[4] + m1.data[8] * m2.data[7], m1.data[6] * m2.data[2] + m1.data[7] * m2.data[5] + m1.data[8] * m2.data[8] });
 }
 sml_export template<class T>
-inline Matrix<T, 4, 4> operator * (const Matrix<T, 4, 4>& m1, const Matrix<T, 4, 4>& m2) {
+inline constexpr Matrix<T, 4, 4> operator * (const Matrix<T, 4, 4>& m1, const Matrix<T, 4, 4>& m2) {
 	return Matrix<T, 4, 4>({
-		m1.at(0) * m2.at(0) + m1.at(1) * m2.at(4) + m1.at(2) * m2.at(8) + m1.at(3) * m2.at(12), m1.at(0) * m2.at(1) + m1.at(1) * m2.at(5) + m1.at(2) * m2.at(9) + m1.at(3) * m2.at(13), m1.at(0) * m2.at(2) + m1.at(1) * m2.at(6) + m1.at(2) * m2.at(10) + m1.at(3) * m2.at(14), m1.at(0) * m2.at(3) + m1.at(1) * m2.at(7) + m1.at(2) * m2.at(11) + m1.at(3) * m2.at(15),
-		m1.at(4) * m2.at(0) + m1.at(5) * m2.at(4) + m1.at(6) * m2.at(8) + m1.at(7) * m2.at(12), m1.at(4) * m2.at(1) + m1.at(5) * m2.at(5) + m1.at(6) * m2.at(9) + m1.at(7) * m2.at(13), m1.at(4) * m2.at(2) + m1.at(5) * m2.at(6) + m1.at(6) * m2.at(10) + m1.at(7) * m2.at(14), m1.at(4) * m2.at(3) + m1.at(5) * m2.at(7) + m1.at(6) * m2.at(11) + m1.at(7) * m2.at(15),
-		m1.at(8) * m2.at(0) + m1.at(9) * m2.at(4) + m1.at(10) * m2.at(8) + m1.at(11) * m2.at(12), m1.at(8) * m2.at(1) + m1.at(9) * m2.at(5) + m1.at(10) * m2.at(9) + m1.at(11) * m2.at(13), m1.at(8) * m2.at(2) + m1.at(9) * m2.at(6) + m1.at(10) * m2.at(10) + m1.at(11) * m2.at(14), m1.at(8) * m2.at(3) + m1.at(9) * m2.at(7) + m1.at(10) * m2.at(11) + m1.at(11) * m2.at(15),
-		m1.at(12) * m2.at(0) + m1.at(13) * m2.at(4) + m1.at(14) * m2.at(8) + m1.at(15) * m2.at(12), m1.at(12) * m2.at(1) + m1.at(13) * m2.at(5) + m1.at(14) * m2.at(9) + m1.at(15) * m2.at(13), m1.at(12) * m2.at(2) + m1.at(13) * m2.at(6) + m1.at(14) * m2.at(10) + m1.at(15) * m2.at(14), m1.at(12) * m2.at(3) + m1.at(13) * m2.at(7) + m1.at(14) * m2.at(11) + m1.at(15) * m2.at(15) });
+		m1.data[0] * m2.data[0] + m1.data[1] * m2.data[4] + m1.data[2] * m2.data[8] + m1.data[3] * m2.data[12], m1.data[0] * m2.data[1] + m1.data[1] * m2.data[5] + m1.data[2] * m2.data[9] + m1.data[3] * m2.data[13], m1.data[0] * m2.data[2] + m1.data[1] * m2.data[6] + m1.data[2] * m2.data[10] + m1.data[3] * m2.data[14], m1.data[0] * m2.data[3] + m1.data[1] * m2.data[7] + m1.data[2] * m2.data[11] + m1.data[3] * m2.data[15],
+		m1.data[4] * m2.data[0] + m1.data[5] * m2.data[4] + m1.data[6] * m2.data[8] + m1.data[7] * m2.data[12], m1.data[4] * m2.data[1] + m1.data[5] * m2.data[5] + m1.data[6] * m2.data[9] + m1.data[7] * m2.data[13], m1.data[4] * m2.data[2] + m1.data[5] * m2.data[6] + m1.data[6] * m2.data[10] + m1.data[7] * m2.data[14], m1.data[4] * m2.data[3] + m1.data[5] * m2.data[7] + m1.data[6] * m2.data[11] + m1.data[7] * m2.data[15],
+		m1.data[8] * m2.data[0] + m1.data[9] * m2.data[4] + m1.data[10] * m2.data[8] + m1.data[11] * m2.data[12], m1.data[8] * m2.data[1] + m1.data[9] * m2.data[5] + m1.data[10] * m2.data[9] + m1.data[11] * m2.data[13], m1.data[8] * m2.data[2] + m1.data[9] * m2.data[6] + m1.data[10] * m2.data[10] + m1.data[11] * m2.data[14], m1.data[8] * m2.data[3] + m1.data[9] * m2.data[7] + m1.data[10] * m2.data[11] + m1.data[11] * m2.data[15],
+		m1.data[12] * m2.data[0] + m1.data[13] * m2.data[4] + m1.data[14] * m2.data[8] + m1.data[15] * m2.data[12], m1.data[12] * m2.data[1] + m1.data[13] * m2.data[5] + m1.data[14] * m2.data[9] + m1.data[15] * m2.data[13], m1.data[12] * m2.data[2] + m1.data[13] * m2.data[6] + m1.data[14] * m2.data[10] + m1.data[15] * m2.data[14], m1.data[12] * m2.data[3] + m1.data[13] * m2.data[7] + m1.data[14] * m2.data[11] + m1.data[15] * m2.data[15] });
 }
 
 // Matrix * Vector / Column Matrix = Column Matrix
 
 sml_export template<arithmetic T, size_t dim, arithmetic T2>
-inline Matrix<T, dim, 1>& operator * (const Matrix<T, dim, dim>& m, const Vector<T2, dim>& v) {
+inline constexpr Matrix<T, dim, 1> operator * (const Matrix<T, dim, dim>& m, const Vector<T2, dim>& v) {
 	Matrix<T, dim, 1> ret(0);
 	for (int i = 0; i < dim; i++) {
 		for (int j = 0; j < dim; j++) {
@@ -454,57 +567,57 @@ inline Matrix<T, dim, 1>& operator * (const Matrix<T, dim, dim>& m, const Vector
 
 // 2x2 Matrix * 2x1 Column Matrix = 2x1 Matrix
 sml_export template<class T>
-inline Matrix<T, 2, 1> operator * (const Matrix<T, 2, 2>& m1, const Matrix<T, 2, 1>& m2) {
+inline constexpr Matrix<T, 2, 1> operator * (const Matrix<T, 2, 2>& m1, const Matrix<T, 2, 1>& m2) {
 	return Matrix<T, 2, 1>({
-		m1.at(0) * m2.at(0) + m1.at(1) * m2.at(1),
-		m1.at(2) * m2.at(0) + m1.at(3) * m2.at(1) });
+		m1.data[0] * m2.data[0] + m1.data[1] * m2.data[1],
+		m1.data[2] * m2.data[0] + m1.data[3] * m2.data[1] });
 }
 // 2x2 Matrix * 2-Vector = 2x1 Matrix
 sml_export template<class T>
-inline Matrix<T, 2, 1> operator * (const Matrix<T, 2, 2>& m1, const Vector<T, 2>& v) {
+inline constexpr Matrix<T, 2, 1> operator * (const Matrix<T, 2, 2>& m1, const Vector<T, 2>& v) {
 	return Matrix<T, 2, 1>({
-		m1.at(0) * v.at(0) + m1.at(1) * v.at(1),
-		m1.at(2) * v.at(0) + m1.at(3) * v.at(1) });
+		m1.data[0] * v[0] + m1.data[1] * v[1],
+		m1.data[2] * v[0] + m1.data[3] * v[1] });
 }
 // 3x3 Matrix * 3x1 Column Matrix = 3x1 Matrix
 sml_export template<class T>
-inline Matrix<T, 3, 1> operator * (const Matrix<T, 3, 3>& m1, const Matrix<T, 3, 1>& m2) {
+inline constexpr Matrix<T, 3, 1> operator * (const Matrix<T, 3, 3>& m1, const Matrix<T, 3, 1>& m2) {
 	return Matrix<T, 3, 1>({
-		m1.at(0) * m2.at(0) + m1.at(1) * m2.at(1) + m1.at(2) * m2.at(2),
-		m1.at(3) * m2.at(0) + m1.at(4) * m2.at(1) + m1.at(5) * m2.at(2),
-		m1.at(6) * m2.at(0) + m1.at(7) * m2.at(1) + m1.at(8) * m2.at(2) });
+		m1.data[0] * m2.data[0] + m1.data[1] * m2.data[1] + m1.data[2] * m2.data[2],
+		m1.data[3] * m2.data[0] + m1.data[4] * m2.data[1] + m1.data[5] * m2.data[2],
+		m1.data[6] * m2.data[0] + m1.data[7] * m2.data[1] + m1.data[8] * m2.data[2] });
 }
 // 3x3 Matrix * 3-Vector = 3x1 Matrix
 sml_export template<class T>
-inline Matrix<T, 3, 1> operator * (const Matrix<T, 3, 3>& m, const Vector<T, 3>& v) {
+inline constexpr Matrix<T, 3, 1> operator * (const Matrix<T, 3, 3>& m, const Vector<T, 3>& v) {
 	return Matrix<T, 3, 1>({ 
-		m.at(0) * v.at(0) + m.at(1) * v.at(1) + m.at(2) * v.at(2),
-		m.at(3) * v.at(0) + m.at(4) * v.at(1) + m.at(5) * v.at(2),
-		m.at(6) * v.at(0) + m.at(7) * v.at(1) + m.at(8) * v.at(2) });
+		m.data[0] * v[0] + m.data[1] * v[1] + m.data[2] * v[2],
+		m.data[3] * v[0] + m.data[4] * v[1] + m.data[5] * v[2],
+		m.data[6] * v[0] + m.data[7] * v[1] + m.data[8] * v[2] });
 }
 // 4x4 Matrix * 4x1 Column Matrix = 4x1 Matrix
 sml_export template<class T>
-inline Matrix<T, 4, 1> operator * (const Matrix<T, 4, 4>& m1, const Matrix<T, 4, 1>& m2) {
+inline constexpr Matrix<T, 4, 1> operator * (const Matrix<T, 4, 4>& m1, const Matrix<T, 4, 1>& m2) {
 	return Matrix<T, 4, 1>({
-		m1.at(0) * m2.at(0) + m1.at(1) * m2.at(1) + m1.at(2) * m2.at(2) + m1.at(3) * m2.at(3),
-		m1.at(4) * m2.at(0) + m1.at(5) * m2.at(1) + m1.at(6) * m2.at(2) + m1.at(7) * m2.at(3),
-		m1.at(8) * m2.at(0) + m1.at(9) * m2.at(1) + m1.at(10) * m2.at(2) + m1.at(11) * m2.at(3),
-		m1.at(12) * m2.at(0) + m1.at(13) * m2.at(1) + m1.at(14) * m2.at(2) + m1.at(15) * m2.at(3) });
+		m1.data[0] * m2.data[0] + m1.data[1] * m2.data[1] + m1.data[2] * m2.data[2] + m1.data[3] * m2.data[3],
+		m1.data[4] * m2.data[0] + m1.data[5] * m2.data[1] + m1.data[6] * m2.data[2] + m1.data[7] * m2.data[3],
+		m1.data[8] * m2.data[0] + m1.data[9] * m2.data[1] + m1.data[10] * m2.data[2] + m1.data[11] * m2.data[3],
+		m1.data[12] * m2.data[0] + m1.data[13] * m2.data[1] + m1.data[14] * m2.data[2] + m1.data[15] * m2.data[3] });
 }
 // 4x4 Matrix * 4-Vector = 4x1 Matrix
 sml_export template<class T>
-inline Matrix<T, 4, 1> operator * (const Matrix<T, 4, 4>& m1, const Vector<T, 4>& v) {
+inline constexpr Matrix<T, 4, 1> operator * (const Matrix<T, 4, 4>& m1, const Vector<T, 4>& v) {
 	return Matrix<T, 4, 1>({
-		m1.at(0) * v.at(0) + m1.at(1) * v.at(1) + m1.at(2) * v.at(2) + m1.at(3) * v.at(3),
-		m1.at(4) * v.at(0) + m1.at(5) * v.at(1) + m1.at(6) * v.at(2) + m1.at(7) * v.at(3),
-		m1.at(8) * v.at(0) + m1.at(9) * v.at(1) + m1.at(10) * v.at(2) + m1.at(11) * v.at(3),
-		m1.at(12) * v.at(0) + m1.at(13) * v.at(1) + m1.at(14) * v.at(2) + m1.at(15) * v.at(3) });
+		m1.data[0] * v[0] + m1.data[1] * v[1] + m1.data[2] * v[2] + m1.data[3] * v[3],
+		m1.data[4] * v[0] + m1.data[5] * v[1] + m1.data[6] * v[2] + m1.data[7] * v[3],
+		m1.data[8] * v[0] + m1.data[9] * v[1] + m1.data[10] * v[2] + m1.data[11] * v[3],
+		m1.data[12] * v[0] + m1.data[13] * v[1] + m1.data[14] * v[2] + m1.data[15] * v[3] });
 }
 
 // Vector / Row Matrix * Matrix = Row Matrix
 
 sml_export template<arithmetic T, size_t dim, arithmetic T2>
-inline Matrix<T, 1, dim>& operator * (const Vector<T2, dim>& v, const Matrix<T, dim, dim>& m) {
+inline constexpr Matrix<T, 1, dim> operator * (const Vector<T2, dim>& v, const Matrix<T, dim, dim>& m) {
 	Matrix<T, 1, dim> ret(0);
 	for (int i = 0; i < dim; i++) {
 		for (int j = 0; j < dim; j++) {
@@ -516,46 +629,46 @@ inline Matrix<T, 1, dim>& operator * (const Vector<T2, dim>& v, const Matrix<T,
 
 // 1x2 Row Matrix * 2x2 Matrix = 1x2 Matrix
 sml_export template<class T>
-inline Matrix<T, 1, 2> operator * (const Matrix<T, 1, 2>& m1, const Matrix<T, 2, 2>& m2) {
+inline constexpr Matrix<T, 1, 2> operator * (const Matrix<T, 1, 2>& m1, const Matrix<T, 2, 2>& m2) {
 	return Matrix<T, 1, 2>({
-		m1.at(0) * m2.at(0) + m1.at(1) * m2.at(2), m1.at(0) * m2.at(1) + m1.at(1) * m2.at(3) });
+		m1.data[0] * m2.data[0] + m1.data[1] * m2.data[2], m1.data[0] * m2.data[1] + m1.data[1] * m2.data[3] });
 }
 // 2-Vector * 2x2 Matrix = 1x2 Matrix
 sml_export template<class T>
-inline Matrix<T, 1, 2> operator * (const Vector<T, 2>& v, const Matrix<T, 2, 2>& m) {
+inline constexpr Matrix<T, 1, 2> operator * (const Vector<T, 2>& v, const Matrix<T, 2, 2>& m) {
 	return Matrix<T, 1, 2>({
-		v.at(0) * m.at(0) + v.at(1) * m.at(2), v.at(0) * m.at(1) + v.at(1) * m.at(3) });
+		v[0] * m.data[0] + v[1] * m.data[2], v[0] * m.data[1] + v[1] * m.data[3] });
 }
 // 1x3 Row Matrix * 3x3 Matrix = 1x3 Matrix
 sml_export template<class T>
-inline Matrix<T, 1, 3> operator * (const Matrix<T, 1, 3>& m1, const Matrix<T, 3, 3>& m2) {
+inline constexpr Matrix<T, 1, 3> operator * (const Matrix<T, 1, 3>& m1, const Matrix<T, 3, 3>& m2) {
 	return Matrix<T, 1, 3>({
-		m1.at(0) * m2.at(0) + m1.at(1) * m2.at(3) + m1.at(2) * m2.at(6), m1.at(0) * m2.at(1) + m1.at(1) * m2.at(4) + m1.at(2) * m2.at(7), m1.at(0) * m2.at(2) + m1.at(1) * m2.at(5) + m1.at(2) * m2.at(8) });
+		m1.data[0] * m2.data[0] + m1.data[1] * m2.data[3] + m1.data[2] * m2.data[6], m1.data[0] * m2.data[1] + m1.data[1] * m2.data[4] + m1.data[2] * m2.data[7], m1.data[0] * m2.data[2] + m1.data[1] * m2.data[5] + m1.data[2] * m2.data[8] });
 }
 // 3-Vector * 3x3 Matrix = 1x3 Matrix
 sml_export template<class T>
-inline Matrix<T, 1, 3> operator * (const Vector<T, 3>& v, const Matrix<T, 3, 3>& m) {
+inline constexpr Matrix<T, 1, 3> operator * (const Vector<T, 3>& v, const Matrix<T, 3, 3>& m) {
 	return Matrix<T, 1, 3>({ 
-		v.at(0) * m.at(0) + v.at(1) * m.at(3) + v.at(2) * m.at(6),
-		v.at(0) * m.at(1) + v.at(1) * m.at(4) + v.at(2) * m.at(7),
-		v.at(0) * m.at(2) + v.at(1) * m.at(5) + v.at(2) * m.at(8) });
+		v[0] * m.data[0] + v[1] * m.data[3] + v[2] * m.data[6],
+		v[0] * m.data[1] + v[1] * m.data[4] + v[2] * m.data[7],
+		v[0] * m.data[2] + v[1] * m.data[5] + v[2] * m.data[8] });
 }
 // 1x4 Row Matrix * 4x4 Matrix = 1x4 Matrix
 sml_export template<class T>
-inline Matrix<T, 1, 4> operator * (const Matrix<T, 1, 4>& m1, const Matrix<T, 4, 4>& m2) {
+inline constexpr Matrix<T, 1, 4> operator * (const Matrix<T, 1, 4>& m1, const Matrix<T, 4, 4>& m2) {
 	return Matrix<T, 1, 4>({
-		m1.at(0) * m2.at(0) + m1.at(1) * m2.at(4) + m1.at(2) * m2.at(8) + m1.at(3) * m2.at(12), m1.at(0) * m2.at(1) + m1.at(1) * m2.at(5) + m1.at(2) * m2.at(9) + m1.at(3) * m2.at(13), m1.at(0) * m2.at(2) + m1.at(1) * m2.at(6) + m1.at(2) * m2.at(10) + m1.at(3) * m2.at(14), m1.at(0) * m2.at(3) + m1.at(1) * m2.at(7) + m1.at(2) * m2.at(11) + m1.at(3) * m2.at(15) });
+		m1.data[0] * m2.data[0] + m1.data[1] * m2.data[4] + m1.data[2] * m2.data[8] + m1.data[3] * m2.data[12], m1.data[0] * m2.data[1] + m1.data[1] * m2.data[5] + m1.data[2] * m2.data[9] + m1.data[3] * m2.data[13], m1.data[0] * m2.data[2] + m1.data[1] * m2.data[6] + m1.data[2] * m2.data[10] + m1.data[3] * m2.data[14], m1.data[0] * m2.data[3] + m1.data[1] * m2.data[7] + m1.data[2] * m2.data[11] + m1.data[3] * m2.data[15] });
 }
 // 4-Vector * 4x4 Matrix = 1x4 Matrix
 sml_export template<class T>
-inline Matrix<T, 1, 4> operator * (const Vector<T, 4>& v, const Matrix<T, 4, 4>& m) {
+inline constexpr Matrix<T, 1, 4> operator * (const Vector<T, 4>& v, const Matrix<T, 4, 4>& m) {
 	return Matrix<T, 1, 4>({
-		v.at(0) * m.at(0) + v.at(1) * m.at(4) + v.at(2) * m.at(8) + v.at(3) * m.at(12), v.at(0) * m.at(1) + v.at(1) * m.at(5) + v.at(2) * m.at(9) + v.at(3) * m.at(13), v.at(0) * m.at(2) + v.at(1) * m.at(6) + v.at(2) * m.at(10) + v.at(3) * m.at(14), v.at(0) * m.at(3) + v.at(1) * m.at(7) + v.at(2) * m.at(11) + v.at(3) * m.at(15) });
+		v[0] * m.data[0] + v[1] * m.data[4] + v[2] * m.data[8] + v[3] * m.data[12], v[0] * m.data[1] + v[1] * m.data[5] + v[2] * m.data[9] + v[3] * m.data[13], v[0] * m.data[2] + v[1] * m.data[6] + v[2] * m.data[10] + v[3] * m.data[14], v[0] * m.data[3] + v[1] * m.data[7] + v[2] * m.data[11] + v[3] * m.data[15] });
 }
 
 // Outer Product - Returns the Matrix multiplication of two Vectors, with the first treated as a 1xm Matrix and the second as an mx1 Matrix.
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-Matrix<T, nrows, ncols> outer_product(const Vector<T, nrows>& v1, const Vector<T2, ncols>& v2) {
+constexpr Matrix<T, nrows, ncols> outer_product(const Vector<T, nrows>& v1, const Vector<T2, ncols>& v2) {
 	Matrix<T, nrows, ncols> ret(0);
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
@@ -567,14 +680,14 @@ Matrix<T, nrows, ncols> outer_product(const Vector<T, nrows>& v1, const Vector<T
 
 // Outer Product - Returns the Matrix multiplication of a row Matrix and a column Matrix.
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-Matrix<T, nrows, ncols> outer_product(const Matrix<T, nrows, 1>& m1, const Matrix<T2, 1, ncols>& m2) {
+constexpr Matrix<T, nrows, ncols> outer_product(const Matrix<T, nrows, 1>& m1, const Matrix<T2, 1, ncols>& m2) {
 	return m1 * m2;
 }
 
 // Scalar multiplication
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator *= (const T2& t) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator *= (const T2& t) {
 	for (int i = 0; i < nrows; i++) {
 		for (int j = 0; j < ncols; j++) {
 			data[(i * ncols) + j] *= static_cast<T>(t);
@@ -583,12 +696,12 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator *= (const T2&
 	return *this;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator * (Matrix<T, nrows, ncols> m1, const T2& t) {
+inline constexpr Matrix<T, nrows, ncols> operator * (Matrix<T, nrows, ncols> m1, const T2& t) {
 	m1 *= t;
 	return m1;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator * (const T2& t, Matrix<T, nrows, ncols> m1) {
+inline constexpr Matrix<T, nrows, ncols> operator * (const T2& t, Matrix<T, nrows, ncols> m1) {
 	m1 *= t;
 	return m1;
 }
@@ -596,7 +709,7 @@ inline Matrix<T, nrows, ncols>& operator * (const T2& t, Matrix<T, nrows, ncols>
 // Scalar division
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator /= (const T2& t) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator /= (const T2& t) {
 	for (int i = 0; i < nrows; i++) {
 		for (int j = 0; j < ncols; j++) {
 			data[(i * ncols) + j] /= static_cast<T>(t);
@@ -605,12 +718,12 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator /= (const T2&
 	return *this;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator / (Matrix<T, nrows, ncols> m1, const T2& t) {
+inline constexpr Matrix<T, nrows, ncols> operator / (Matrix<T, nrows, ncols> m1, const T2& t) {
 	m1 /= t;
 	return m1;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator / (const T2& t, Matrix<T, nrows, ncols> m1) {
+inline constexpr Matrix<T, nrows, ncols> operator / (const T2& t, Matrix<T, nrows, ncols> m1) {
 	m1 /= t;
 	return m1;
 }
@@ -618,16 +731,16 @@ inline Matrix<T, nrows, ncols>& operator / (const T2& t, Matrix<T, nrows, ncols>
 // Matrix modulus - requires integer operands
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator %= (const Matrix<T2, nrows, ncols>& m2) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator %= (const Matrix<T2, nrows, ncols>& m2) {
 	for (int i = 0; i < nrows; i++) {
 		for (int j = 0; j < ncols; j++) {
-			data[(i * ncols) + j] %= static_cast<T>(m2.at(i, j));
+			data[(i * ncols) + j] %= static_cast<T>(m2[i][j]);
 		}
 	}
 	return *this;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator % (Matrix<T, nrows, ncols> m1, const Matrix<T2, nrows, ncols>& m2) {
+inline constexpr Matrix<T, nrows, ncols> operator % (Matrix<T, nrows, ncols> m1, const Matrix<T2, nrows, ncols>& m2) {
 	m1 %= m2;
 	return m1;
 }
@@ -635,7 +748,7 @@ inline Matrix<T, nrows, ncols>& operator % (Matrix<T, nrows, ncols> m1, const Ma
 // Scalar modulus - requires integer operands
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator %= (const T2& t) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator %= (const T2& t) {
 	for (int i = 0; i < nrows; i++) {
 		for (int j = 0; j < ncols; j++) {
 			data[(i * ncols) + j] %= static_cast<T>(t);
@@ -644,12 +757,12 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::operator %= (const T2&
 	return *this;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator % (Matrix<T, nrows, ncols> m1, const T2& t) {
+inline constexpr Matrix<T, nrows, ncols> operator % (Matrix<T, nrows, ncols> m1, const T2& t) {
 	m1 %= t;
 	return m1;
 }
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-inline Matrix<T, nrows, ncols>& operator % (const T2& t, Matrix<T, nrows, ncols> m1) {
+inline constexpr Matrix<T, nrows, ncols> operator % (const T2& t, Matrix<T, nrows, ncols> m1) {
 	m1 %= t;
 	return m1;
 }
@@ -657,10 +770,10 @@ inline Matrix<T, nrows, ncols>& operator % (const T2& t, Matrix<T, nrows, ncols>
 // Add a row to each row of a Matrix
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::add_row(const Matrix<T2, 1, ncols>& m2) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::add_row(const Matrix<T2, 1, ncols>& m2) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] += static_cast<T>(m2.at(0, j));
+			(*this)[i][j] += static_cast<T>(m2[0][j]);
 		}
 	}
 	return *this;
@@ -668,10 +781,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::add_row(const Matrix<T2
 // Subtract a row from each row of a Matrix
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::sub_row(const Matrix<T2, 1, ncols>& m2) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::sub_row(const Matrix<T2, 1, ncols>& m2) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] -= static_cast<T>(m2.at(0, j));
+			(*this)[i][j] -= static_cast<T>(m2[0][j]);
 		}
 	}
 	return *this;
@@ -679,10 +792,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::sub_row(const Matrix<T2
 // Multiply each row of a Matrix with a row
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::mul_row(const Matrix<T2, 1, ncols>& m2) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::mul_row(const Matrix<T2, 1, ncols>& m2) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] *= static_cast<T>(m2.at(0, j));
+			(*this)[i][j] *= static_cast<T>(m2[0][j]);
 		}
 	}
 	return *this;
@@ -690,10 +803,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::mul_row(const Matrix<T2
 // Divide a each row of a Matrix by a row
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::div_row(const Matrix<T2, 1, ncols>& m2) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::div_row(const Matrix<T2, 1, ncols>& m2) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] /= static_cast<T>(m2.at(0, j));
+			(*this)[i][j] /= static_cast<T>(m2[0][j]);
 		}
 	}
 	return *this;
@@ -702,10 +815,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::div_row(const Matrix<T2
 // Add a column to each column of a Matrix
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::add_col(const Matrix<T2, nrows, 1>& m2) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::add_col(const Matrix<T2, nrows, 1>& m2) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] += static_cast<T>(m2.at(i, 0));
+			(*this)[i][j] += static_cast<T>(m2[i][0]);
 		}
 	}
 	return *this;
@@ -713,10 +826,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::add_col(const Matrix<T2
 // Subtract a column from each column of a Matrix
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::sub_col(const Matrix<T2, nrows, 1>& m2) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::sub_col(const Matrix<T2, nrows, 1>& m2) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] -= static_cast<T>(m2.at(i, 0));
+			(*this)[i][j] -= static_cast<T>(m2[i][0]);
 		}
 	}
 	return *this;
@@ -724,10 +837,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::sub_col(const Matrix<T2
 // Multiply each column of a Matrix with a column
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::mul_col(const Matrix<T2, nrows, 1>& m2) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::mul_col(const Matrix<T2, nrows, 1>& m2) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] *= static_cast<T>(m2.at(i, 0));
+			(*this)[i][j] *= static_cast<T>(m2[i][0]);
 		}
 	}
 	return *this;
@@ -735,10 +848,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::mul_col(const Matrix<T2
 // Divide a each column of a Matrix by a column
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::div_col(const Matrix<T2, nrows, 1>& m2) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::div_col(const Matrix<T2, nrows, 1>& m2) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] /= static_cast<T>(m2.at(i, 0));
+			(*this)[i][j] /= static_cast<T>(m2[i][0]);
 		}
 	}
 	return *this;
@@ -747,10 +860,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::div_col(const Matrix<T2
 // Add a row to each row of a Matrix
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::add_row(const Vector<T2, ncols>& v) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::add_row(const Vector<T2, ncols>& v) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] += static_cast<T>(v.at(j));
+			(*this)[i][j] += static_cast<T>(v[j]);
 		}
 	}
 	return *this;
@@ -758,10 +871,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::add_row(const Vector<T2
 // Subtract a row from each row of a Matrix
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::sub_row(const Vector<T2, ncols>& v) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::sub_row(const Vector<T2, ncols>& v) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] -= static_cast<T>(v.at(j));
+			(*this)[i][j] -= static_cast<T>(v[j]);
 		}
 	}
 	return *this;
@@ -769,10 +882,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::sub_row(const Vector<T2
 // Multiply each row of a Matrix with a row
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::mul_row(const Vector<T2, ncols>& v) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::mul_row(const Vector<T2, ncols>& v) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] *= static_cast<T>(v.at(j));
+			(*this)[i][j] *= static_cast<T>(v[j]);
 		}
 	}
 	return *this;
@@ -780,10 +893,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::mul_row(const Vector<T2
 // Divide a each row of a Matrix by a row
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::div_row(const Vector<T2, ncols>& v) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::div_row(const Vector<T2, ncols>& v) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] /= static_cast<T>(v.at(j));
+			(*this)[i][j] /= static_cast<T>(v[j]);
 		}
 	}
 	return *this;
@@ -792,10 +905,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::div_row(const Vector<T2
 // Add a column to each column of a Matrix
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::add_col(const Vector<T2, nrows>& v) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::add_col(const Vector<T2, nrows>& v) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] += static_cast<T>(v.at(i));
+			(*this)[i][j] += static_cast<T>(v[i]);
 		}
 	}
 	return *this;
@@ -803,10 +916,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::add_col(const Vector<T2
 // Subtract a column from each column of a Matrix
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::sub_col(const Vector<T2, nrows>& v) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::sub_col(const Vector<T2, nrows>& v) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] -= static_cast<T>(v.at(i));
+			(*this)[i][j] -= static_cast<T>(v[i]);
 		}
 	}
 	return *this;
@@ -814,10 +927,10 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::sub_col(const Vector<T2
 // Multiply each column of a Matrix with a column
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::mul_col(const Vector<T2, nrows>& v) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::mul_col(const Vector<T2, nrows>& v) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] *= static_cast<T>(v.at(i));
+			(*this)[i][j] *= static_cast<T>(v[i]);
 		}
 	}
 	return *this;
@@ -825,169 +938,478 @@ inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::mul_col(const Vector<T2
 // Divide a each column of a Matrix by a column
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
 template<arithmetic T2>
-inline Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::div_col(const Vector<T2, nrows>& v) {
+inline constexpr Matrix<T, nrows, ncols>& Matrix<T, nrows, ncols>::div_col(const Vector<T2, nrows>& v) {
 	for (size_t i = 0; i < nrows; i++) {
 		for (size_t j = 0; j < ncols; j++) {
-			(*this)[i][j] /= static_cast<T>(v.at(i));
+			(*this)[i][j] /= static_cast<T>(v[i]);
 		}
 	}
 	return *this;
 }
 
+namespace detail {
+
+	// Edge of the square tiles the transposes work in: a source and a destination tile of doubles fit in L1
+	inline constexpr size_t transpose_tile = 32;
+
+	// Transposes of at least this many elements are split across threads
+	inline constexpr size_t transpose_parallel_threshold = 512 * 512;
+
+	// dst[j][i] = src[i][j] for an r x c block, where lds and ldd are the row strides of src and dst
+	template<arithmetic T>
+	inline void transpose_tile_kernel(const T* src, size_t lds, T* dst, size_t ldd, size_t r, size_t c) {
+		size_t i = 0;
+		if constexpr (std::is_same_v<T, float> && simd_enabled<float, 4>) {
+			// 4x4 blocks transposed in registers
+			using simd = simd_ops<T, 4>;
+			for (; i + 4 <= r; i += 4) {
+				size_t j = 0;
+				for (; j + 4 <= c; j += 4) {
+					const T* s = src + (i * lds) + j;
+					typename simd::reg r0 = simd::load(s), r1 = simd::load(s + lds), r2 = simd::load(s + (2 * lds)), r3 = simd::load(s + (3 * lds));
+					simd::transpose4(r0, r1, r2, r3);
+					T* d = dst + (j * ldd) + i;
+					simd::store(d, r0);
+					simd::store(d + ldd, r1);
+					simd::store(d + (2 * ldd), r2);
+					simd::store(d + (3 * ldd), r3);
+				}
+				for (; j < c; j++) {
+					for (size_t k = 0; k < 4; k++) {
+						dst[(j * ldd) + i + k] = src[((i + k) * lds) + j];
+					}
+				}
+			}
+		}
+		for (; i < r; i++) {
+			for (size_t j = 0; j < c; j++) {
+				dst[(j * ldd) + i] = src[(i * lds) + j];
+			}
+		}
+	}
+
+	// Cache-oblivious transpose: halve the longer side until the block fits in a tile, so that both the reads and
+	// the writes stay within a few cache lines at every level of the memory hierarchy
+	template<arithmetic T>
+	void transpose_recursive(const T* src, size_t lds, T* dst, size_t ldd, size_t r, size_t c) {
+		if ((r <= transpose_tile) && (c <= transpose_tile)) {
+			transpose_tile_kernel(src, lds, dst, ldd, r, c);
+		}
+		else if (r >= c) {
+			// Split on a multiple of 4 so that the register kernel sees whole blocks
+			const size_t h = ((r / 2) + 3) & ~size_t(3);
+			transpose_recursive(src, lds, dst, ldd, h, c);
+			transpose_recursive(src + (h * lds), lds, dst + h, ldd, r - h, c);
+		}
+		else {
+			const size_t h = ((c / 2) + 3) & ~size_t(3);
+			transpose_recursive(src, lds, dst, ldd, r, h);
+			transpose_recursive(src + h, lds, dst + (h * ldd), ldd, r, c - h);
+		}
+	}
+
+	// dst (c x r) = transpose of src (r x c), both row-major and contiguous
+	template<arithmetic T>
+	void transpose_into(const T* src, T* dst, size_t r, size_t c) {
+		if ((r * c) >= transpose_parallel_threshold) {
+			// Each thread takes a band of source rows, which is a band of destination columns
+			parallel_for(r, transpose_tile, [=](size_t begin, size_t end) {
+				transpose_recursive(src + (begin * c), c, dst + begin, r, end - begin, c);
+			});
+		}
+		else {
+			transpose_recursive(src, c, dst, r, r, c);
+		}
+	}
+
+	// Swap the r x c block at p with the transpose of the c x r block at q, both with row stride ld
+	template<arithmetic T>
+	inline void swap_transpose_tiles(T* p, T* q, size_t ld, size_t r, size_t c) {
+		// The rows handled four at a time below, with the rest left to the scalar loop
+		size_t four_rows = 0;
+		if constexpr (std::is_same_v<T, float> && simd_enabled<float, 4>) {
+			using simd = simd_ops<T, 4>;
+			four_rows = r - (r % 4);
+			for (size_t i = 0; i < four_rows; i += 4) {
+				size_t j = 0;
+				for (; j + 4 <= c; j += 4) {
+					T* a = p + (i * ld) + j;
+					T* b = q + (j * ld) + i;
+					typename simd::reg a0 = simd::load(a), a1 = simd::load(a + ld), a2 = simd::load(a + (2 * ld)), a3 = simd::load(a + (3 * ld));
+					typename simd::reg b0 = simd::load(b), b1 = simd::load(b + ld), b2 = simd::load(b + (2 * ld)), b3 = simd::load(b + (3 * ld));
+					simd::transpose4(a0, a1, a2, a3);
+					simd::transpose4(b0, b1, b2, b3);
+					simd::store(a, b0);
+					simd::store(a + ld, b1);
+					simd::store(a + (2 * ld), b2);
+					simd::store(a + (3 * ld), b3);
+					simd::store(b, a0);
+					simd::store(b + ld, a1);
+					simd::store(b + (2 * ld), a2);
+					simd::store(b + (3 * ld), a3);
+				}
+				for (; j < c; j++) {
+					for (size_t k = 0; k < 4; k++) {
+						std::swap(p[((i + k) * ld) + j], q[(j * ld) + i + k]);
+					}
+				}
+			}
+		}
+		for (size_t i = four_rows; i < r; i++) {
+			for (size_t j = 0; j < c; j++) {
+				std::swap(p[(i * ld) + j], q[(j * ld) + i]);
+			}
+		}
+	}
+
+	// In-place transpose of a contiguous n x n matrix, one band of tile rows at a time: the diagonal tile is
+	// transposed in place, and each tile to its right is swapped with the transpose of its mirror image below
+	template<arithmetic T>
+	void transpose_square_inplace(T* a, size_t n) {
+		constexpr size_t b = transpose_tile;
+		const size_t bands = (n + b - 1) / b;
+		const auto transpose_bands = [=](size_t first, size_t last) {
+			for (size_t band = first; band < last; band++) {
+				const size_t ii = band * b;
+				const size_t bi = std::min(b, n - ii);
+				for (size_t i = ii; i < ii + bi; i++) {
+					for (size_t j = i + 1; j < ii + bi; j++) {
+						std::swap(a[(i * n) + j], a[(j * n) + i]);
+					}
+				}
+				for (size_t jj = ii + b; jj < n; jj += b) {
+					swap_transpose_tiles(a + (ii * n) + jj, a + (jj * n) + ii, n, bi, std::min(b, n - jj));
+				}
+			}
+		};
+		// Bands touch disjoint pairs of tiles, so they can be shared out between threads
+		if ((n * n) >= transpose_parallel_threshold) {
+			parallel_for(bands, 1, transpose_bands);
+		}
+		else {
+			transpose_bands(0, bands);
+		}
+	}
+
+} // !namespace detail
+
 // Transpose matrices
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
-Matrix<T, nrows, ncols> transpose(const Matrix<T, nrows, ncols>& original) {
+constexpr Matrix<T, ncols, nrows> transpose(const Matrix<T, nrows, ncols>& original) {
 	Matrix<T, ncols, nrows> temp;
-	for (size_t i = 0; i < nrows; i++) {
-		for (size_t j = 0; j < ncols; j++) {
-			temp[j][i] = original[i][j];
+	if consteval {
+		for (size_t i = 0; i < nrows; i++) {
+			for (size_t j = 0; j < ncols; j++) {
+				temp[j][i] = original[i][j];
+			}
 		}
 	}
+	else {
+		detail::transpose_into(original.data.data(), temp.data.data(), nrows, ncols);
+	}
 	return temp;
 }
 
+// Transpose a square matrix in place
+sml_export template<arithmetic T, size_t dim>
+constexpr Matrix<T, dim, dim>& transpose_inplace(Matrix<T, dim, dim>& m) {
+	if consteval {
+		for (size_t i = 0; i < dim; i++) {
+			for (size_t j = i + 1; j < dim; j++) {
+				std::swap(m[i][j], m[j][i]);
+			}
+		}
+	}
+	else {
+		detail::transpose_square_inplace(m.data.data(), dim);
+	}
+	return m;
+}
+
 // Dot product 
 sml_export template<arithmetic T, size_t elements>
-double dot(const Matrix<T, 1, elements>& m1, const Matrix<T, elements, 1>& m2) {
+constexpr double dot(const Matrix<T, 1, elements>& m1, const Matrix<T, elements, 1>& m2) {
 	double ret = 0;
 	for (size_t i = 0; i < elements; i++) {
-		ret += (m1.at(0, i) * m2.at(i, 0));
+		ret += (m1[0][i] * m2[i][0]);
 	}
 	return ret;
 }
 sml_export template<arithmetic T, size_t elements>
-double dot(const Matrix<T, elements, 1>& m1, const Matrix<T, 1, elements>& m2) {
+constexpr double dot(const Matrix<T, elements, 1>& m1, const Matrix<T, 1, elements>& m2) {
 	double ret = 0;
 	for (size_t i = 0; i < elements; i++) {
-		ret += (m1.at(i, 0) * m2.at(0, i));
+		ret += (m1[i][0] * m2[0][i]);
 	}
 	return ret;
 }
 sml_export template<arithmetic T, size_t elements>
-double dot(const Matrix<T, elements, 1>& m1, const Matrix<T, elements, 1>& m2) {
+constexpr double dot(const Matrix<T, elements, 1>& m1, const Matrix<T, elements, 1>& m2) {
 	double ret = 0;
 	for (size_t i = 0; i < elements; i++) {
-		ret += (m1.at(i, 0) * m2.at(i, 0));
+		ret += (m1[i][0] * m2[i][0]);
 	}
 	return ret;
 }
 sml_export template<arithmetic T, size_t elements>
-double dot(const Matrix<T, 1, elements>& m1, const Matrix<T, 1, elements>& m2) {
+constexpr double dot(const Matrix<T, 1, elements>& m1, const Matrix<T, 1, elements>& m2) {
 	double ret = 0;
 	for (size_t i = 0; i < elements; i++) {
-		ret += (m1.at(0, i) * m2.at(0, i));
+		ret += (m1[0][i] * m2[0][i]);
 	}
 	return ret;
 }
 
 // Element-wise matrix multiplication (Hadamard product)
 sml_export template<arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
-Matrix<T, nrows, ncols> multiply_elements(Matrix<T, nrows, ncols> m1, const Matrix<T2, nrows, ncols>& m2) {
-	std::transform(m1.begin(), m1.end(), m2.begin(), m1.begin(), [](T i, T2 j) -> T {return i * static_cast<T>(j); });
+constexpr Matrix<T, nrows, ncols> multiply_elements(Matrix<T, nrows, ncols> m1, const Matrix<T2, nrows, ncols>& m2) {
+	for (size_t i = 0; i < nrows * ncols; i++) {
+		m1.data[i] *= static_cast<T>(m2.data[i]);
+	}
 	return m1;
 }
 
 // Calculate the trace of a matrix
 sml_export template<arithmetic T, size_t dim>
-T trace(const Matrix<T, dim, dim>& m) {
+constexpr T trace(const Matrix<T, dim, dim>& m) {
 	T ret = 0;
 	for (size_t i = 0; i < dim; i++) {
-		ret += m.at(i, i);
+		ret += m[i][i];
 	}
 	return ret;
 }
 
-sml_export template<arithmetic T, size_t dim>
-std::tuple<Matrix<float, dim, dim>, Vector<size_t, dim + 1>> LUPDecomposition(const Matrix<T, dim, dim>& m) {
+namespace detail {
+
+	// Width of the panels in the blocked LU factorisation
+	inline constexpr size_t lu_block = 32;
+
+	// Blocked right-looking LU factorisation with partial pivoting, in place, of the n x n row-major matrix a
+	// On return a holds U on and above the diagonal and the multipliers of the unit lower triangular L below it,
+	// and pivots[k] is the row that was exchanged with row k at step k. Returns the number of row exchanges,
+	// and sets singular if a zero pivot was met (the factorisation then carries on past that column)
+	template<std::floating_point T>
+	constexpr size_t lu_factor_inplace(T* a, size_t n, size_t* pivots, bool& singular) {
+		size_t swaps = 0;
+		singular = false;
+		const auto row = [a, n](size_t i) { return a + (i * n); };
+
+		for (size_t kb = 0; kb < n; kb += lu_block) {
+			const size_t ke = std::min(n, kb + lu_block);
+
+			// Factor the panel of columns [kb, ke), updating only within the panel
+			for (size_t k = kb; k < ke; k++) {
+				size_t p = k;
+				T max = std::abs(row(k)[k]);
+				for (size_t i = k + 1; i < n; i++) {
+					const T v = std::abs(row(i)[k]);
+					if (v > max) {
+						max = v;
+						p = i;
+					}
+				}
+				pivots[k] = p;
+				if (p != k) {
+					std::swap_ranges(row(k), row(k) + n, row(p));
+					swaps++;
+				}
+				if (row(k)[k] == T(0)) {
+					singular = true;
+					continue;
+				}
 
-	Matrix<float, dim, dim> A;
-	for (int i = 0; i < m.size(); i++) {
-		A.at(i) = static_cast<float>(m.at(i));
-	}
+				const T inv_pivot = T(1) / row(k)[k];
+				const T* rk = row(k);
+				for (size_t i = k + 1; i < n; i++) {
+					T* ri = row(i);
+					const T l = (ri[k] *= inv_pivot);
+					for (size_t j = k + 1; j < ke; j++) {
+						ri[j] -= l * rk[j];
+					}
+				}
+			}
 
-	size_t numberOfPivots = 0;
-	Vector<size_t, dim + 1> pivot_matrix(0);
+			if (ke == n) {
+				break;
+			}
 
-	int maxI = 0, j = 0, k = 0, i = 0;
-	float maxA, absA;
-	float ptr;
+			// U12 = L11^-1 * A12, for the rows of the panel right of it
+			for (size_t k = kb; k < ke; k++) {
+				const T* rk = row(k);
+				for (size_t i = k + 1; i < ke; i++) {
+					T* ri = row(i);
+					const T l = ri[k];
+					for (size_t j = ke; j < n; j++) {
+						ri[j] -= l * rk[j];
+					}
+				}
+			}
 
-	for (i = 0; i <= dim; i++) {
-		pivot_matrix.at(i) = i;
+			// Trailing update A22 -= L21 * U12, streaming along rows while the panel rows of U12 stay in cache
+			for (size_t i = ke; i < n; i++) {
+				T* ri = row(i);
+				for (size_t k = kb; k < ke; k++) {
+					const T l = ri[k];
+					const T* rk = row(k);
+					for (size_t j = ke; j < n; j++) {
+						ri[j] -= l * rk[j];
+					}
+				}
+			}
+		}
+		return swaps;
 	}
 
-	for (i = 0; i < dim; i++) {
-		maxA = 0.0;
-		maxI = i;
-
-		for (k = i; k < dim; k++) {
-			if ((absA = fabs(A[k][i])) > maxA) {
-				maxA = absA;
-				maxI = k;
+	// Solve A X = B in place, where lu and pivots are the result of lu_factor_inplace for A, and B is n x nrhs
+	// row-major. Whole rows of B are combined at a time, so every right-hand side is solved in the same pass
+	template<std::floating_point T>
+	constexpr void lu_solve_inplace(const T* lu, const size_t* pivots, size_t n, T* b, size_t nrhs) {
+		const auto row = [b, nrhs](size_t i) { return b + (i * nrhs); };
+		for (size_t k = 0; k < n; k++) {
+			if (pivots[k] != k) {
+				std::swap_ranges(row(k), row(k) + nrhs, row(pivots[k]));
 			}
 		}
-
-		if (maxI != i) {
-			// Pivoting P
-			j = static_cast<int>(pivot_matrix.at(i));
-			pivot_matrix.at(i) = pivot_matrix.at(maxI);
-			pivot_matrix.at(maxI) = j;
-
-			// Pivot rows of A
-			for (size_t r = 0; r < dim; r++) {
-				ptr = A[i][r];
-				A[i][r] = A[maxI][r];
-				A[maxI][r] = ptr;
+		// Forward substitution with the unit lower triangle
+		for (size_t i = 1; i < n; i++) {
+			T* bi = row(i);
+			for (size_t k = 0; k < i; k++) {
+				const T l = lu[(i * n) + k];
+				const T* bk = row(k);
+				for (size_t j = 0; j < nrhs; j++) {
+					bi[j] -= l * bk[j];
+				}
 			}
-
-			// We store the number of pivots in the final element of the unit permutation vector
-			pivot_matrix.at(dim)++;
 		}
-
-		for (j = i + 1; j < dim; j++) {
-			A[j][i] /= A[i][i];
-			for (k = i + 1; k < dim; k++) {
-				A[j][k] -= A[j][i] * A[i][k];
+		// Back substitution with the upper triangle
+		for (size_t i = n; i-- > 0;) {
+			T* bi = row(i);
+			for (size_t k = i + 1; k < n; k++) {
+				const T u = lu[(i * n) + k];
+				const T* bk = row(k);
+				for (size_t j = 0; j < nrhs; j++) {
+					bi[j] -= u * bk[j];
+				}
+			}
+			const T inv_pivot = T(1) / lu[(i * n) + i];
+			for (size_t j = 0; j < nrhs; j++) {
+				bi[j] *= inv_pivot;
 			}
 		}
 	}
 
-	return std::make_tuple(A, pivot_matrix);
-}
-
+	// Determinant from the diagonal of U and the number of row exchanges
+	template<std::floating_point T>
+	constexpr T lu_det(const T* lu, size_t n, size_t swaps) {
+		T ret = 1;
+		for (size_t i = 0; i < n; i++) {
+			ret *= lu[(i * n) + i];
+		}
+		return (swaps % 2 == 0) ? ret : -ret;
+	}
+
+	// 4x4 determinant by cofactor expansion along the top row, with the six 2x2 minors of the bottom two rows shared
+	// between the four cofactors
+	template<arithmetic T>
+	constexpr T det4(const T* m) {
+		const T c0 = (m[8] * m[13]) - (m[9] * m[12]);
+		const T c1 = (m[8] * m[14]) - (m[10] * m[12]);
+		const T c2 = (m[8] * m[15]) - (m[11] * m[12]);
+		const T c3 = (m[9] * m[14]) - (m[10] * m[13]);
+		const T c4 = (m[9] * m[15]) - (m[11] * m[13]);
+		const T c5 = (m[10] * m[15]) - (m[11] * m[14]);
+		return (m[0] * ((m[5] * c5) - (m[6] * c4) + (m[7] * c3)))
+			- (m[1] * ((m[4] * c5) - (m[6] * c2) + (m[7] * c1)))
+			+ (m[2] * ((m[4] * c4) - (m[5] * c2) + (m[7] * c0)))
+			- (m[3] * ((m[4] * c3) - (m[5] * c1) + (m[6] * c0)));
+	}
+
+#if defined(SML_SIMD_SSE) || defined(SML_SIMD_NEON)
+	// det4 with a register per row: the six minors of the bottom two rows come from three products of row 2 with
+	// shuffles of row 3, each less its own shuffle, and the signed cofactors of the top row from shuffles of row 1
+	// times shuffles of those. The sums are ordered differently from det4, so the last bit may differ
+	inline double det4_simd(const double* m) {
+		using simd = simd_ops<double, 4>;
+		using reg = simd::reg;
+		const reg r0 = simd::load(m), r1 = simd::load(m + 4), r2 = simd::load(m + 8), r3 = simd::load(m + 12);
+		// (c0, -c0, c5, -c5), (c1, c4, -c1, -c4) and (c2, c3, -c3, -c2), for the minors c0 to c5 of det4
+		const reg p = simd::mul(r2, simd::swap_pairs(r3));
+		const reg q = simd::mul(r2, simd::swap_halves(r3));
+		const reg r = simd::mul(r2, simd::reverse(r3));
+		const reg c05 = simd::sub(p, simd::swap_pairs(p));
+		const reg c14 = simd::sub(q, simd::swap_halves(q));
+		const reg c23 = simd::sub(r, simd::reverse(r));
+		reg cofactors = simd::mul(simd::swap_pairs(r1), simd::swap_halves(c05));
+		cofactors = simd::fma(simd::swap_halves(r1), simd::reverse(c14), cofactors);
+		cofactors = simd::fma(simd::reverse(r1), simd::swap_pairs(c23), cofactors);
+		return simd::hsum(simd::mul(r0, cofactors));
+	}
+#endif
+
+} // !namespace detail
+
+// LU decomposition with partial pivoting, computed in the precision of m (integer matrices in float)
+// L and U are packed into one matrix (L with an implicit unit diagonal), and the pivot vector holds the row
+// permutation followed by dim plus the number of row exchanges. LUFactor keeps the factors for repeated solves
 sml_export template<arithmetic T, size_t dim>
-float det(const Matrix<T, dim, dim>& m) {
-
-	// Returns the determinant of matrix m from its LUP decomposition
-
-	Matrix<T, dim, dim> A;
-	Vector<size_t, dim + 1> P;
-	size_t numberOfPermutations = 0;
-
-	std::tie(A, P) = LUPDecomposition(m);
+constexpr std::tuple<Matrix<detail::decomposition_type<T>, dim, dim>, Vector<size_t, dim + 1>> LUPDecomposition(const Matrix<T, dim, dim>& m) {
+	Matrix<detail::decomposition_type<T>, dim, dim> A(m);
+	std::array<size_t, dim> pivots;
+	bool singular;
+	const size_t swaps = detail::lu_factor_inplace(A.data.data(), dim, pivots.data(), singular);
 
-	float det = static_cast<float>(A[0][0]);
-	for (int i = 1; i < dim; i++) {
-		det *= static_cast<float>(A[i][i]);
+	Vector<size_t, dim + 1> pivot_matrix(0);
+	for (size_t i = 0; i < dim; i++) {
+		pivot_matrix[i] = i;
 	}
+	for (size_t i = 0; i < dim; i++) {
+		std::swap(pivot_matrix[i], pivot_matrix[pivots[i]]);
+	}
+	// We store the number of pivots in the final element of the unit permutation vector, which starts out as dim
+	pivot_matrix[dim] = dim + swaps;
+
+	return std::make_tuple(A, pivot_matrix);
+}
 
-	return (P.at(dim) - dim) % 2 == 0 ? det : -det;
+// Returns the determinant of matrix m from its LU decomposition, computed in double whatever the type of m
+sml_export template<arithmetic T, size_t dim>
+constexpr double det(const Matrix<T, dim, dim>& m) {
+	Matrix<double, dim, dim> A(m);
+	std::array<size_t, dim> pivots;
+	bool singular;
+	const size_t swaps = detail::lu_factor_inplace(A.data.data(), dim, pivots.data(), singular);
+	return detail::lu_det(A.data.data(), dim, swaps);
 }
 
 sml_export template<arithmetic T>
-double det(const Matrix<T, 2, 2>& m) {
+constexpr double det(const Matrix<T, 2, 2>& m) {
 	return static_cast<double>((m[0][0] * m[1][1]) - (m[0][1] * m[1][0]));
 }
 
 sml_export template<arithmetic T>
-double det(const Matrix<T, 3, 3>& m) {
+constexpr double det(const Matrix<T, 3, 3>& m) {
 	return static_cast<double>(m[0][0] * ((m[1][1] * m[2][2]) - (m[1][2] * m[2][1]))
 		- m[0][1] * ((m[1][0] * m[2][2]) - (m[1][2] * m[2][0]))
 		+ m[0][2] * ((m[1][0] * m[2][1]) - (m[1][1] * m[2][0])));
 }
 
+// The closed form in double, without the copies and pivoting of the LU path. Every product of two float or moderate
+// integer elements is exact in double, so integer matrices give their exact determinant. With SSE or NEON the rows
+// are held in registers of four doubles at run time; constant evaluation uses the scalar expansion, whose sums are
+// ordered differently, so the two may differ in the last bit
+sml_export template<arithmetic T>
+constexpr double det(const Matrix<T, 4, 4>& m) {
+	const Matrix<double, 4, 4> d(m);
+#if defined(SML_SIMD_SSE) || defined(SML_SIMD_NEON)
+	if !consteval {
+		return detail::det4_simd(d.data.data());
+	}
+#endif
+	return detail::det4(d.data.data());
+}
+
 sml_export template<arithmetic T, size_t dim>
-Matrix<T, dim, dim> identity() {
+constexpr Matrix<T, dim, dim> identity() {
 	Matrix<T, dim, dim> ret(0);
 	for (size_t i = 0; i < dim; i++) {
 		ret[i][i] = 1;
@@ -996,67 +1418,228 @@ Matrix<T, dim, dim> identity() {
 }
 
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
-Matrix<T, nrows, ncols> exchange_columns(Matrix<T, nrows, ncols>& m, const size_t& colA, const size_t& colB) {
+constexpr Matrix<T, nrows, ncols> exchange_columns(Matrix<T, nrows, ncols>& m, const size_t& colA, const size_t& colB) {
 	for (size_t i = 0; i < nrows; i++) {
-		std::swap(m.at(i, colA), m.at(i, colB));
+		std::swap(m[i][colA], m[i][colB]);
 	}
 	return m;
 }
 
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
-Matrix<T, nrows, ncols> exchange_rows(Matrix<T, nrows, ncols>& m, const size_t& colA, const size_t& colB) {
+constexpr Matrix<T, nrows, ncols> exchange_rows(Matrix<T, nrows, ncols>& m, const size_t& colA, const size_t& colB) {
 	for (size_t i = 0; i < ncols; i++) {
-		std::swap(m.at(colA, i), m.at(colB, i));
+		std::swap(m[colA][i], m[colB][i]);
 	}
 	return m;
 }
 
-sml_export template<arithmetic T, size_t dim>
-Matrix<T, dim, dim> inverse(const Matrix<T, dim, dim>& m) {
+namespace detail {
 
-	Matrix<T, dim, dim> I = identity<T, dim>();
-	Matrix<T, dim, dim> M = m;
+	// Four lanes held in an array, standing in for simd_ops<T, 4> on targets without a SIMD backend for T
+	template<class T>
+	struct scalar_ops4 {
+		using reg = std::array<T, 4>;
+		static constexpr reg load(const T* p) { return { p[0], p[1], p[2], p[3] }; }
+		static constexpr void store(T* p, const reg& v) { std::copy(v.begin(), v.end(), p); }
+		static constexpr reg broadcast(T t) { return { t, t, t, t }; }
+		static constexpr reg add(const reg& a, const reg& b) { return { a[0] + b[0], a[1] + b[1], a[2] + b[2], a[3] + b[3] }; }
+		static constexpr reg sub(const reg& a, const reg& b) { return { a[0] - b[0], a[1] - b[1], a[2] - b[2], a[3] - b[3] }; }
+		static constexpr reg mul(const reg& a, const reg& b) { return { a[0] * b[0], a[1] * b[1], a[2] * b[2], a[3] * b[3] }; }
+	};
 
-	for (size_t i = 0; i < dim; i++) {
-		if (M.at(i, i) == 0 ) {
-			// Swap with a row below it
-			for (size_t j = i; j < dim; j++) {
-				if (M.at(j, j) != 0) {
-					exchange_columns(M, i, j);
-					exchange_columns(I, i, j);
-				}
+	template<class T>
+	using inverse_ops4 = std::conditional_t<simd_enabled<T, 4>, simd_ops<T, 4>, scalar_ops4<T>>;
+
+	// Whether the bottom row of m is (0, 0, 0, 1), so that it is an affine transform
+	template<arithmetic T>
+	inline constexpr bool is_affine(const Matrix<T, 4, 4>& m) {
+		return (m[3][0] == T(0)) && (m[3][1] == T(0)) && (m[3][2] == T(0)) && (m[3][3] == T(1));
+	}
+
+	// Closed-form inverses by the adjugate, written to out. Each returns false, leaving out untouched, if m is singular
+	template<std::floating_point T>
+	inline constexpr bool inverse2(const T* m, T* out) {
+		const T d = (m[0] * m[3]) - (m[1] * m[2]);
+		if (d == T(0)) {
+			return false;
+		}
+		const T inv_d = T(1) / d;
+		const T a = m[0];
+		out[0] = m[3] * inv_d;
+		out[1] = -m[1] * inv_d;
+		out[2] = -m[2] * inv_d;
+		out[3] = a * inv_d;
+		return true;
+	}
+
+	// m and out are 3x3 blocks whose rows are stride elements apart
+	template<std::floating_point T>
+	inline constexpr bool inverse3(const T* m, size_t stride, T* out, size_t out_stride) {
+		const T* r0 = m;
+		const T* r1 = m + stride;
+		const T* r2 = m + (2 * stride);
+		const T c00 = (r1[1] * r2[2]) - (r1[2] * r2[1]);
+		const T c01 = (r1[2] * r2[0]) - (r1[0] * r2[2]);
+		const T c02 = (r1[0] * r2[1]) - (r1[1] * r2[0]);
+		const T d = (r0[0] * c00) + (r0[1] * c01) + (r0[2] * c02);
+		if (d == T(0)) {
+			return false;
+		}
+		const T inv_d = T(1) / d;
+		const std::array<T, 9> adj = {
+			c00, (r0[2] * r2[1]) - (r0[1] * r2[2]), (r0[1] * r1[2]) - (r0[2] * r1[1]),
+			c01, (r0[0] * r2[2]) - (r0[2] * r2[0]), (r0[2] * r1[0]) - (r0[0] * r1[2]),
+			c02, (r0[1] * r2[0]) - (r0[0] * r2[1]), (r0[0] * r1[1]) - (r0[1] * r1[0])
+		};
+		for (size_t i = 0; i < 3; i++) {
+			for (size_t j = 0; j < 3; j++) {
+				out[(i * out_stride) + j] = adj[(i * 3) + j] * inv_d;
+			}
+		}
+		return true;
+	}
+
+	// 4x4 inverse by cofactors, four lanes at a time: the 2x2 minors of the bottom two rows are formed as vectors,
+	// and each row of the adjugate is then three multiplies by (gathered) elements of the top two rows
+	// Constant evaluation uses the scalar lanes, as the SIMD intrinsics cannot be evaluated at compile time
+	template<std::floating_point T, class ops = inverse_ops4<T>>
+	inline constexpr bool inverse4(const T* m, T* out) {
+		using reg = typename ops::reg;
+		const auto gather = [](T a, T b, T c, T d) { return ops::load(std::array<T, 4>{ a, b, c, d }.data()); };
+		const auto at = [m](size_t i, size_t j) { return m[(i * 4) + j]; };
+		// a * b - c * d
+		const auto minor = [](reg a, reg b, reg c, reg d) { return ops::sub(ops::mul(a, b), ops::mul(c, d)); };
+
+		const reg f0 = minor(gather(at(2, 2), at(2, 2), at(1, 2), at(1, 2)), gather(at(3, 3), at(3, 3), at(3, 3), at(2, 3)),
+			gather(at(3, 2), at(3, 2), at(3, 2), at(2, 2)), gather(at(2, 3), at(2, 3), at(1, 3), at(1, 3)));
+		const reg f1 = minor(gather(at(2, 1), at(2, 1), at(1, 1), at(1, 1)), gather(at(3, 3), at(3, 3), at(3, 3), at(2, 3)),
+			gather(at(3, 1), at(3, 1), at(3, 1), at(2, 1)), gather(at(2, 3), at(2, 3), at(1, 3), at(1, 3)));
+		const reg f2 = minor(gather(at(2, 1), at(2, 1), at(1, 1), at(1, 1)), gather(at(3, 2), at(3, 2), at(3, 2), at(2, 2)),
+			gather(at(3, 1), at(3, 1), at(3, 1), at(2, 1)), gather(at(2, 2), at(2, 2), at(1, 2), at(1, 2)));
+		const reg f3 = minor(gather(at(2, 0), at(2, 0), at(1, 0), at(1, 0)), gather(at(3, 3), at(3, 3), at(3, 3), at(2, 3)),
+			gather(at(3, 0), at(3, 0), at(3, 0), at(2, 0)), gather(at(2, 3), at(2, 3), at(1, 3), at(1, 3)));
+		const reg f4 = minor(gather(at(2, 0), at(2, 0), at(1, 0), at(1, 0)), gather(at(3, 2), at(3, 2), at(3, 2), at(2, 2)),
+			gather(at(3, 0), at(3, 0), at(3, 0), at(2, 0)), gather(at(2, 2), at(2, 2), at(1, 2), at(1, 2)));
+		const reg f5 = minor(gather(at(2, 0), at(2, 0), at(1, 0), at(1, 0)), gather(at(3, 1), at(3, 1), at(3, 1), at(2, 1)),
+			gather(at(3, 0), at(3, 0), at(3, 0), at(2, 0)), gather(at(2, 1), at(2, 1), at(1, 1), at(1, 1)));
+
+		const reg v0 = gather(at(1, 0), at(0, 0), at(0, 0), at(0, 0));
+		const reg v1 = gather(at(1, 1), at(0, 1), at(0, 1), at(0, 1));
+		const reg v2 = gather(at(1, 2), at(0, 2), at(0, 2), at(0, 2));
+		const reg v3 = gather(at(1, 3), at(0, 3), at(0, 3), at(0, 3));
+
+		// Alternating cofactor signs
+		const reg sign_a = gather(1, -1, 1, -1);
+		const reg sign_b = gather(-1, 1, -1, 1);
+		const reg inv0 = ops::mul(sign_a, ops::add(ops::sub(ops::mul(v1, f0), ops::mul(v2, f1)), ops::mul(v3, f2)));
+		const reg inv1 = ops::mul(sign_b, ops::add(ops::sub(ops::mul(v0, f0), ops::mul(v2, f3)), ops::mul(v3, f4)));
+		const reg inv2 = ops::mul(sign_a, ops::add(ops::sub(ops::mul(v0, f1), ops::mul(v1, f3)), ops::mul(v3, f5)));
+		const reg inv3 = ops::mul(sign_b, ops::add(ops::sub(ops::mul(v0, f2), ops::mul(v1, f4)), ops::mul(v2, f5)));
+
+		// The adjugate is built transposed, so each inv register is a column of it
+		std::array<T, 16> adj = {};
+		ops::store(adj.data(), inv0);
+		ops::store(adj.data() + 4, inv1);
+		ops::store(adj.data() + 8, inv2);
+		ops::store(adj.data() + 12, inv3);
+		const T d = (at(0, 0) * adj[0]) + (at(0, 1) * adj[4]) + (at(0, 2) * adj[8]) + (at(0, 3) * adj[12]);
+		if (d == T(0)) {
+			return false;
+		}
+		const reg inv_d = ops::broadcast(T(1) / d);
+		for (size_t i = 0; i < 16; i += 4) {
+			ops::store(out + i, ops::mul(ops::load(adj.data() + i), inv_d));
+		}
+		return true;
+	}
+
+	// Affine inverse: the 3x3 block is inverted, and the translation is taken back through it
+	template<std::floating_point T>
+	inline constexpr bool inverse_affine(const T* m, T* out) {
+		if (!inverse3(m, 4, out, 4)) {
+			return false;
+		}
+		for (size_t i = 0; i < 3; i++) {
+			const T* r = out + (i * 4);
+			out[(i * 4) + 3] = -((r[0] * m[3]) + (r[1] * m[7]) + (r[2] * m[11]));
+		}
+		out[12] = out[13] = out[14] = T(0);
+		out[15] = T(1);
+		return true;
+	}
+
+	// Inverse of a dim x dim matrix in the precision U, closed-form up to 4x4 and by pivoted LU beyond that
+	template<std::floating_point U, size_t dim>
+	inline constexpr bool inverse_into(const Matrix<U, dim, dim>& m, Matrix<U, dim, dim>& out) {
+		const U* a = m.data.data();
+		U* b = out.data.data();
+		if constexpr (dim == 1) {
+			if (a[0] == U(0)) {
+				return false;
+			}
+			b[0] = U(1) / a[0];
+			return true;
+		}
+		else if constexpr (dim == 2) {
+			return inverse2(a, b);
+		}
+		else if constexpr (dim == 3) {
+			return inverse3(a, 3, b, 3);
+		}
+		else if constexpr (dim == 4) {
+			if (is_affine(m)) {
+				return inverse_affine(a, b);
+			}
+			if consteval {
+				return inverse4<U, scalar_ops4<U>>(a, b);
 			}
-			if (M.at(i, i) == 0)
-				return Matrix<T, dim, dim>(0);
-		}
-
-		// Divide row by value
-		T temp = 1.0/M.at(i, i);
-		for (size_t j = 0; j < dim; j++) {
-			M.at(i, j) *= temp;
-			I.at(i, j) *= temp;
-		}
-
-		// Annihilate entries above and below the pivot
-		for (size_t j = 0; j < dim; j++) {
-			if (j == i)
-				continue;
-			// Subtract the current row multiplied by the element being annihilated
-			T factor = M.at(j, i) / M.at(i,i);
-			for (size_t k = 0; k < dim; k++) {
-				M.at(j, k) -= (factor * M.at(i, k));
-				I.at(j, k) -= (factor * I.at(i, k));
+			else {
+				return inverse4(a, b);
+			}
+		}
+		else {
+			Matrix<U, dim, dim> lu = m;
+			std::array<size_t, dim> pivots;
+			bool singular;
+			lu_factor_inplace(lu.data.data(), dim, pivots.data(), singular);
+			if (singular) {
+				return false;
 			}
+			out = identity<U, dim>();
+			lu_solve_inplace(lu.data.data(), pivots.data(), dim, b, dim);
+			return true;
 		}
 	}
 
-	return I;
+} // !namespace detail
+
+// Inverse of a square matrix, computed in the precision of m (integer matrices in float, then converted back)
+// Matrices up to 4x4 use closed forms, with 4x4 affine transforms inverting only their 3x3 block and translation,
+// and larger matrices are solved through a pivoted LU factorisation. A singular matrix gives a matrix of zeroes
+sml_export template<arithmetic T, size_t dim>
+constexpr Matrix<T, dim, dim> inverse(const Matrix<T, dim, dim>& m) {
+	using U = detail::decomposition_type<T>;
+	if constexpr (std::same_as<T, U>) {
+		Matrix<T, dim, dim> ret;
+		return detail::inverse_into(m, ret) ? ret : Matrix<T, dim, dim>(0);
+	}
+	else {
+		Matrix<U, dim, dim> ret;
+		return detail::inverse_into(Matrix<U, dim, dim>(m), ret) ? Matrix<T, dim, dim>(ret) : Matrix<T, dim, dim>(0);
+	}
+}
+
+// Inverse of a 4x4 transform known to be affine, ignoring its bottom row
+sml_export template<std::floating_point T>
+constexpr Matrix<T, 4, 4> inverse_affine(const Matrix<T, 4, 4>& m) {
+	Matrix<T, 4, 4> ret;
+	return detail::inverse_affine(m.data.data(), ret.data.data()) ? ret : Matrix<T, 4, 4>(0);
 }
 
 //Take the absolute value of each component
 using std::abs;
 sml_export template<arithmetic T, size_t nrows, size_t ncols >
-Matrix<T, nrows, ncols> abs(Matrix<T, nrows, ncols>& m) {
+constexpr Matrix<T, nrows, ncols> abs(Matrix<T, nrows, ncols>& m) {
 	Matrix<T, nrows, ncols> ret = m;
 	for (T& i : ret) {
 		i = std::abs(i);
@@ -1065,59 +1648,313 @@ Matrix<T, nrows, ncols> abs(Matrix<T, nrows, ncols>& m) {
 }
 
 sml_export template<arithmetic T, size_t rows, size_t cols, arithmetic T2, arithmetic T3>
-Matrix<T, rows, cols> lerp(const Matrix<T, rows, cols>& m1, const Matrix<T2, rows, cols>& m2, const T3 t) {
-	return (m1 + ((m2 - m1) * static_cast<T>(t)));
+constexpr Matrix<T, rows, cols> lerp(const Matrix<T, rows, cols>& m1, const Matrix<T2, rows, cols>& m2, const T3 t) {
+	// Evaluated in a single pass rather than through the arithmetic operators, which would create three temporaries
+	Matrix<T, rows, cols> ret;
+	const T weight = static_cast<T>(t);
+	for (size_t i = 0; i < rows * cols; i++) {
+		ret.data[i] = m1.data[i] + ((static_cast<T>(m2.data[i]) - m1.data[i]) * weight);
+	}
+	return ret;
 }
 
 // Return the index of the largest element
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
-size_t max_element(const Matrix<T, nrows, ncols>& m) {
+constexpr size_t max_element(const Matrix<T, nrows, ncols>& m) {
 	return std::distance(m.begin(), std::max_element(m.begin(), m.end()));
 }
 
 // Return the index of the smallest element
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
-size_t min_element(const Matrix<T, nrows, ncols>& m) {
+constexpr size_t min_element(const Matrix<T, nrows, ncols>& m) {
 	return std::distance(m.begin(), std::min_element(m.begin(), m.end()));
 }
 
 // Return the largest element
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
-T max(const Matrix<T, nrows, ncols>& m) {
+constexpr T max(const Matrix<T, nrows, ncols>& m) {
 	return *std::max_element(m.begin(), m.end());
 }
 
 // Return the smallest element
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
-T min(const Matrix<T, nrows, ncols>& m) {
+constexpr T min(const Matrix<T, nrows, ncols>& m) {
 	return *std::min_element(m.begin(), m.end());
 }
 
 // Clamp
 sml_export template<arithmetic T, size_t nrows, size_t ncols>
-Matrix<T, nrows, ncols> clamp(const Matrix<T, nrows, ncols>& m, const T& t1, const T& t2) {
-	Matrix<T, nrows, ncols> ret = m; std::transform(ret.begin(), ret.end(), ret.begin(), [t1, t2](T i) -> T {return std::clamp(i, t1, t2); });
+constexpr Matrix<T, nrows, ncols> clamp(const Matrix<T, nrows, ncols>& m, const T& t1, const T& t2) {
+	Matrix<T, nrows, ncols> ret;
+	for (size_t i = 0; i < nrows * ncols; i++) {
+		ret.data[i] = std::clamp(m.data[i], t1, t2);
+	}
 	return ret;
 }
 
+namespace detail {
+
+	// Fewest elements worth handing to a thread of their own in the parallel element-wise operations: waking a thread
+	// costs about as much as streaming this many bytes through an operation
+	inline constexpr size_t parallel_element_bytes = size_t(1) << 16;
+
+	template<class T>
+	inline constexpr size_t parallel_element_grain = parallel_element_bytes / sizeof(T);
+
+	// Call f(i) for every element index i in [0, n), with each thread taking whole cache lines
+	template<class T, execution_policy Policy, class F>
+	inline void for_each_element(Policy&& policy, size_t n, F f) {
+		for_each_range(policy, n, parallel_element_grain<T>, [&](size_t begin, size_t end) {
+			SML_IVDEP
+			for (size_t i = begin; i < end; i++) {
+				f(i);
+			}
+		}, std::max<size_t>(1, 64 / sizeof(T)));
+	}
+
+	// Call f(i) for every row index i in [0, nrows), with each thread taking a band of whole rows
+	template<class T, execution_policy Policy, class F>
+	inline void for_each_row(Policy&& policy, size_t nrows, size_t ncols, F f) {
+		for_each_range(policy, nrows, std::max<size_t>(1, parallel_element_grain<T> / std::max<size_t>(1, ncols)), [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				f(i);
+			}
+		});
+	}
+
+	// Index of the first element of [data, data + n) that no other is better than
+	template<execution_policy Policy, class T, class Better>
+	inline size_t extreme_element(Policy&& policy, const T* data, size_t n, Better better) {
+		return reduce_ranges<size_t>(policy, n, parallel_element_grain<T>,
+			[=](size_t begin, size_t end) {
+				size_t best = begin;
+				for (size_t i = begin + 1; i < end; i++) {
+					if (better(data[i], data[best])) {
+						best = i;
+					}
+				}
+				return best;
+			},
+			[=](size_t a, size_t b) { return better(data[b], data[a]) ? b : a; });
+	}
+
+	// Sum of the diagonal of a dim x dim matrix; each diagonal element is on a cache line of its own
+	template<execution_policy Policy, class T>
+	inline T parallel_trace(Policy&& policy, const T* data, size_t dim) {
+		return reduce_ranges<T>(policy, dim, parallel_element_grain<T> / 16,
+			[=](size_t begin, size_t end) {
+				T sum = 0;
+				for (size_t i = begin; i < end; i++) {
+					sum += data[(i * dim) + i];
+				}
+				return sum;
+			},
+			[](T a, T b) { return a + b; });
+	}
+
+	template<class R, size_t n>
+	inline constexpr bool is_row_operand = false;
+	template<arithmetic T, size_t n>
+	inline constexpr bool is_row_operand<Matrix<T, 1, n>, n> = true;
+	template<arithmetic T, size_t n>
+	inline constexpr bool is_row_operand<Vector<T, n>, n> = true;
+
+	template<class R, size_t n>
+	inline constexpr bool is_col_operand = false;
+	template<arithmetic T, size_t n>
+	inline constexpr bool is_col_operand<Matrix<T, n, 1>, n> = true;
+	template<arithmetic T, size_t n>
+	inline constexpr bool is_col_operand<Vector<T, n>, n> = true;
+
+	// m[i][j] = op(m[i][j], r[j]) for every row i
+	template<execution_policy Policy, class T, class T2, class Op>
+	inline void broadcast_row(Policy&& policy, T* m, size_t nrows, size_t ncols, const T2* r, Op op) {
+		for_each_row<T>(policy, nrows, ncols, [=](size_t i) {
+			T* row = m + (i * ncols);
+			SML_IVDEP
+			for (size_t j = 0; j < ncols; j++) {
+				row[j] = op(row[j], static_cast<T>(r[j]));
+			}
+		});
+	}
+
+	// m[i][j] = op(m[i][j], c[i]) for every row i
+	template<execution_policy Policy, class T, class T2, class Op>
+	inline void broadcast_col(Policy&& policy, T* m, size_t nrows, size_t ncols, const T2* c, Op op) {
+		for_each_row<T>(policy, nrows, ncols, [=](size_t i) {
+			T* row = m + (i * ncols);
+			const T x = static_cast<T>(c[i]);
+			SML_IVDEP
+			for (size_t j = 0; j < ncols; j++) {
+				row[j] = op(row[j], x);
+			}
+		});
+	}
+
+} // !namespace detail
+
+// Element-wise operations with an execution policy, for large matrices: with par or par_unseq the elements are
+// shared out between threads, and below a few tens of kilobytes the operation runs on the calling thread
+
+// m1 += m2, m1 -= m2 and m1 %= m2, element by element
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
+Matrix<T, nrows, ncols>& add_assign(Policy&& policy, Matrix<T, nrows, ncols>& m1, const Matrix<T2, nrows, ncols>& m2) {
+	detail::for_each_element<T>(policy, nrows * ncols, [&](size_t i) { m1.data[i] += static_cast<T>(m2.data[i]); });
+	return m1;
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
+Matrix<T, nrows, ncols>& sub_assign(Policy&& policy, Matrix<T, nrows, ncols>& m1, const Matrix<T2, nrows, ncols>& m2) {
+	detail::for_each_element<T>(policy, nrows * ncols, [&](size_t i) { m1.data[i] -= static_cast<T>(m2.data[i]); });
+	return m1;
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
+Matrix<T, nrows, ncols>& mod_assign(Policy&& policy, Matrix<T, nrows, ncols>& m1, const Matrix<T2, nrows, ncols>& m2) {
+	detail::for_each_element<T>(policy, nrows * ncols, [&](size_t i) { m1.data[i] %= static_cast<T>(m2.data[i]); });
+	return m1;
+}
+
+// m += t, m -= t, m *= t, m /= t and m %= t for a scalar t
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
+Matrix<T, nrows, ncols>& add_assign(Policy&& policy, Matrix<T, nrows, ncols>& m, const T2& t) {
+	const T s = static_cast<T>(t);
+	detail::for_each_element<T>(policy, nrows * ncols, [&](size_t i) { m.data[i] += s; });
+	return m;
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
+Matrix<T, nrows, ncols>& sub_assign(Policy&& policy, Matrix<T, nrows, ncols>& m, const T2& t) {
+	const T s = static_cast<T>(t);
+	detail::for_each_element<T>(policy, nrows * ncols, [&](size_t i) { m.data[i] -= s; });
+	return m;
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
+Matrix<T, nrows, ncols>& mul_assign(Policy&& policy, Matrix<T, nrows, ncols>& m, const T2& t) {
+	const T s = static_cast<T>(t);
+	detail::for_each_element<T>(policy, nrows * ncols, [&](size_t i) { m.data[i] *= s; });
+	return m;
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
+Matrix<T, nrows, ncols>& div_assign(Policy&& policy, Matrix<T, nrows, ncols>& m, const T2& t) {
+	const T s = static_cast<T>(t);
+	detail::for_each_element<T>(policy, nrows * ncols, [&](size_t i) { m.data[i] /= s; });
+	return m;
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
+Matrix<T, nrows, ncols>& mod_assign(Policy&& policy, Matrix<T, nrows, ncols>& m, const T2& t) {
+	const T s = static_cast<T>(t);
+	detail::for_each_element<T>(policy, nrows * ncols, [&](size_t i) { m.data[i] %= s; });
+	return m;
+}
+
+// m.add_row(r) and the other row broadcasts, for r a row Matrix or a Vector
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, class R> requires detail::is_row_operand<R, ncols>
+Matrix<T, nrows, ncols>& add_row(Policy&& policy, Matrix<T, nrows, ncols>& m, const R& r) {
+	detail::broadcast_row(policy, m.data.data(), nrows, ncols, &*r.begin(), [](T a, T b) { return a + b; });
+	return m;
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, class R> requires detail::is_row_operand<R, ncols>
+Matrix<T, nrows, ncols>& sub_row(Policy&& policy, Matrix<T, nrows, ncols>& m, const R& r) {
+	detail::broadcast_row(policy, m.data.data(), nrows, ncols, &*r.begin(), [](T a, T b) { return a - b; });
+	return m;
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, class R> requires detail::is_row_operand<R, ncols>
+Matrix<T, nrows, ncols>& mul_row(Policy&& policy, Matrix<T, nrows, ncols>& m, const R& r) {
+	detail::broadcast_row(policy, m.data.data(), nrows, ncols, &*r.begin(), [](T a, T b) { return a * b; });
+	return m;
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, class R> requires detail::is_row_operand<R, ncols>
+Matrix<T, nrows, ncols>& div_row(Policy&& policy, Matrix<T, nrows, ncols>& m, const R& r) {
+	detail::broadcast_row(policy, m.data.data(), nrows, ncols, &*r.begin(), [](T a, T b) { return a / b; });
+	return m;
+}
+
+// m.add_col(c) and the other column broadcasts, for c a column Matrix or a Vector
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, class C> requires detail::is_col_operand<C, nrows>
+Matrix<T, nrows, ncols>& add_col(Policy&& policy, Matrix<T, nrows, ncols>& m, const C& c) {
+	detail::broadcast_col(policy, m.data.data(), nrows, ncols, &*c.begin(), [](T a, T b) { return a + b; });
+	return m;
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, class C> requires detail::is_col_operand<C, nrows>
+Matrix<T, nrows, ncols>& sub_col(Policy&& policy, Matrix<T, nrows, ncols>& m, const C& c) {
+	detail::broadcast_col(policy, m.data.data(), nrows, ncols, &*c.begin(), [](T a, T b) { return a - b; });
+	return m;
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, class C> requires detail::is_col_operand<C, nrows>
+Matrix<T, nrows, ncols>& mul_col(Policy&& policy, Matrix<T, nrows, ncols>& m, const C& c) {
+	detail::broadcast_col(policy, m.data.data(), nrows, ncols, &*c.begin(), [](T a, T b) { return a * b; });
+	return m;
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, class C> requires detail::is_col_operand<C, nrows>
+Matrix<T, nrows, ncols>& div_col(Policy&& policy, Matrix<T, nrows, ncols>& m, const C& c) {
+	detail::broadcast_col(policy, m.data.data(), nrows, ncols, &*c.begin(), [](T a, T b) { return a / b; });
+	return m;
+}
+
+// Element-wise matrix multiplication (Hadamard product)
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols, arithmetic T2>
+Matrix<T, nrows, ncols> multiply_elements(Policy&& policy, Matrix<T, nrows, ncols> m1, const Matrix<T2, nrows, ncols>& m2) {
+	detail::for_each_element<T>(policy, nrows * ncols, [&](size_t i) { m1.data[i] *= static_cast<T>(m2.data[i]); });
+	return m1;
+}
+
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols>
+Matrix<T, nrows, ncols> clamp(Policy&& policy, Matrix<T, nrows, ncols> m, const T& t1, const T& t2) {
+	detail::for_each_element<T>(policy, nrows * ncols, [&](size_t i) { m.data[i] = std::clamp(m.data[i], t1, t2); });
+	return m;
+}
+
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols>
+Matrix<T, nrows, ncols> abs(Policy&& policy, Matrix<T, nrows, ncols> m) {
+	detail::for_each_element<T>(policy, nrows * ncols, [&](size_t i) { m.data[i] = std::abs(m.data[i]); });
+	return m;
+}
+
+// Index of the largest and smallest elements, the first if there are several, and their values
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols>
+size_t max_element(Policy&& policy, const Matrix<T, nrows, ncols>& m) {
+	return detail::extreme_element(policy, m.data.data(), nrows * ncols, [](T a, T b) { return a > b; });
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols>
+size_t min_element(Policy&& policy, const Matrix<T, nrows, ncols>& m) {
+	return detail::extreme_element(policy, m.data.data(), nrows * ncols, [](T a, T b) { return a < b; });
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols>
+T max(Policy&& policy, const Matrix<T, nrows, ncols>& m) {
+	return m.data[max_element(policy, m)];
+}
+sml_export template<execution_policy Policy, arithmetic T, size_t nrows, size_t ncols>
+T min(Policy&& policy, const Matrix<T, nrows, ncols>& m) {
+	return m.data[min_element(policy, m)];
+}
+
+sml_export template<execution_policy Policy, arithmetic T, size_t dim>
+T trace(Policy&& policy, const Matrix<T, dim, dim>& m) {
+	return detail::parallel_trace(policy, m.data.data(), dim);
+}
+
 // Create a rotation matrix for a rotation about the X-axis
-sml_export inline Matrix<float, 4, 4> RotateX(const float radians) {
+sml_export constexpr Matrix<float, 4, 4> RotateX(const float radians) {
+	const float c = detail::constexpr_cos(radians);
+	const float s = detail::constexpr_sin(radians);
 	return Matrix<float, 4, 4>( 1.0f, 0.0f, 0.0f, 0.0f,
-		0.0f, cos(radians), -sin(radians), 0.0f,
-		0.0f, sin(radians), cos(radians), 0.0f,
+		0.0f, c, -s, 0.0f,
+		0.0f, s, c, 0.0f,
 		0.0f, 0.0f, 0.0f, 1.0f );
 }
 // Create a rotation matrix for a rotation about the Y-axis
-sml_export inline Matrix<float, 4, 4> RotateY(const float radians) {
-	return Matrix<float, 4, 4>(   cos(radians), 0.0f, sin(radians), 0.0f,
+sml_export constexpr Matrix<float, 4, 4> RotateY(const float radians) {
+	const float c = detail::constexpr_cos(radians);
+	const float s = detail::constexpr_sin(radians);
+	return Matrix<float, 4, 4>(   c, 0.0f, s, 0.0f,
 		0.0f, 1.0f, 0.0f, 0.0f,
-		-sin(radians), 0.0f, cos(radians), 0.0f,
+		-s, 0.0f, c, 0.0f,
 		0.0f, 0.0f, 0.0f, 1.0f );
 }
 // Create a rotation matrix for a rotation about the Z-axis
-sml_export inline Matrix<float, 4, 4> RotateZ(const float radians) {
-	return Matrix<float, 4, 4>(   cos(radians), -sin(radians), 0.0f, 0.0f,
-		sin(radians), cos(radians), 0.0f, 0.0f,
+sml_export constexpr Matrix<float, 4, 4> RotateZ(const float radians) {
+	const float c = detail::constexpr_cos(radians);
+	const float s = detail::constexpr_sin(radians);
+	return Matrix<float, 4, 4>(   c, -s, 0.0f, 0.0f,
+		s, c, 0.0f, 0.0f,
 		0.0f, 0.0f, 1.0f, 0.0f,
 		0.0f, 0.0f, 0.0f, 1.0f );
 }
@@ -1125,47 +1962,47 @@ sml_export inline Matrix<float, 4, 4> RotateZ(const float radians) {
 // Return the square matrix to the top left that is 1 smaller in each dimension eg a 3x3 from a 4x4
 sml_export template<arithmetic T, size_t dim>
 	requires (dim >= 2)
-sml::Matrix<T, dim - 1, dim - 1> top_left(const sml::Matrix<T, dim, dim>& m) {
+constexpr sml::Matrix<T, dim - 1, dim - 1> top_left(const sml::Matrix<T, dim, dim>& m) {
 	sml::Matrix<T, dim - 1, dim - 1> ret(0);
 	for (int i = 0; i < (dim - 1); i++) {
 		for (int j = 0; j < (dim - 1); j++) {
-			ret.at(i, j) = m.at(i, j);
+			ret[i][j] = m[i][j];
 		}
 	}
 	return ret;
 }
 sml_export template<arithmetic T, size_t dim>
 	requires (dim <= 1)
-T top_left(const sml::Matrix<T, dim, dim>& m) {
-	return m.at(0, 0);
+constexpr T top_left(const sml::Matrix<T, dim, dim>& m) {
+	return m[0][0];
 }
 
 // Return the square matrix to the top right that is 1 smaller in each dimension eg a 3x3 from a 4x4
 sml_export template<arithmetic T, size_t dim>
 	requires (dim >= 2)
-sml::Matrix<T, dim - 1, dim - 1> top_right(const sml::Matrix<T, dim, dim>& m) {
+constexpr sml::Matrix<T, dim - 1, dim - 1> top_right(const sml::Matrix<T, dim, dim>& m) {
 	sml::Matrix<T, dim - 1, dim - 1> ret(0);
 	for (int i = 0; i < (dim - 1); i++) {
 		for (int j = 1; j < dim; j++) {
-			ret.at(i, j - 1) = m.at(i, j);
+			ret[i][j - 1] = m[i][j];
 		}
 	}
 	return ret;
 }
 sml_export template<arithmetic T, size_t dim>
 	requires (dim <= 1)
-T top_right(const sml::Matrix<T, dim, dim>& m) {
-	return m.at(0, 1);
+constexpr T top_right(const sml::Matrix<T, dim, dim>& m) {
+	return m[0][1];
 }
 
 // Return the square matrix to the bottom left that is 1 smaller in each dimension eg a 3x3 from a 4x4
 sml_export template<arithmetic T, size_t dim>
 	requires (dim >= 2)
-sml::Matrix<T, dim - 1, dim - 1> bottom_left(const sml::Matrix<T, dim, dim>& m) {
+constexpr sml::Matrix<T, dim - 1, dim - 1> bottom_left(const sml::Matrix<T, dim, dim>& m) {
 	sml::Matrix<T, dim - 1, dim - 1> ret(0);
 	for (int i = 1; i < dim; i++) {
 		for (int j = 0; j < dim - 1; j++) {
-			ret.at(i - 1, j) = m.at(i, j);
+			ret[i - 1][j] = m[i][j];
 		}
 	}
 	return ret;
@@ -1173,30 +2010,30 @@ sml::Matrix<T, dim - 1, dim - 1> bottom_left(const sml::Matrix<T, dim, dim>& m)
 
 sml_export template<arithmetic T, size_t dim>
 	requires (dim <= 1)
-T bottom_left(const sml::Matrix<T, dim, dim>& m) {
-	return m.at(1, 0);
+constexpr T bottom_left(const sml::Matrix<T, dim, dim>& m) {
+	return m[1][0];
 }
 
 // Return the square matrix to the bottom right that is 1 smaller in each dimension eg a 3x3 from a 4x4
 sml_export template<arithmetic T, size_t dim>
 	requires (dim >= 2)
-sml::Matrix<T, dim - 1, dim - 1> bottom_right(const sml::Matrix<T, dim, dim>& m) {
+constexpr sml::Matrix<T, dim - 1, dim - 1> bottom_right(const sml::Matrix<T, dim, dim>& m) {
 	sml::Matrix<T, dim - 1, dim - 1> ret(0);
 	for (int i = 1; i < dim; i++) {
 		for (int j = 1; j < dim; j++) {
-			ret.at(i - 1, j - 1) = m.at(i, j);
+			ret[i - 1][j - 1] = m[i][j];
 		}
 	}
 	return ret;
 }
 sml_export template<arithmetic T, size_t dim>
 	requires (dim <= 1)
-T bottom_right(const sml::Matrix<T, dim, dim>& m) {
-	return m.at(1, 1);
+constexpr T bottom_right(const sml::Matrix<T, dim, dim>& m) {
+	return m[1][1];
 }
 
 // Efficiently calculate the inverse transpose of a Mat44f - useful for shaders
-sml_export sml::Matrix<float, 4, 4> inverse_transpose(const sml::Matrix<float, 4, 4> m) {
+sml_export constexpr sml::Matrix<float, 4, 4> inverse_transpose(const sml::Matrix<float, 4, 4> m) {
 	float subFactor00 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
 	float subFactor01 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
 	float subFactor02 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
@@ -0,0 +1,25 @@
+export module sml:Parallel;
+
+#ifdef SML_NO_IMPORT_STD
+
+import <algorithm>;
+import <array>;
+import <atomic>;
+import <concepts>;
+import <condition_variable>;
+import <exception>;
+import <mutex>;
+import <thread>;
+import <type_traits>;
+import <vector>;
+
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+#define SML_MODULE_PARALLEL
+#include "Parallel.hpp"
\ No newline at end of file
@@ -0,0 +1,286 @@
+#ifndef SML_PARALLEL_HPP
+#define SML_PARALLEL_HPP
+
+#ifndef SML_MODULE_PARALLEL
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#endif // !SML_MODULE_PARALLEL
+
+// Execution policies and the thread pool behind them
+//
+//     sml::add_assign(sml::execution::par, a, b);          // a += b, split across the default pool
+//     sml::thread_pool pool(8);
+//     float m = sml::max(sml::execution::par.on(pool), a);  // on a pool of eight threads
+//
+// Work below a size threshold always runs on the calling thread, where starting threads would cost more than it saves
+
+namespace sml {
+
+	// Persistent worker threads for the parallel policies, so that a parallel call costs a wake-up rather than the
+	// creation of a thread per chunk. The calling thread works alongside the pool, and every thread claims chunks
+	// from a shared counter until none are left, so threads that finish early take on the remaining work
+	sml_export class thread_pool {
+	public:
+		// A pool of threads threads in total, counting the thread that calls run()
+		explicit thread_pool(size_t threads = std::thread::hardware_concurrency()) {
+			const size_t n = std::max<size_t>(1, threads);
+			workers.reserve(n - 1);
+			for (size_t i = 1; i < n; i++) {
+				workers.emplace_back([this] { work(); });
+			}
+		}
+		thread_pool(const thread_pool&) = delete;
+		thread_pool& operator=(const thread_pool&) = delete;
+		~thread_pool() {
+			{
+				std::lock_guard lock(mutex);
+				stopping = true;
+			}
+			wake.notify_all();
+			for (auto& worker : workers) {
+				worker.join();
+			}
+		}
+
+		// Number of threads that share the work of run(), including the caller
+		inline size_t size() const noexcept { return workers.size() + 1; }
+
+		// Call f(i) for every i in [0, n), returning once all calls have finished and rethrowing the first exception
+		// any of them threw. Calls from inside a running task (nested parallelism) run on the calling thread
+		template<class F>
+		void run(size_t n, F&& f) {
+			if ((n <= 1) || workers.empty() || inside_task()) {
+				for (size_t i = 0; i < n; i++) {
+					f(i);
+				}
+				return;
+			}
+
+			// One job at a time: concurrent callers queue here
+			std::lock_guard serial(run_mutex);
+			job current;
+			current.count = n;
+			current.context = &f;
+			current.call = [](void* context, size_t i) { (*static_cast<std::remove_reference_t<F>*>(context))(i); };
+			{
+				std::lock_guard lock(mutex);
+				active = &current;
+				generation++;
+			}
+			wake.notify_all();
+			execute(current);
+
+			std::unique_lock lock(mutex);
+			finished.wait(lock, [&] { return (current.done.load() == current.count) && (current.running == 0); });
+			active = nullptr;
+			if (current.error) {
+				std::rethrow_exception(current.error);
+			}
+		}
+
+	private:
+		struct job {
+			void (*call)(void*, size_t) = nullptr;
+			void* context = nullptr;
+			size_t count = 0;
+			std::atomic<size_t> next = 0;
+			std::atomic<size_t> done = 0;
+			size_t running = 0;
+			std::exception_ptr error;
+		};
+
+		static inline bool& inside_task() {
+			static thread_local bool inside = false;
+			return inside;
+		}
+
+		// Claim and run chunks of j until there are none left
+		inline void execute(job& j) {
+			const bool was_inside = inside_task();
+			inside_task() = true;
+			size_t completed = 0;
+			for (size_t i = j.next++; i < j.count; i = j.next++) {
+				try {
+					j.call(j.context, i);
+				}
+				catch (...) {
+					std::lock_guard lock(mutex);
+					if (!j.error) {
+						j.error = std::current_exception();
+					}
+				}
+				completed++;
+			}
+			inside_task() = was_inside;
+			if ((completed > 0) && ((j.done += completed) == j.count)) {
+				std::lock_guard lock(mutex);
+				finished.notify_all();
+			}
+		}
+
+		inline void work() {
+			size_t seen = 0;
+			while (true) {
+				job* j;
+				{
+					std::unique_lock lock(mutex);
+					wake.wait(lock, [&] { return stopping || ((active != nullptr) && (generation != seen)); });
+					if (stopping) {
+						return;
+					}
+					seen = generation;
+					j = active;
+					j->running++;
+				}
+				execute(*j);
+				{
+					std::lock_guard lock(mutex);
+					j->running--;
+				}
+				finished.notify_all();
+			}
+		}
+
+		std::vector<std::thread> workers;
+		std::mutex run_mutex;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable finished;
+		job* active = nullptr;
+		size_t generation = 0;
+		bool stopping = false;
+	};
+
+	// The pool used by par and par_unseq unless they are given another, with a thread per hardware thread
+	sml_export inline thread_pool& default_thread_pool() {
+		static thread_pool pool;
+		return pool;
+	}
+
+	// Execution policies for the bulk operations, mirroring those in std::execution
+	// seq runs on the calling thread; par may split the work across the threads of a pool; par_unseq may also
+	// vectorise within each thread, which every bulk kernel already does, so it behaves as par
+	namespace execution {
+
+		sml_export struct sequenced_policy {};
+
+		sml_export struct parallel_policy {
+			thread_pool* pool = nullptr;
+			// The same policy, run on p rather than on the default pool
+			constexpr parallel_policy on(thread_pool& p) const noexcept { return { &p }; }
+		};
+
+		sml_export struct parallel_unsequenced_policy {
+			thread_pool* pool = nullptr;
+			constexpr parallel_unsequenced_policy on(thread_pool& p) const noexcept { return { &p }; }
+		};
+
+		sml_export inline constexpr sequenced_policy seq{};
+		sml_export inline constexpr parallel_policy par{};
+		sml_export inline constexpr parallel_unsequenced_policy par_unseq{};
+
+	} // !namespace execution
+
+	sml_export template<class P>
+	concept execution_policy = std::same_as<std::remove_cvref_t<P>, execution::sequenced_policy>
+		|| std::same_as<std::remove_cvref_t<P>, execution::parallel_policy>
+		|| std::same_as<std::remove_cvref_t<P>, execution::parallel_unsequenced_policy>;
+
+	namespace detail {
+
+		// Chunks per thread handed out by parallel_for, so that threads which finish early can take on more of the work
+		inline constexpr size_t parallel_chunks_per_thread = 4;
+
+		// Split [0, n) into contiguous ranges of at least grain elements, starting on multiples of align, and call
+		// f(begin, end) for each on the threads of pool. Fewer than two grains of work run on the calling thread
+		template<class F>
+		void parallel_for(thread_pool& pool, size_t n, size_t grain, F f, size_t align = 1) {
+			const size_t chunks = std::min(pool.size() * parallel_chunks_per_thread, n / std::max<size_t>(1, grain));
+			if (chunks <= 1) {
+				f(size_t(0), n);
+				return;
+			}
+
+			size_t step = (n + chunks - 1) / chunks;
+			step = ((step + align - 1) / align) * align;
+			pool.run((n + step - 1) / step, [&](size_t chunk) {
+				const size_t begin = chunk * step;
+				f(begin, std::min(n, begin + step));
+			});
+		}
+		template<class F>
+		void parallel_for(size_t n, size_t grain, F f) {
+			parallel_for(default_thread_pool(), n, grain, f);
+		}
+
+		template<execution_policy Policy>
+		inline constexpr bool is_parallel_policy = !std::same_as<std::remove_cvref_t<Policy>, execution::sequenced_policy>;
+
+		template<execution_policy Policy>
+		inline thread_pool& policy_pool(const Policy& policy) {
+			if constexpr (is_parallel_policy<Policy>) {
+				return (policy.pool != nullptr) ? *policy.pool : default_thread_pool();
+			}
+			else {
+				return default_thread_pool();
+			}
+		}
+
+		// Run f(begin, end) over [0, n), across threads only if the policy allows it
+		template<execution_policy Policy, class F>
+		inline void for_each_range(Policy&& policy, size_t n, size_t grain, F f, size_t align = 1) {
+			if constexpr (is_parallel_policy<Policy>) {
+				parallel_for(policy_pool(policy), n, grain, f, align);
+			}
+			else {
+				f(size_t(0), n);
+			}
+		}
+
+		// Most ranges a parallel reduction is split in to, whatever the size of the pool
+		inline constexpr size_t parallel_reduce_chunks = 64;
+
+		// Reduce [0, n) by mapping ranges with map(begin, end) and combining the results in order with combine(a, b)
+		// The ranges depend only on n and grain and are combined in order, so a parallel reduction gives the same
+		// result on a pool of any size. The partial results are held on the stack, so that reducing never allocates
+		template<class R, execution_policy Policy, class Map, class Combine>
+		inline R reduce_ranges(Policy&& policy, size_t n, size_t grain, Map map, Combine combine) {
+			if constexpr (is_parallel_policy<Policy>) {
+				thread_pool& pool = policy_pool(policy);
+				const size_t chunks = std::min(parallel_reduce_chunks, n / std::max<size_t>(1, grain));
+				if (chunks > 1) {
+					const size_t step = (n + chunks - 1) / chunks;
+					const size_t count = (n + step - 1) / step;
+					std::array<R, parallel_reduce_chunks> partial;
+					pool.run(count, [&](size_t chunk) {
+						const size_t begin = chunk * step;
+						partial[chunk] = map(begin, std::min(n, begin + step));
+					});
+					R ret = partial[0];
+					for (size_t i = 1; i < count; i++) {
+						ret = combine(ret, partial[i]);
+					}
+					return ret;
+				}
+			}
+			return map(size_t(0), n);
+		}
+
+	} // !namespace detail
+
+}
+#endif // !SML_PARALLEL_HPP
@@ -8,7 +8,11 @@ export module sml:Quaternion;
 
 import <array>;
 import <algorithm>;
+import <cmath>;
+import <concepts>;
 import <iostream>;
+import <limits>;
+import <stdexcept>;
 import <unordered_map>;
 import <vector>;
 import <cassert>;
@@ -18,6 +22,7 @@ import std;
 import <cassert>;
 #endif // SML_NO_IMPORT_STD
 import :Utility;
+import :Simd;
 import :Vector;
 import :Matrix;
 #define SML_MODULE_VECTOR
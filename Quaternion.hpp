@@ -1,73 +1,149 @@
 #ifndef SML_QUATERNION_HPP
 #define SML_QUATERNION_HPP
 
+#include "Config.hpp"
+
 namespace sml {
 
+#if defined(SML_QUATERNION_LANES)
+	// The vector part (i, j, k) of a Quaternion, read and written in place through a pointer to its lanes
+	// Quaternion::vector() returns one, so q.vector()[1] = y and q.vector() = v change q. It converts to a Vector<T, 3>
+	// copy where one is needed, but not where a Vector is deduced, so pass Vector<T, 3>(q.vector()) to templates
+	sml_export template<arithmetic T>
+	class QuaternionVectorRef {
+	public:
+		explicit constexpr QuaternionVectorRef(T* ijk) : elements(ijk) {}
+
+		inline constexpr T& operator[] (size_t i) const {
+			SML_CHECK_INDEX(i, 3);
+			return elements[i];
+		}
+		inline constexpr T& at(size_t i) const {
+			if (i >= 3) {
+				throw std::out_of_range("QuaternionVectorRef: index out of range");
+			}
+			return elements[i];
+		}
+
+		inline constexpr operator Vector<T, 3>() const { return Vector<T, 3>(elements[0], elements[1], elements[2]); }
+
+		// Assignment writes the lanes rather than rebinding the view
+		inline constexpr QuaternionVectorRef& operator = (const QuaternionVectorRef& v) {
+			return *this = Vector<T, 3>(v);
+		}
+		template<arithmetic T2>
+		inline constexpr QuaternionVectorRef& operator = (const Vector<T2, 3>& v) {
+			for (size_t n = 0; n < 3; n++) {
+				elements[n] = static_cast<T>(v[n]);
+			}
+			return *this;
+		}
 
+		template<arithmetic T2>
+		inline constexpr QuaternionVectorRef& operator += (const Vector<T2, 3>& v) {
+			for (size_t n = 0; n < 3; n++) {
+				elements[n] += static_cast<T>(v[n]);
+			}
+			return *this;
+		}
+		template<arithmetic T2>
+		inline constexpr QuaternionVectorRef& operator -= (const Vector<T2, 3>& v) {
+			for (size_t n = 0; n < 3; n++) {
+				elements[n] -= static_cast<T>(v[n]);
+			}
+			return *this;
+		}
+		template<arithmetic T2>
+		inline constexpr QuaternionVectorRef& operator *= (const T2& t) {
+			for (size_t n = 0; n < 3; n++) {
+				elements[n] *= static_cast<T>(t);
+			}
+			return *this;
+		}
+		template<arithmetic T2>
+		inline constexpr QuaternionVectorRef& operator /= (const T2& t) {
+			for (size_t n = 0; n < 3; n++) {
+				elements[n] /= static_cast<T>(t);
+			}
+			return *this;
+		}
+
+		template<arithmetic T2>
+		inline constexpr bool operator == (const Vector<T2, 3>& v) const {
+			return (elements[0] == v[0]) && (elements[1] == v[1]) && (elements[2] == v[2]);
+		}
+
+	private:
+		T* elements;
+	};
+#endif // SML_QUATERNION_LANES
+
+	// With SML_QUATERNION_LANES, four contiguous lanes (s, i, j, k), the scalar part
+	// followed by the vector part, aligned to the SIMD register width when the backend handles four lanes of T.
+	// Otherwise the scalar part and the vector part are the public scalar and vector members
 	sml_export template<arithmetic T>
 	class Quaternion {
 	public:
-		Quaternion() {
-			scalar = { static_cast<T>(0) };
-			vector = { static_cast<T>(0) };
+#if defined(SML_QUATERNION_LANES)
+		constexpr Quaternion() : lanes{} {}
+		template<arithmetic T2>
+		constexpr Quaternion(const Quaternion<T2>& q2) : lanes{ static_cast<T>(q2[0]), static_cast<T>(q2[1]), static_cast<T>(q2[2]), static_cast<T>(q2[3]) } {};
+		template<arithmetic T2>
+		constexpr Quaternion(const T2 c) : lanes{ static_cast<T>(c), static_cast<T>(c), static_cast<T>(c), static_cast<T>(c) } {};
+		template<arithmetic T2, arithmetic T3>
+		constexpr Quaternion(const T2 s, const Vector<T3, 3> v) : lanes{ static_cast<T>(s), static_cast<T>(v[0]), static_cast<T>(v[1]), static_cast<T>(v[2]) } {};
+		template<arithmetic T2, arithmetic T3, arithmetic T4, arithmetic T5>
+		constexpr Quaternion(const T2 s, const T3 v0, const T4 v1, const T5 v2) : lanes{ static_cast<T>(s), static_cast<T>(v0), static_cast<T>(v1), static_cast<T>(v2) } {};
+		template<arithmetic T2>
+		constexpr Quaternion(const T2 arr[4]) : lanes{ static_cast<T>(arr[0]), static_cast<T>(arr[1]), static_cast<T>(arr[2]), static_cast<T>(arr[3]) } {};
+
+		// Access elements with q[i], with the scalar part at q[0]
+		inline constexpr T operator[] (size_t i) const {
+			SML_CHECK_INDEX(i, 4);
+			return lanes[i];
 		}
+		inline constexpr T& operator[] (size_t i) {
+			SML_CHECK_INDEX(i, 4);
+			return lanes[i];
+		}
+
+		// The four lanes (s, i, j, k)
+		inline constexpr T* data() noexcept { return lanes.data(); }
+		inline constexpr const T* data() const noexcept { return lanes.data(); }
+
+		inline constexpr T& at(size_t i) { return lanes.at(i); }
+		inline constexpr T at(size_t i) const { return lanes.at(i); }
+
+		// The scalar part, and the vector part (i, j, k), in place of the scalar and vector members: q.scalar[0] is
+		// q.scalar() and q.vector[i] is q.vector()[i]. On a const Quaternion, vector() returns a Vector<T, 3> copy
+		inline constexpr T& scalar() { return lanes[0]; }
+		inline constexpr T scalar() const { return lanes[0]; }
+		inline constexpr QuaternionVectorRef<T> vector() { return QuaternionVectorRef<T>(lanes.data() + 1); }
+		inline constexpr Vector<T, 3> vector() const { return Vector<T, 3>(lanes[1], lanes[2], lanes[3]); }
+#else
+		constexpr Quaternion() : scalar{ static_cast<T>(0) }, vector{ static_cast<T>(0) } {}
 		template<arithmetic T2>
-		Quaternion(const Quaternion<T2>& q2) : scalar{ static_cast<T>(q2.scalar[0])}, vector{q2.vector} {};
+		constexpr Quaternion(const Quaternion<T2>& q2) : scalar{ static_cast<T>(q2.scalar[0]) }, vector{ q2.vector } {};
 		template<arithmetic T2>
-		Quaternion(const T2 c) : scalar{ static_cast<T>(c) }, vector{ Vector<T, 3>(static_cast<T>(c),static_cast<T>(c),static_cast<T>(c)) } {};
+		constexpr Quaternion(const T2 c) : scalar{ static_cast<T>(c) }, vector{ Vector<T, 3>(static_cast<T>(c), static_cast<T>(c), static_cast<T>(c)) } {};
 		template<arithmetic T2, arithmetic T3>
-		Quaternion(const T2 s, const Vector<T3, 3> v) : scalar{ static_cast<T>(s) }, vector{ v } {};
+		constexpr Quaternion(const T2 s, const Vector<T3, 3> v) : scalar{ static_cast<T>(s) }, vector{ v } {};
 		template<arithmetic T2, arithmetic T3, arithmetic T4, arithmetic T5>
-		Quaternion(const T2 s, const T3 v0, const T4 v1, const T5 v2) : scalar{ static_cast<T>(s) }, vector{ Vector<T, 3>(static_cast<T>(v0),static_cast<T>(v1),static_cast<T>(v2)) } {};
+		constexpr Quaternion(const T2 s, const T3 v0, const T4 v1, const T5 v2) : scalar{ static_cast<T>(s) }, vector{ Vector<T, 3>(static_cast<T>(v0), static_cast<T>(v1), static_cast<T>(v2)) } {};
 		template<arithmetic T2>
-		Quaternion(const T2 arr[4]) {
-			scalar[0] = { static_cast<T>(arr[0]) };
-			vector[0] = static_cast<T>(arr[1]);
-			vector[1] = static_cast<T>(arr[2]);
-			vector[2] = static_cast<T>(arr[3]);
-		}
-		inline T operator[] (size_t i) const {
-			switch (i)
-			{
-			case 0:
-				return scalar[0];
-				break;
-			case 1:
-				return vector[0];
-				break;
-			case 2:
-				return vector[1];
-				break;
-			case 3:
-				return vector[2];
-				break;
-			default:
-				std::cerr << "Out of range error: " << i << "\n";
-				break;
-			}
+		constexpr Quaternion(const T2 arr[4]) : scalar{ static_cast<T>(arr[0]) }, vector{ Vector<T, 3>(static_cast<T>(arr[1]), static_cast<T>(arr[2]), static_cast<T>(arr[3])) } {};
+
+		// Access elements with q[i], with the scalar part at q[0]
+		inline constexpr T operator[] (size_t i) const {
+			SML_CHECK_INDEX(i, 4);
+			return (i == 0) ? scalar[0] : vector[i - 1];
 		}
-		inline T& operator[] (size_t i) {
-			switch (i)
-			{
-			case 0:
-				return scalar[0];
-				break;
-			case 1:
-				return vector[0];
-				break;
-			case 2:
-				return vector[1];
-				break;
-			case 3:
-				return vector[2];
-				break;
-			default:
-				std::cerr << "Out of range error: " << i << "\n";
-				break;
-			}
+		inline constexpr T& operator[] (size_t i) {
+			SML_CHECK_INDEX(i, 4);
+			return (i == 0) ? scalar[0] : vector[i - 1];
 		}
 
-		inline T& at(size_t i) {
+		inline constexpr T& at(size_t i) {
 			if (i == 0) {
 				return scalar.at(0);
 			}
@@ -75,7 +151,7 @@ namespace sml {
 				return vector.at(i - 1);
 			}
 		}
-		inline T at(size_t i) const {
+		inline constexpr T at(size_t i) const {
 			if (i == 0) {
 				return scalar.at(0);
 			}
@@ -83,72 +159,104 @@ namespace sml {
 				return vector.at(i - 1);
 			}
 		}
-
-		inline T& q0() { return scalar[0]; }
-		inline T& q1() { return vector[0]; }
-		inline T& q2() { return vector[1]; }
-		inline T& q3() { return vector[2]; }
-		inline T& s() { return scalar[0]; }
-		inline T& i() { return vector[0]; }
-		inline T& j() { return vector[1]; }
-		inline T& k() { return vector[2]; }
-		inline T q0() const { return scalar[0]; }
-		inline T q1() const { return vector[0]; }
-		inline T q2() const { return vector[1]; }
-		inline T q3() const { return vector[2]; }
-		inline T s() const { return scalar[0]; }
-		inline T i() const { return vector[0]; }
-		inline T j() const { return vector[1]; }
-		inline T k() const { return vector[2]; }
+#endif // SML_QUATERNION_LANES
+
+		inline constexpr T& q0() { return (*this)[0]; }
+		inline constexpr T& q1() { return (*this)[1]; }
+		inline constexpr T& q2() { return (*this)[2]; }
+		inline constexpr T& q3() { return (*this)[3]; }
+		inline constexpr T& s() { return (*this)[0]; }
+		inline constexpr T& i() { return (*this)[1]; }
+		inline constexpr T& j() { return (*this)[2]; }
+		inline constexpr T& k() { return (*this)[3]; }
+		inline constexpr T q0() const { return (*this)[0]; }
+		inline constexpr T q1() const { return (*this)[1]; }
+		inline constexpr T q2() const { return (*this)[2]; }
+		inline constexpr T q3() const { return (*this)[3]; }
+		inline constexpr T s() const { return (*this)[0]; }
+		inline constexpr T i() const { return (*this)[1]; }
+		inline constexpr T j() const { return (*this)[2]; }
+		inline constexpr T k() const { return (*this)[3]; }
 
 		// Unary operators
-		inline const Quaternion& operator + () const { return *this; }
-		inline Quaternion operator - () const {
-			Quaternion<T> ret = *this;
-			ret.scalar[0] = -scalar[0];
-			ret.vector = -vector;
-			return ret;
+		inline constexpr const Quaternion& operator + () const { return *this; }
+		inline constexpr Quaternion operator - () const {
+			return Quaternion<T>(-q0(), -q1(), -q2(), -q3());
 		}
 
 		// Comparison operators
-		inline bool operator == (const Quaternion<T>& q2) const {
-			return ((scalar.at(0) == q2.scalar.at(0)) && (vector == q2.vector));
-		}
 		template<arithmetic T2>
-		inline bool operator == (const Quaternion<T2>& q2) const {
-			return ((scalar.at(0) == q2.scalar.at(0)) && (vector == q2.vector));
+		inline constexpr bool operator == (const Quaternion<T2>& q2) const {
+			return ((*this)[0] == q2[0]) && ((*this)[1] == q2[1]) && ((*this)[2] == q2[2]) && ((*this)[3] == q2[3]);
 		}
 
 		// Assignment operator
 		template<arithmetic T2>
-		inline Quaternion<T>& operator = (const Quaternion<T2>& q2) {
-			scalar[0] = static_cast<T>(q2.scalar[0]);
-			vector = q2.vector;
+		inline constexpr Quaternion<T>& operator = (const Quaternion<T2>& q2) {
+			for (size_t n = 0; n < 4; n++) {
+				(*this)[n] = static_cast<T>(q2[n]);
+			}
 			return *this;
 		}
 
 		template<arithmetic T2>
-		inline Quaternion<T>& operator+= (const Quaternion<T2>& q2);
+		inline constexpr Quaternion<T>& operator+= (const Quaternion<T2>& q2);
 
 		template<arithmetic T2>
-		inline Quaternion<T>& operator-= (const Quaternion<T2>& q2);
+		inline constexpr Quaternion<T>& operator-= (const Quaternion<T2>& q2);
 
 		template<arithmetic T2>
-		inline Quaternion<T>& operator*= (const Quaternion<T2>& q2);
+		inline constexpr Quaternion<T>& operator*= (const Quaternion<T2>& q2);
 
 		template<arithmetic T2>
-		inline Quaternion<T>& operator*= (const T2& t);
+		inline constexpr Quaternion<T>& operator*= (const T2& t);
 
 		template<arithmetic T2>
-		inline Quaternion<T>& operator/= (const T2& t);
+		inline constexpr Quaternion<T>& operator/= (const T2& t);
 		template<arithmetic T2>
-		inline Quaternion<T>& operator/= (const Quaternion<T2>& q2);
+		inline constexpr Quaternion<T>& operator/= (const Quaternion<T2>& q2);
 
+#if defined(SML_QUATERNION_LANES)
+		alignas(detail::simd_alignment<T, 4>) std::array<T, 4> lanes;
+#else
 		std::array<T, 1> scalar;
 		Vector<T, 3> vector;
+#endif
 
 	};
 
+	static_assert((sizeof(Quaternion<float>) == 4 * sizeof(float)) && (sizeof(Quaternion<double>) == 4 * sizeof(double)),
+		"Quaternion lanes must be contiguous");
+
+	namespace detail {
+
+		// Whether the Quaternion kernels run in the SIMD registers, which they load the four lanes of T in to directly
+		template<arithmetic T>
+#if defined(SML_QUATERNION_LANES)
+		inline constexpr bool simd_quaternion = simd_enabled<T, 4>;
+#else
+		inline constexpr bool simd_quaternion = false;
+#endif
+
+		// out = a * b, the Hamilton product of two quaternions in the SIMD registers for four lanes of T. Each lane of
+		// the product sums a's scalar times b and a's i, j and k times permutations of b, with the signs below
+		template<arithmetic T>
+		inline void simd_quaternion_multiply(const T* a, const T* b, T* out) {
+			using simd = simd_ops<T, 4>;
+			using reg = typename simd::reg;
+			const reg sign_i = simd::load(std::array<T, 4>{ -1, 1, -1, 1 }.data());
+			const reg sign_j = simd::load(std::array<T, 4>{ -1, 1, 1, -1 }.data());
+			const reg sign_k = simd::load(std::array<T, 4>{ -1, -1, 1, 1 }.data());
+			const reg vb = simd::load(b);
+			reg r = simd::mul(simd::broadcast(a[0]), vb);
+			r = simd::fma(simd::mul(simd::broadcast(a[1]), sign_i), simd::swap_pairs(vb), r);
+			r = simd::fma(simd::mul(simd::broadcast(a[2]), sign_j), simd::swap_halves(vb), r);
+			r = simd::fma(simd::mul(simd::broadcast(a[3]), sign_k), simd::reverse(vb), r);
+			simd::store(out, r);
+		}
+
+	} // !namespace detail
+
 	// Write vector to ostream
 	sml_export template<arithmetic T>
 	inline std::ostream& operator << (std::ostream& os, const Quaternion<T>& t) {
@@ -164,43 +272,70 @@ namespace sml {
 	}
 
 	sml_export template<arithmetic T>
-	inline Quaternion<T> Conjugate(const Quaternion<T>& q) {
+	inline constexpr Quaternion<T> Conjugate(const Quaternion<T>& q) {
+		if !consteval {
+			if constexpr (detail::simd_quaternion<T>) {
+				using simd = detail::simd_ops<T, 4>;
+				Quaternion<T> ret;
+				simd::store(ret.data(), simd::mul(simd::load(q.data()), simd::load(std::array<T, 4>{ 1, -1, -1, -1 }.data())));
+				return ret;
+			}
+		}
 		return Quaternion<T>(q.q0(), -q.q1(), -q.q2(), -q.q3());
 	}
 
+	// Sum of the products of the four lanes of q1 and q2
+	sml_export template<arithmetic T>
+	inline constexpr T dot(const Quaternion<T>& q1, const Quaternion<T>& q2) {
+		if !consteval {
+			if constexpr (detail::simd_quaternion<T>) {
+				return detail::simd_ops<T, 4>::dot(q1.data(), q2.data());
+			}
+		}
+		return (q1.q0() * q2.q0()) + (q1.q1() * q2.q1()) + (q1.q2() * q2.q2()) + (q1.q3() * q2.q3());
+	}
+
 	using std::abs;
 	sml_export template<arithmetic T>
-		inline Quaternion<T> abs(const Quaternion<T>& q) {
-		return Quaternion<T>(abs(q.scalar), abs(q.vector));
+		inline constexpr Quaternion<T> abs(const Quaternion<T>& q) {
+		return Quaternion<T>(std::abs(q[0]), std::abs(q[1]), std::abs(q[2]), std::abs(q[3]));
 	}
 
 	sml_export template<arithmetic T>
 		template<arithmetic T2>
-		inline Quaternion<T>& Quaternion<T>::operator+= (const Quaternion<T2>& q2) {
-			q0() += static_cast<T>(q2.q0());
-			vector += q2.vector;
+		inline constexpr Quaternion<T>& Quaternion<T>::operator+= (const Quaternion<T2>& q2) {
+			for (size_t n = 0; n < 4; n++) {
+				(*this)[n] += static_cast<T>(q2[n]);
+			}
 			return *this;
 	}
 	sml_export template<arithmetic T, arithmetic T2>
-		inline Quaternion<T> operator+ (Quaternion<T> q1, const Quaternion<T2>& q2) {
+		inline constexpr Quaternion<T> operator+ (Quaternion<T> q1, const Quaternion<T2>& q2) {
 		return q1 += q2;
 	}
 
 	sml_export template<arithmetic T>
 		template<arithmetic T2>
-	inline Quaternion<T>& Quaternion<T>::operator-= (const Quaternion<T2>& q2) {
-		q0() -= static_cast<T>(q2.q0());
-		vector -= q2.vector;
+	inline constexpr Quaternion<T>& Quaternion<T>::operator-= (const Quaternion<T2>& q2) {
+		for (size_t n = 0; n < 4; n++) {
+			(*this)[n] -= static_cast<T>(q2[n]);
+		}
 		return *this;
 	}
 	sml_export template<arithmetic T, arithmetic T2>
-		inline Quaternion<T> operator- (Quaternion<T> q1, const Quaternion<T2>& q2) {
+		inline constexpr Quaternion<T> operator- (Quaternion<T> q1, const Quaternion<T2>& q2) {
 		return q1 -= q2;
 	}
 
 	sml_export template<arithmetic T>
 		template<arithmetic T2>
-	inline Quaternion<T>& Quaternion<T>::operator*= (const Quaternion<T2>& q) {
+	inline constexpr Quaternion<T>& Quaternion<T>::operator*= (const Quaternion<T2>& q) {
+		if !consteval {
+			if constexpr (std::is_same_v<T, T2> && detail::simd_quaternion<T>) {
+				detail::simd_quaternion_multiply(this->data(), q.data(), this->data());
+				return *this;
+			}
+		}
 
 		//(a, b, c, d) * (e, f, g, h);
 		// q0 q1 q2 q3    q0 q1 q2 q3
@@ -220,147 +355,360 @@ namespace sml {
 		return *this;
 	}
 	sml_export template<arithmetic T, arithmetic T2>
-		inline Quaternion<T> operator* (Quaternion<T> q1, const Quaternion<T2>& q2) {
+		inline constexpr Quaternion<T> operator* (Quaternion<T> q1, const Quaternion<T2>& q2) {
 		return q1 *= q2;
 	}
 
 	sml_export template<arithmetic T>
 		template<arithmetic T2>
-	inline Quaternion<T>& Quaternion<T>::operator*= (const T2& t) {
-
-		scalar[0] *= static_cast<T>(t);
-		vector *= t;
+	inline constexpr Quaternion<T>& Quaternion<T>::operator*= (const T2& t) {
+		for (size_t n = 0; n < 4; n++) {
+			(*this)[n] *= static_cast<T>(t);
+		}
 		return *this;
 	}
 	sml_export template<arithmetic T, arithmetic T2>
-		inline Quaternion<T> operator* (Quaternion<T> q, const T2& t) {
+		inline constexpr Quaternion<T> operator* (Quaternion<T> q, const T2& t) {
 		return q *= t;
 	}
 
 	sml_export template<arithmetic T>
 		template<arithmetic T2>
-	inline Quaternion<T>& Quaternion<T>::operator/=(const T2& t) {
-		scalar[0] /= static_cast<T>(t);
-		vector /= t;
+	inline constexpr Quaternion<T>& Quaternion<T>::operator/=(const T2& t) {
+		for (size_t n = 0; n < 4; n++) {
+			(*this)[n] /= static_cast<T>(t);
+		}
 		return *this;
 	}
 	sml_export template<arithmetic T, arithmetic T2>
-		inline Quaternion<T> operator/ (Quaternion<T> q, const T2& t) {
+		inline constexpr Quaternion<T> operator/ (Quaternion<T> q, const T2& t) {
 		return q /= t;
 	}
 
 	sml_export template<arithmetic T>
 		template<arithmetic T2>
-	inline Quaternion<T>& Quaternion<T>::operator/=(const Quaternion<T2>& q2) {
-		return *this *= inverse(q2);
+	inline constexpr Quaternion<T>& Quaternion<T>::operator/=(const Quaternion<T2>& q2) {
+		return *this *= Inverse(q2);
 	}
 	sml_export template<arithmetic T, arithmetic T2>
-		inline Quaternion<T> operator/ (Quaternion<T> q, const Quaternion<T2>& q2) {
+		inline constexpr Quaternion<T> operator/ (Quaternion<T> q, const Quaternion<T2>& q2) {
 		return q /= q2;
 	}
 
 	sml_export template<arithmetic T>
-		inline double SquaredLength(const Quaternion<T>& q) {
+		inline constexpr double SquaredLength(const Quaternion<T>& q) {
 		return (q.q0() * q.q0()) + (q.q1() * q.q1()) + (q.q2() * q.q2()) + (q.q3() * q.q3());
 	}
 
 	sml_export template<arithmetic T>
-		inline double Length(const Quaternion<T>& q) {
-		return std::sqrt(SquaredLength(q));
+		inline constexpr double Length(const Quaternion<T>& q) {
+		return detail::constexpr_sqrt(SquaredLength(q));
 	}
 
 	sml_export template<arithmetic T>
-		inline Quaternion<T> Inverse(const Quaternion<T>& q) {
+		inline constexpr Quaternion<T> Inverse(const Quaternion<T>& q) {
 		return Conjugate(q) / SquaredLength(q);
 	}
 
 	sml_export template<arithmetic T>
-		inline Quaternion<T> Normalise(const Quaternion<T>& q) {
+		inline constexpr Quaternion<T> Normalise(const Quaternion<T>& q) {
+		if !consteval {
+			// For double, the horizontal sum and a four lane division cost more than four scalar divisions
+			if constexpr (std::is_same_v<T, float> && detail::simd_quaternion<T>) {
+				using simd = detail::simd_ops<T, 4>;
+				const typename simd::reg v = simd::load(q.data());
+				Quaternion<T> ret;
+				simd::store(ret.data(), simd::div(v, simd::broadcast(static_cast<T>(std::sqrt(dot(q, q))))));
+				return ret;
+			}
+		}
 		return (q / Length(q));
 	}
 
+	namespace detail {
+
+		// Default tolerance of IsNormal on the squared length: about a thousand roundings, so that quaternions built
+		// from a chain of products of unit quaternions still pass
+		template<arithmetic T>
+		inline constexpr double normal_tolerance = std::is_floating_point_v<T> ? 1024.0 * std::numeric_limits<T>::epsilon() : 0.0;
+
+		// Shepperd's method. The largest of the four components is found by comparing the trace with the diagonal and
+		// recovered from it, and the others from sums and differences of the off-diagonal elements, divided by it, so
+		// that there is only one square root and no division by a small number. The four cases are blended with weights
+		// of 0 and 1 rather than branched between, as which one applies is as good as random for a stream of rotations.
+		// The result has a non-negative scalar part
+		template<std::floating_point T>
+		inline constexpr void shepperd(T m00, T m01, T m02, T m10, T m11, T m12, T m20, T m21, T m22, T* out) {
+			const T trace = m00 + m11 + m22;
+			const T largest = std::max(std::max(m00, m11), m22);
+			// In order of precedence, so that a tie goes to the first
+			const bool by_s = trace >= largest;
+			const bool by_i = m00 == largest;
+			const bool by_j = m11 == largest;
+			const T ws = T(by_s);
+			const T wi = T(!by_s & by_i);
+			const T wj = T(!by_s & !by_i & by_j);
+			const T wk = T(1) - ws - wi - wj;
+			// 4 times the square of the largest component, and the others times the same scale
+			const T t = T(1) + ((ws + wi - wj - wk) * m00) + ((ws - wi + wj - wk) * m11) + ((ws - wi - wj + wk) * m22);
+			const T d21 = m21 - m12, d02 = m02 - m20, d10 = m10 - m01;
+			const T s10 = m10 + m01, s02 = m02 + m20, s21 = m21 + m12;
+			const T s = (ws * t) + (wi * d21) + (wj * d02) + (wk * d10);
+			const T i = (ws * d21) + (wi * t) + (wj * s10) + (wk * s02);
+			const T j = (ws * d02) + (wi * s10) + (wj * t) + (wk * s21);
+			const T k = (ws * d10) + (wi * s02) + (wj * s21) + (wk * t);
+			const T f = std::copysign(T(0.5) / constexpr_sqrt(t), s);
+			out[0] = s * f;
+			out[1] = i * f;
+			out[2] = j * f;
+			out[3] = k * f;
+		}
+
+		// The rotation matrix of the unit quaternion (s, i, j, k), as nine elements in row-major order
+		template<arithmetic T>
+		inline constexpr std::array<T, 9> rotation_elements(T s, T i, T j, T k) {
+			const T ii = T(2) * i * i, jj = T(2) * j * j, kk = T(2) * k * k;
+			const T si = T(2) * s * i, sj = T(2) * s * j, sk = T(2) * s * k;
+			const T ij = T(2) * i * j, ik = T(2) * i * k, jk = T(2) * j * k;
+			return { T(1) - jj - kk, ij - sk, ik + sj,
+				ij + sk, T(1) - ii - kk, jk - si,
+				ik - sj, jk + si, T(1) - ii - jj };
+		}
+
+	} // !namespace detail
+
+	// Whether q is of unit length, to within tolerance on its squared length
 	sml_export template<arithmetic T>
-		inline bool IsNormal(const Quaternion<T>& q) {
-		return (q == Normalise(q));
+		inline constexpr bool IsNormal(const Quaternion<T>& q, const double tolerance = detail::normal_tolerance<T>) {
+		const double d = SquaredLength(q) - 1.0;
+		return ((d <= tolerance) && (-d <= tolerance));
 	}
 
 	sml_export template<arithmetic T>
-		inline Quaternion<T> RotationMatrixToQuaternion(sml::Matrix<T, 4, 4> mat) {
+		inline constexpr Quaternion<T> RotationMatrixToQuaternion(sml::Matrix<T, 4, 4> mat) {
 
 		return RotationMatrixToQuaternion(top_left(mat));
 	}
+	// The unit quaternion of the rotation matrix mat, with a non-negative scalar part
 	sml_export template<arithmetic T>
-		inline Quaternion<T> RotationMatrixToQuaternion(sml::Matrix<T, 3, 3> mat) {
+		inline constexpr Quaternion<T> RotationMatrixToQuaternion(sml::Matrix<T, 3, 3> mat) {
+		// Integer matrices are converted through double
+		using F = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+		std::array<F, 4> q{};
+		detail::shepperd<F>(mat[0][0], mat[0][1], mat[0][2], mat[1][0], mat[1][1], mat[1][2], mat[2][0], mat[2][1], mat[2][2], q.data());
+		return Quaternion<T>(q[0], q[1], q[2], q[3]);
+	}
 
-		Quaternion<T> ret(0);
+	// The rotation matrix of the unit quaternion q. Only checked to be of unit length when SML_CHECKED is defined
+	sml_export template<arithmetic T>
+		inline constexpr Matrix<T, 4, 4> QuaternionTo44RotationMatrix(const Quaternion<T>& q) {
 
-		ret.q0() = std::sqrt(std::max(0.0, 1.0 + mat.at(0, 0) + mat.at(1, 1) + mat.at(2, 2))) / 2;
-		ret.q1() = std::sqrt(std::max(0.0, 1.0 + mat.at(0, 0) - mat.at(1, 1) - mat.at(2, 2))) / 2;
-		ret.q2() = std::sqrt(std::max(0.0, 1.0 - mat.at(0, 0) + mat.at(1, 1) - mat.at(2, 2))) / 2;
-		ret.q3() = std::sqrt(std::max(0.0, 1.0 - mat.at(0, 0) - mat.at(1, 1) + mat.at(2, 2))) / 2;
+		SML_CHECK_ARGUMENT(IsNormal(q), "QuaternionTo44RotationMatrix: quaternion is not of unit length");
 
-		ret.i() = std::copysign(ret.i(), mat.at(2, 1) - mat.at(1, 2));
-		ret.j() = std::copysign(ret.j(), mat.at(0, 2) - mat.at(2, 0));
-		ret.k() = std::copysign(ret.k(), mat.at(1, 0) - mat.at(0, 1));
-		
-		return ret;
+		const std::array<T, 9> m = detail::rotation_elements(q.s(), q.i(), q.j(), q.k());
+		return Matrix<T, 4, 4>(m[0], m[1], m[2], 0,
+							 m[3], m[4], m[5], 0,
+							 m[6], m[7], m[8], 0,
+							 0, 0, 0, 1);
 	}
 
 	sml_export template<arithmetic T>
-		inline Matrix<T, 4, 4> QuaternionTo44RotationMatrix(const Quaternion<T>& q) {
+		inline constexpr Matrix<T, 3, 3> QuaternionTo33RotationMatrix(const Quaternion<T>& q) {
 
-		assert(IsNormal(q));
+		SML_CHECK_ARGUMENT(IsNormal(q), "QuaternionTo33RotationMatrix: quaternion is not of unit length");
 
-		T isq = 2.0 * q.i() * q.i();
-		T jsq = 2.0 * q.j() * q.j();
-		T ksq = 2.0 * q.k() * q.k();
+		const std::array<T, 9> m = detail::rotation_elements(q.s(), q.i(), q.j(), q.k());
+		return Matrix<T, 3, 3>(m[0], m[1], m[2],
+								m[3], m[4], m[5],
+								m[6], m[7], m[8]);
+	}
 
-		T si = 2.0 * q.s() * q.i();
-		T ij = 2.0 * q.i() * q.j();
-		T jk = 2.0 * q.j() * q.k();
-		T sk = 2.0 * q.s() * q.k();
-		T ik = 2.0 * q.i() * q.k();
-		T sj = 2.0 * q.s() * q.j();
+	namespace detail {
+
+		// The rotation of p by the quaternion (s, v): expanding q p q* / |q|^2 with t = 2 (v x p) gives
+		// p + (s t + v x t) / |q|^2, two cross products in place of two Hamilton products and an inverse
+		// unit skips the division by |q|^2, for quaternions known to be of unit length
+		template<bool unit, arithmetic T>
+		inline constexpr Vector<T, 3> rotate_vector(T s, T vi, T vj, T vk, T x, T y, T z) {
+			const T tx = T(2) * ((vj * z) - (vk * y));
+			const T ty = T(2) * ((vk * x) - (vi * z));
+			const T tz = T(2) * ((vi * y) - (vj * x));
+			T rx = (s * tx) + ((vj * tz) - (vk * ty));
+			T ry = (s * ty) + ((vk * tx) - (vi * tz));
+			T rz = (s * tz) + ((vi * ty) - (vj * tx));
+			if constexpr (!unit) {
+				const T inv_norm = T(1) / ((s * s) + (vi * vi) + (vj * vj) + (vk * vk));
+				rx *= inv_norm;
+				ry *= inv_norm;
+				rz *= inv_norm;
+			}
+			return Vector<T, 3>(x + rx, y + ry, z + rz);
+		}
 
-		return Matrix<T,4,4>(1.0 - jsq - ksq, ij - sk, ik + sj, 0.0,
-							 ij + sk, 1.0 - isq - ksq, jk - si, 0.0,
-							 ik - sj, jk + si, 1.0 - isq - jsq, 0.0, 
-							 0.0, 0.0, 0.0, 1.0);
+		// Inverse(rot) * pos * rot when conjugate is set, otherwise rot * pos * Inverse(rot)
+		template<bool conjugate, bool unit, arithmetic T, arithmetic T2>
+		inline constexpr Vector<T2, 3> rotate_vector(const Vector<T2, 3>& pos, const Quaternion<T>& rot) {
+			const T sign = conjugate ? T(-1) : T(1);
+			return Vector<T2, 3>(rotate_vector<unit>(rot.s(), sign * rot.i(), sign * rot.j(), sign * rot.k(),
+				static_cast<T>(pos[0]), static_cast<T>(pos[1]), static_cast<T>(pos[2])));
+		}
+
+	} // !namespace detail
+
+	// Rotate pos by Inverse(rot) * pos * rot; rot need not be of unit length
+	sml_export template<arithmetic T, arithmetic T2>
+	inline constexpr Vector<T2, 3> RotateActive(const Vector<T2, 3> pos, const Quaternion<T> rot) {
+		return detail::rotate_vector<true, false>(pos, rot);
 	}
 
-	sml_export template<arithmetic T>
-		inline Matrix<T, 3, 3> QuaternionTo33RotationMatrix(const Quaternion<T>& q) {
+	// Rotate pos by rot * pos * Inverse(rot); rot need not be of unit length
+	sml_export template<arithmetic T, arithmetic T2>
+	inline constexpr Vector<T2, 3> RotatePassive(const Vector<T2, 3> pos, const Quaternion<T> rot) {
+		return detail::rotate_vector<false, false>(pos, rot);
+	}
+
+	// RotateActive and RotatePassive for a rot of unit length, whose inverse is its conjugate. rot is not checked and
+	// the result is not a rotation of pos unless it has been normalised
+	sml_export template<arithmetic T, arithmetic T2>
+	inline constexpr Vector<T2, 3> RotateActiveUnit(const Vector<T2, 3>& pos, const Quaternion<T>& rot) {
+		return detail::rotate_vector<true, true>(pos, rot);
+	}
+	sml_export template<arithmetic T, arithmetic T2>
+	inline constexpr Vector<T2, 3> RotatePassiveUnit(const Vector<T2, 3>& pos, const Quaternion<T>& rot) {
+		return detail::rotate_vector<false, true>(pos, rot);
+	}
 
-		assert(IsNormal(q));
+	namespace detail {
+
+		// The arc between two rotations, as slerp needs it: the cosine of the angle theta between them, theta, and
+		// 1 / sin(theta). Where the cosine is above linear_threshold or below -linear_threshold, sin(theta) is too
+		// small to divide by and slerp interpolates linearly instead. Near 1 that is indistinguishable at such small
+		// angles. Near -1 the two ends are nearly the same rotation with opposite signs, with no one half circle
+		// between them, so the far end is negated and slerp stays on that rotation. The cosine is clamped to [-1, 1],
+		// as rounding can take the dot product of two unit quaternions just outside it
+		template<std::floating_point T>
+		struct slerp_arc {
+			static constexpr T linear_threshold = T(0.9995);
+
+			slerp_arc() = default;
+			explicit slerp_arc(T d) : cos_theta(std::min(std::max(d, T(-1)), T(1))), linear(std::abs(d) > linear_threshold) {
+				if (!linear) {
+					theta = std::acos(cos_theta);
+					inv_sin = T(1) / std::sqrt(T(1) - (cos_theta * cos_theta));
+				}
+			}
 
-		T isq = 2.0 * q.i() * q.i();
-		T jsq = 2.0 * q.j() * q.j();
-		T ksq = 2.0 * q.k() * q.k();
+			// Weights of the two ends at t, sin((1 - t) theta) / sin(theta) and sin(t theta) / sin(theta), or the
+			// linear weights for a linear arc, whose result needs normalising
+			inline void weights(T t, T& wa, T& wb) const {
+				if (linear) {
+					wa = T(1) - t;
+					wb = (cos_theta < T(0)) ? -t : t;
+					return;
+				}
+				// sin((1 - t) theta) = sin(theta) cos(t theta) - cos(theta) sin(t theta), so that the only
+				// trigonometry is the sine and cosine of one angle
+				const T sin_t = std::sin(t * theta);
+				wa = std::cos(t * theta) - (cos_theta * sin_t * inv_sin);
+				wb = sin_t * inv_sin;
+			}
 
-		T si = 2.0 * q.s() * q.i();
-		T ij = 2.0 * q.i() * q.j();
-		T jk = 2.0 * q.j() * q.k();
-		T sk = 2.0 * q.s() * q.k();
-		T ik = 2.0 * q.i() * q.k();
-		T sj = 2.0 * q.s() * q.j();
+			T cos_theta = T(1);
+			T theta = T(0);
+			T inv_sin = T(0);
+			bool linear = true;
+		};
+
+		// wa * a + wb * b, normalised if normalise is set
+		template<std::floating_point T>
+		inline Quaternion<T> blend(const Quaternion<T>& a, T wa, const Quaternion<T>& b, T wb, bool normalise) {
+			T s = (wa * a.s()) + (wb * b.s());
+			T i = (wa * a.i()) + (wb * b.i());
+			T j = (wa * a.j()) + (wb * b.j());
+			T k = (wa * a.k()) + (wb * b.k());
+			if (normalise) {
+				const T inv_length = T(1) / std::sqrt((s * s) + (i * i) + (j * j) + (k * k));
+				s *= inv_length;
+				i *= inv_length;
+				j *= inv_length;
+				k *= inv_length;
+			}
+			return Quaternion<T>(s, i, j, k);
+		}
+
+		// slerp from a to b along arc, the arc between them
+		template<std::floating_point T>
+		inline Quaternion<T> slerp(const Quaternion<T>& a, const Quaternion<T>& b, const slerp_arc<T>& arc, T t) {
+			T wa, wb;
+			arc.weights(t, wa, wb);
+			return blend(a, wa, b, wb, arc.linear);
+		}
 
-		return Matrix<T, 3, 3>(1.0 - jsq - ksq, ij - sk, ik + sj,
-								ij + sk, 1.0 - isq - ksq, jk - si,
-								ik - sj, jk + si, 1.0 - isq - jsq);
+		// slerp, taking the shorter of the two arcs between a and b only if shortest is set
+		template<bool shortest, std::floating_point T>
+		inline Quaternion<T> slerp(const Quaternion<T>& a, const Quaternion<T>& b, T t) {
+			const T d = dot(a, b);
+			if (shortest && (d < T(0))) {
+				return slerp(a, -b, slerp_arc<T>(-d), t);
+			}
+			return slerp(a, b, slerp_arc<T>(d), t);
+		}
+
+		// Logarithm of a unit quaternion, a pure quaternion held as its vector part
+		template<std::floating_point T>
+		inline Vector<T, 3> unit_log(const Quaternion<T>& q) {
+			const T length = std::sqrt((q.i() * q.i()) + (q.j() * q.j()) + (q.k() * q.k()));
+			if (length <= std::numeric_limits<T>::epsilon()) {
+				return Vector<T, 3>(q.i(), q.j(), q.k());
+			}
+			const T f = std::atan2(length, q.s()) / length;
+			return Vector<T, 3>(f * q.i(), f * q.j(), f * q.k());
+		}
+
+		// Exponential of the pure quaternion v, a unit quaternion
+		template<std::floating_point T>
+		inline Quaternion<T> pure_exp(const Vector<T, 3>& v) {
+			const T angle = std::sqrt((v[0] * v[0]) + (v[1] * v[1]) + (v[2] * v[2]));
+			const T f = (angle <= std::numeric_limits<T>::epsilon()) ? T(1) : std::sin(angle) / angle;
+			return Quaternion<T>(std::cos(angle), f * v[0], f * v[1], f * v[2]);
+		}
+
+	} // !namespace detail
+
+	// Normalised linear interpolation from a to b, along the shorter arc between them. Cheaper than slerp, but the
+	// rotation does not proceed at a constant rate over t
+	sml_export template<std::floating_point T, arithmetic T2>
+	inline Quaternion<T> nlerp(const Quaternion<T>& a, const Quaternion<T>& b, const T2 t) {
+		const T tt = static_cast<T>(t);
+		const T wb = (dot(a, b) < T(0)) ? -tt : tt;
+		return detail::blend(a, T(1) - tt, b, wb, true);
 	}
 
-	sml_export template<arithmetic T, arithmetic T2>
-	inline Vector<T2, 3> RotateActive(const Vector<T2, 3> pos, const Quaternion<T> rot) {
-		Quaternion<T> temp(0, pos);
-		temp = Inverse(rot) * temp * rot;
-		return temp.vector;
+	// Spherical linear interpolation from a to b, unit quaternions, rotating at a constant rate along the shorter arc
+	// between them
+	sml_export template<std::floating_point T, arithmetic T2>
+	inline Quaternion<T> slerp(const Quaternion<T>& a, const Quaternion<T>& b, const T2 t) {
+		return detail::slerp<true>(a, b, static_cast<T>(t));
 	}
 
-	sml_export template<arithmetic T, arithmetic T2>
-	inline Vector<T2, 3> RotatePassive(const Vector<T2, 3> pos, const Quaternion<T> rot) {
-		Quaternion<T> temp(0, pos);
-		temp = rot * temp * Inverse(rot);
-		return temp.vector;
+	// The control point of q for squad, between the keys before and after it; at the ends of a sequence of keys, pass
+	// the end key itself as its missing neighbour
+	sml_export template<std::floating_point T>
+	inline Quaternion<T> squad_control_point(const Quaternion<T>& prev, const Quaternion<T>& q, const Quaternion<T>& next) {
+		const Quaternion<T> inv = Conjugate(q);
+		// prev and next on the same side of the hypersphere as q, so that the logarithms take the shorter arcs
+		const Quaternion<T> to_prev = inv * ((dot(q, prev) < T(0)) ? -prev : prev);
+		const Quaternion<T> to_next = inv * ((dot(q, next) < T(0)) ? -next : next);
+		const Vector<T, 3> sum = detail::unit_log(to_prev) + detail::unit_log(to_next);
+		return q * detail::pure_exp(sum * T(-0.25));
+	}
+
+	// Spherical quadrangle interpolation from q1 to q2, through their control points a1 and a2 from
+	// squad_control_point. Curves through a sequence of keys interpolated this way are smooth across the keys
+	sml_export template<std::floating_point T, arithmetic T2>
+	inline Quaternion<T> squad(const Quaternion<T>& q1, const Quaternion<T>& a1, const Quaternion<T>& a2, const Quaternion<T>& q2, const T2 t) {
+		const T tt = static_cast<T>(t);
+		return detail::slerp<false>(detail::slerp<false>(q1, q2, tt), detail::slerp<false>(a1, a2, tt), T(2) * tt * (T(1) - tt));
 	}
 
 	sml_export using Quatf = Quaternion<float>;
@@ -5,6 +5,20 @@ export module sml;
 #endif
 
 export import :Utility;
+export import :Simd;
+export import :Allocator;
+export import :Parallel;
 export import :Vector;
 export import :Matrix;
-export import :Quaternion;
\ No newline at end of file
+export import :Expression;
+export import :DynMatrix;
+export import :Decomposition;
+export import :Sparse;
+export import :Solver;
+export import :Quaternion;
+export import :Transform;
+export import :Batch;
+export import :Hierarchy;
+export import :Animation;
+export import :Serialize;
+export import :Text;
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef SML_HPP
+#define SML_HPP
+
+// The whole library for builds that do not use modules, with every part included in dependency order
+// Module builds import sml from SML.cppm instead
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <version>
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#include "Utility.hpp"
+#include "Simd.hpp"
+#include "Allocator.hpp"
+#include "Parallel.hpp"
+#include "Vector.hpp"
+#include "Matrix.hpp"
+#include "Expression.hpp"
+#include "DynMatrix.hpp"
+#include "Decomposition.hpp"
+#include "Sparse.hpp"
+#include "Solver.hpp"
+#include "Quaternion.hpp"
+#include "Transform.hpp"
+#include "Batch.hpp"
+#include "Hierarchy.hpp"
+#include "Animation.hpp"
+#include "Serialize.hpp"
+#include "Text.hpp"
+
+#endif // !SML_HPP
\ No newline at end of file
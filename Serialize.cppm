@@ -0,0 +1,52 @@
+module;
+
+#include "Config.hpp"
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+export module sml:Serialize;
+
+#ifdef SML_NO_IMPORT_STD
+
+import <algorithm>;
+import <array>;
+import <bit>;
+import <concepts>;
+import <cstdint>;
+import <cstring>;
+import <filesystem>;
+import <fstream>;
+import <istream>;
+import <ostream>;
+import <span>;
+import <stdexcept>;
+import <string>;
+import <type_traits>;
+import <vector>;
+
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+import :Utility;
+import :Vector;
+import :Matrix;
+import :Quaternion;
+#define SML_MODULE_SERIALIZE
+#include "Serialize.hpp"
\ No newline at end of file
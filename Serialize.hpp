@@ -0,0 +1,566 @@
+#ifndef SML_SERIALIZE_HPP
+#define SML_SERIALIZE_HPP
+
+#ifndef SML_MODULE_SERIALIZE
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#endif // !SML_MODULE_SERIALIZE
+
+// Binary files of Vectors, Matrices and Quaternions
+//
+//     sml::write_binary("poses.sml", std::span<const sml::Mat44f>(poses));
+//     std::vector<sml::Mat44f> back = sml::read_binary<sml::Mat44f>("poses.sml");
+//     sml::MappedArray<sml::Mat44f> mapped("poses.sml");      // no copy: pages are read in as they are touched
+//     for (const sml::Mat44f& m : mapped.span()) { ... }
+//
+// A file is a 64-byte header followed by the elements of every object, packed and little-endian, with Matrices in
+// row-major order and Quaternions as q0 (the scalar part), q1, q2, q3. The header records the format version, the
+// scalar type, the kind of object and its dimensions, so files are only ever read back as the type they were written
+// as. Objects are written and read with single block copies wherever their layout in memory matches the file's.
+//
+// Header layout, all fields little-endian:
+//     0   magic "SMLB"          4   u16 version          6   u8 object kind       7   u8 scalar kind
+//     8   u8 scalar bytes       12  u32 rows             16  u32 columns          20  u32 offset of the data
+//     24  u64 number of objects, or binary_unknown_count if the writer could not seek back to fill it in
+
+namespace sml {
+
+	sml_export inline constexpr uint16_t binary_format_version = 1;
+
+	// Count recorded by writers to streams that cannot seek; readers then read up to the end of the file
+	sml_export inline constexpr uint64_t binary_unknown_count = ~uint64_t(0);
+
+	namespace detail {
+
+		inline constexpr size_t binary_header_bytes = 64;
+		inline constexpr std::array<char, 4> binary_magic = { 'S', 'M', 'L', 'B' };
+
+		// Objects are (de)serialised through a buffer of this many scalars when they cannot be copied directly
+		inline constexpr size_t binary_chunk_scalars = 4096;
+
+		enum class binary_object : uint8_t { vector = 1, matrix = 2, quaternion = 3 };
+		enum class binary_scalar : uint8_t { signed_integer = 1, unsigned_integer = 2, floating_point = 3 };
+
+		// Shape of each serialisable type, and its elements in file order: row by row for a Matrix, q0 first for a Quaternion
+		template<class Object>
+		struct serial_traits {
+			static constexpr bool enabled = false;
+		};
+
+		template<arithmetic T, size_t elements>
+		struct serial_traits<Vector<T, elements>> {
+			static constexpr bool enabled = true;
+			using value_type = T;
+			static constexpr binary_object kind = binary_object::vector;
+			static constexpr size_t rows = elements;
+			static constexpr size_t cols = 1;
+			static inline T get(const Vector<T, elements>& v, size_t i) { return v[i]; }
+			static inline void set(Vector<T, elements>& v, size_t i, T x) { v[i] = x; }
+		};
+
+		template<arithmetic T, size_t nrows, size_t ncols>
+		struct serial_traits<Matrix<T, nrows, ncols>> {
+			static constexpr bool enabled = true;
+			using value_type = T;
+			static constexpr binary_object kind = binary_object::matrix;
+			static constexpr size_t rows = nrows;
+			static constexpr size_t cols = ncols;
+			static inline T get(const Matrix<T, nrows, ncols>& m, size_t i) { return m.data[i]; }
+			static inline void set(Matrix<T, nrows, ncols>& m, size_t i, T x) { m.data[i] = x; }
+		};
+
+		template<arithmetic T>
+		struct serial_traits<Quaternion<T>> {
+			static constexpr bool enabled = true;
+			using value_type = T;
+			static constexpr binary_object kind = binary_object::quaternion;
+			static constexpr size_t rows = 4;
+			static constexpr size_t cols = 1;
+			static inline T get(const Quaternion<T>& q, size_t i) { return q[i]; }
+			static inline void set(Quaternion<T>& q, size_t i, T x) { q[i] = x; }
+		};
+
+		template<class Object>
+		concept serialisable = serial_traits<Object>::enabled;
+
+		template<serialisable Object>
+		inline constexpr size_t serial_scalars = serial_traits<Object>::rows * serial_traits<Object>::cols;
+
+		template<serialisable Object>
+		inline constexpr size_t binary_record_bytes = serial_scalars<Object> * sizeof(typename serial_traits<Object>::value_type);
+
+		// True if an array of Object has exactly the bytes of its records in a file, so it can be copied (or mapped)
+		// as a block: no padding, and a little-endian target
+		template<serialisable Object>
+		inline constexpr bool binary_contiguous = std::is_trivially_copyable_v<Object>
+			&& (sizeof(Object) == binary_record_bytes<Object>)
+			&& (std::endian::native == std::endian::little);
+
+		template<arithmetic T>
+		inline constexpr binary_scalar binary_scalar_kind = std::floating_point<T> ? binary_scalar::floating_point
+			: (std::is_signed_v<T> ? binary_scalar::signed_integer : binary_scalar::unsigned_integer);
+
+		// Reverse the bytes of x on big-endian targets, so that it is stored (or was stored) little-endian
+		template<arithmetic T>
+		inline T little_endian(T x) {
+			if constexpr ((std::endian::native == std::endian::little) || (sizeof(T) == 1)) {
+				return x;
+			}
+			else {
+				using U = std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>;
+				return std::bit_cast<T>(std::byteswap(std::bit_cast<U>(x)));
+			}
+		}
+
+		template<std::unsigned_integral U>
+		inline void store_le(unsigned char* p, U x) {
+			for (size_t i = 0; i < sizeof(U); i++) {
+				p[i] = static_cast<unsigned char>(x >> (8 * i));
+			}
+		}
+
+		template<std::unsigned_integral U>
+		inline U load_le(const unsigned char* p) {
+			U x = 0;
+			for (size_t i = 0; i < sizeof(U); i++) {
+				x |= static_cast<U>(p[i]) << (8 * i);
+			}
+			return x;
+		}
+
+		template<serialisable Object>
+		inline std::array<unsigned char, binary_header_bytes> binary_header(uint64_t count) {
+			using T = typename serial_traits<Object>::value_type;
+			std::array<unsigned char, binary_header_bytes> h = {};
+			std::memcpy(h.data(), binary_magic.data(), binary_magic.size());
+			store_le<uint16_t>(h.data() + 4, binary_format_version);
+			h[6] = static_cast<unsigned char>(serial_traits<Object>::kind);
+			h[7] = static_cast<unsigned char>(binary_scalar_kind<T>);
+			h[8] = static_cast<unsigned char>(sizeof(T));
+			store_le<uint32_t>(h.data() + 12, static_cast<uint32_t>(serial_traits<Object>::rows));
+			store_le<uint32_t>(h.data() + 16, static_cast<uint32_t>(serial_traits<Object>::cols));
+			store_le<uint32_t>(h.data() + 20, static_cast<uint32_t>(binary_header_bytes));
+			store_le<uint64_t>(h.data() + 24, count);
+			return h;
+		}
+
+		struct binary_layout {
+			uint64_t count;
+			size_t data_offset;
+		};
+
+		// Check that a header describes a file of Objects, returning the number of objects and where they start
+		template<serialisable Object>
+		inline binary_layout parse_binary_header(const unsigned char* h) {
+			using T = typename serial_traits<Object>::value_type;
+			if (std::memcmp(h, binary_magic.data(), binary_magic.size()) != 0) {
+				throw std::runtime_error("sml: not an SML binary file");
+			}
+			if (load_le<uint16_t>(h + 4) > binary_format_version) {
+				throw std::runtime_error("sml: binary file is from a newer version of the format");
+			}
+			if ((h[6] != static_cast<unsigned char>(serial_traits<Object>::kind))
+				|| (h[7] != static_cast<unsigned char>(binary_scalar_kind<T>)) || (h[8] != sizeof(T))
+				|| (load_le<uint32_t>(h + 12) != serial_traits<Object>::rows) || (load_le<uint32_t>(h + 16) != serial_traits<Object>::cols)) {
+				throw std::runtime_error("sml: binary file holds a different type of object");
+			}
+			const size_t offset = load_le<uint32_t>(h + 20);
+			if (offset < binary_header_bytes) {
+				throw std::runtime_error("sml: corrupt binary file header");
+			}
+			return { load_le<uint64_t>(h + 24), offset };
+		}
+
+		// Scalars of n objects, in file order and byte order, to out
+		template<serialisable Object>
+		inline void pack_binary(const Object* in, size_t n, typename serial_traits<Object>::value_type* out) {
+			constexpr size_t k = serial_scalars<Object>;
+			for (size_t i = 0; i < n; i++) {
+				for (size_t j = 0; j < k; j++) {
+					out[(i * k) + j] = little_endian(serial_traits<Object>::get(in[i], j));
+				}
+			}
+		}
+
+		template<serialisable Object>
+		inline void unpack_binary(const typename serial_traits<Object>::value_type* in, size_t n, Object* out) {
+			constexpr size_t k = serial_scalars<Object>;
+			for (size_t i = 0; i < n; i++) {
+				for (size_t j = 0; j < k; j++) {
+					serial_traits<Object>::set(out[i], j, little_endian(in[(i * k) + j]));
+				}
+			}
+		}
+
+		// Bytes from the read position of is to its end, or binary_unknown_count if it cannot seek
+		inline uint64_t binary_bytes_left(std::istream& is) {
+			const std::streampos here = is.tellg();
+			if (here == std::streampos(-1)) {
+				return binary_unknown_count;
+			}
+			is.seekg(0, std::ios::end);
+			const std::streampos end = is.tellg();
+			is.clear();
+			is.seekg(here);
+			return ((end == std::streampos(-1)) || (end < here)) ? binary_unknown_count : static_cast<uint64_t>(end - here);
+		}
+
+	} // !namespace detail
+
+	// Writes objects one at a time or a span at a time to a binary stream. The number of objects is filled in to the
+	// header by finish() (or the destructor) if the stream can seek, and is otherwise left as binary_unknown_count
+	sml_export template<class Object> requires detail::serialisable<Object>
+	class BinaryWriter {
+	public:
+		using value_type = typename detail::serial_traits<Object>::value_type;
+
+		explicit BinaryWriter(std::ostream& os) : os(os), start(os.tellp()) {
+			const auto header = detail::binary_header<Object>(binary_unknown_count);
+			os.write(reinterpret_cast<const char*>(header.data()), header.size());
+			check();
+		}
+		BinaryWriter(const BinaryWriter&) = delete;
+		BinaryWriter& operator=(const BinaryWriter&) = delete;
+		~BinaryWriter() {
+			if (!finished) {
+				try {
+					finish();
+				}
+				catch (...) {
+				}
+			}
+		}
+
+		inline void write(const Object& o) { write(std::span<const Object>(&o, 1)); }
+
+		inline void write(std::span<const Object> objects) {
+			if constexpr (detail::binary_contiguous<Object>) {
+				os.write(reinterpret_cast<const char*>(objects.data()), static_cast<std::streamsize>(objects.size_bytes()));
+			}
+			else {
+				constexpr size_t per_chunk = std::max<size_t>(1, detail::binary_chunk_scalars / detail::serial_scalars<Object>);
+				std::vector<value_type> buffer(per_chunk * detail::serial_scalars<Object>);
+				for (size_t i = 0; i < objects.size(); i += per_chunk) {
+					const size_t n = std::min(per_chunk, objects.size() - i);
+					detail::pack_binary(objects.data() + i, n, buffer.data());
+					os.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(n * detail::binary_record_bytes<Object>));
+				}
+			}
+			check();
+			count += objects.size();
+		}
+
+		// Number of objects written so far
+		inline size_t size() const noexcept { return count; }
+
+		// Record the number of objects in the header, if the stream allows it, and flush
+		inline void finish() {
+			finished = true;
+			if (start != std::streampos(-1)) {
+				const std::streampos end = os.tellp();
+				unsigned char n[8];
+				detail::store_le<uint64_t>(n, count);
+				os.seekp(start + std::streamoff(24));
+				os.write(reinterpret_cast<const char*>(n), sizeof(n));
+				os.seekp(end);
+			}
+			os.flush();
+			check();
+		}
+
+	private:
+		inline void check() const {
+			if (!os) {
+				throw std::runtime_error("sml: failed to write binary stream");
+			}
+		}
+
+		std::ostream& os;
+		std::streampos start;
+		size_t count = 0;
+		bool finished = false;
+	};
+
+	// Reads the objects of a binary stream written by BinaryWriter, in order, a span at a time
+	sml_export template<class Object> requires detail::serialisable<Object>
+	class BinaryReader {
+	public:
+		using value_type = typename detail::serial_traits<Object>::value_type;
+
+		explicit BinaryReader(std::istream& is) : is(is) {
+			std::array<unsigned char, detail::binary_header_bytes> header;
+			if (!is.read(reinterpret_cast<char*>(header.data()), header.size())) {
+				throw std::runtime_error("sml: binary stream is too short for its header");
+			}
+			const detail::binary_layout layout = detail::parse_binary_header<Object>(header.data());
+			is.ignore(static_cast<std::streamsize>(layout.data_offset - detail::binary_header_bytes));
+			remaining = layout.count;
+		}
+
+		// Number of objects in the stream, or binary_unknown_count if it was not recorded
+		inline uint64_t size() const noexcept { return (remaining == binary_unknown_count) ? remaining : (remaining + count); }
+
+		// Read up to out.size() objects to the start of out, returning how many were read: fewer only at the end
+		inline size_t read(std::span<Object> out) {
+			const size_t wanted = (remaining == binary_unknown_count) ? out.size() : static_cast<size_t>(std::min<uint64_t>(out.size(), remaining));
+			size_t n = 0;
+			if constexpr (detail::binary_contiguous<Object>) {
+				is.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(wanted * sizeof(Object)));
+				n = static_cast<size_t>(is.gcount()) / sizeof(Object);
+			}
+			else {
+				constexpr size_t per_chunk = std::max<size_t>(1, detail::binary_chunk_scalars / detail::serial_scalars<Object>);
+				std::vector<value_type> buffer(per_chunk * detail::serial_scalars<Object>);
+				while (n < wanted) {
+					const size_t chunk = std::min(per_chunk, wanted - n);
+					is.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(chunk * detail::binary_record_bytes<Object>));
+					const size_t got = static_cast<size_t>(is.gcount()) / detail::binary_record_bytes<Object>;
+					detail::unpack_binary(buffer.data(), got, out.data() + n);
+					n += got;
+					if (got < chunk) {
+						break;
+					}
+				}
+			}
+			if ((remaining != binary_unknown_count) && (n < wanted)) {
+				throw std::runtime_error("sml: binary stream ended early");
+			}
+			if (remaining != binary_unknown_count) {
+				remaining -= n;
+			}
+			count += n;
+			return n;
+		}
+
+		// Read the next object, returning false at the end of the stream
+		inline bool read(Object& o) { return read(std::span<Object>(&o, 1)) == 1; }
+
+	private:
+		std::istream& is;
+		uint64_t remaining = 0;
+		size_t count = 0;
+	};
+
+	// Write all of objects to a stream or to a new file
+	sml_export template<class Object> requires detail::serialisable<Object>
+	void write_binary(std::ostream& os, std::span<const Object> objects) {
+		BinaryWriter<Object> writer(os);
+		writer.write(objects);
+		writer.finish();
+	}
+	sml_export template<class Object> requires detail::serialisable<Object>
+	void write_binary(const std::filesystem::path& path, std::span<const Object> objects) {
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			throw std::runtime_error("sml: cannot create " + path.string());
+		}
+		write_binary(file, objects);
+	}
+
+	// Read every object of a stream or file
+	// The count in the header is checked against the length of the stream before anything is allocated for it, so
+	// a corrupt count fails as a short stream would. Streams that cannot seek are read, and grown in to, a chunk at a
+	// time instead
+	sml_export template<class Object> requires detail::serialisable<Object>
+	std::vector<Object> read_binary(std::istream& is) {
+		BinaryReader<Object> reader(is);
+		std::vector<Object> ret;
+		const uint64_t count = reader.size();
+		if (count != binary_unknown_count) {
+			const uint64_t bytes = detail::binary_bytes_left(is);
+			if (bytes != binary_unknown_count) {
+				if (count > bytes / detail::binary_record_bytes<Object>) {
+					throw std::runtime_error("sml: binary stream ended early");
+				}
+				ret.resize(static_cast<size_t>(count));
+				reader.read(ret);
+				return ret;
+			}
+			constexpr size_t per_chunk = std::max<size_t>(1, detail::binary_chunk_scalars / detail::serial_scalars<Object>);
+			while (ret.size() < count) {
+				const size_t done = ret.size();
+				ret.resize(done + static_cast<size_t>(std::min<uint64_t>(per_chunk, count - done)));
+				reader.read(std::span<Object>(ret).subspan(done));
+			}
+			return ret;
+		}
+		Object o;
+		while (reader.read(o)) {
+			ret.push_back(o);
+		}
+		return ret;
+	}
+	sml_export template<class Object> requires detail::serialisable<Object>
+	std::vector<Object> read_binary(const std::filesystem::path& path) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			throw std::runtime_error("sml: cannot open " + path.string());
+		}
+		return read_binary<Object>(file);
+	}
+
+	// Read-only view of a binary file mapped in to memory, whose objects are used in place without being copied
+	// Only types laid out in memory exactly as in the file can be mapped: no padding, and a little-endian target
+	sml_export template<class Object> requires detail::serialisable<Object>
+	class MappedArray {
+		static_assert(detail::binary_contiguous<Object>, "MappedArray needs objects laid out exactly as in the file; use BinaryReader instead");
+		static_assert(alignof(Object) <= detail::binary_header_bytes, "Objects in a mapped file are only aligned to its header size");
+	public:
+		MappedArray() noexcept {}
+		explicit MappedArray(const std::filesystem::path& path) { open(path); }
+		MappedArray(const MappedArray&) = delete;
+		MappedArray& operator=(const MappedArray&) = delete;
+		MappedArray(MappedArray&& other) noexcept { swap(other); }
+		MappedArray& operator=(MappedArray&& other) noexcept {
+			MappedArray(std::move(other)).swap(*this);
+			return *this;
+		}
+		~MappedArray() { close(); }
+
+		// Map path, replacing any file already mapped
+		inline void open(const std::filesystem::path& path) {
+			close();
+			map(path);
+			if (bytes < detail::binary_header_bytes) {
+				close();
+				throw std::runtime_error("sml: " + path.string() + " is too short for its header");
+			}
+			try {
+				const auto* base = static_cast<const unsigned char*>(address);
+				const detail::binary_layout layout = detail::parse_binary_header<Object>(base);
+				const size_t available = (bytes >= layout.data_offset) ? (bytes - layout.data_offset) / sizeof(Object) : 0;
+				if ((layout.data_offset % alignof(Object)) != 0) {
+					throw std::runtime_error("sml: objects in " + path.string() + " are misaligned for mapping");
+				}
+				if ((layout.count != binary_unknown_count) && (layout.count > available)) {
+					throw std::runtime_error("sml: " + path.string() + " is shorter than its header says");
+				}
+				const size_t n = (layout.count == binary_unknown_count) ? available : static_cast<size_t>(layout.count);
+				objects = std::span<const Object>(reinterpret_cast<const Object*>(base + layout.data_offset), n);
+			}
+			catch (...) {
+				close();
+				throw;
+			}
+		}
+
+		inline void close() noexcept {
+			if (address != nullptr) {
+#if defined(_WIN32)
+				UnmapViewOfFile(address);
+#else
+				munmap(address, bytes);
+#endif
+			}
+			address = nullptr;
+			bytes = 0;
+			objects = {};
+		}
+
+		inline bool is_open() const noexcept { return address != nullptr; }
+
+		inline std::span<const Object> span() const noexcept { return objects; }
+		inline operator std::span<const Object>() const noexcept { return objects; }
+
+		inline const Object& operator[](size_t i) const {
+			SML_CHECK_INDEX(i, objects.size());
+			return objects[i];
+		}
+		inline size_t size() const noexcept { return objects.size(); }
+		inline bool empty() const noexcept { return objects.empty(); }
+		inline const Object* data() const noexcept { return objects.data(); }
+		inline auto begin() const noexcept { return objects.begin(); }
+		inline auto end() const noexcept { return objects.end(); }
+
+		inline void swap(MappedArray& other) noexcept {
+			std::swap(address, other.address);
+			std::swap(bytes, other.bytes);
+			std::swap(objects, other.objects);
+		}
+
+	private:
+		// Map the whole of the file read-only, setting address and bytes
+		inline void map(const std::filesystem::path& path) {
+#if defined(_WIN32)
+			HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE) {
+				throw std::runtime_error("sml: cannot open " + path.string());
+			}
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file, &size) || (size.QuadPart == 0)) {
+				CloseHandle(file);
+				throw std::runtime_error("sml: cannot map " + path.string());
+			}
+			HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			CloseHandle(file);
+			if (mapping == nullptr) {
+				throw std::runtime_error("sml: cannot map " + path.string());
+			}
+			address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping);
+			if (address == nullptr) {
+				throw std::runtime_error("sml: cannot map " + path.string());
+			}
+			bytes = static_cast<size_t>(size.QuadPart);
+#else
+			const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0) {
+				throw std::runtime_error("sml: cannot open " + path.string());
+			}
+			struct stat info;
+			if ((fstat(fd, &info) != 0) || (info.st_size == 0)) {
+				::close(fd);
+				throw std::runtime_error("sml: cannot map " + path.string());
+			}
+			void* p = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd);
+			if (p == MAP_FAILED) {
+				throw std::runtime_error("sml: cannot map " + path.string());
+			}
+			// Objects are usually read from start to end
+			madvise(p, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+			address = p;
+			bytes = static_cast<size_t>(info.st_size);
+#endif
+		}
+
+		void* address = nullptr;
+		size_t bytes = 0;
+		std::span<const Object> objects;
+	};
+
+}
+#endif // !SML_SERIALIZE_HPP
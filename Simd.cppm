@@ -0,0 +1,23 @@
+module;
+
+#include "Config.hpp"
+#if defined(SML_SIMD_SSE)
+#include <immintrin.h>
+#elif defined(SML_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+export module sml:Simd;
+
+#ifdef SML_NO_IMPORT_STD
+import <cstddef>;
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+#define SML_MODULE_SIMD
+#include "Simd.hpp"
\ No newline at end of file
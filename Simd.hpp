@@ -0,0 +1,383 @@
+#ifndef SML_SIMD_HPP
+#define SML_SIMD_HPP
+
+#include "Config.hpp"
+
+#ifndef SML_MODULE_SIMD
+
+#include <cstddef>
+#if defined(SML_SIMD_SSE)
+#include <immintrin.h>
+#elif defined(SML_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#endif // !SML_MODULE_SIMD
+
+namespace sml {
+
+	namespace detail {
+
+		// Explicit SIMD kernels backing Vector<float, 3>, Vector<float, 4>, Vector<double, 2> and Vector<double, 4>
+		// simd_ops<T, elements>::enabled is only true for the combinations supported by the target, and every
+		// specialisation provides the same set of static functions so that Vector can use them interchangeably
+		template<class T, size_t elements>
+		struct simd_ops {
+			static constexpr bool enabled = false;
+			static constexpr size_t alignment = alignof(T);
+		};
+
+		template<class T, size_t elements>
+		inline constexpr bool simd_enabled = simd_ops<T, elements>::enabled;
+
+		// Alignment of the storage of a Vector, which is raised to the register width when a SIMD backend is in use
+		template<class T, size_t elements>
+		inline constexpr size_t simd_alignment = simd_ops<T, elements>::alignment;
+
+#if defined(SML_SIMD_SSE)
+
+		// Four packed floats
+		struct simd_f32x4 {
+			using reg = __m128;
+			static constexpr bool enabled = true;
+
+			static inline reg broadcast(float t) { return _mm_set1_ps(t); }
+			static inline reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+			static inline reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+			static inline reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+			static inline reg div(reg a, reg b) { return _mm_div_ps(a, b); }
+			static inline reg sqrt(reg v) { return _mm_sqrt_ps(v); }
+			// The magnitudes of a with the signs of b
+			static inline reg copysign(reg a, reg b) {
+				const reg sign = _mm_set1_ps(-0.0f);
+				return _mm_or_ps(_mm_andnot_ps(sign, a), _mm_and_ps(sign, b));
+			}
+			// a * b + c
+			static inline reg fma(reg a, reg b, reg c) {
+#if defined(SML_SIMD_FMA)
+				return _mm_fmadd_ps(a, b, c);
+#else
+				return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+			}
+			// Sum of all four lanes
+			static inline float hsum(reg v) {
+				reg shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+				reg sums = _mm_add_ps(v, shuf);
+				shuf = _mm_movehl_ps(shuf, sums);
+				return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+			}
+			// Sum of all four lanes in double, one lane at a time from zero, as a loop accumulating in double adds them
+			static inline double hsum_double(reg v) {
+				const __m128d lo = _mm_cvtps_pd(v);
+				const __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+				__m128d sum = _mm_add_sd(_mm_setzero_pd(), lo);
+				sum = _mm_add_sd(sum, _mm_unpackhi_pd(lo, lo));
+				sum = _mm_add_sd(sum, hi);
+				return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(hi, hi)));
+			}
+			// Repack the (x, y, z) of four registers into three, as twelve consecutive floats
+			static inline void pack_xyz(reg r0, reg r1, reg r2, reg r3, reg& o0, reg& o1, reg& o2) {
+				o0 = _mm_shuffle_ps(r0, _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(0, 0, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+				o1 = _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(1, 0, 2, 1));
+				o2 = _mm_shuffle_ps(_mm_shuffle_ps(r2, r3, _MM_SHUFFLE(0, 0, 2, 2)), r3, _MM_SHUFFLE(2, 1, 2, 0));
+			}
+			// Non-temporal store to a 16-byte aligned address, bypassing the cache; follow a run of these with fence()
+			static inline void stream(float* p, reg v) { _mm_stream_ps(p, v); }
+			static inline void fence() { _mm_sfence(); }
+			// Transpose the 4x4 block held one row per register
+			static inline void transpose4(reg& r0, reg& r1, reg& r2, reg& r3) { _MM_TRANSPOSE4_PS(r0, r1, r2, r3); }
+			// (a, b, c, d) to (b, a, d, c), (c, d, a, b) and (d, c, b, a)
+			static inline reg swap_pairs(reg v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)); }
+			static inline reg swap_halves(reg v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)); }
+			static inline reg reverse(reg v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3)); }
+			// Lane-wise maximum, comparisons giving all-ones lanes where true, and a or b by such a mask
+			static inline reg max(reg a, reg b) { return _mm_max_ps(a, b); }
+			static inline reg greater_equal(reg a, reg b) { return _mm_cmpge_ps(a, b); }
+			static inline reg equal(reg a, reg b) { return _mm_cmpeq_ps(a, b); }
+			static inline reg select(reg mask, reg a, reg b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+		};
+
+		template<>
+		struct simd_ops<float, 4> : simd_f32x4 {
+			static constexpr size_t alignment = 16;
+
+			static inline reg load(const float* p) { return _mm_loadu_ps(p); }
+			static inline void store(float* p, reg v) { _mm_storeu_ps(p, v); }
+			static inline float dot(const float* a, const float* b) { return hsum(_mm_mul_ps(load(a), load(b))); }
+			static inline double dot_double(const float* a, const float* b) { return hsum_double(_mm_mul_ps(load(a), load(b))); }
+		};
+
+		// Vector<float, 3> is kept at 12 bytes so that arrays of them match vertex buffer layouts
+		// It is loaded into the low three lanes of a register, with the top lane zeroed
+		template<>
+		struct simd_ops<float, 3> : simd_f32x4 {
+			static constexpr size_t alignment = alignof(float);
+
+			// x and y are loaded as a pair by movlps, which has no alignment requirement and, unlike a double load, does
+			// not read the floats through another type
+			static inline reg load(const float* p) {
+				return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p)), _mm_load_ss(p + 2));
+			}
+			static inline void store(float* p, reg v) {
+				_mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+				_mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+			}
+			static inline float dot(const float* a, const float* b) { return hsum(_mm_mul_ps(load(a), load(b))); }
+			static inline double dot_double(const float* a, const float* b) { return hsum_double(_mm_mul_ps(load(a), load(b))); }
+			static inline reg cross(reg a, reg b) {
+				const reg a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+				const reg b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+				const reg c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+				return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+			}
+		};
+
+		// Two packed doubles
+		template<>
+		struct simd_ops<double, 2> {
+			using reg = __m128d;
+			static constexpr bool enabled = true;
+			static constexpr size_t alignment = 16;
+
+			static inline reg load(const double* p) { return _mm_loadu_pd(p); }
+			static inline void store(double* p, reg v) { _mm_storeu_pd(p, v); }
+			static inline reg broadcast(double t) { return _mm_set1_pd(t); }
+			static inline reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+			static inline reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+			static inline reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+			static inline reg div(reg a, reg b) { return _mm_div_pd(a, b); }
+			static inline reg fma(reg a, reg b, reg c) {
+#if defined(SML_SIMD_FMA)
+				return _mm_fmadd_pd(a, b, c);
+#else
+				return _mm_add_pd(_mm_mul_pd(a, b), c);
+#endif
+			}
+			static inline double hsum(reg v) { return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v))); }
+			static inline double dot(const double* a, const double* b) { return hsum(_mm_mul_pd(load(a), load(b))); }
+			static inline double dot_double(const double* a, const double* b) { return dot(a, b); }
+		};
+
+#if defined(SML_SIMD_AVX)
+		// Four packed doubles in one AVX register
+		template<>
+		struct simd_ops<double, 4> {
+			using reg = __m256d;
+			static constexpr bool enabled = true;
+			static constexpr size_t alignment = 32;
+
+			static inline reg load(const double* p) { return _mm256_loadu_pd(p); }
+			static inline void store(double* p, reg v) { _mm256_storeu_pd(p, v); }
+			static inline reg broadcast(double t) { return _mm256_set1_pd(t); }
+			static inline reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+			static inline reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+			static inline reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+			static inline reg div(reg a, reg b) { return _mm256_div_pd(a, b); }
+			static inline reg fma(reg a, reg b, reg c) {
+#if defined(SML_SIMD_FMA)
+				return _mm256_fmadd_pd(a, b, c);
+#else
+				return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+			}
+			static inline double hsum(reg v) {
+				return simd_ops<double, 2>::hsum(_mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1)));
+			}
+			static inline double dot(const double* a, const double* b) { return hsum(_mm256_mul_pd(load(a), load(b))); }
+			static inline double dot_double(const double* a, const double* b) { return dot(a, b); }
+			// (a, b, c, d) to (b, a, d, c), (c, d, a, b) and (d, c, b, a)
+			static inline reg swap_pairs(reg v) { return _mm256_permute_pd(v, 0x5); }
+			static inline reg swap_halves(reg v) { return _mm256_permute2f128_pd(v, v, 0x1); }
+			static inline reg reverse(reg v) { return swap_pairs(swap_halves(v)); }
+		};
+
+		// Eight packed floats, holding two rows of a 4x4 float matrix; not a Vector backend
+		struct simd_f32x8 {
+			using reg = __m256;
+
+			static inline reg load(const float* p) { return _mm256_loadu_ps(p); }
+			static inline void store(float* p, reg v) { _mm256_storeu_ps(p, v); }
+			// The four floats at p in both halves of the register
+			static inline reg broadcast4(const float* p) { return _mm256_broadcast_ps(reinterpret_cast<const __m128*>(p)); }
+			// Lane i of each half of v, repeated across that half
+			template<int i>
+			static inline reg splat(reg v) { return _mm256_permute_ps(v, i * 0x55); }
+			static inline reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+			static inline reg fma(reg a, reg b, reg c) {
+#if defined(SML_SIMD_FMA)
+				return _mm256_fmadd_ps(a, b, c);
+#else
+				return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+			}
+		};
+#else
+		// Four packed doubles as a pair of SSE registers
+		template<>
+		struct simd_ops<double, 4> {
+			using half = simd_ops<double, 2>;
+			struct reg { __m128d lo, hi; };
+			static constexpr bool enabled = true;
+			static constexpr size_t alignment = 16;
+
+			static inline reg load(const double* p) { return { half::load(p), half::load(p + 2) }; }
+			static inline void store(double* p, reg v) { half::store(p, v.lo); half::store(p + 2, v.hi); }
+			static inline reg broadcast(double t) { return { half::broadcast(t), half::broadcast(t) }; }
+			static inline reg add(reg a, reg b) { return { half::add(a.lo, b.lo), half::add(a.hi, b.hi) }; }
+			static inline reg sub(reg a, reg b) { return { half::sub(a.lo, b.lo), half::sub(a.hi, b.hi) }; }
+			static inline reg mul(reg a, reg b) { return { half::mul(a.lo, b.lo), half::mul(a.hi, b.hi) }; }
+			static inline reg div(reg a, reg b) { return { half::div(a.lo, b.lo), half::div(a.hi, b.hi) }; }
+			static inline reg fma(reg a, reg b, reg c) { return { half::fma(a.lo, b.lo, c.lo), half::fma(a.hi, b.hi, c.hi) }; }
+			static inline double hsum(reg v) { return half::hsum(half::add(v.lo, v.hi)); }
+			static inline double dot(const double* a, const double* b) { return hsum(mul(load(a), load(b))); }
+			static inline double dot_double(const double* a, const double* b) { return dot(a, b); }
+			// (a, b, c, d) to (b, a, d, c), (c, d, a, b) and (d, c, b, a)
+			static inline reg swap_pairs(reg v) { return { _mm_shuffle_pd(v.lo, v.lo, 1), _mm_shuffle_pd(v.hi, v.hi, 1) }; }
+			static inline reg swap_halves(reg v) { return { v.hi, v.lo }; }
+			static inline reg reverse(reg v) { return swap_pairs(swap_halves(v)); }
+		};
+#endif // SML_SIMD_AVX
+
+#elif defined(SML_SIMD_NEON)
+
+		// Four packed floats
+		struct simd_f32x4 {
+			using reg = float32x4_t;
+			static constexpr bool enabled = true;
+
+			static inline reg broadcast(float t) { return vdupq_n_f32(t); }
+			static inline reg add(reg a, reg b) { return vaddq_f32(a, b); }
+			static inline reg sub(reg a, reg b) { return vsubq_f32(a, b); }
+			static inline reg mul(reg a, reg b) { return vmulq_f32(a, b); }
+			static inline reg div(reg a, reg b) { return vdivq_f32(a, b); }
+			static inline reg sqrt(reg v) { return vsqrtq_f32(v); }
+			// The magnitudes of a with the signs of b
+			static inline reg copysign(reg a, reg b) { return vbslq_f32(vdupq_n_u32(0x80000000u), b, a); }
+			static inline reg fma(reg a, reg b, reg c) { return vfmaq_f32(c, a, b); }
+			static inline float hsum(reg v) { return vaddvq_f32(v); }
+			// Sum of all four lanes in double, one lane at a time from zero, as a loop accumulating in double adds them
+			static inline double hsum_double(reg v) {
+				const float64x2_t lo = vcvt_f64_f32(vget_low_f32(v));
+				const float64x2_t hi = vcvt_high_f64_f32(v);
+				return (((0.0 + vgetq_lane_f64(lo, 0)) + vgetq_lane_f64(lo, 1)) + vgetq_lane_f64(hi, 0)) + vgetq_lane_f64(hi, 1);
+			}
+			// Repack the (x, y, z) of four registers into three, as twelve consecutive floats
+			static inline void pack_xyz(reg r0, reg r1, reg r2, reg r3, reg& o0, reg& o1, reg& o2) {
+				o0 = vsetq_lane_f32(vgetq_lane_f32(r1, 0), r0, 3);
+				o1 = vcombine_f32(vget_low_f32(vextq_f32(r1, r1, 1)), vget_low_f32(r2));
+				o2 = vsetq_lane_f32(vgetq_lane_f32(r2, 2), vextq_f32(r3, r3, 3), 0);
+			}
+			// NEON has no non-temporal stores, so these are plain stores
+			static inline void stream(float* p, reg v) { vst1q_f32(p, v); }
+			static inline void fence() {}
+			// Transpose the 4x4 block held one row per register
+			static inline void transpose4(reg& r0, reg& r1, reg& r2, reg& r3) {
+				const float32x4x2_t t01 = vtrnq_f32(r0, r1);
+				const float32x4x2_t t23 = vtrnq_f32(r2, r3);
+				r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+				r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+				r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+				r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+			}
+			// (a, b, c, d) to (b, a, d, c), (c, d, a, b) and (d, c, b, a)
+			static inline reg swap_pairs(reg v) { return vrev64q_f32(v); }
+			static inline reg swap_halves(reg v) { return vextq_f32(v, v, 2); }
+			static inline reg reverse(reg v) { return vrev64q_f32(vextq_f32(v, v, 2)); }
+			// Lane-wise maximum, comparisons giving all-ones lanes where true, and a or b by such a mask
+			static inline reg max(reg a, reg b) { return vmaxq_f32(a, b); }
+			static inline reg greater_equal(reg a, reg b) { return vreinterpretq_f32_u32(vcgeq_f32(a, b)); }
+			static inline reg equal(reg a, reg b) { return vreinterpretq_f32_u32(vceqq_f32(a, b)); }
+			static inline reg select(reg mask, reg a, reg b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+		};
+
+		template<>
+		struct simd_ops<float, 4> : simd_f32x4 {
+			static constexpr size_t alignment = 16;
+
+			static inline reg load(const float* p) { return vld1q_f32(p); }
+			static inline void store(float* p, reg v) { vst1q_f32(p, v); }
+			static inline float dot(const float* a, const float* b) { return hsum(vmulq_f32(load(a), load(b))); }
+			static inline double dot_double(const float* a, const float* b) { return hsum_double(vmulq_f32(load(a), load(b))); }
+		};
+
+		// Vector<float, 3> is kept at 12 bytes so that arrays of them match vertex buffer layouts
+		// It is loaded into the low three lanes of a register, with the top lane zeroed
+		template<>
+		struct simd_ops<float, 3> : simd_f32x4 {
+			static constexpr size_t alignment = alignof(float);
+
+			static inline reg load(const float* p) { return vcombine_f32(vld1_f32(p), vld1_lane_f32(p + 2, vdup_n_f32(0.0f), 0)); }
+			static inline void store(float* p, reg v) {
+				vst1_f32(p, vget_low_f32(v));
+				vst1q_lane_f32(p + 2, v, 2);
+			}
+			static inline float dot(const float* a, const float* b) { return hsum(vmulq_f32(load(a), load(b))); }
+			static inline double dot_double(const float* a, const float* b) { return hsum_double(vmulq_f32(load(a), load(b))); }
+			static inline reg cross(reg a, reg b) {
+				// Rotate (x, y, z, w) to (y, z, x, w)
+				const auto yzx = [](reg v) {
+					const reg yzwx = vextq_f32(v, v, 1);
+					return vsetq_lane_f32(vgetq_lane_f32(v, 3), vsetq_lane_f32(vgetq_lane_f32(v, 0), yzwx, 2), 3);
+				};
+				const reg c = vsubq_f32(vmulq_f32(a, yzx(b)), vmulq_f32(yzx(a), b));
+				return yzx(c);
+			}
+		};
+
+		// Two packed doubles
+		template<>
+		struct simd_ops<double, 2> {
+			using reg = float64x2_t;
+			static constexpr bool enabled = true;
+			static constexpr size_t alignment = 16;
+
+			static inline reg load(const double* p) { return vld1q_f64(p); }
+			static inline void store(double* p, reg v) { vst1q_f64(p, v); }
+			static inline reg broadcast(double t) { return vdupq_n_f64(t); }
+			static inline reg add(reg a, reg b) { return vaddq_f64(a, b); }
+			static inline reg sub(reg a, reg b) { return vsubq_f64(a, b); }
+			static inline reg mul(reg a, reg b) { return vmulq_f64(a, b); }
+			static inline reg div(reg a, reg b) { return vdivq_f64(a, b); }
+			static inline reg fma(reg a, reg b, reg c) { return vfmaq_f64(c, a, b); }
+			static inline double hsum(reg v) { return vaddvq_f64(v); }
+			static inline double dot(const double* a, const double* b) { return hsum(vmulq_f64(load(a), load(b))); }
+			static inline double dot_double(const double* a, const double* b) { return dot(a, b); }
+		};
+
+		// Four packed doubles as a pair of NEON registers
+		template<>
+		struct simd_ops<double, 4> {
+			using half = simd_ops<double, 2>;
+			struct reg { float64x2_t lo, hi; };
+			static constexpr bool enabled = true;
+			static constexpr size_t alignment = 16;
+
+			static inline reg load(const double* p) { return { half::load(p), half::load(p + 2) }; }
+			static inline void store(double* p, reg v) { half::store(p, v.lo); half::store(p + 2, v.hi); }
+			static inline reg broadcast(double t) { return { half::broadcast(t), half::broadcast(t) }; }
+			static inline reg add(reg a, reg b) { return { half::add(a.lo, b.lo), half::add(a.hi, b.hi) }; }
+			static inline reg sub(reg a, reg b) { return { half::sub(a.lo, b.lo), half::sub(a.hi, b.hi) }; }
+			static inline reg mul(reg a, reg b) { return { half::mul(a.lo, b.lo), half::mul(a.hi, b.hi) }; }
+			static inline reg div(reg a, reg b) { return { half::div(a.lo, b.lo), half::div(a.hi, b.hi) }; }
+			static inline reg fma(reg a, reg b, reg c) { return { half::fma(a.lo, b.lo, c.lo), half::fma(a.hi, b.hi, c.hi) }; }
+			static inline double hsum(reg v) { return half::hsum(half::add(v.lo, v.hi)); }
+			static inline double dot(const double* a, const double* b) { return hsum(mul(load(a), load(b))); }
+			static inline double dot_double(const double* a, const double* b) { return dot(a, b); }
+			// (a, b, c, d) to (b, a, d, c), (c, d, a, b) and (d, c, b, a)
+			static inline reg swap_pairs(reg v) { return { vextq_f64(v.lo, v.lo, 1), vextq_f64(v.hi, v.hi, 1) }; }
+			static inline reg swap_halves(reg v) { return { v.hi, v.lo }; }
+			static inline reg reverse(reg v) { return swap_pairs(swap_halves(v)); }
+		};
+
+#endif // SML_SIMD_SSE / SML_SIMD_NEON
+
+	} // !namespace detail
+
+} // !namespace sml
+
+#endif // !SML_SIMD_HPP
@@ -0,0 +1,29 @@
+export module sml:Solver;
+
+#ifdef SML_NO_IMPORT_STD
+
+import <algorithm>;
+import <cmath>;
+import <concepts>;
+import <limits>;
+import <span>;
+import <type_traits>;
+import <vector>;
+
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+import :Utility;
+import :Allocator;
+import :Parallel;
+import :Vector;
+import :Matrix;
+import :DynMatrix;
+import :Sparse;
+#define SML_MODULE_SOLVER
+#include "Solver.hpp"
\ No newline at end of file
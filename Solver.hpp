@@ -0,0 +1,748 @@
+#ifndef SML_SOLVER_HPP
+#define SML_SOLVER_HPP
+
+#ifndef SML_MODULE_SOLVER
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#include "Allocator.hpp"
+#include "Parallel.hpp"
+
+#endif // !SML_MODULE_SOLVER
+
+#include "Config.hpp"
+
+// Iterative solvers for large linear systems A x = b, where A is only ever multiplied by vectors
+//
+//     sml::IncompleteCholesky<double> ic(a);         // a is a symmetric positive-definite SparseMatrix
+//     sml::SolverWorkspace<double> work;
+//     auto stats = sml::conjugate_gradient(sml::execution::par, a, b, std::span(x), ic, work);
+//     if (!stats.converged) { ... }
+//
+// A is a SparseMatrix, a square DynMatrix, or anything callable as a(x, y) to write y = A x for spans x and y, so
+// that operators which are never stored as a matrix can be solved too. conjugate_gradient() is for symmetric
+// positive-definite A, bicgstab() and gmres() for any non-singular A. x holds the initial guess on entry (zeroes if
+// there is nothing better) and the solution on return.
+//
+// Preconditioners are called in the same way, as m(r, z) to write z = M^-1 r for some M close to A and cheap to solve
+// with: JacobiPreconditioner scales by the inverse of the diagonal, and IncompleteCholesky solves with a Cholesky
+// factor of A that keeps only the nonzero pattern of A.
+//
+// The solvers keep their vectors in a SolverWorkspace, which any of them can share. It grows on the first solve that
+// needs it to and is reused after that, so that iterating never allocates (bar the buffers each thread of a parallel
+// product with a CSC matrix sums in to, which is why CSR is the form to solve with). With a parallel policy, the vector
+// updates and dot products are split across threads, as are products with a SparseMatrix or DynMatrix; dot products
+// are combined in a fixed order, so a solve takes the same steps on a pool of any size.
+
+namespace sml {
+
+	// Where a solve stopped: after how many iterations and products with A, and with what residual |b - A x| / |b|, as
+	// tracked by the iteration rather than recomputed from x
+	sml_export template<std::floating_point T>
+	struct SolverStats {
+		size_t iterations = 0;
+		size_t products = 0;
+		T residual = 0;
+		bool converged = false;
+	};
+
+	sml_export template<std::floating_point T>
+	struct SolverOptions {
+		// Stop once |b - A x| <= tolerance * |b|
+		T tolerance = std::sqrt(std::numeric_limits<T>::epsilon());
+		// Most iterations before giving up, or 0 for as many as there are unknowns
+		size_t max_iterations = 0;
+		// Krylov vectors gmres() builds up before restarting from its current solution
+		size_t restart = 30;
+	};
+
+	// Vectors for the iterative solvers, kept between solves so that they are only allocated once
+	sml_export template<std::floating_point T>
+	class SolverWorkspace {
+	public:
+		SolverWorkspace() {}
+
+		// Make room for count vectors of n elements, each starting on a cache line, followed by scalars elements. Only
+		// allocates if the workspace is too small
+		inline void reserve(size_t n, size_t count, size_t scalars = 0) {
+			constexpr size_t line = std::max<size_t>(1, 64 / sizeof(T));
+			stride = ((n + line - 1) / line) * line;
+			vectors = count;
+			if (stride * vectors + scalars > storage.size()) {
+				storage.resize(stride * vectors + scalars);
+			}
+		}
+
+		inline T* vector(size_t i) noexcept { return storage.data() + (i * stride); }
+		inline T* scalars() noexcept { return storage.data() + (vectors * stride); }
+
+		// Elements allocated
+		inline size_t capacity() const noexcept { return storage.size(); }
+
+	private:
+		std::vector<T, aligned_allocator<T>> storage;
+		size_t stride = 0;
+		size_t vectors = 0;
+	};
+
+	// M = I, for solving without a preconditioner. The solvers skip applying it altogether
+	sml_export struct IdentityPreconditioner {
+		template<class T>
+		inline void operator () (std::span<const T> r, std::span<T> z) const {
+			std::copy(r.begin(), r.end(), z.begin());
+		}
+	};
+
+	sml_export template<class M, class T>
+	concept preconditioner = std::invocable<const M&, std::span<const T>, std::span<T>>;
+
+	namespace detail {
+
+		template<class Op, class T>
+		inline constexpr bool is_sparse_operator = false;
+		template<arithmetic T, sparse_format format>
+		inline constexpr bool is_sparse_operator<SparseMatrix<T, format>, T> = true;
+
+		template<class Op, class T>
+		inline constexpr bool is_dense_operator = false;
+		template<arithmetic T, class Allocator>
+		inline constexpr bool is_dense_operator<DynMatrix<T, Allocator>, T> = true;
+
+	} // !namespace detail
+
+	sml_export template<class Op, class T>
+	concept linear_operator = detail::is_sparse_operator<Op, T> || detail::is_dense_operator<Op, T>
+		|| std::invocable<const Op&, std::span<const T>, std::span<T>>;
+
+	// z = M^-1 r for M the diagonal of A. Zeroes on the diagonal are left unscaled
+	sml_export template<std::floating_point T>
+	class JacobiPreconditioner {
+	public:
+		JacobiPreconditioner() {}
+		explicit JacobiPreconditioner(std::span<const T> diagonal) : inverse_diagonal(diagonal.size()) {
+			for (size_t i = 0; i < diagonal.size(); i++) {
+				inverse_diagonal[i] = (diagonal[i] != T(0)) ? (T(1) / diagonal[i]) : T(1);
+			}
+		}
+		template<sparse_format format>
+		explicit JacobiPreconditioner(const SparseMatrix<T, format>& a) : JacobiPreconditioner(diagonal(a)) {}
+		template<class Allocator>
+		explicit JacobiPreconditioner(const DynMatrix<T, Allocator>& a) : JacobiPreconditioner(diagonal(a)) {}
+
+		template<execution_policy Policy>
+		inline void operator () (Policy&& policy, std::span<const T> r, std::span<T> z) const {
+			detail::require_dimensions((r.size() == inverse_diagonal.size()) && (z.size() >= r.size()), "JacobiPreconditioner: dimensions do not match");
+			const T* d = inverse_diagonal.data();
+			const T* in = r.data();
+			T* out = z.data();
+			detail::for_each_element<T>(policy, r.size(), [=](size_t i) { out[i] = d[i] * in[i]; });
+		}
+		inline void operator () (std::span<const T> r, std::span<T> z) const {
+			(*this)(execution::seq, r, z);
+		}
+
+		inline size_t size() const noexcept { return inverse_diagonal.size(); }
+
+	private:
+		std::vector<T, aligned_allocator<T>> inverse_diagonal;
+
+		template<sparse_format format>
+		static std::vector<T> diagonal(const SparseMatrix<T, format>& a) {
+			detail::require_dimensions(a.rows() == a.cols(), "JacobiPreconditioner: matrix is not square");
+			std::vector<T> ret(a.rows());
+			for (size_t i = 0; i < a.rows(); i++) {
+				ret[i] = a.at(i, i);
+			}
+			return ret;
+		}
+		template<class Allocator>
+		static std::vector<T> diagonal(const DynMatrix<T, Allocator>& a) {
+			detail::require_dimensions(a.rows() == a.cols(), "JacobiPreconditioner: matrix is not square");
+			std::vector<T> ret(a.rows());
+			for (size_t i = 0; i < a.rows(); i++) {
+				ret[i] = a.data[(i * a.cols()) + i];
+			}
+			return ret;
+		}
+	};
+
+	// z = M^-1 r for M = L transpose(L), the incomplete Cholesky factorisation IC(0) of a symmetric positive-definite
+	// SparseMatrix A: L is computed as for a Cholesky factor, but only where A is nonzero below the diagonal. Only one
+	// triangle of A is read, so A must be symmetric. Pivots that are not positive, which IC(0) can give for matrices
+	// that are far from diagonally dominant, are replaced by the diagonal of A to keep M positive definite, and counted
+	// in breakdowns()
+	sml_export template<std::floating_point T>
+	class IncompleteCholesky {
+	public:
+		IncompleteCholesky() {}
+		template<sparse_format format>
+		explicit IncompleteCholesky(const SparseMatrix<T, format>& a) { factor(a); }
+
+		// (Re)factor a, replacing any previous factor
+		template<sparse_format format>
+		void factor(const SparseMatrix<T, format>& a) {
+			detail::require_dimensions(a.rows() == a.cols(), "IncompleteCholesky: matrix is not square");
+			const size_t n = a.rows();
+
+			// The entries of each row of L left of the diagonal, which for a symmetric matrix are those of its outer
+			// index before the diagonal in either format
+			offsets.assign(n + 1, 0);
+			indices.clear();
+			values.clear();
+			inverse_diagonal.assign(n, T(0));
+			for (size_t i = 0; i < n; i++) {
+				for (size_t p = a.offsets[i]; p < a.offsets[i + 1]; p++) {
+					if (a.indices[p] < i) {
+						indices.push_back(a.indices[p]);
+						values.push_back(a.values[p]);
+					}
+					else if (a.indices[p] == i) {
+						inverse_diagonal[i] = a.values[p];
+					}
+				}
+				offsets[i + 1] = indices.size();
+			}
+
+			// Row by row: L(i, k) = (A(i, k) - sum over j < k of L(i, j) L(k, j)) / L(k, k), with the sum taken over the
+			// columns both rows have, then L(i, i) = sqrt(A(i, i) - sum over j < i of L(i, j)^2). The diagonal is held
+			// in inverse_diagonal, and inverted once every row is done
+			replaced = 0;
+			for (size_t i = 0; i < n; i++) {
+				const size_t first = offsets[i];
+				T squares = 0;
+				for (size_t p = first; p < offsets[i + 1]; p++) {
+					const size_t k = indices[p];
+					T sum = values[p];
+					size_t q = first;
+					size_t s = offsets[k];
+					while ((q < p) && (s < offsets[k + 1])) {
+						if (indices[q] == indices[s]) {
+							sum -= values[q++] * values[s++];
+						}
+						else if (indices[q] < indices[s]) {
+							q++;
+						}
+						else {
+							s++;
+						}
+					}
+					values[p] = sum / inverse_diagonal[k];
+					squares += values[p] * values[p];
+				}
+				const T pivot = inverse_diagonal[i] - squares;
+				if (pivot > T(0)) {
+					inverse_diagonal[i] = std::sqrt(pivot);
+				}
+				else {
+					inverse_diagonal[i] = (inverse_diagonal[i] > T(0)) ? std::sqrt(inverse_diagonal[i]) : T(1);
+					replaced++;
+				}
+			}
+			for (T& d : inverse_diagonal) {
+				d = T(1) / d;
+			}
+		}
+
+		// Solve L y = r by forward substitution and then transpose(L) z = y by back substitution, in place in z. Both
+		// run on one thread, as each element depends on the ones before it
+		inline void operator () (std::span<const T> r, std::span<T> z) const {
+			detail::require_dimensions((r.size() == size()) && (z.size() >= r.size()), "IncompleteCholesky: dimensions do not match");
+			const size_t n = size();
+			for (size_t i = 0; i < n; i++) {
+				T sum = r[i];
+				for (size_t p = offsets[i]; p < offsets[i + 1]; p++) {
+					sum -= values[p] * z[indices[p]];
+				}
+				z[i] = sum * inverse_diagonal[i];
+			}
+			// Column i of transpose(L) is row i of L, so once z[i] is known it is scattered to the rows above it
+			for (size_t i = n; i-- > 0;) {
+				const T zi = z[i] * inverse_diagonal[i];
+				z[i] = zi;
+				for (size_t p = offsets[i]; p < offsets[i + 1]; p++) {
+					z[indices[p]] -= values[p] * zi;
+				}
+			}
+		}
+
+		inline size_t size() const noexcept { return inverse_diagonal.size(); }
+		inline size_t nonzeroes() const noexcept { return values.size() + inverse_diagonal.size(); }
+		inline size_t breakdowns() const noexcept { return replaced; }
+
+	private:
+		std::vector<size_t> offsets = { 0 };
+		std::vector<sparse_index> indices;
+		std::vector<T, aligned_allocator<T>> values;
+		std::vector<T, aligned_allocator<T>> inverse_diagonal;
+		size_t replaced = 0;
+	};
+
+	namespace detail {
+
+		// Sum of f(i) over [begin, end), in four running sums so that the additions do not wait on each other
+		template<class T, class F>
+		inline T sum_range(size_t begin, size_t end, F f) {
+			T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+			size_t i = begin;
+			for (; i + 4 <= end; i += 4) {
+				s0 += f(i);
+				s1 += f(i + 1);
+				s2 += f(i + 2);
+				s3 += f(i + 3);
+			}
+			for (; i < end; i++) {
+				s0 += f(i);
+			}
+			return (s0 + s1) + (s2 + s3);
+		}
+
+		// Sum of f(i) over [0, n), which may also update element i of any vectors it likes, so that an update and the
+		// dot product that follows it take one pass over memory rather than two
+		template<class T, execution_policy Policy, class F>
+		inline T sum_elements(Policy&& policy, size_t n, F f) {
+			return reduce_ranges<T>(policy, n, parallel_element_grain<T>,
+				[&](size_t begin, size_t end) { return sum_range<T>(begin, end, f); },
+				[](T a, T b) { return a + b; });
+		}
+
+		template<execution_policy Policy, class T>
+		inline T solver_dot(Policy&& policy, const T* a, const T* b, size_t n) {
+			return sum_elements<T>(policy, n, [=](size_t i) { return a[i] * b[i]; });
+		}
+
+		// y = a x
+		template<execution_policy Policy, class T, class Op>
+		inline void apply_operator(Policy&& policy, const Op& a, const T* x, T* y, size_t n) {
+			if constexpr (is_sparse_operator<Op, T>) {
+				multiply(policy, a, std::span<const T>(x, n), std::span<T>(y, n));
+			}
+			else if constexpr (is_dense_operator<Op, T>) {
+				const T* m = a.data.data();
+				for_each_row<T>(policy, n, n, [=](size_t i) {
+					const T* row = m + (i * n);
+					y[i] = sum_range<T>(0, n, [=](size_t j) { return row[j] * x[j]; });
+				});
+			}
+			else {
+				a(std::span<const T>(x, n), std::span<T>(y, n));
+			}
+		}
+
+		// z = m^-1 r, passing the policy on to preconditioners that take one
+		template<execution_policy Policy, class T, class Pre>
+		inline void apply_preconditioner(Policy&& policy, const Pre& m, const T* r, T* z, size_t n) {
+			if constexpr (std::invocable<const Pre&, Policy&, std::span<const T>, std::span<T>>) {
+				m(policy, std::span<const T>(r, n), std::span<T>(z, n));
+			}
+			else {
+				m(std::span<const T>(r, n), std::span<T>(z, n));
+			}
+		}
+
+		template<class Pre>
+		inline constexpr bool is_preconditioned = !std::same_as<Pre, IdentityPreconditioner>;
+
+		template<class T, class Op>
+		inline void require_system(const Op& a, size_t b_size, size_t x_size, const char* message) {
+			if constexpr (is_sparse_operator<Op, T> || is_dense_operator<Op, T>) {
+				require_dimensions((a.rows() == a.cols()) && (a.rows() == x_size), message);
+			}
+			require_dimensions(b_size == x_size, message);
+		}
+
+		template<class T>
+		inline size_t iteration_limit(const SolverOptions<T>& options, size_t n) {
+			return (options.max_iterations != 0) ? options.max_iterations : std::max<size_t>(1, n);
+		}
+
+		// Returns |b|, after setting x to zero and marking the solve converged if b is zero
+		template<execution_policy Policy, class T>
+		inline T start_solve(Policy&& policy, const T* b, T* x, size_t n, SolverStats<T>& stats) {
+			const T b_norm = std::sqrt(sum_elements<T>(policy, n, [=](size_t i) { return b[i] * b[i]; }));
+			if (b_norm == T(0)) {
+				std::fill(x, x + n, T(0));
+				stats.converged = true;
+			}
+			return b_norm;
+		}
+
+		// r = b - a x, returning |r|^2
+		template<execution_policy Policy, class T, class Op>
+		inline T residual(Policy&& policy, const Op& a, const T* b, const T* x, T* r, size_t n, SolverStats<T>& stats) {
+			apply_operator(policy, a, x, r, n);
+			stats.products++;
+			return sum_elements<T>(policy, n, [=](size_t i) {
+				r[i] = b[i] - r[i];
+				return r[i] * r[i];
+			});
+		}
+
+		// Preconditioned conjugate gradients. Each iteration takes one product with a, one application of m, and four
+		// passes over the vectors, with the updates of x and r fused with the norm of r
+		template<execution_policy Policy, class T, class Op, class Pre>
+		SolverStats<T> conjugate_gradient(Policy&& policy, const Op& a, const T* b, T* x, size_t n, const Pre& m, SolverWorkspace<T>& work, const SolverOptions<T>& options) {
+			SolverStats<T> stats;
+			const T b_norm = start_solve(policy, b, x, n, stats);
+			if (stats.converged) {
+				return stats;
+			}
+			const T target = options.tolerance * b_norm;
+
+			work.reserve(n, is_preconditioned<Pre> ? 4 : 3);
+			T* r = work.vector(0);
+			T* p = work.vector(1);
+			T* q = work.vector(2);
+			T* z = is_preconditioned<Pre> ? work.vector(3) : r;
+
+			T r_norm = std::sqrt(residual(policy, a, b, x, r, n, stats));
+			stats.residual = r_norm / b_norm;
+			if (r_norm <= target) {
+				stats.converged = true;
+				return stats;
+			}
+			T rz = r_norm * r_norm;
+			if constexpr (is_preconditioned<Pre>) {
+				apply_preconditioner(policy, m, r, z, n);
+				rz = solver_dot(policy, r, z, n);
+			}
+			std::copy(z, z + n, p);
+
+			const size_t limit = iteration_limit(options, n);
+			while (stats.iterations < limit) {
+				apply_operator(policy, a, p, q, n);
+				stats.products++;
+				const T pq = solver_dot(policy, p, q, n);
+				// a is not positive definite, or the search direction has vanished
+				if (!(pq > T(0))) {
+					break;
+				}
+				const T alpha = rz / pq;
+				r_norm = std::sqrt(sum_elements<T>(policy, n, [=](size_t i) {
+					x[i] += alpha * p[i];
+					r[i] -= alpha * q[i];
+					return r[i] * r[i];
+				}));
+				stats.iterations++;
+				stats.residual = r_norm / b_norm;
+				if (r_norm <= target) {
+					stats.converged = true;
+					break;
+				}
+
+				T rz_next = r_norm * r_norm;
+				if constexpr (is_preconditioned<Pre>) {
+					apply_preconditioner(policy, m, r, z, n);
+					rz_next = solver_dot(policy, r, z, n);
+				}
+				const T beta = rz_next / rz;
+				rz = rz_next;
+				for_each_element<T>(policy, n, [=](size_t i) { p[i] = z[i] + beta * p[i]; });
+			}
+			return stats;
+		}
+
+		// Right-preconditioned BiCGSTAB, solving a m^-1 y = b for y = m x. Each iteration takes two products with a and
+		// two applications of m
+		template<execution_policy Policy, class T, class Op, class Pre>
+		SolverStats<T> bicgstab(Policy&& policy, const Op& a, const T* b, T* x, size_t n, const Pre& m, SolverWorkspace<T>& work, const SolverOptions<T>& options) {
+			SolverStats<T> stats;
+			const T b_norm = start_solve(policy, b, x, n, stats);
+			if (stats.converged) {
+				return stats;
+			}
+			const T target = options.tolerance * b_norm;
+
+			work.reserve(n, is_preconditioned<Pre> ? 7 : 5);
+			T* r = work.vector(0);
+			T* shadow = work.vector(1);
+			T* p = work.vector(2);
+			T* v = work.vector(3);
+			T* t = work.vector(4);
+			T* p_hat = is_preconditioned<Pre> ? work.vector(5) : p;
+			// s takes the place of r until r is updated from it
+			T* s = r;
+			T* s_hat = is_preconditioned<Pre> ? work.vector(6) : s;
+
+			T r_norm = std::sqrt(residual(policy, a, b, x, r, n, stats));
+			stats.residual = r_norm / b_norm;
+			if (r_norm <= target) {
+				stats.converged = true;
+				return stats;
+			}
+			std::copy(r, r + n, shadow);
+			std::fill(p, p + n, T(0));
+			std::fill(v, v + n, T(0));
+			T rho = 1;
+			T alpha = 1;
+			T omega = 1;
+
+			const size_t limit = iteration_limit(options, n);
+			while (stats.iterations < limit) {
+				const T rho_next = solver_dot(policy, shadow, r, n);
+				// r has become orthogonal to the shadow residual, and the iteration cannot continue
+				if (rho_next == T(0)) {
+					break;
+				}
+				const T beta = (rho_next / rho) * (alpha / omega);
+				rho = rho_next;
+				for_each_element<T>(policy, n, [=](size_t i) { p[i] = r[i] + beta * (p[i] - omega * v[i]); });
+
+				if constexpr (is_preconditioned<Pre>) {
+					apply_preconditioner(policy, m, p, p_hat, n);
+				}
+				apply_operator(policy, a, p_hat, v, n);
+				stats.products++;
+				const T shadow_v = solver_dot(policy, shadow, v, n);
+				if (shadow_v == T(0)) {
+					break;
+				}
+				alpha = rho / shadow_v;
+				const T s_norm = std::sqrt(sum_elements<T>(policy, n, [=](size_t i) {
+					s[i] -= alpha * v[i];
+					return s[i] * s[i];
+				}));
+				if (s_norm <= target) {
+					for_each_element<T>(policy, n, [=](size_t i) { x[i] += alpha * p_hat[i]; });
+					stats.iterations++;
+					stats.residual = s_norm / b_norm;
+					stats.converged = true;
+					break;
+				}
+
+				if constexpr (is_preconditioned<Pre>) {
+					apply_preconditioner(policy, m, s, s_hat, n);
+				}
+				apply_operator(policy, a, s_hat, t, n);
+				stats.products++;
+				const T tt = solver_dot(policy, t, t, n);
+				if (tt == T(0)) {
+					break;
+				}
+				omega = solver_dot(policy, t, s, n) / tt;
+				r_norm = std::sqrt(sum_elements<T>(policy, n, [=](size_t i) {
+					x[i] += alpha * p_hat[i] + omega * s_hat[i];
+					r[i] = s[i] - omega * t[i];
+					return r[i] * r[i];
+				}));
+				stats.iterations++;
+				stats.residual = r_norm / b_norm;
+				if (r_norm <= target) {
+					stats.converged = true;
+					break;
+				}
+				if (omega == T(0)) {
+					break;
+				}
+			}
+			return stats;
+		}
+
+		// Right-preconditioned GMRES, restarted every options.restart iterations. The Krylov basis is orthogonalised by
+		// modified Gram-Schmidt, with each subtraction fused with the next dot product, and the least squares problem
+		// is kept triangular by Givens rotations, which also give the residual at every step without computing it
+		template<execution_policy Policy, class T, class Op, class Pre>
+		SolverStats<T> gmres(Policy&& policy, const Op& a, const T* b, T* x, size_t n, const Pre& m, SolverWorkspace<T>& work, const SolverOptions<T>& options) {
+			SolverStats<T> stats;
+			const T b_norm = start_solve(policy, b, x, n, stats);
+			if (stats.converged) {
+				return stats;
+			}
+			const T target = options.tolerance * b_norm;
+
+			const size_t restart = std::clamp<size_t>(options.restart, 1, n);
+			// The basis V, then z = m^-1 v for preconditioning, followed by the Hessenberg matrix H (by columns of
+			// restart + 1), the rotations and the right-hand side g
+			work.reserve(n, restart + (is_preconditioned<Pre> ? 2 : 1), (restart + 1) * restart + 3 * restart + 1);
+			const auto basis = [&work](size_t i) { return work.vector(i); };
+			T* z = is_preconditioned<Pre> ? work.vector(restart + 1) : nullptr;
+			T* h = work.scalars();
+			T* cs = h + ((restart + 1) * restart);
+			T* sn = cs + restart;
+			T* g = sn + restart;
+
+			const size_t limit = iteration_limit(options, n);
+			while (true) {
+				T* v0 = basis(0);
+				const T beta = std::sqrt(residual(policy, a, b, x, v0, n, stats));
+				stats.residual = beta / b_norm;
+				if (beta <= target) {
+					stats.converged = true;
+					break;
+				}
+				if (stats.iterations >= limit) {
+					break;
+				}
+				const T scale = T(1) / beta;
+				for_each_element<T>(policy, n, [=](size_t i) { v0[i] *= scale; });
+				std::fill(g, g + restart + 1, T(0));
+				g[0] = beta;
+
+				size_t k = 0;
+				while ((k < restart) && (stats.iterations < limit)) {
+					const size_t j = k;
+					T* w = basis(j + 1);
+					if constexpr (is_preconditioned<Pre>) {
+						apply_preconditioner(policy, m, basis(j), z, n);
+						apply_operator(policy, a, z, w, n);
+					}
+					else {
+						apply_operator(policy, a, basis(j), w, n);
+					}
+					stats.products++;
+
+					T* hj = h + (j * (restart + 1));
+					hj[0] = solver_dot(policy, w, basis(0), n);
+					for (size_t i = 1; i <= j; i++) {
+						const T* previous = basis(i - 1);
+						const T* vi = basis(i);
+						const T hp = hj[i - 1];
+						hj[i] = sum_elements<T>(policy, n, [=](size_t e) {
+							w[e] -= hp * previous[e];
+							return w[e] * vi[e];
+						});
+					}
+					const T* last = basis(j);
+					const T hl = hj[j];
+					const T w_norm = std::sqrt(sum_elements<T>(policy, n, [=](size_t e) {
+						w[e] -= hl * last[e];
+						return w[e] * w[e];
+					}));
+					hj[j + 1] = w_norm;
+					if (w_norm > T(0)) {
+						const T w_scale = T(1) / w_norm;
+						for_each_element<T>(policy, n, [=](size_t e) { w[e] *= w_scale; });
+					}
+
+					for (size_t i = 0; i < j; i++) {
+						const T upper = cs[i] * hj[i] + sn[i] * hj[i + 1];
+						hj[i + 1] = cs[i] * hj[i + 1] - sn[i] * hj[i];
+						hj[i] = upper;
+					}
+					const T d = std::hypot(hj[j], hj[j + 1]);
+					cs[j] = (d != T(0)) ? (hj[j] / d) : T(1);
+					sn[j] = (d != T(0)) ? (hj[j + 1] / d) : T(0);
+					hj[j] = d;
+					hj[j + 1] = 0;
+					g[j + 1] = -sn[j] * g[j];
+					g[j] = cs[j] * g[j];
+
+					k++;
+					stats.iterations++;
+					stats.residual = std::abs(g[j + 1]) / b_norm;
+					// Converged, or the Krylov space is invariant under a and holds the solution
+					if ((std::abs(g[j + 1]) <= target) || (w_norm == T(0))) {
+						break;
+					}
+				}
+
+				// Solve the triangular system H y = g in place in g, and add m^-1 V y to x
+				for (size_t i = k; i-- > 0;) {
+					T sum = g[i];
+					for (size_t c = i + 1; c < k; c++) {
+						sum -= h[(c * (restart + 1)) + i] * g[c];
+					}
+					const T diagonal = h[(i * (restart + 1)) + i];
+					g[i] = (diagonal != T(0)) ? (sum / diagonal) : T(0);
+				}
+				T* update = is_preconditioned<Pre> ? basis(k) : x;
+				const T* y = g;
+				for_each_range(policy, n, parallel_element_grain<T>, [&](size_t begin, size_t end) {
+					for (size_t i = 0; i < k; i++) {
+						const T* vi = basis(i);
+						const T yi = y[i];
+						if (is_preconditioned<Pre> && (i == 0)) {
+							SML_IVDEP
+							for (size_t e = begin; e < end; e++) {
+								update[e] = yi * vi[e];
+							}
+						}
+						else {
+							SML_IVDEP
+							for (size_t e = begin; e < end; e++) {
+								update[e] += yi * vi[e];
+							}
+						}
+					}
+				});
+				if constexpr (is_preconditioned<Pre>) {
+					apply_preconditioner(policy, m, update, z, n);
+					for_each_element<T>(policy, n, [=](size_t i) { x[i] += z[i]; });
+				}
+			}
+			return stats;
+		}
+
+	} // !namespace detail
+
+	// Solve a x = b by preconditioned conjugate gradients, for symmetric positive-definite a
+	sml_export template<execution_policy Policy, std::floating_point T, linear_operator<T> Op, preconditioner<T> Pre>
+	SolverStats<T> conjugate_gradient(Policy&& policy, const Op& a, std::type_identity_t<std::span<const T>> b, std::span<T> x, const Pre& m, SolverWorkspace<T>& work, const SolverOptions<T>& options = {}) {
+		detail::require_system<T>(a, b.size(), x.size(), "conjugate_gradient: dimensions do not match");
+		return detail::conjugate_gradient(policy, a, b.data(), x.data(), x.size(), m, work, options);
+	}
+	sml_export template<std::floating_point T, linear_operator<T> Op, preconditioner<T> Pre>
+	SolverStats<T> conjugate_gradient(const Op& a, std::type_identity_t<std::span<const T>> b, std::span<T> x, const Pre& m, SolverWorkspace<T>& work, const SolverOptions<T>& options = {}) {
+		return conjugate_gradient(execution::seq, a, b, x, m, work, options);
+	}
+	sml_export template<execution_policy Policy, std::floating_point T, linear_operator<T> Op>
+	SolverStats<T> conjugate_gradient(Policy&& policy, const Op& a, std::type_identity_t<std::span<const T>> b, std::span<T> x, const SolverOptions<T>& options = {}) {
+		SolverWorkspace<T> work;
+		return conjugate_gradient(policy, a, b, x, IdentityPreconditioner(), work, options);
+	}
+	sml_export template<std::floating_point T, linear_operator<T> Op>
+	SolverStats<T> conjugate_gradient(const Op& a, std::type_identity_t<std::span<const T>> b, std::span<T> x, const SolverOptions<T>& options = {}) {
+		return conjugate_gradient(execution::seq, a, b, x, options);
+	}
+
+	// Solve a x = b by right-preconditioned BiCGSTAB, for any non-singular a
+	sml_export template<execution_policy Policy, std::floating_point T, linear_operator<T> Op, preconditioner<T> Pre>
+	SolverStats<T> bicgstab(Policy&& policy, const Op& a, std::type_identity_t<std::span<const T>> b, std::span<T> x, const Pre& m, SolverWorkspace<T>& work, const SolverOptions<T>& options = {}) {
+		detail::require_system<T>(a, b.size(), x.size(), "bicgstab: dimensions do not match");
+		return detail::bicgstab(policy, a, b.data(), x.data(), x.size(), m, work, options);
+	}
+	sml_export template<std::floating_point T, linear_operator<T> Op, preconditioner<T> Pre>
+	SolverStats<T> bicgstab(const Op& a, std::type_identity_t<std::span<const T>> b, std::span<T> x, const Pre& m, SolverWorkspace<T>& work, const SolverOptions<T>& options = {}) {
+		return bicgstab(execution::seq, a, b, x, m, work, options);
+	}
+	sml_export template<execution_policy Policy, std::floating_point T, linear_operator<T> Op>
+	SolverStats<T> bicgstab(Policy&& policy, const Op& a, std::type_identity_t<std::span<const T>> b, std::span<T> x, const SolverOptions<T>& options = {}) {
+		SolverWorkspace<T> work;
+		return bicgstab(policy, a, b, x, IdentityPreconditioner(), work, options);
+	}
+	sml_export template<std::floating_point T, linear_operator<T> Op>
+	SolverStats<T> bicgstab(const Op& a, std::type_identity_t<std::span<const T>> b, std::span<T> x, const SolverOptions<T>& options = {}) {
+		return bicgstab(execution::seq, a, b, x, options);
+	}
+
+	// Solve a x = b by right-preconditioned GMRES, restarted every options.restart iterations, for any non-singular a
+	sml_export template<execution_policy Policy, std::floating_point T, linear_operator<T> Op, preconditioner<T> Pre>
+	SolverStats<T> gmres(Policy&& policy, const Op& a, std::type_identity_t<std::span<const T>> b, std::span<T> x, const Pre& m, SolverWorkspace<T>& work, const SolverOptions<T>& options = {}) {
+		detail::require_system<T>(a, b.size(), x.size(), "gmres: dimensions do not match");
+		return detail::gmres(policy, a, b.data(), x.data(), x.size(), m, work, options);
+	}
+	sml_export template<std::floating_point T, linear_operator<T> Op, preconditioner<T> Pre>
+	SolverStats<T> gmres(const Op& a, std::type_identity_t<std::span<const T>> b, std::span<T> x, const Pre& m, SolverWorkspace<T>& work, const SolverOptions<T>& options = {}) {
+		return gmres(execution::seq, a, b, x, m, work, options);
+	}
+	sml_export template<execution_policy Policy, std::floating_point T, linear_operator<T> Op>
+	SolverStats<T> gmres(Policy&& policy, const Op& a, std::type_identity_t<std::span<const T>> b, std::span<T> x, const SolverOptions<T>& options = {}) {
+		SolverWorkspace<T> work;
+		return gmres(policy, a, b, x, IdentityPreconditioner(), work, options);
+	}
+	sml_export template<std::floating_point T, linear_operator<T> Op>
+	SolverStats<T> gmres(const Op& a, std::type_identity_t<std::span<const T>> b, std::span<T> x, const SolverOptions<T>& options = {}) {
+		return gmres(execution::seq, a, b, x, options);
+	}
+
+}
+#endif // !SML_SOLVER_HPP
\ No newline at end of file
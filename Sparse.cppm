@@ -0,0 +1,29 @@
+export module sml:Sparse;
+
+#ifdef SML_NO_IMPORT_STD
+
+import <algorithm>;
+import <cstdint>;
+import <limits>;
+import <span>;
+import <stdexcept>;
+import <type_traits>;
+import <utility>;
+import <vector>;
+
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+import :Utility;
+import :Allocator;
+import :Parallel;
+import :Vector;
+import :Matrix;
+import :DynMatrix;
+#define SML_MODULE_SPARSE
+#include "Sparse.hpp"
\ No newline at end of file
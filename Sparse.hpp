@@ -0,0 +1,532 @@
+#ifndef SML_SPARSE_HPP
+#define SML_SPARSE_HPP
+
+#ifndef SML_MODULE_SPARSE
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#include "Allocator.hpp"
+#include "Parallel.hpp"
+
+#endif // !SML_MODULE_SPARSE
+
+#include "Config.hpp"
+
+// Sparse matrices in compressed sparse row (CSR) or column (CSC) form, for large systems that are mostly zeroes
+//
+//     sml::SparseBuilder<double> builder(n, n);
+//     builder.add(i, j, k);                          // repeated entries are summed, as in finite element assembly
+//     const sml::CSRMatrix<double> a(builder);
+//     sml::multiply(sml::execution::par, a, std::span<const double>(x), std::span<double>(y));   // y = a * x
+//     sml::DynVector<double> z = a * v;
+//
+// Only the nonzeroes are stored: for each row (CSR) or column (CSC), the positions of its entries along the other
+// dimension in increasing order, and their values. transpose() switches between the two forms by copying the arrays as
+// they are, as the CSR arrays of a matrix are the CSC arrays of its transpose, while converting a matrix from one form
+// to the other is one counting pass over its nonzeroes.
+//
+// Products that read each output element from a single row of CSR (or column of CSC) are split across threads by
+// their number of nonzeroes rather than of rows, so that a few dense rows do not leave the other threads idle.
+// Products the other way round scatter into the output, and run in parallel by giving each thread its own output
+// that is summed at the end.
+
+namespace sml {
+
+	// Whether a SparseMatrix compresses its rows (CSR) or its columns (CSC)
+	sml_export enum class sparse_format : uint8_t {
+		csr,
+		csc
+	};
+
+	// Position of an entry within its row or column. Four bytes rather than eight, as the products are limited by
+	// reading the indices and values from memory
+	sml_export using sparse_index = std::uint32_t;
+
+	// Entries of a sparse matrix collected one at a time, in any order, before compressing them into a SparseMatrix
+	sml_export template<arithmetic T>
+	class SparseBuilder {
+	public:
+		struct entry {
+			sparse_index row;
+			sparse_index col;
+			T value;
+		};
+
+		SparseBuilder(size_t rows, size_t cols) : nrows(rows), ncols(cols) {
+			if ((rows > std::numeric_limits<sparse_index>::max()) || (cols > std::numeric_limits<sparse_index>::max())) {
+				throw std::invalid_argument("SparseBuilder: dimensions do not fit in sparse_index");
+			}
+		}
+
+		// Add value at (row, col), to be summed with any other entries at the same position
+		inline void add(size_t row, size_t col, T value) {
+			if ((row >= nrows) || (col >= ncols)) {
+				throw std::out_of_range("SparseBuilder: index out of range");
+			}
+			items.push_back({ static_cast<sparse_index>(row), static_cast<sparse_index>(col), value });
+		}
+
+		inline void reserve(size_t entries) { items.reserve(entries); }
+		inline void clear() noexcept { items.clear(); }
+
+		inline size_t rows() const noexcept { return nrows; }
+		inline size_t cols() const noexcept { return ncols; }
+		inline size_t size() const noexcept { return items.size(); }
+		inline const std::vector<entry>& entries() const noexcept { return items; }
+
+	private:
+		size_t nrows;
+		size_t ncols;
+		std::vector<entry> items;
+	};
+
+	namespace detail {
+
+		// Fewest nonzeroes in a product worth handing to a thread of their own
+		inline constexpr size_t sparse_parallel_grain = size_t(1) << 14;
+
+		// The compressed arrays of a sparse matrix along its outer dimension (rows for CSR, columns for CSC)
+		template<arithmetic T>
+		struct compressed {
+			std::vector<size_t> offsets;
+			std::vector<sparse_index> indices;
+			std::vector<T, aligned_allocator<T>> values;
+		};
+
+		// The same arrays without owning them, as the kernels take them
+		template<arithmetic T>
+		struct compressed_ref {
+			const size_t* offsets;
+			const sparse_index* indices;
+			const T* values;
+			size_t outer_size;
+
+			inline size_t nonzeroes() const noexcept { return offsets[outer_size]; }
+		};
+
+		// Compress the entries given by outer(i), inner(i) and value(i) for i < n into outer_size lists, each sorted by
+		// inner index with repeated positions summed. A counting sort by inner index followed by a stable one by outer
+		// index leaves each list sorted, without comparisons
+		template<arithmetic T, class Outer, class Inner, class Value>
+		inline compressed<T> compress(size_t n, size_t outer_size, size_t inner_size, Outer outer, Inner inner, Value value) {
+			std::vector<size_t> by_inner(inner_size + 1, 0);
+			for (size_t i = 0; i < n; i++) {
+				by_inner[inner(i) + 1]++;
+			}
+			for (size_t i = 0; i < inner_size; i++) {
+				by_inner[i + 1] += by_inner[i];
+			}
+			std::vector<size_t> order(n);
+			for (size_t i = 0; i < n; i++) {
+				order[by_inner[inner(i)]++] = i;
+			}
+
+			compressed<T> ret;
+			ret.offsets.assign(outer_size + 1, 0);
+			for (size_t i = 0; i < n; i++) {
+				ret.offsets[outer(i) + 1]++;
+			}
+			for (size_t i = 0; i < outer_size; i++) {
+				ret.offsets[i + 1] += ret.offsets[i];
+			}
+			std::vector<size_t> next(ret.offsets.begin(), ret.offsets.end() - 1);
+			ret.indices.resize(n);
+			ret.values.resize(n);
+			for (const size_t i : order) {
+				const size_t k = next[outer(i)]++;
+				ret.indices[k] = static_cast<sparse_index>(inner(i));
+				ret.values[k] = value(i);
+			}
+
+			// Sum repeated positions, compacting the arrays in place
+			size_t out = 0;
+			for (size_t o = 0; o < outer_size; o++) {
+				const size_t begin = ret.offsets[o];
+				const size_t end = ret.offsets[o + 1];
+				ret.offsets[o] = out;
+				for (size_t k = begin; k < end; k++) {
+					if ((out > ret.offsets[o]) && (ret.indices[out - 1] == ret.indices[k])) {
+						ret.values[out - 1] += ret.values[k];
+					}
+					else {
+						ret.indices[out] = ret.indices[k];
+						ret.values[out] = ret.values[k];
+						out++;
+					}
+				}
+			}
+			ret.offsets[outer_size] = out;
+			ret.indices.resize(out);
+			ret.values.resize(out);
+			return ret;
+		}
+
+		// The same matrix compressed along its other dimension, in one counting pass. The lists come out sorted, as
+		// they are filled in order of the original outer index
+		template<arithmetic T>
+		inline compressed<T> recompress(compressed_ref<T> c, size_t inner_size) {
+			const size_t n = c.nonzeroes();
+			compressed<T> ret;
+			ret.offsets.assign(inner_size + 1, 0);
+			for (size_t k = 0; k < n; k++) {
+				ret.offsets[size_t(c.indices[k]) + 1]++;
+			}
+			for (size_t i = 0; i < inner_size; i++) {
+				ret.offsets[i + 1] += ret.offsets[i];
+			}
+			std::vector<size_t> next(ret.offsets.begin(), ret.offsets.end() - 1);
+			ret.indices.resize(n);
+			ret.values.resize(n);
+			for (size_t o = 0; o < c.outer_size; o++) {
+				for (size_t k = c.offsets[o]; k < c.offsets[o + 1]; k++) {
+					const size_t j = next[c.indices[k]]++;
+					ret.indices[j] = static_cast<sparse_index>(o);
+					ret.values[j] = c.values[k];
+				}
+			}
+			return ret;
+		}
+
+		// The outer lists whose first nonzero falls in [begin, end) of the nonzeroes, so that splitting the nonzeroes
+		// into ranges splits the lists between them with each list in exactly one range
+		inline std::pair<size_t, size_t> outer_range(const size_t* offsets, size_t outer_size, size_t begin, size_t end) {
+			const size_t b = size_t(std::lower_bound(offsets, offsets + outer_size, begin) - offsets);
+			const size_t e = (end == offsets[outer_size]) ? outer_size : size_t(std::lower_bound(offsets, offsets + outer_size, end) - offsets);
+			return { b, e };
+		}
+
+		// y[o] = sum over the list o of value * x[index], for width right-hand sides held row-major in x and y
+		template<execution_policy Policy, arithmetic T>
+		inline void sparse_gather(Policy&& policy, compressed_ref<T> a, const T* x, T* y, size_t width) {
+			const size_t* offsets = a.offsets;
+			const sparse_index* indices = a.indices;
+			const T* values = a.values;
+			for_each_range(policy, a.nonzeroes(), sparse_parallel_grain, [&](size_t begin, size_t end) {
+				const auto [ob, oe] = outer_range(offsets, a.outer_size, begin, end);
+				if (width == 1) {
+					for (size_t o = ob; o < oe; o++) {
+						T sum = 0;
+						for (size_t k = offsets[o]; k < offsets[o + 1]; k++) {
+							sum += values[k] * x[indices[k]];
+						}
+						y[o] = sum;
+					}
+					return;
+				}
+				for (size_t o = ob; o < oe; o++) {
+					T* yo = y + (o * width);
+					std::fill(yo, yo + width, T(0));
+					for (size_t k = offsets[o]; k < offsets[o + 1]; k++) {
+						const T v = values[k];
+						const T* xk = x + (size_t(indices[k]) * width);
+						SML_IVDEP
+						for (size_t j = 0; j < width; j++) {
+							yo[j] += v * xk[j];
+						}
+					}
+				}
+			});
+		}
+
+		// y[index] += value * x[o] over the lists [ob, oe), for width right-hand sides held row-major in x and y
+		template<arithmetic T>
+		inline void sparse_scatter_range(compressed_ref<T> a, size_t ob, size_t oe, const T* x, T* y, size_t width) {
+			const size_t* offsets = a.offsets;
+			const sparse_index* indices = a.indices;
+			const T* values = a.values;
+			for (size_t o = ob; o < oe; o++) {
+				const T* xo = x + (o * width);
+				for (size_t k = offsets[o]; k < offsets[o + 1]; k++) {
+					const T v = values[k];
+					T* yk = y + (size_t(indices[k]) * width);
+					SML_IVDEP
+					for (size_t j = 0; j < width; j++) {
+						yk[j] += v * xo[j];
+					}
+				}
+			}
+		}
+
+		// y = the transpose of the lists times x, where y has inner_size rows. In parallel, each thread scatters into
+		// an output of its own, as two lists may add to the same element of y, and these are summed at the end
+		template<execution_policy Policy, arithmetic T>
+		inline void sparse_scatter(Policy&& policy, compressed_ref<T> a, size_t inner_size, const T* x, T* y, size_t width) {
+			const size_t nonzeroes = a.nonzeroes();
+			const size_t out_size = inner_size * width;
+			if constexpr (is_parallel_policy<Policy>) {
+				thread_pool& pool = policy_pool(policy);
+				const size_t chunks = std::min(pool.size(), nonzeroes / sparse_parallel_grain);
+				if (chunks > 1) {
+					std::vector<T, aligned_allocator<T>> partial((chunks - 1) * out_size, T(0));
+					pool.run(chunks, [&](size_t chunk) {
+						const auto [ob, oe] = outer_range(a.offsets, a.outer_size, (chunk * nonzeroes) / chunks, ((chunk + 1) * nonzeroes) / chunks);
+						T* out = (chunk == 0) ? y : partial.data() + ((chunk - 1) * out_size);
+						if (chunk == 0) {
+							std::fill(y, y + out_size, T(0));
+						}
+						sparse_scatter_range(a, ob, oe, x, out, width);
+					});
+					for_each_range(policy, out_size, sparse_parallel_grain, [&](size_t begin, size_t end) {
+						for (size_t c = 0; c < (chunks - 1); c++) {
+							const T* p = partial.data() + (c * out_size);
+							SML_IVDEP
+							for (size_t i = begin; i < end; i++) {
+								y[i] += p[i];
+							}
+						}
+					});
+					return;
+				}
+			}
+			std::fill(y, y + out_size, T(0));
+			sparse_scatter_range(a, 0, a.outer_size, x, y, width);
+		}
+
+	} // !namespace detail
+
+	// A rows x cols matrix storing only its nonzeroes, compressed by row (CSR) or by column (CSC)
+	// The arrays are public as in DynMatrix, for handing to other libraries: offsets has an element per row (CSR) or
+	// column (CSC) and one more, and the entries of row or column o are indices and values [offsets[o], offsets[o + 1])
+	sml_export template<arithmetic T, sparse_format format = sparse_format::csr>
+	class SparseMatrix {
+	public:
+		SparseMatrix() {
+			offsets.assign(1, 0);
+		}
+		// An empty rows x cols matrix
+		SparseMatrix(size_t rows, size_t cols) : nrows(rows), ncols(cols) {
+			require_index_range(rows, cols);
+			offsets.assign(outer_size() + 1, 0);
+		}
+		explicit SparseMatrix(const SparseBuilder<T>& builder) : nrows(builder.rows()), ncols(builder.cols()) {
+			const auto& e = builder.entries();
+			const auto row = [&e](size_t i) { return size_t(e[i].row); };
+			const auto col = [&e](size_t i) { return size_t(e[i].col); };
+			const auto value = [&e](size_t i) { return e[i].value; };
+			if constexpr (format == sparse_format::csr) {
+				assign(detail::compress<T>(e.size(), nrows, ncols, row, col, value));
+			}
+			else {
+				assign(detail::compress<T>(e.size(), ncols, nrows, col, row, value));
+			}
+		}
+		// The same matrix in the other format
+		template<sparse_format format2>
+		explicit SparseMatrix(const SparseMatrix<T, format2>& m2) : nrows(m2.rows()), ncols(m2.cols()) {
+			if constexpr (format2 == format) {
+				offsets = m2.offsets;
+				indices = m2.indices;
+				values = m2.values;
+			}
+			else {
+				assign(detail::recompress<T>({ m2.offsets.data(), m2.indices.data(), m2.values.data(), m2.outer_size() }, m2.inner_size()));
+			}
+		}
+		// The nonzero elements of a dense matrix
+		template<arithmetic T2, class Allocator2>
+		explicit SparseMatrix(const DynMatrix<T2, Allocator2>& m2) : SparseMatrix(m2.rows(), m2.cols()) {
+			from_dense(m2.data.data());
+		}
+		template<arithmetic T2, size_t rows, size_t cols>
+		explicit SparseMatrix(const Matrix<T2, rows, cols>& m2) : SparseMatrix(rows, cols) {
+			from_dense(m2.data.data());
+		}
+
+		// The element at (row, col), which is zero if it is not stored
+		inline T at(size_t r, size_t c) const {
+			if ((r >= nrows) || (c >= ncols)) {
+				throw std::out_of_range("SparseMatrix: index out of range");
+			}
+			const size_t o = (format == sparse_format::csr) ? r : c;
+			const sparse_index i = static_cast<sparse_index>((format == sparse_format::csr) ? c : r);
+			const auto first = indices.begin() + offsets[o];
+			const auto last = indices.begin() + offsets[o + 1];
+			const auto it = std::lower_bound(first, last, i);
+			return ((it != last) && (*it == i)) ? values[size_t(it - indices.begin())] : T(0);
+		}
+
+		// Copy into a dense matrix
+		inline DynMatrix<T> to_dense() const {
+			DynMatrix<T> ret(nrows, ncols, 0);
+			for (size_t o = 0; o < outer_size(); o++) {
+				for (size_t k = offsets[o]; k < offsets[o + 1]; k++) {
+					if constexpr (format == sparse_format::csr) {
+						ret.data[(o * ncols) + indices[k]] = values[k];
+					}
+					else {
+						ret.data[(size_t(indices[k]) * ncols) + o] = values[k];
+					}
+				}
+			}
+			return ret;
+		}
+
+		inline size_t rows() const noexcept { return nrows; }
+		inline size_t cols() const noexcept { return ncols; }
+		// Number of stored elements
+		inline size_t nonzeroes() const noexcept { return values.size(); }
+		// Number of rows for CSR, or of columns for CSC
+		inline size_t outer_size() const noexcept { return (format == sparse_format::csr) ? nrows : ncols; }
+		inline size_t inner_size() const noexcept { return (format == sparse_format::csr) ? ncols : nrows; }
+
+	private:
+		size_t nrows = 0;
+		size_t ncols = 0;
+
+	public:
+		std::vector<size_t> offsets;
+		std::vector<sparse_index> indices;
+		std::vector<T, aligned_allocator<T>> values;
+
+	private:
+		static inline void require_index_range(size_t rows, size_t cols) {
+			if ((rows > std::numeric_limits<sparse_index>::max()) || (cols > std::numeric_limits<sparse_index>::max())) {
+				throw std::invalid_argument("SparseMatrix: dimensions do not fit in sparse_index");
+			}
+		}
+
+		inline void assign(detail::compressed<T>&& c) {
+			offsets = std::move(c.offsets);
+			indices = std::move(c.indices);
+			values = std::move(c.values);
+		}
+
+		template<arithmetic T2>
+		inline void from_dense(const T2* m) {
+			for (size_t o = 0; o < outer_size(); o++) {
+				for (size_t i = 0; i < inner_size(); i++) {
+					const T2 t = (format == sparse_format::csr) ? m[(o * ncols) + i] : m[(i * ncols) + o];
+					if (t != T2(0)) {
+						indices.push_back(static_cast<sparse_index>(i));
+						values.push_back(static_cast<T>(t));
+					}
+				}
+				offsets[o + 1] = values.size();
+			}
+		}
+	};
+
+	sml_export template<arithmetic T>
+	using CSRMatrix = SparseMatrix<T, sparse_format::csr>;
+	sml_export template<arithmetic T>
+	using CSCMatrix = SparseMatrix<T, sparse_format::csc>;
+
+	namespace detail {
+
+		template<arithmetic T, sparse_format format>
+		inline compressed_ref<T> sparse_ref(const SparseMatrix<T, format>& a) {
+			return { a.offsets.data(), a.indices.data(), a.values.data(), a.outer_size() };
+		}
+
+		// y = a * x, or transpose(a) * x, for width right-hand sides held row-major in x and y. Each element of y is read
+		// from one row of CSR or one column of CSC, or scattered to from the other way round
+		template<execution_policy Policy, arithmetic T, sparse_format format>
+		inline void sparse_product(Policy&& policy, const SparseMatrix<T, format>& a, bool transposed, const T* x, T* y, size_t width) {
+			if ((format == sparse_format::csr) != transposed) {
+				sparse_gather(policy, sparse_ref(a), x, y, width);
+			}
+			else {
+				sparse_scatter(policy, sparse_ref(a), a.inner_size(), x, y, width);
+			}
+		}
+
+		template<arithmetic T, sparse_format format>
+		inline void require_product(const SparseMatrix<T, format>& a, bool transposed, size_t x_size, size_t y_size) {
+			const size_t in = transposed ? a.rows() : a.cols();
+			const size_t out = transposed ? a.cols() : a.rows();
+			require_dimensions(x_size == in, "SparseMatrix product: dimensions do not match");
+			require_dimensions(y_size >= out, "SparseMatrix product: output is smaller than the result");
+		}
+
+	} // !namespace detail
+
+	// y = a * x, writing the result to the start of y, which must not overlap x
+	sml_export template<execution_policy Policy, arithmetic T, sparse_format format>
+	void multiply(Policy&& policy, const SparseMatrix<T, format>& a, std::type_identity_t<std::span<const T>> x, std::type_identity_t<std::span<T>> y) {
+		detail::require_product(a, false, x.size(), y.size());
+		detail::sparse_product(policy, a, false, x.data(), y.data(), 1);
+	}
+	sml_export template<arithmetic T, sparse_format format>
+	void multiply(const SparseMatrix<T, format>& a, std::type_identity_t<std::span<const T>> x, std::type_identity_t<std::span<T>> y) {
+		multiply(execution::seq, a, x, y);
+	}
+
+	// y = transpose(a) * x, without forming the transpose
+	sml_export template<execution_policy Policy, arithmetic T, sparse_format format>
+	void multiply_transposed(Policy&& policy, const SparseMatrix<T, format>& a, std::type_identity_t<std::span<const T>> x, std::type_identity_t<std::span<T>> y) {
+		detail::require_product(a, true, x.size(), y.size());
+		detail::sparse_product(policy, a, true, x.data(), y.data(), 1);
+	}
+	sml_export template<arithmetic T, sparse_format format>
+	void multiply_transposed(const SparseMatrix<T, format>& a, std::type_identity_t<std::span<const T>> x, std::type_identity_t<std::span<T>> y) {
+		multiply_transposed(execution::seq, a, x, y);
+	}
+
+	// Sparse matrix-vector product, treating v as a column vector
+	sml_export template<arithmetic T, sparse_format format, class Allocator>
+	inline DynVector<T, Allocator> operator * (const SparseMatrix<T, format>& a, const DynVector<T, Allocator>& v) {
+		detail::require_product(a, false, v.size(), a.rows());
+		DynVector<T, Allocator> ret(a.rows());
+		detail::sparse_product(execution::seq, a, false, v.data.data(), ret.data.data(), 1);
+		return ret;
+	}
+
+	// Product of a sparse and a dense matrix, dense
+	sml_export template<execution_policy Policy, arithmetic T, sparse_format format, class Allocator>
+	DynMatrix<T, Allocator> multiply(Policy&& policy, const SparseMatrix<T, format>& a, const DynMatrix<T, Allocator>& b) {
+		detail::require_dimensions(a.cols() == b.rows(), "SparseMatrix product: inner dimensions do not match");
+		DynMatrix<T, Allocator> ret(a.rows(), b.cols());
+		detail::sparse_product(policy, a, false, b.data.data(), ret.data.data(), b.cols());
+		return ret;
+	}
+	sml_export template<arithmetic T, sparse_format format, class Allocator>
+	inline DynMatrix<T, Allocator> operator * (const SparseMatrix<T, format>& a, const DynMatrix<T, Allocator>& b) {
+		return multiply(execution::seq, a, b);
+	}
+
+	// Product of a dense and a sparse matrix, as the transpose of transpose(a) * transpose(b) so that the rows of the
+	// dense operand are still read whole
+	sml_export template<execution_policy Policy, arithmetic T, class Allocator, sparse_format format>
+	DynMatrix<T, Allocator> multiply(Policy&& policy, const DynMatrix<T, Allocator>& b, const SparseMatrix<T, format>& a) {
+		detail::require_dimensions(b.cols() == a.rows(), "SparseMatrix product: inner dimensions do not match");
+		const DynMatrix<T, Allocator> bt = transpose(b);
+		DynMatrix<T, Allocator> ct(a.cols(), b.rows());
+		detail::sparse_product(policy, a, true, bt.data.data(), ct.data.data(), b.rows());
+		return transpose(ct);
+	}
+	sml_export template<arithmetic T, class Allocator, sparse_format format>
+	inline DynMatrix<T, Allocator> operator * (const DynMatrix<T, Allocator>& b, const SparseMatrix<T, format>& a) {
+		return multiply(execution::seq, b, a);
+	}
+
+	// The transpose, in the other format, with the arrays copied as they are: the rows of a are the columns of the result
+	sml_export template<arithmetic T>
+	CSCMatrix<T> transpose(const CSRMatrix<T>& a) {
+		CSCMatrix<T> ret(a.cols(), a.rows());
+		ret.offsets = a.offsets;
+		ret.indices = a.indices;
+		ret.values = a.values;
+		return ret;
+	}
+	sml_export template<arithmetic T>
+	CSRMatrix<T> transpose(const CSCMatrix<T>& a) {
+		CSRMatrix<T> ret(a.cols(), a.rows());
+		ret.offsets = a.offsets;
+		ret.indices = a.indices;
+		ret.values = a.values;
+		return ret;
+	}
+
+}
+#endif // !SML_SPARSE_HPP
\ No newline at end of file
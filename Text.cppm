@@ -0,0 +1,39 @@
+module;
+
+#include <version>
+
+export module sml:Text;
+
+#ifdef SML_NO_IMPORT_STD
+
+import <algorithm>;
+import <array>;
+import <charconv>;
+#if __has_include(<format>)
+import <format>;
+#endif
+import <istream>;
+import <memory>;
+import <ostream>;
+import <span>;
+import <stdexcept>;
+import <string>;
+import <string_view>;
+import <system_error>;
+import <vector>;
+
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+import :Utility;
+import :Vector;
+import :Matrix;
+import :Quaternion;
+import :Serialize;
+#define SML_MODULE_TEXT
+#include "Text.hpp"
\ No newline at end of file
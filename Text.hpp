@@ -0,0 +1,409 @@
+#ifndef SML_TEXT_HPP
+#define SML_TEXT_HPP
+
+#ifndef SML_MODULE_TEXT
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include <version>
+#if __has_include(<format>)
+#include <format>
+#endif
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#endif // !SML_MODULE_TEXT
+
+// Text input and output of Vectors, Matrices and Quaternions, through std::to_chars and std::from_chars
+//
+//     sml::write_text(file, std::span<const sml::Vec3f>(points), ',');    // one object per line, as CSV
+//     std::vector<sml::Vec3f> points = sml::read_text<sml::Vec3f>(file);  // whitespace or comma separated
+//     std::string s = std::format("{:.3f}", m);                           // each element formatted as {:.3f}
+//
+// Elements are written in their shortest round-trip form, so text written by write_text or to_chars reads back as
+// exactly the same values. Objects are read as their elements in order (row by row for a Matrix, q0 first for a
+// Quaternion), separated by any mix of whitespace and commas, so line breaks within and between objects are free.
+
+namespace sml {
+
+	namespace detail {
+
+		// Text is read from streams this many bytes at a time
+		inline constexpr size_t text_chunk_bytes = size_t(1) << 20;
+
+		inline constexpr bool is_text_separator(char c) {
+			return (c == ' ') || (c == ',') || (c == '\n') || (c == '\r') || (c == '\t') || (c == '\v') || (c == '\f');
+		}
+
+		inline const char* skip_text_separators(const char* first, const char* last) {
+			while ((first != last) && is_text_separator(*first)) {
+				first++;
+			}
+			return first;
+		}
+
+		// std::from_chars after any separators, also accepting a leading + and reading bool as an integer
+		template<arithmetic T>
+		inline std::from_chars_result scalar_from_chars(const char* first, const char* last, T& x) {
+			first = skip_text_separators(first, last);
+			if ((first != last) && (*first == '+') && ((last - first) > 1) && (first[1] != '-')) {
+				first++;
+			}
+			if constexpr (std::same_as<T, bool>) {
+				int i = 0;
+				const auto result = std::from_chars(first, last, i);
+				if (result.ec == std::errc()) {
+					x = (i != 0);
+				}
+				return result;
+			}
+			else {
+				return std::from_chars(first, last, x);
+			}
+		}
+
+		// The text around a failed read, for error messages
+		inline std::string text_excerpt(const char* first, const char* last) {
+			first = skip_text_separators(first, last);
+			return std::string(first, std::find_if(first, std::min(last, first + 32), is_text_separator));
+		}
+
+		// Parse as many whole objects as there are in [first, last) to the end of out, returning where parsing stopped
+		// Unless at_end is set, the last number in the text may be incomplete, so parsing stops before it
+		template<class Object>
+		inline const char* parse_objects(const char* first, const char* last, bool at_end, std::vector<Object>& out) {
+			// Without the end of the text, only numbers followed by a separator are known to be whole
+			const char* limit = last;
+			if (!at_end) {
+				while ((limit != first) && !is_text_separator(limit[-1])) {
+					limit--;
+				}
+			}
+			while (true) {
+				const char* start = skip_text_separators(first, limit);
+				if (start == limit) {
+					return start;
+				}
+				Object o;
+				const char* p = start;
+				for (size_t j = 0; j < serial_scalars<Object>; j++) {
+					p = skip_text_separators(p, limit);
+					if (p == limit) {
+						if (at_end) {
+							throw std::runtime_error("sml: text ends part way through an object");
+						}
+						return start;
+					}
+					// Each number must run up to the next separator, so that "1.5x" is an error rather than two values
+					typename serial_traits<Object>::value_type x;
+					const auto result = scalar_from_chars(p, limit, x);
+					if ((result.ec != std::errc()) || ((result.ptr != limit) && !is_text_separator(*result.ptr))) {
+						throw std::runtime_error("sml: cannot read a number from \"" + text_excerpt(p, limit) + "\"");
+					}
+					serial_traits<Object>::set(o, j, x);
+					p = result.ptr;
+				}
+				out.push_back(o);
+				first = p;
+			}
+		}
+
+		// A std::format spec applied to each element of an object: [[fill]align][sign][width][.precision][type], with
+		// type one of a, e, f and g (or A, E, F and G) for floating-point elements and b, d, o and x (or X) for
+		// integers. With neither a precision nor a type, elements are written in their shortest round-trip form, as
+		// by to_chars. The spec is parsed and applied here rather than by std::formatter<T>, so that it does not
+		// depend on <format>; the # and 0 flags, L and nested width or precision fields are not supported
+		template<arithmetic T, class CharT>
+		class element_format {
+		public:
+			// Parse the spec at the start of [first, last), returning where it ends (at the closing brace or last), or
+			// nullptr if it is not valid
+			constexpr const CharT* parse(const CharT* first, const CharT* last) {
+				if (((last - first) > 1) && is_align(first[1]) && (first[0] != CharT('{')) && (first[0] != CharT('}'))) {
+					fill = first[0];
+					align = static_cast<char>(first[1]);
+					first += 2;
+				}
+				else if ((first != last) && is_align(*first)) {
+					align = static_cast<char>(*first++);
+				}
+				if ((first != last) && ((*first == CharT('+')) || (*first == CharT('-')) || (*first == CharT(' ')))) {
+					sign = static_cast<char>(*first++);
+				}
+				if ((first != last) && (*first == CharT('0'))) {
+					return nullptr;
+				}
+				first = parse_count(first, last, width);
+				if (first == nullptr) {
+					return nullptr;
+				}
+				if ((first != last) && (*first == CharT('.'))) {
+					const CharT* digits = ++first;
+					first = parse_count(first, last, precision);
+					if ((first == nullptr) || (first == digits) || !std::floating_point<T>) {
+						return nullptr;
+					}
+					has_precision = true;
+				}
+				if ((first == last) || (*first == CharT('}'))) {
+					return first;
+				}
+				type = static_cast<char>(*first++);
+				if (!is_type(type)) {
+					return nullptr;
+				}
+				return ((first == last) || (*first == CharT('}'))) ? first : nullptr;
+			}
+
+			// Write x to out, returning the end of what was written
+			template<class OutputIt>
+			OutputIt format(T x, OutputIt out) const {
+				std::array<char, max_scalar_chars> fixed;
+				std::vector<char> grown;
+				char* first = fixed.data();
+				std::to_chars_result result = write(first, first + fixed.size(), x);
+				// Only a large precision overflows the fixed buffer
+				while (result.ec == std::errc::value_too_large) {
+					grown.resize(std::max(2 * grown.size(), size_t(4) * fixed.size()));
+					first = grown.data();
+					result = write(first, first + grown.size(), x);
+				}
+				if ((type == 'A') || (type == 'E') || (type == 'F') || (type == 'G') || (type == 'X')) {
+					std::transform(first, result.ptr, first, [](char c) { return ((c >= 'a') && (c <= 'z')) ? static_cast<char>(c - 'a' + 'A') : c; });
+				}
+
+				const char prefix = ((sign != '-') && (first != result.ptr) && (*first != '-')) ? sign : 0;
+				const size_t length = static_cast<size_t>(result.ptr - first) + ((prefix != 0) ? 1 : 0);
+				const size_t padding = (width > length) ? (width - length) : 0;
+				const size_t before = (align == '<') ? 0 : ((align == '^') ? (padding / 2) : padding);
+				for (size_t i = 0; i < before; i++) {
+					*out++ = fill;
+				}
+				if (prefix != 0) {
+					*out++ = static_cast<CharT>(prefix);
+				}
+				for (const char* c = first; c != result.ptr; c++) {
+					*out++ = static_cast<CharT>(*c);
+				}
+				for (size_t i = before; i < padding; i++) {
+					*out++ = fill;
+				}
+				return out;
+			}
+
+		private:
+			static constexpr bool is_align(CharT c) {
+				return (c == CharT('<')) || (c == CharT('>')) || (c == CharT('^'));
+			}
+			static constexpr bool is_type(char c) {
+				if constexpr (std::floating_point<T>) {
+					return (c == 'a') || (c == 'e') || (c == 'f') || (c == 'g') || (c == 'A') || (c == 'E') || (c == 'F') || (c == 'G');
+				}
+				else {
+					return (c == 'b') || (c == 'd') || (c == 'o') || (c == 'x') || (c == 'X');
+				}
+			}
+			// Read a decimal count, returning nullptr if it overflows
+			static constexpr const CharT* parse_count(const CharT* first, const CharT* last, size_t& count) {
+				for (; (first != last) && (*first >= CharT('0')) && (*first <= CharT('9')); first++) {
+					if (count > (size_t(-1) - 9) / 10) {
+						return nullptr;
+					}
+					count = (10 * count) + static_cast<size_t>(*first - CharT('0'));
+				}
+				return first;
+			}
+
+			std::to_chars_result write(char* first, char* last, T x) const {
+				if constexpr (std::floating_point<T>) {
+					const int p = static_cast<int>(std::min<size_t>(precision, 1u << 20));
+					switch (type) {
+					case 'a': case 'A':
+						return has_precision ? std::to_chars(first, last, x, std::chars_format::hex, p) : std::to_chars(first, last, x, std::chars_format::hex);
+					case 'e': case 'E':
+						return std::to_chars(first, last, x, std::chars_format::scientific, has_precision ? p : 6);
+					case 'f': case 'F':
+						return std::to_chars(first, last, x, std::chars_format::fixed, has_precision ? p : 6);
+					case 'g': case 'G':
+						return std::to_chars(first, last, x, std::chars_format::general, has_precision ? p : 6);
+					default:
+						return has_precision ? std::to_chars(first, last, x, std::chars_format::general, p) : scalar_to_chars(first, last, x);
+					}
+				}
+				else {
+					const int base = (type == 'b') ? 2 : ((type == 'o') ? 8 : (((type == 'x') || (type == 'X')) ? 16 : 10));
+					if constexpr (std::same_as<T, bool>) {
+						return std::to_chars(first, last, static_cast<int>(x), base);
+					}
+					else {
+						return std::to_chars(first, last, x, base);
+					}
+				}
+			}
+
+			CharT fill = CharT(' ');
+			char align = 0;
+			char sign = '-';
+			char type = 0;
+			size_t width = 0;
+			size_t precision = 0;
+			bool has_precision = false;
+		};
+
+		// Write the elements of o with spec, separated by spaces, with the rows of a Matrix on lines of their own
+		template<class Object, class CharT, class OutputIt>
+		OutputIt format_elements(const Object& o, const element_format<typename serial_traits<Object>::value_type, CharT>& spec, OutputIt out) {
+			constexpr size_t row = (serial_traits<Object>::kind == binary_object::matrix) ? serial_traits<Object>::cols : serial_scalars<Object>;
+			for (size_t j = 0; j < serial_scalars<Object>; j++) {
+				if (j > 0) {
+					*out++ = CharT(((j % row) == 0) ? '\n' : ' ');
+				}
+				out = spec.format(serial_traits<Object>::get(o, j), out);
+			}
+			return out;
+		}
+
+	} // !namespace detail
+
+	// Write the elements of o to [first, last) as std::to_chars does, separated by separator
+	sml_export template<class Object> requires detail::serialisable<Object>
+	std::to_chars_result to_chars(char* first, char* last, const Object& o, char separator = ' ') {
+		for (size_t j = 0; j < detail::serial_scalars<Object>; j++) {
+			if (j > 0) {
+				if (first == last) {
+					return { last, std::errc::value_too_large };
+				}
+				*first++ = separator;
+			}
+			const auto result = detail::scalar_to_chars(first, last, detail::serial_traits<Object>::get(o, j));
+			if (result.ec != std::errc()) {
+				return result;
+			}
+			first = result.ptr;
+		}
+		return { first, std::errc() };
+	}
+
+	// Read the elements of o from [first, last) as std::from_chars does, skipping whitespace and commas before each
+	// On failure, o is left unchanged and ptr points to the number that could not be read
+	sml_export template<class Object> requires detail::serialisable<Object>
+	std::from_chars_result from_chars(const char* first, const char* last, Object& o) {
+		Object ret = o;
+		for (size_t j = 0; j < detail::serial_scalars<Object>; j++) {
+			typename detail::serial_traits<Object>::value_type x;
+			const auto result = detail::scalar_from_chars(first, last, x);
+			if (result.ec != std::errc()) {
+				return { detail::skip_text_separators(first, last), result.ec };
+			}
+			detail::serial_traits<Object>::set(ret, j, x);
+			first = result.ptr;
+		}
+		o = ret;
+		return { first, std::errc() };
+	}
+
+	// Write each object to a line of its own, with its elements separated by separator (such as ',' for CSV)
+	sml_export template<class Object, class CharT> requires detail::serialisable<Object>
+	void write_text(std::basic_ostream<CharT>& os, std::span<const Object> objects, char separator = ' ') {
+		detail::text_writer<CharT> out(os);
+		for (const Object& o : objects) {
+			for (size_t j = 0; j < detail::serial_scalars<Object>; j++) {
+				if (j > 0) {
+					out.put(separator);
+				}
+				out.put_scalar(detail::serial_traits<Object>::get(o, j));
+			}
+			out.put('\n');
+		}
+		out.flush();
+		if (!os) {
+			throw std::runtime_error("sml: failed to write text");
+		}
+	}
+
+	// Read every object in text, throwing std::runtime_error if any of it is not a number or the last object is
+	// incomplete
+	sml_export template<class Object> requires detail::serialisable<Object>
+	std::vector<Object> read_text(std::string_view text) {
+		std::vector<Object> ret;
+		detail::parse_objects(text.data(), text.data() + text.size(), true, ret);
+		return ret;
+	}
+
+	// Read every object up to the end of a stream, a large block at a time
+	sml_export template<class Object> requires detail::serialisable<Object>
+	std::vector<Object> read_text(std::istream& is) {
+		std::vector<Object> ret;
+		std::vector<char> buffer(detail::text_chunk_bytes);
+		size_t held = 0;
+		while (true) {
+			is.read(buffer.data() + held, static_cast<std::streamsize>(buffer.size() - held));
+			held += static_cast<size_t>(is.gcount());
+			const bool at_end = !is;
+			const char* stop = detail::parse_objects(buffer.data(), buffer.data() + held, at_end, ret);
+			if (at_end) {
+				return ret;
+			}
+			// Carry the unparsed tail over to the next block, growing the buffer if one object fills all of it
+			const size_t kept = static_cast<size_t>((buffer.data() + held) - stop);
+			std::copy(stop, stop + kept, buffer.data());
+			held = kept;
+			if (held == buffer.size()) {
+				buffer.resize(2 * buffer.size());
+			}
+		}
+	}
+
+}
+
+#if defined(__cpp_lib_format)
+
+namespace sml::detail {
+
+	// std::format support, applying the format spec to every element: std::format("{:8.3f}", m)
+	template<class Object, class CharT>
+	struct object_formatter {
+		template<class ParseContext>
+		constexpr auto parse(ParseContext& ctx) {
+			const CharT* first = std::to_address(ctx.begin());
+			const CharT* end = spec.parse(first, first + (ctx.end() - ctx.begin()));
+			if (end == nullptr) {
+				throw std::format_error("sml: invalid format spec for a Vector, Matrix or Quaternion");
+			}
+			return ctx.begin() + (end - first);
+		}
+
+		template<class FormatContext>
+		auto format(const Object& o, FormatContext& ctx) const {
+			return format_elements(o, spec, ctx.out());
+		}
+
+		element_format<typename serial_traits<Object>::value_type, CharT> spec;
+	};
+
+}
+
+template<sml::arithmetic T, size_t elements, class CharT>
+struct std::formatter<sml::Vector<T, elements>, CharT> : sml::detail::object_formatter<sml::Vector<T, elements>, CharT> {};
+
+template<sml::arithmetic T, size_t nrows, size_t ncols, class CharT>
+struct std::formatter<sml::Matrix<T, nrows, ncols>, CharT> : sml::detail::object_formatter<sml::Matrix<T, nrows, ncols>, CharT> {};
+
+template<sml::arithmetic T, class CharT>
+struct std::formatter<sml::Quaternion<T>, CharT> : sml::detail::object_formatter<sml::Quaternion<T>, CharT> {};
+
+#endif // __cpp_lib_format
+
+#endif // !SML_TEXT_HPP
@@ -0,0 +1,38 @@
+module;
+
+#include "Config.hpp"
+#if defined(SML_SIMD_SSE)
+#include <immintrin.h>
+#elif defined(SML_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+export module sml:Transform;
+
+#ifdef SML_NO_IMPORT_STD
+
+import <algorithm>;
+import <array>;
+import <concepts>;
+import <cstdint>;
+import <span>;
+import <stdexcept>;
+import <type_traits>;
+import <utility>;
+
+#else
+import std;
+#endif // SML_NO_IMPORT_STD
+
+#ifndef sml_export
+#define sml_export export
+#endif
+
+import :Utility;
+import :Simd;
+import :Parallel;
+import :Vector;
+import :Matrix;
+import :Quaternion;
+#define SML_MODULE_TRANSFORM
+#include "Transform.hpp"
\ No newline at end of file
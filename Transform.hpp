@@ -0,0 +1,694 @@
+#ifndef SML_TRANSFORM_HPP
+#define SML_TRANSFORM_HPP
+
+#ifndef SML_MODULE_TRANSFORM
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#ifndef sml_export
+#define sml_export
+#endif // !sml_export
+
+#include "Simd.hpp"
+#include "Parallel.hpp"
+
+#endif // !SML_MODULE_TRANSFORM
+
+#include "Config.hpp"
+
+// Apply one 4x4 transform to a whole buffer of 3-vectors
+//
+//     sml::transform_points(model, std::span<const sml::Vec3f>(vertices), std::span<sml::Vec3f>(world));
+//     sml::transform_normals(sml::execution::par, model, normals, world_normals);
+//
+// Points take the translation of the matrix, directions do not, and normals are transformed by the inverse transpose
+// so that they stay perpendicular to transformed surfaces (they are not renormalised). The matrix is loaded once and
+// kept in registers for the whole buffer, and large outputs are written with non-temporal stores. in and out may be
+// the same buffer.
+//
+// Rotate whole buffers of 3-vectors by quaternions, either one for the whole buffer or one per element
+//
+//     sml::RotatePassive(offsets, orientation, rotated);
+//     sml::RotatePassiveUnit(sml::execution::par, offsets, std::span<const sml::Quatf>(orientations), rotated);
+//
+// A single rotation is converted to a matrix once and applied as transform_directions is. Per element rotations are
+// expanded to two cross products instead of two quaternion products, and the Unit forms also skip the division by the
+// squared length of each quaternion, so they must only be given normalised quaternions.
+//
+// Convert whole buffers between unit quaternions and rotation matrices
+//
+//     sml::QuaternionTo44RotationMatrix(std::span<const sml::Quatf>(orientations), std::span<sml::Mat44f>(models));
+//     sml::RotationMatrixToQuaternion(sml::execution::par, std::span<const sml::Mat33f>(bases), orientations);
+//
+// Matrices are converted by Shepperd's method, as RotationMatrixToQuaternion is. For float with SSE or NEON, four
+// matrices are converted at a time, one per lane, after transposing them so that each register holds one element of
+// all four.
+//
+// Determinants of whole buffers of square matrices, such as for finding inverted or degenerate transforms in a mesh
+//
+//     sml::det(std::span<const sml::Mat44f>(models), std::span<float>(determinants));
+//
+// 3x3 and 4x4 use the closed forms of det, with 4x4 float done four matrices at a time with SSE or NEON, and larger
+// matrices a pivoted LU factorisation each.
+//
+// Multiply whole buffers of small square matrices, such as the local and parent transforms of a skeleton
+//
+//     sml::batch_multiply(std::span<const sml::Mat44f>(parents), locals, world);   // world[i] = parents[i] * locals[i]
+//     sml::batch_multiply(sml::execution::par, view, world, view_world);           // view_world[i] = view * world[i]
+//
+// Either side may be a single matrix, applied to every element of the other. The products are computed without calls
+// or temporaries, with a SIMD register per row where the backend has registers that size (4x4 and 3x3 float, and 4x4
+// and 2x2 double), or two rows per register for 4x4 float with AVX. out may be the same buffer as either input.
+
+namespace sml {
+
+	namespace detail {
+
+		// Outputs at least this large are written with non-temporal stores: they would not fit in cache anyway, and
+		// bypassing it saves reading each destination line in before overwriting it
+		inline constexpr size_t transform_stream_bytes = size_t(1) << 22;
+
+		// Fewest elements worth handing to a thread of their own
+		inline constexpr size_t transform_parallel_grain = size_t(1) << 15;
+
+		// out = upper 3x4 of m applied to each of n vectors, with the translation column only if translate is set
+		template<bool translate, std::floating_point T>
+		inline void transform_affine(const Matrix<T, 4, 4>& m, const Vector<T, 3>* in, Vector<T, 3>* out, size_t n, [[maybe_unused]] bool stream) {
+#if defined(SML_SIMD_SSE) || defined(SML_SIMD_NEON)
+			if constexpr (std::same_as<T, float>) {
+				using simd = simd_ops<float, 4>;
+				using reg = simd::reg;
+				// Columns of the matrix, so that each result is c0 * x + c1 * y + c2 * z (+ c3)
+				const reg c0 = simd::load(std::array<float, 4>{ m[0][0], m[1][0], m[2][0], 0.0f }.data());
+				const reg c1 = simd::load(std::array<float, 4>{ m[0][1], m[1][1], m[2][1], 0.0f }.data());
+				const reg c2 = simd::load(std::array<float, 4>{ m[0][2], m[1][2], m[2][2], 0.0f }.data());
+				const reg c3 = simd::load(std::array<float, 4>{ m[0][3], m[1][3], m[2][3], 0.0f }.data());
+				const auto apply = [&](const Vector<float, 3>& v) {
+					const float* p = &*v.begin();
+					const reg r = simd::fma(c0, simd::broadcast(p[0]), simd::fma(c1, simd::broadcast(p[1]), simd::mul(c2, simd::broadcast(p[2]))));
+					return translate ? simd::add(r, c3) : r;
+				};
+
+				size_t i = 0;
+				if (stream) {
+					// Streaming stores need 16-byte alignment, which one of the first four elements will have
+					for (; (i < n) && ((reinterpret_cast<std::uintptr_t>(&*out[i].begin()) % 16) != 0); i++) {
+						simd_ops<float, 3>::store(&*out[i].begin(), apply(in[i]));
+					}
+				}
+				for (; i + 4 <= n; i += 4) {
+					reg o0, o1, o2;
+					simd::pack_xyz(apply(in[i]), apply(in[i + 1]), apply(in[i + 2]), apply(in[i + 3]), o0, o1, o2);
+					float* dst = &*out[i].begin();
+					if (stream) {
+						simd::stream(dst, o0);
+						simd::stream(dst + 4, o1);
+						simd::stream(dst + 8, o2);
+					}
+					else {
+						simd::store(dst, o0);
+						simd::store(dst + 4, o1);
+						simd::store(dst + 8, o2);
+					}
+				}
+				for (; i < n; i++) {
+					simd_ops<float, 3>::store(&*out[i].begin(), apply(in[i]));
+				}
+				if (stream) {
+					simd::fence();
+				}
+				return;
+			}
+#endif
+			const T m00 = m[0][0], m01 = m[0][1], m02 = m[0][2], m03 = translate ? m[0][3] : T(0);
+			const T m10 = m[1][0], m11 = m[1][1], m12 = m[1][2], m13 = translate ? m[1][3] : T(0);
+			const T m20 = m[2][0], m21 = m[2][1], m22 = m[2][2], m23 = translate ? m[2][3] : T(0);
+			SML_IVDEP
+			for (size_t i = 0; i < n; i++) {
+				const T x = in[i][0], y = in[i][1], z = in[i][2];
+				out[i][0] = (m00 * x) + (m01 * y) + (m02 * z) + m03;
+				out[i][1] = (m10 * x) + (m11 * y) + (m12 * z) + m13;
+				out[i][2] = (m20 * x) + (m21 * y) + (m22 * z) + m23;
+			}
+		}
+
+		// Points through a matrix with a projective bottom row, dividing by the resulting w
+		template<std::floating_point T>
+		inline void transform_projective(const Matrix<T, 4, 4>& m, const Vector<T, 3>* in, Vector<T, 3>* out, size_t n) {
+			for (size_t i = 0; i < n; i++) {
+				const T x = in[i][0], y = in[i][1], z = in[i][2];
+				const T inv_w = T(1) / ((m[3][0] * x) + (m[3][1] * y) + (m[3][2] * z) + m[3][3]);
+				out[i][0] = ((m[0][0] * x) + (m[0][1] * y) + (m[0][2] * z) + m[0][3]) * inv_w;
+				out[i][1] = ((m[1][0] * x) + (m[1][1] * y) + (m[1][2] * z) + m[1][3]) * inv_w;
+				out[i][2] = ((m[2][0] * x) + (m[2][1] * y) + (m[2][2] * z) + m[2][3]) * inv_w;
+			}
+		}
+
+		template<bool translate, execution_policy Policy, std::floating_point T>
+		inline void transform_span(Policy&& policy, const Matrix<T, 4, 4>& m, std::span<const Vector<T, 3>> in, std::span<Vector<T, 3>> out) {
+			if (out.size() < in.size()) {
+				throw std::invalid_argument("transform: output span is smaller than the input");
+			}
+			const bool affine = !translate || is_affine(m);
+			const bool stream = (in.size() * sizeof(Vector<T, 3>)) >= transform_stream_bytes;
+			for_each_range(policy, in.size(), transform_parallel_grain, [&](size_t begin, size_t end) {
+				if (affine) {
+					transform_affine<translate>(m, in.data() + begin, out.data() + begin, end - begin, stream);
+				}
+				else {
+					transform_projective(m, in.data() + begin, out.data() + begin, end - begin);
+				}
+			});
+		}
+
+		// The matrix that transforms normals consistently with m
+		template<std::floating_point T>
+		inline Matrix<T, 4, 4> normal_matrix(const Matrix<T, 4, 4>& m) {
+			if constexpr (std::same_as<T, float>) {
+				return inverse_transpose(m);
+			}
+			else {
+				return transpose(inverse(m));
+			}
+		}
+
+		// Fewest matrix products worth handing to a thread of their own
+		inline constexpr size_t batch_multiply_grain = size_t(1) << 12;
+
+		// out[i] = a[i * a_step] * b[i * b_step] for i in [0, count), where a step of 0 applies a single matrix to all
+		// Each row of a product is the sum of the rows of the right-hand matrix, each scaled by an element of the same
+		// row of the left-hand one: with a register per row, that is n * n broadcasts and multiply-adds per product.
+		// Both matrices are read in full before the product is written, so out may alias a or b
+		template<arithmetic T, size_t n>
+		inline void batch_multiply_kernel(const Matrix<T, n, n>* a, size_t a_step, const Matrix<T, n, n>* b, size_t b_step, Matrix<T, n, n>* out, size_t count) {
+#if defined(SML_SIMD_AVX)
+			if constexpr (std::same_as<T, float> && (n == 4)) {
+				// Two rows of the product per AVX register, with the rows of b repeated in both halves
+				using simd = simd_f32x8;
+				using reg = simd::reg;
+				for (size_t i = 0; i < count; i++) {
+					const float* lhs = &*a[i * a_step].begin();
+					const float* rhs = &*b[i * b_step].begin();
+					const reg b0 = simd::broadcast4(rhs), b1 = simd::broadcast4(rhs + 4);
+					const reg b2 = simd::broadcast4(rhs + 8), b3 = simd::broadcast4(rhs + 12);
+					const auto product_rows = [&](reg rows) {
+						reg acc = simd::mul(simd::splat<0>(rows), b0);
+						acc = simd::fma(simd::splat<1>(rows), b1, acc);
+						acc = simd::fma(simd::splat<2>(rows), b2, acc);
+						return simd::fma(simd::splat<3>(rows), b3, acc);
+					};
+					const reg r01 = product_rows(simd::load(lhs));
+					const reg r23 = product_rows(simd::load(lhs + 8));
+					float* dst = &*out[i].begin();
+					simd::store(dst, r01);
+					simd::store(dst + 8, r23);
+				}
+				return;
+			}
+#endif
+			if constexpr (simd_enabled<T, n>) {
+				using simd = simd_ops<T, n>;
+				using reg = typename simd::reg;
+				// The row loops are unrolled with fold expressions so that every row stays in a register
+				[&]<size_t... r>(std::index_sequence<r...>) {
+					for (size_t i = 0; i < count; i++) {
+						const T* lhs = &*a[i * a_step].begin();
+						const T* rhs = &*b[i * b_step].begin();
+						const reg rows[n] = { simd::load(rhs + (r * n))... };
+						const auto product_row = [&](const T* lhs_row) {
+							reg acc = simd::mul(simd::broadcast(lhs_row[0]), rows[0]);
+							([&] {
+								if constexpr (r > 0) {
+									acc = simd::fma(simd::broadcast(lhs_row[r]), rows[r], acc);
+								}
+							}(), ...);
+							return acc;
+						};
+						const reg ret[n] = { product_row(lhs + (r * n))... };
+						T* dst = &*out[i].begin();
+						(simd::store(dst + (r * n), ret[r]), ...);
+					}
+				}(std::make_index_sequence<n>{});
+			}
+			else {
+				for (size_t i = 0; i < count; i++) {
+					out[i] = a[i * a_step] * b[i * b_step];
+				}
+			}
+		}
+
+		template<execution_policy Policy, arithmetic T, size_t n>
+		inline void batch_multiply_span(Policy&& policy, const Matrix<T, n, n>* a, size_t a_step, const Matrix<T, n, n>* b, size_t b_step, std::span<Matrix<T, n, n>> out, size_t count) {
+			if (out.size() < count) {
+				throw std::invalid_argument("batch_multiply: output span is smaller than the input");
+			}
+			for_each_range(policy, count, batch_multiply_grain, [&](size_t begin, size_t end) {
+				batch_multiply_kernel(a + (begin * a_step), a_step, b + (begin * b_step), b_step, out.data() + begin, end - begin);
+			});
+		}
+
+		// The rotation matrix of the quaternion (s, v), divided by its squared length so that v need not be normalised
+		template<std::floating_point T>
+		inline Matrix<T, 4, 4> rotation_matrix(T s, T i, T j, T k) {
+			const T f = T(2) / ((s * s) + (i * i) + (j * j) + (k * k));
+			const T ii = f * i * i, jj = f * j * j, kk = f * k * k;
+			const T ij = f * i * j, ik = f * i * k, jk = f * j * k;
+			const T si = f * s * i, sj = f * s * j, sk = f * s * k;
+			return Matrix<T, 4, 4>(T(1) - jj - kk, ij - sk, ik + sj, T(0),
+				ij + sk, T(1) - ii - kk, jk - si, T(0),
+				ik - sj, jk + si, T(1) - ii - jj, T(0),
+				T(0), T(0), T(0), T(1));
+		}
+
+		// Fewest elements rotated by their own quaternions worth handing to a thread of their own
+		inline constexpr size_t rotate_parallel_grain = size_t(1) << 14;
+
+		// out[i] = in[i] rotated by rots[i], by its conjugate if conjugate is set
+		template<bool conjugate, bool unit, std::floating_point T>
+		inline void rotate_each(const Vector<T, 3>* in, const Quaternion<T>* rots, Vector<T, 3>* out, size_t n) {
+#if (defined(SML_SIMD_SSE) && !defined(SML_SIMD_AVX)) || defined(SML_SIMD_NEON)
+			// Without AVX the loop below is not vectorised across elements, so each vector is rotated within a
+			// register instead. With AVX the compiler does better by vectorising the loop
+			if constexpr (std::same_as<T, float>) {
+				using simd = simd_ops<float, 3>;
+				using reg = simd::reg;
+				const reg two = simd::broadcast(2.0f);
+				const reg sign = simd::broadcast(conjugate ? -1.0f : 1.0f);
+				for (size_t i = 0; i < n; i++) {
+					const reg p = simd::load(&*in[i].begin());
+#if defined(SML_QUATERNION_LANES)
+					const reg v = simd::mul(sign, simd::load(rots[i].data() + 1));
+#else
+					const reg v = simd::mul(sign, simd::load(&*rots[i].vector.begin()));
+#endif
+					const float s = rots[i].s();
+					const reg t = simd::mul(two, simd::cross(v, p));
+					reg r = simd::fma(simd::broadcast(s), t, simd::cross(v, t));
+					if constexpr (!unit) {
+						r = simd::mul(r, simd::broadcast(1.0f / ((s * s) + (rots[i].i() * rots[i].i()) + (rots[i].j() * rots[i].j()) + (rots[i].k() * rots[i].k()))));
+					}
+					simd::store(&*out[i].begin(), simd::add(p, r));
+				}
+				return;
+			}
+#endif
+			const T sign = conjugate ? T(-1) : T(1);
+			SML_IVDEP
+			for (size_t i = 0; i < n; i++) {
+				out[i] = rotate_vector<unit>(rots[i].s(), sign * rots[i].i(), sign * rots[i].j(), sign * rots[i].k(), in[i][0], in[i][1], in[i][2]);
+			}
+		}
+
+		template<bool conjugate, bool unit, execution_policy Policy, std::floating_point T>
+		inline void rotate_span(Policy&& policy, std::span<const Vector<T, 3>> in, std::span<const Quaternion<T>> rots, std::span<Vector<T, 3>> out) {
+			if (rots.size() != in.size()) {
+				throw std::invalid_argument("rotate: input and rotation spans differ in size");
+			}
+			if (out.size() < in.size()) {
+				throw std::invalid_argument("rotate: output span is smaller than the input");
+			}
+			for_each_range(policy, in.size(), rotate_parallel_grain, [&](size_t begin, size_t end) {
+				rotate_each<conjugate, unit>(in.data() + begin, rots.data() + begin, out.data() + begin, end - begin);
+			});
+		}
+
+		// Fewest conversions between quaternions and matrices worth handing to a thread of their own
+		inline constexpr size_t convert_parallel_grain = size_t(1) << 13;
+
+		// out[i] = QuaternionTo33RotationMatrix(in[i]), or the 4x4 form for n == 4
+		template<std::floating_point T, size_t n>
+		inline void quaternions_to_matrices(const Quaternion<T>* in, Matrix<T, n, n>* out, size_t count) {
+			// Not worth transposing four at a time into registers, as the conversion is bound by writing the matrices
+			SML_IVDEP
+			for (size_t i = 0; i < count; i++) {
+				if constexpr (n == 4) {
+					out[i] = QuaternionTo44RotationMatrix(in[i]);
+				}
+				else {
+					out[i] = QuaternionTo33RotationMatrix(in[i]);
+				}
+			}
+		}
+
+#if defined(SML_SIMD_SSE) || defined(SML_SIMD_NEON)
+		// Load the top rows of four consecutive float matrices transposed, so that m[r][c] holds element (r, c) of
+		// each of them. For 3x3 matrices the last column is zero
+		template<size_t rows, size_t n>
+		inline void load_transposed(const Matrix<float, n, n>* in, simd_f32x4::reg (&m)[rows][4]) {
+			const auto load_row = [in](size_t e, size_t r) {
+				if constexpr (n == 4) {
+					return simd_ops<float, 4>::load(in[e].data.data() + (4 * r));
+				}
+				else {
+					return simd_ops<float, 3>::load(in[e].data.data() + (3 * r));
+				}
+			};
+			// Written out rather than looped over, as the loop is not unrolled at -O2 and m would then live in memory
+			const auto transpose_row = [&](size_t r) {
+				m[r][0] = load_row(0, r);
+				m[r][1] = load_row(1, r);
+				m[r][2] = load_row(2, r);
+				m[r][3] = load_row(3, r);
+				simd_f32x4::transpose4(m[r][0], m[r][1], m[r][2], m[r][3]);
+			};
+			transpose_row(0);
+			transpose_row(1);
+			transpose_row(2);
+			if constexpr (rows == 4) {
+				transpose_row(3);
+			}
+		}
+#endif
+
+		// out[i] = RotationMatrixToQuaternion(in[i]), from the upper 3x3 of each matrix
+		template<std::floating_point T, size_t n>
+		inline void matrices_to_quaternions(const Matrix<T, n, n>* in, Quaternion<T>* out, size_t count) {
+			size_t i = 0;
+#if defined(SML_SIMD_SSE) || defined(SML_SIMD_NEON)
+			// The scalar loop below is not vectorised because of its square root
+			if constexpr (std::same_as<T, float>) {
+				using simd = simd_ops<float, 4>;
+				using reg = simd::reg;
+				const reg one = simd::broadcast(1.0f);
+				const reg half = simd::broadcast(0.5f);
+				for (; (i + 4) <= count; i += 4) {
+					reg m[3][4];
+					load_transposed(in + i, m);
+					// The same choice of case as detail::shepperd, made by mask
+					const reg trace = simd::add(simd::add(m[0][0], m[1][1]), m[2][2]);
+					const reg largest = simd::max(simd::max(m[0][0], m[1][1]), m[2][2]);
+					const reg by_s = simd::greater_equal(trace, largest);
+					const reg by_i = simd::equal(m[0][0], largest);
+					const reg by_j = simd::equal(m[1][1], largest);
+					const auto choose = [&](reg a, reg b, reg c, reg d) { return simd::select(by_s, a, simd::select(by_i, b, simd::select(by_j, c, d))); };
+					const reg t = choose(simd::add(one, trace),
+						simd::sub(simd::sub(simd::add(one, m[0][0]), m[1][1]), m[2][2]),
+						simd::sub(simd::add(simd::sub(one, m[0][0]), m[1][1]), m[2][2]),
+						simd::add(simd::sub(simd::sub(one, m[0][0]), m[1][1]), m[2][2]));
+					const reg d21 = simd::sub(m[2][1], m[1][2]), d02 = simd::sub(m[0][2], m[2][0]), d10 = simd::sub(m[1][0], m[0][1]);
+					const reg s10 = simd::add(m[1][0], m[0][1]), s02 = simd::add(m[0][2], m[2][0]), s21 = simd::add(m[2][1], m[1][2]);
+					reg qs = choose(t, d21, d02, d10);
+					reg qi = choose(d21, t, s10, s02);
+					reg qj = choose(d02, s10, t, s21);
+					reg qk = choose(d10, s02, s21, t);
+					const reg f = simd::copysign(simd::div(half, simd::sqrt(t)), qs);
+					qs = simd::mul(qs, f);
+					qi = simd::mul(qi, f);
+					qj = simd::mul(qj, f);
+					qk = simd::mul(qk, f);
+					simd::transpose4(qs, qi, qj, qk);
+#if defined(SML_QUATERNION_LANES)
+					simd::store(out[i].data(), qs);
+					simd::store(out[i + 1].data(), qi);
+					simd::store(out[i + 2].data(), qj);
+					simd::store(out[i + 3].data(), qk);
+#else
+					// Through a staging array, as the scalar and vector members cannot be stored to as one
+					std::array<float, 16> lanes;
+					simd::store(lanes.data(), qs);
+					simd::store(lanes.data() + 4, qi);
+					simd::store(lanes.data() + 8, qj);
+					simd::store(lanes.data() + 12, qk);
+					for (size_t q = 0; q < 4; q++) {
+						out[i + q] = Quaternion<float>(lanes[4 * q], lanes[(4 * q) + 1], lanes[(4 * q) + 2], lanes[(4 * q) + 3]);
+					}
+#endif
+				}
+			}
+#endif
+			for (; i < count; i++) {
+				const T* m = in[i].data.data();
+				std::array<T, 4> q;
+				shepperd(m[0], m[1], m[2], m[n], m[n + 1], m[n + 2], m[2 * n], m[(2 * n) + 1], m[(2 * n) + 2], q.data());
+				out[i] = Quaternion<T>(q[0], q[1], q[2], q[3]);
+			}
+		}
+
+		template<execution_policy Policy, std::floating_point T, size_t n>
+		inline void quaternions_to_matrices_span(Policy&& policy, std::span<const Quaternion<T>> in, std::span<Matrix<T, n, n>> out) {
+			if (out.size() < in.size()) {
+				throw std::invalid_argument("QuaternionToRotationMatrix: output span is smaller than the input");
+			}
+			for_each_range(policy, in.size(), convert_parallel_grain, [&](size_t begin, size_t end) {
+				quaternions_to_matrices(in.data() + begin, out.data() + begin, end - begin);
+			});
+		}
+
+		template<execution_policy Policy, std::floating_point T, size_t n>
+		inline void matrices_to_quaternions_span(Policy&& policy, std::span<const Matrix<T, n, n>> in, std::span<Quaternion<T>> out) {
+			if (out.size() < in.size()) {
+				throw std::invalid_argument("RotationMatrixToQuaternion: output span is smaller than the input");
+			}
+			for_each_range(policy, in.size(), convert_parallel_grain, [&](size_t begin, size_t end) {
+				matrices_to_quaternions(in.data() + begin, out.data() + begin, end - begin);
+			});
+		}
+
+		// Fewest determinants worth handing to a thread of their own
+		inline constexpr size_t det_parallel_grain = size_t(1) << 13;
+
+		// out[i] = det(in[i]), in the precision of T
+		template<std::floating_point T, size_t n>
+		inline void det_each(const Matrix<T, n, n>* in, T* out, size_t count) {
+			size_t i = 0;
+#if defined(SML_SIMD_SSE) || defined(SML_SIMD_NEON)
+			// The cofactor expansion of det, for four matrices at a time with one per lane. Not done for 3x3, where
+			// gathering the rows of twelve bytes costs more than the fourteen operations of each determinant
+			if constexpr (std::same_as<T, float> && (n == 4)) {
+				using simd = simd_ops<float, 4>;
+				using reg = simd::reg;
+				// a * b - c * d
+				const auto minor = [](reg a, reg b, reg c, reg d) { return simd::sub(simd::mul(a, b), simd::mul(c, d)); };
+				// a * x - b * y + c * z, with products and sums in the order of det4
+				const auto cofactor = [](reg a, reg x, reg b, reg y, reg c, reg z) {
+					return simd::add(simd::sub(simd::mul(a, x), simd::mul(b, y)), simd::mul(c, z));
+				};
+				const auto block = [&](const Matrix<float, 4, 4>* in4, float* out4) {
+					reg m[4][4];
+					load_transposed(in4, m);
+					const reg c0 = minor(m[2][0], m[3][1], m[2][1], m[3][0]);
+					const reg c1 = minor(m[2][0], m[3][2], m[2][2], m[3][0]);
+					const reg c2 = minor(m[2][0], m[3][3], m[2][3], m[3][0]);
+					const reg c3 = minor(m[2][1], m[3][2], m[2][2], m[3][1]);
+					const reg c4 = minor(m[2][1], m[3][3], m[2][3], m[3][1]);
+					const reg c5 = minor(m[2][2], m[3][3], m[2][3], m[3][2]);
+					reg d = simd::mul(m[0][0], cofactor(m[1][1], c5, m[1][2], c4, m[1][3], c3));
+					d = simd::sub(d, simd::mul(m[0][1], cofactor(m[1][0], c5, m[1][2], c2, m[1][3], c1)));
+					d = simd::add(d, simd::mul(m[0][2], cofactor(m[1][0], c4, m[1][1], c2, m[1][3], c0)));
+					d = simd::sub(d, simd::mul(m[0][3], cofactor(m[1][0], c3, m[1][1], c1, m[1][2], c0)));
+					simd::store(out4, d);
+				};
+				for (; (i + 4) <= count; i += 4) {
+					block(in + i, out + i);
+				}
+				// The last few through the lanes as well, padded to four, so that each result does not depend on where
+				// the range split between threads falls. The compiler may contract the scalar det4 into fused
+				// multiply-adds, which would round differently from the lanes
+				if (i < count) {
+					std::array<Matrix<float, 4, 4>, 4> padded;
+					std::array<float, 4> d;
+					std::fill(std::copy(in + i, in + count, padded.begin()), padded.end(), Matrix<float, 4, 4>(0));
+					block(padded.data(), d.data());
+					std::copy(d.begin(), d.begin() + (count - i), out + i);
+					i = count;
+				}
+			}
+#endif
+			// Without the lanes, the closed forms in the precision of T
+			for (; i < count; i++) {
+				if constexpr (n == 4) {
+					out[i] = det4(in[i].data.data());
+				}
+				else {
+					out[i] = static_cast<T>(det(in[i]));
+				}
+			}
+		}
+
+		template<execution_policy Policy, std::floating_point T, size_t n>
+		inline void det_span(Policy&& policy, std::span<const Matrix<T, n, n>> in, std::span<T> out) {
+			if (out.size() < in.size()) {
+				throw std::invalid_argument("det: output span is smaller than the input");
+			}
+			for_each_range(policy, in.size(), det_parallel_grain, [&](size_t begin, size_t end) {
+				det_each(in.data() + begin, out.data() + begin, end - begin);
+			});
+		}
+
+	} // !namespace detail
+
+	// Transform positions by m, including its translation, writing the results to the start of out
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void transform_points(Policy&& policy, const Matrix<T, 4, 4>& m, std::type_identity_t<std::span<const Vector<T, 3>>> in, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::transform_span<true>(policy, m, in, out);
+	}
+	sml_export template<std::floating_point T>
+	void transform_points(const Matrix<T, 4, 4>& m, std::type_identity_t<std::span<const Vector<T, 3>>> in, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::transform_span<true>(execution::seq, m, in, out);
+	}
+
+	// Transform directions by the upper 3x3 of m, ignoring its translation
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void transform_directions(Policy&& policy, const Matrix<T, 4, 4>& m, std::type_identity_t<std::span<const Vector<T, 3>>> in, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::transform_span<false>(policy, m, in, out);
+	}
+	sml_export template<std::floating_point T>
+	void transform_directions(const Matrix<T, 4, 4>& m, std::type_identity_t<std::span<const Vector<T, 3>>> in, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::transform_span<false>(execution::seq, m, in, out);
+	}
+
+	// Transform surface normals by the inverse transpose of m
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void transform_normals(Policy&& policy, const Matrix<T, 4, 4>& m, std::type_identity_t<std::span<const Vector<T, 3>>> in, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::transform_span<false>(policy, detail::normal_matrix(m), in, out);
+	}
+	sml_export template<std::floating_point T>
+	void transform_normals(const Matrix<T, 4, 4>& m, std::type_identity_t<std::span<const Vector<T, 3>>> in, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::transform_span<false>(execution::seq, detail::normal_matrix(m), in, out);
+	}
+
+	// Rotate each vector by Inverse(rot) * in[i] * rot, as RotateActive does
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void RotateActive(Policy&& policy, std::type_identity_t<std::span<const Vector<T, 3>>> in, const Quaternion<T>& rot, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::transform_span<false>(policy, detail::rotation_matrix(rot.s(), -rot.i(), -rot.j(), -rot.k()), in, out);
+	}
+	sml_export template<std::floating_point T>
+	void RotateActive(std::type_identity_t<std::span<const Vector<T, 3>>> in, const Quaternion<T>& rot, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		RotateActive(execution::seq, in, rot, out);
+	}
+
+	// Rotate each vector by rot * in[i] * Inverse(rot), as RotatePassive does
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void RotatePassive(Policy&& policy, std::type_identity_t<std::span<const Vector<T, 3>>> in, const Quaternion<T>& rot, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::transform_span<false>(policy, detail::rotation_matrix(rot.s(), rot.i(), rot.j(), rot.k()), in, out);
+	}
+	sml_export template<std::floating_point T>
+	void RotatePassive(std::type_identity_t<std::span<const Vector<T, 3>>> in, const Quaternion<T>& rot, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		RotatePassive(execution::seq, in, rot, out);
+	}
+
+	// Rotate each vector by its own rotation, out[i] = RotateActive(in[i], rots[i])
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void RotateActive(Policy&& policy, std::type_identity_t<std::span<const Vector<T, 3>>> in, std::span<const Quaternion<T>> rots, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::rotate_span<true, false>(policy, in, rots, out);
+	}
+	sml_export template<std::floating_point T>
+	void RotateActive(std::type_identity_t<std::span<const Vector<T, 3>>> in, std::span<const Quaternion<T>> rots, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::rotate_span<true, false>(execution::seq, in, rots, out);
+	}
+
+	// out[i] = RotatePassive(in[i], rots[i])
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void RotatePassive(Policy&& policy, std::type_identity_t<std::span<const Vector<T, 3>>> in, std::span<const Quaternion<T>> rots, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::rotate_span<false, false>(policy, in, rots, out);
+	}
+	sml_export template<std::floating_point T>
+	void RotatePassive(std::type_identity_t<std::span<const Vector<T, 3>>> in, std::span<const Quaternion<T>> rots, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::rotate_span<false, false>(execution::seq, in, rots, out);
+	}
+
+	// out[i] = RotateActiveUnit(in[i], rots[i]), for rotations of unit length only
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void RotateActiveUnit(Policy&& policy, std::type_identity_t<std::span<const Vector<T, 3>>> in, std::span<const Quaternion<T>> rots, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::rotate_span<true, true>(policy, in, rots, out);
+	}
+	sml_export template<std::floating_point T>
+	void RotateActiveUnit(std::type_identity_t<std::span<const Vector<T, 3>>> in, std::span<const Quaternion<T>> rots, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::rotate_span<true, true>(execution::seq, in, rots, out);
+	}
+
+	// out[i] = RotatePassiveUnit(in[i], rots[i]), for rotations of unit length only
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void RotatePassiveUnit(Policy&& policy, std::type_identity_t<std::span<const Vector<T, 3>>> in, std::span<const Quaternion<T>> rots, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::rotate_span<false, true>(policy, in, rots, out);
+	}
+	sml_export template<std::floating_point T>
+	void RotatePassiveUnit(std::type_identity_t<std::span<const Vector<T, 3>>> in, std::span<const Quaternion<T>> rots, std::type_identity_t<std::span<Vector<T, 3>>> out) {
+		detail::rotate_span<false, true>(execution::seq, in, rots, out);
+	}
+
+	// out[i] = QuaternionTo33RotationMatrix(in[i]), for quaternions of unit length only
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void QuaternionTo33RotationMatrix(Policy&& policy, std::span<const Quaternion<T>> in, std::type_identity_t<std::span<Matrix<T, 3, 3>>> out) {
+		detail::quaternions_to_matrices_span(policy, in, out);
+	}
+	sml_export template<std::floating_point T>
+	void QuaternionTo33RotationMatrix(std::span<const Quaternion<T>> in, std::type_identity_t<std::span<Matrix<T, 3, 3>>> out) {
+		detail::quaternions_to_matrices_span(execution::seq, in, out);
+	}
+
+	// out[i] = QuaternionTo44RotationMatrix(in[i]), for quaternions of unit length only
+	sml_export template<execution_policy Policy, std::floating_point T>
+	void QuaternionTo44RotationMatrix(Policy&& policy, std::span<const Quaternion<T>> in, std::type_identity_t<std::span<Matrix<T, 4, 4>>> out) {
+		detail::quaternions_to_matrices_span(policy, in, out);
+	}
+	sml_export template<std::floating_point T>
+	void QuaternionTo44RotationMatrix(std::span<const Quaternion<T>> in, std::type_identity_t<std::span<Matrix<T, 4, 4>>> out) {
+		detail::quaternions_to_matrices_span(execution::seq, in, out);
+	}
+
+	// out[i] = RotationMatrixToQuaternion(in[i]), for 3x3 rotations or 4x4 transforms without scale
+	sml_export template<execution_policy Policy, std::floating_point T, size_t n> requires ((n == 3) || (n == 4))
+	void RotationMatrixToQuaternion(Policy&& policy, std::span<const Matrix<T, n, n>> in, std::type_identity_t<std::span<Quaternion<T>>> out) {
+		detail::matrices_to_quaternions_span(policy, in, out);
+	}
+	sml_export template<std::floating_point T, size_t n> requires ((n == 3) || (n == 4))
+	void RotationMatrixToQuaternion(std::span<const Matrix<T, n, n>> in, std::type_identity_t<std::span<Quaternion<T>>> out) {
+		detail::matrices_to_quaternions_span(execution::seq, in, out);
+	}
+
+	// out[i] = det(in[i]) for each matrix, in the precision of T
+	sml_export template<execution_policy Policy, std::floating_point T, size_t n>
+	void det(Policy&& policy, std::span<const Matrix<T, n, n>> in, std::type_identity_t<std::span<T>> out) {
+		detail::det_span(policy, in, out);
+	}
+	sml_export template<std::floating_point T, size_t n>
+	void det(std::span<const Matrix<T, n, n>> in, std::type_identity_t<std::span<T>> out) {
+		det(execution::seq, in, out);
+	}
+
+	// out[i] = a[i] * b[i] for each pair of matrices, writing the products to the start of out
+	sml_export template<execution_policy Policy, arithmetic T, size_t n>
+	void batch_multiply(Policy&& policy, std::span<const Matrix<T, n, n>> a, std::type_identity_t<std::span<const Matrix<T, n, n>>> b, std::type_identity_t<std::span<Matrix<T, n, n>>> out) {
+		if (a.size() != b.size()) {
+			throw std::invalid_argument("batch_multiply: input spans differ in size");
+		}
+		detail::batch_multiply_span(policy, a.data(), 1, b.data(), 1, out, a.size());
+	}
+	sml_export template<arithmetic T, size_t n>
+	void batch_multiply(std::span<const Matrix<T, n, n>> a, std::type_identity_t<std::span<const Matrix<T, n, n>>> b, std::type_identity_t<std::span<Matrix<T, n, n>>> out) {
+		batch_multiply(execution::seq, a, b, out);
+	}
+
+	// out[i] = a * b[i], applying one matrix to the left of every matrix in b
+	sml_export template<execution_policy Policy, arithmetic T, size_t n>
+	void batch_multiply(Policy&& policy, const Matrix<T, n, n>& a, std::type_identity_t<std::span<const Matrix<T, n, n>>> b, std::type_identity_t<std::span<Matrix<T, n, n>>> out) {
+		// Copied so that a may itself be an element of out
+		const Matrix<T, n, n> lhs = a;
+		detail::batch_multiply_span(policy, &lhs, 0, b.data(), 1, out, b.size());
+	}
+	sml_export template<arithmetic T, size_t n>
+	void batch_multiply(const Matrix<T, n, n>& a, std::type_identity_t<std::span<const Matrix<T, n, n>>> b, std::type_identity_t<std::span<Matrix<T, n, n>>> out) {
+		batch_multiply(execution::seq, a, b, out);
+	}
+
+	// out[i] = a[i] * b, applying one matrix to the right of every matrix in a
+	sml_export template<execution_policy Policy, arithmetic T, size_t n>
+	void batch_multiply(Policy&& policy, std::type_identity_t<std::span<const Matrix<T, n, n>>> a, const Matrix<T, n, n>& b, std::type_identity_t<std::span<Matrix<T, n, n>>> out) {
+		const Matrix<T, n, n> rhs = b;
+		detail::batch_multiply_span(policy, a.data(), 1, &rhs, 0, out, a.size());
+	}
+	sml_export template<arithmetic T, size_t n>
+	void batch_multiply(std::type_identity_t<std::span<const Matrix<T, n, n>>> a, const Matrix<T, n, n>& b, std::type_identity_t<std::span<Matrix<T, n, n>>> out) {
+		batch_multiply(execution::seq, a, b, out);
+	}
+
+}
+#endif // !SML_TRANSFORM_HPP
\ No newline at end of file
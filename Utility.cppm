@@ -5,7 +5,14 @@ export module sml:Utility;
 #endif
 
 #ifdef SML_NO_IMPORT_STD
-import <numbers>
+import <algorithm>;
+import <array>;
+import <charconv>;
+import <cmath>;
+import <limits>;
+import <numbers>;
+import <ostream>;
+import <type_traits>;
 #else
 import std;
 #endif // SML_NO_IMPORT_STD
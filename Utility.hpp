@@ -6,16 +6,186 @@ namespace sml {
 	sml_export template<typename T>
 	concept arithmetic = std::integral<T> or std::floating_point<T>;
 
+	namespace detail {
+
+		// Width in bytes of the widest SIMD register on the target, used to size register blocks in kernels
+#if defined(__AVX512F__)
+		inline constexpr size_t simd_register_bytes = 64;
+#elif defined(__AVX__)
+		inline constexpr size_t simd_register_bytes = 32;
+#else
+		inline constexpr size_t simd_register_bytes = 16;
+#endif
+
+		// Number of elements of type T that fit in one SIMD register
+		template<class T>
+		inline constexpr size_t simd_lanes = (sizeof(T) < simd_register_bytes) ? (simd_register_bytes / sizeof(T)) : 1;
+
+		// Element type used by the decompositions: floating-point inputs keep their precision, integers use float
+		template<arithmetic T>
+		using decomposition_type = std::conditional_t<std::floating_point<T>, T, float>;
+
+		// Square root, sine and cosine that can be evaluated at compile time, deferring to <cmath> at run time
+		template<std::floating_point T>
+		constexpr T constexpr_sqrt(T x) {
+			if !consteval {
+				return std::sqrt(x);
+			}
+			if (!(x > T(0)) || (x == std::numeric_limits<T>::infinity())) {
+				return (x < T(0)) ? std::numeric_limits<T>::quiet_NaN() : x;
+			}
+			// Newton's method from a first guess above the root, which then falls monotonically until it converges
+			T r = (x > T(1)) ? x : T(1);
+			for (T next = (r + (x / r)) / T(2); next < r; next = (r + (x / r)) / T(2)) {
+				r = next;
+			}
+			// That leaves r within an ulp of the root; one more step with the residual x - r * r computed exactly
+			// (r * r as a sum of two terms by Dekker's product) rounds it correctly, matching std::sqrt
+			constexpr T split = T(1ull << ((std::numeric_limits<T>::digits + 1) / 2)) + T(1);
+			const T c = split * r;
+			const T hi = c - (c - r);
+			const T lo = r - hi;
+			const T p = r * r;
+			const T e = (((hi * hi) - p) + (T(2) * hi * lo)) + (lo * lo);
+			return r + (((x - p) - e) / (T(2) * r));
+		}
+
+		template<std::floating_point T>
+		constexpr T constexpr_sin(T x) {
+			if !consteval {
+				return std::sin(x);
+			}
+			// Reduce to [-pi, pi], then sum the Taylor series until its terms vanish
+			using U = std::common_type_t<T, double>;
+			constexpr U pi = std::numbers::pi_v<U>;
+			U r = static_cast<U>(x);
+			r -= (2 * pi) * static_cast<long long>(r / (2 * pi));
+			r = (r > pi) ? r - (2 * pi) : ((r < -pi) ? r + (2 * pi) : r);
+			U term = r, sum = r;
+			for (int n = 1; (sum + term) != sum; n++) {
+				term *= -(r * r) / static_cast<U>((2 * n) * ((2 * n) + 1));
+				sum += term;
+			}
+			return static_cast<T>(sum);
+		}
+
+		template<std::floating_point T>
+		constexpr T constexpr_cos(T x) {
+			if !consteval {
+				return std::cos(x);
+			}
+			using U = std::common_type_t<T, double>;
+			constexpr U pi = std::numbers::pi_v<U>;
+			U r = static_cast<U>(x);
+			r -= (2 * pi) * static_cast<long long>(r / (2 * pi));
+			r = (r > pi) ? r - (2 * pi) : ((r < -pi) ? r + (2 * pi) : r);
+			U term = 1, sum = 1;
+			for (int n = 1; (sum + term) != sum; n++) {
+				term *= -(r * r) / static_cast<U>(((2 * n) - 1) * (2 * n));
+				sum += term;
+			}
+			return static_cast<T>(sum);
+		}
+
+		// Room for any arithmetic value written by std::to_chars in its shortest round-trip form
+		inline constexpr size_t max_scalar_chars = 64;
+
+		// Write x to [first, last) as std::to_chars does, in its shortest round-trip form, with bool written as 0 or 1
+		template<arithmetic T>
+		inline std::to_chars_result scalar_to_chars(char* first, char* last, T x) {
+			if constexpr (std::same_as<T, bool>) {
+				return std::to_chars(first, last, static_cast<int>(x));
+			}
+			else {
+				return std::to_chars(first, last, x);
+			}
+		}
+
+		// Collects text in a fixed buffer and writes it to a stream in large blocks, widening it for wide streams,
+		// so that formatting many values costs no allocations and few stream calls. Call flush() when done
+		template<class CharT>
+		class text_writer {
+		public:
+			explicit text_writer(std::basic_ostream<CharT>& os) : os(os) {}
+
+			inline void put(char c) {
+				if (n == buffer.size()) {
+					flush();
+				}
+				buffer[n++] = c;
+			}
+			inline void put(const char* text, size_t count) {
+				for (size_t m = 0; count > 0; text += m, count -= m) {
+					if (n == buffer.size()) {
+						flush();
+					}
+					m = std::min(count, buffer.size() - n);
+					std::copy_n(text, m, buffer.data() + n);
+					n += m;
+				}
+			}
+			// count copies of c
+			inline void put(char c, size_t count) {
+				for (size_t m = 0; count > 0; count -= m) {
+					if (n == buffer.size()) {
+						flush();
+					}
+					m = std::min(count, buffer.size() - n);
+					std::fill_n(buffer.data() + n, m, c);
+					n += m;
+				}
+			}
+			template<arithmetic T>
+			inline void put_scalar(T x) {
+				if ((buffer.size() - n) < max_scalar_chars) {
+					flush();
+				}
+				n = static_cast<size_t>(scalar_to_chars(buffer.data() + n, buffer.data() + buffer.size(), x).ptr - buffer.data());
+			}
+
+			inline void flush() {
+				if constexpr (std::same_as<CharT, char>) {
+					os.write(buffer.data(), static_cast<std::streamsize>(n));
+				}
+				else {
+					// to_chars only writes ASCII, which widens one character at a time
+					std::array<CharT, 256> wide;
+					for (size_t i = 0; i < n; i += wide.size()) {
+						const size_t m = std::min(wide.size(), n - i);
+						for (size_t j = 0; j < m; j++) {
+							wide[j] = static_cast<CharT>(buffer[i + j]);
+						}
+						os.write(wide.data(), static_cast<std::streamsize>(m));
+					}
+				}
+				n = 0;
+			}
+
+		private:
+			std::basic_ostream<CharT>& os;
+			std::array<char, 4096> buffer;
+			size_t n = 0;
+		};
+
+		// Satisfied by the nodes of lazy element-wise expressions built by lazy() (see Expression.hpp)
+		template<class E>
+		concept lazy_expression = requires(const E& e, size_t i) {
+			{ E::lazy_size } -> std::convertible_to<size_t>;
+			e[i];
+		};
+
+	} // !namespace detail
+
 	constexpr double DegToRad = std::numbers::pi / 180.0;
 	constexpr double RadToDeg = std::numbers::inv_pi * 180.0;
 
 	sml_export template<arithmetic T>
-	double DegreesToRadians(const T& theta) {
+	constexpr double DegreesToRadians(const T& theta) {
 		return (theta * DegToRad);
 	}
 
 	sml_export template<arithmetic T>
-		double RadiansToDegrees(const T& rads) {
+		constexpr double RadiansToDegrees(const T& rads) {
 		return (rads * RadToDeg); 
 	}
 
@@ -5,6 +5,7 @@ export module sml:Vector;
 import <array>;
 import <algorithm>;
 import <iostream>;
+import <stdexcept>;
 import <unordered_map>;
 import <vector>;
 
@@ -13,6 +14,7 @@ import std;
 #endif // SML_NO_IMPORT_STD
 
 import :Utility;
+import :Simd;
 
 #ifndef sml_export
 #define sml_export export
@@ -6,6 +6,7 @@
 #include <array>
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 #include <unordered_map>
 #include <vector>
 
@@ -13,58 +14,83 @@
 #define sml_export
 #endif // !sml_export
 
+#include "Simd.hpp"
+
 #endif // !SML_MODULE_VECTOR
 
+#include "Config.hpp"
+
 namespace sml {
 
 	sml_export template <arithmetic T, size_t elements>
 		class Vector {
 		public:
-			Vector() { }
+			constexpr Vector() { }
 			template<arithmetic T2>
-			Vector(T2 t) {
+			constexpr Vector(T2 t) {
 				for (size_t i = 0; i < elements; i++) {
-					data.at(i) = static_cast<T>(t);
+					data[i] = static_cast<T>(t);
 				}
 			}
 			template<arithmetic ...T2>
-			Vector(T2 ...ts) : data{ static_cast<T>(ts)... } {}
+			constexpr Vector(T2 ...ts) : data{ static_cast<T>(ts)... } {}
 			template<arithmetic T2>
-			Vector(const Vector<T2, elements>& v2) {
-				std::transform(v2.begin(), v2.end(), data.begin(), [](T2 t)->T {return static_cast<T>(t); });
+			constexpr Vector(const Vector<T2, elements>& v2) {
+				for (size_t i = 0; i < elements; i++) {
+					data[i] = static_cast<T>(v2[i]);
+				}
 			}
 			template<arithmetic T2>
-			Vector(const T2 arr[elements]) {
+			constexpr Vector(const T2 arr[elements]) {
 				for (size_t i = 0; i < elements; i++) {
-					data.at(i) = static_cast<T>(arr[i]);
+					data[i] = static_cast<T>(arr[i]);
 				}
 			}
 			template<arithmetic T2>
-			Vector(const std::array<T2, elements> arr) {
-				std::transform(arr.begin(), arr.end(), data.begin(), [](T2 t)->T {return static_cast<T>(t); });
+			constexpr Vector(const std::array<T2, elements> arr) {
+				for (size_t i = 0; i < elements; i++) {
+					data[i] = static_cast<T>(arr[i]);
+				}
+			}
+
+			// Evaluate a lazy expression (see lazy() in Expression.hpp) in a single pass
+			template<detail::lazy_expression E>
+				requires (E::lazy_size == elements)
+			constexpr Vector(const E& e) {
+				for (size_t i = 0; i < elements; i++) {
+					data[i] = static_cast<T>(e[i]);
+				}
 			}
 
 			// Access elements with v[i]
-			inline T operator [] (size_t i) const { return data[i]; }
-			inline T& operator [] (size_t i) { return data[i]; }
+			inline constexpr T operator [] (size_t i) const {
+				SML_CHECK_INDEX(i, elements);
+				return data[i];
+			}
+			inline constexpr T& operator [] (size_t i) {
+				SML_CHECK_INDEX(i, elements);
+				return data[i];
+			}
 
 			// Access elements with v.at(i)
-			inline T at(int i) const { return data.at(i); }
-			inline T& at(int i) { return data.at(i); }
+			inline constexpr T at(int i) const { return data.at(i); }
+			inline constexpr T& at(int i) { return data.at(i); }
 
 			// Unary operators
-			inline const Vector& operator + () const { return *this; }
-			inline Vector operator - () const {
-				Vector<T, elements> ret = *this;
-				std::transform(ret.begin(), ret.end(), ret.begin(), [](T t)->T {return -t; });
+			inline constexpr const Vector& operator + () const { return *this; }
+			inline constexpr Vector operator - () const {
+				Vector<T, elements> ret;
+				for (size_t i = 0; i < elements; i++) {
+					ret.data[i] = -data[i];
+				}
 				return ret;
 			}
 
 			// Comparison operators
-			inline bool operator == (const Vector<T, elements>& v2) const {
+			inline constexpr bool operator == (const Vector<T, elements>& v2) const {
 				return std::equal(data.begin(), data.end(), v2.begin(), v2.end());
 			}
-			inline bool operator != (const Vector<T, elements>& v2) const {
+			inline constexpr bool operator != (const Vector<T, elements>& v2) const {
 				return !(*this == v2);
 			}
 
@@ -72,88 +98,106 @@ namespace sml {
 
 			// Addition
 			template<arithmetic T2>
-			inline Vector<T, elements>& operator += (const Vector<T2, elements>& v2);
+			inline constexpr Vector<T, elements>& operator += (const Vector<T2, elements>& v2);
 			template<arithmetic T2>
-			inline Vector<T, elements>& operator += (const T2& t);
+			inline constexpr Vector<T, elements>& operator += (const T2& t);
 
 			// Subtraction
 			template<arithmetic T2>
-			inline Vector<T, elements>& operator -= (const Vector<T2, elements>& v2);
+			inline constexpr Vector<T, elements>& operator -= (const Vector<T2, elements>& v2);
 			template<arithmetic T2>
-			inline Vector<T, elements>& operator -= (const T2& t);
+			inline constexpr Vector<T, elements>& operator -= (const T2& t);
 
 			// Multiplication
 			template<arithmetic T2>
-			inline Vector<T, elements>& operator *= (const Vector<T2, elements>& v2);
+			inline constexpr Vector<T, elements>& operator *= (const Vector<T2, elements>& v2);
 			template<arithmetic T2>
-			inline Vector<T, elements>& operator *= (const T2& t);
+			inline constexpr Vector<T, elements>& operator *= (const T2& t);
 
 			// Division
 			template<arithmetic T2>
-			inline Vector<T, elements>& operator /= (const Vector<T2, elements>& v2);
+			inline constexpr Vector<T, elements>& operator /= (const Vector<T2, elements>& v2);
 			template<arithmetic T2>
-			inline Vector<T, elements>& operator /= (const T2& t);
+			inline constexpr Vector<T, elements>& operator /= (const T2& t);
 
 			// Modulus - requires integer operands
 			template<arithmetic T2>
-			inline Vector<T, elements>& operator %= (const Vector<T2, elements>& v2);
+			inline constexpr Vector<T, elements>& operator %= (const Vector<T2, elements>& v2);
 			template<arithmetic T2>
-			inline Vector<T, elements>& operator %= (const T2& t);
+			inline constexpr Vector<T, elements>& operator %= (const T2& t);
 
 			// Assignment operator
 			template<arithmetic T2>
-			inline Vector& operator = (const Vector<T2, elements>& v2) {
-				std::transform(v2.begin(), v2.end(), data.begin(), [](T2 t)->T {return static_cast<T>(t); });
+			inline constexpr Vector& operator = (const Vector<T2, elements>& v2) {
+				for (size_t i = 0; i < elements; i++) {
+					data[i] = static_cast<T>(v2[i]);
+				}
+				return *this;
+			}
+
+			template<detail::lazy_expression E>
+				requires (E::lazy_size == elements)
+			inline constexpr Vector& operator = (const E& e) {
+				for (size_t i = 0; i < elements; i++) {
+					data[i] = static_cast<T>(e[i]);
+				}
 				return *this;
 			}
 
 			// Accessor functions for accessing uv/coordinate/colour elements - analogous to at()
-			// Useful for code readability, but use with caution as all are available for vectors of any length
-			// Eg. Calling a() on a 3-vector will throw an error
-			inline T& u() { return data.at(0); }
-			inline T& v() { return data.at(1); }
-			inline T& x() { return data.at(0); }
-			inline T& y() { return data.at(1); }
-			inline T& z() { return data.at(2); }
-			inline T& w() { return data.at(3); }
-			inline T& r() { return data.at(0); }
-			inline T& g() { return data.at(1); }
-			inline T& b() { return data.at(2); }
-			inline T& a() { return data.at(3); }
-			inline T& roll() { return data.at(0); }
-			inline T& pitch() { return data.at(1); }
-			inline T& yaw() { return data.at(2); }
-			inline T u() const { return data.at(0); }
-			inline T v() const { return data.at(1); }
-			inline T x() const { return data.at(0); }
-			inline T y() const { return data.at(1); }
-			inline T z() const { return data.at(2); }
-			inline T w() const { return data.at(3); }
-			inline T r() const { return data.at(0); }
-			inline T g() const { return data.at(1); }
-			inline T b() const { return data.at(2); }
-			inline T a() const { return data.at(3); }
-			inline T roll() const { return data.at(0); }
-			inline T pitch() const { return data.at(1); }
-			inline T yaw() const { return data.at(2); }
+			// Useful for code readability. Each is only available on vectors long enough to have that element,
+			// eg. calling a() on a 3-vector will not compile, so they need no checks at run time
+			inline constexpr T& u() { return data[0]; }
+			inline constexpr T& v() requires (elements >= 2) { return data[1]; }
+			inline constexpr T& x() { return data[0]; }
+			inline constexpr T& y() requires (elements >= 2) { return data[1]; }
+			inline constexpr T& z() requires (elements >= 3) { return data[2]; }
+			inline constexpr T& w() requires (elements >= 4) { return data[3]; }
+			inline constexpr T& r() { return data[0]; }
+			inline constexpr T& g() requires (elements >= 2) { return data[1]; }
+			inline constexpr T& b() requires (elements >= 3) { return data[2]; }
+			inline constexpr T& a() requires (elements >= 4) { return data[3]; }
+			inline constexpr T& roll() { return data[0]; }
+			inline constexpr T& pitch() requires (elements >= 2) { return data[1]; }
+			inline constexpr T& yaw() requires (elements >= 3) { return data[2]; }
+			inline constexpr T u() const { return data[0]; }
+			inline constexpr T v() const requires (elements >= 2) { return data[1]; }
+			inline constexpr T x() const { return data[0]; }
+			inline constexpr T y() const requires (elements >= 2) { return data[1]; }
+			inline constexpr T z() const requires (elements >= 3) { return data[2]; }
+			inline constexpr T w() const requires (elements >= 4) { return data[3]; }
+			inline constexpr T r() const { return data[0]; }
+			inline constexpr T g() const requires (elements >= 2) { return data[1]; }
+			inline constexpr T b() const requires (elements >= 3) { return data[2]; }
+			inline constexpr T a() const requires (elements >= 4) { return data[3]; }
+			inline constexpr T roll() const { return data[0]; }
+			inline constexpr T pitch() const requires (elements >= 2) { return data[1]; }
+			inline constexpr T yaw() const requires (elements >= 3) { return data[2]; }
 
 			// Is this a zero vector?
-			inline bool IsZero() const {
+			inline constexpr bool IsZero() const {
 				return Vector<T, elements>(0) == *this;
 			}
 
 			// Make this vector a zero vector
-			inline void Clear(void* = 0) {
+			inline constexpr void Clear(void* = 0) {
 				for (int i = 0; i < elements; i++) {
 					data[i] = T(0);
 				}
 			}
-			inline void Zero() {
+			inline constexpr void Zero() {
 				Clear();
 			}
 
 			// v1 = v1 + v2 * weight
-			void AddWithWeight(Vector const& v2, float weight) {
+			constexpr void AddWithWeight(Vector const& v2, float weight) {
+				if !consteval {
+					if constexpr (detail::simd_enabled<T, elements>) {
+						using simd = detail::simd_ops<T, elements>;
+						simd::store(data.data(), simd::fma(simd::load(v2.data.data()), simd::broadcast(static_cast<T>(weight)), simd::load(data.data())));
+						return;
+					}
+				}
 				for (int i = 0; i < elements; i++) {
 					data[i] += v2.data[i] * weight;
 				}
@@ -171,7 +215,8 @@ namespace sml {
 			inline constexpr std::array<T, elements>::size_type max_size() const noexcept { return data.max_size(); }
 			inline constexpr bool empty() const noexcept { return data.empty(); }
 		private:
-			std::array<T, elements> data = {};
+			// Aligned to the SIMD register width when the SIMD backend handles this Vector
+			alignas(detail::simd_alignment<T, elements>) std::array<T, elements> data = {};
 	};
 
 	// Write vector to ostream
@@ -199,14 +244,21 @@ namespace sml {
 	// Vector addition
 	sml_export template<arithmetic T, size_t elements>
 		template<arithmetic T2>
-	inline Vector<T, elements>& Vector<T, elements>::operator += (const Vector<T2, elements>& v2) {
+	inline constexpr Vector<T, elements>& Vector<T, elements>::operator += (const Vector<T2, elements>& v2) {
+		if !consteval {
+			if constexpr (std::is_same_v<T, T2> && detail::simd_enabled<T, elements>) {
+				using simd = detail::simd_ops<T, elements>;
+				simd::store(data.data(), simd::add(simd::load(data.data()), simd::load(v2.data.data())));
+				return *this;
+			}
+		}
 		for (size_t i = 0; i < elements; i++) {
 			data[i] += static_cast<T>(v2[i]);
 		}
 		return *this;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator + (Vector<T, elements> v1, const Vector<T2, elements>& v2) {
+		inline constexpr Vector<T, elements> operator + (Vector<T, elements> v1, const Vector<T2, elements>& v2) {
 		v1 += v2;
 		return v1;
 	}
@@ -214,19 +266,26 @@ namespace sml {
 	// Scalar addition
 	sml_export template<arithmetic T, size_t elements>
 		template<arithmetic T2>
-	inline Vector<T, elements>& Vector<T, elements>::operator+= (const T2& t) {
+	inline constexpr Vector<T, elements>& Vector<T, elements>::operator+= (const T2& t) {
+		if !consteval {
+			if constexpr (detail::simd_enabled<T, elements>) {
+				using simd = detail::simd_ops<T, elements>;
+				simd::store(data.data(), simd::add(simd::load(data.data()), simd::broadcast(static_cast<T>(t))));
+				return *this;
+			}
+		}
 		for (size_t i = 0; i < elements; i++) {
 			data[i] += static_cast<T>(t);
 		}
 		return *this;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator + (Vector<T, elements> v1, const T2& t) {
+		inline constexpr Vector<T, elements> operator + (Vector<T, elements> v1, const T2& t) {
 		v1 += t;
 		return v1;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator + (const T2& t, Vector<T, elements> v1) {
+		inline constexpr Vector<T, elements> operator + (const T2& t, Vector<T, elements> v1) {
 		v1 += t;
 		return v1;
 	}
@@ -234,14 +293,21 @@ namespace sml {
 	// Vector subtraction
 	sml_export template<arithmetic T, size_t elements>
 		template<arithmetic T2>
-	inline Vector<T, elements>& Vector<T, elements>::operator -= (const Vector<T2, elements>& v2) {
+	inline constexpr Vector<T, elements>& Vector<T, elements>::operator -= (const Vector<T2, elements>& v2) {
+		if !consteval {
+			if constexpr (std::is_same_v<T, T2> && detail::simd_enabled<T, elements>) {
+				using simd = detail::simd_ops<T, elements>;
+				simd::store(data.data(), simd::sub(simd::load(data.data()), simd::load(v2.data.data())));
+				return *this;
+			}
+		}
 		for (size_t i = 0; i < elements; i++) {
 			data[i] -= static_cast<T>(v2[i]);
 		}
 		return *this;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator - (Vector<T, elements> v1, const Vector<T2, elements>& v2) {
+		inline constexpr Vector<T, elements> operator - (Vector<T, elements> v1, const Vector<T2, elements>& v2) {
 		v1 -= v2;
 		return v1;
 	}
@@ -249,19 +315,26 @@ namespace sml {
 	// Scalar subtraction
 	sml_export template<arithmetic T, size_t elements>
 		template<arithmetic T2>
-	inline Vector<T, elements>& Vector<T, elements>::operator-= (const T2& t) {
+	inline constexpr Vector<T, elements>& Vector<T, elements>::operator-= (const T2& t) {
+		if !consteval {
+			if constexpr (detail::simd_enabled<T, elements>) {
+				using simd = detail::simd_ops<T, elements>;
+				simd::store(data.data(), simd::sub(simd::load(data.data()), simd::broadcast(static_cast<T>(t))));
+				return *this;
+			}
+		}
 		for (size_t i = 0; i < elements; i++) {
 			data[i] -= static_cast<T>(t);
 		}
 		return *this;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator - (Vector<T, elements> v1, const T2& t) {
+		inline constexpr Vector<T, elements> operator - (Vector<T, elements> v1, const T2& t) {
 		v1 -= t;
 		return v1;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator - (const T2& t, Vector<T, elements> v1) {
+		inline constexpr Vector<T, elements> operator - (const T2& t, Vector<T, elements> v1) {
 		for (size_t i = 0; i < elements; i++) {
 			v1[i] = static_cast<T>(t) - v1[i];
 		}
@@ -271,14 +344,21 @@ namespace sml {
 	// Vector multiplication
 	sml_export template<arithmetic T, size_t elements>
 		template<arithmetic T2>
-	inline Vector<T, elements>& Vector<T, elements>::operator *= (const Vector<T2, elements>& v2) {
+	inline constexpr Vector<T, elements>& Vector<T, elements>::operator *= (const Vector<T2, elements>& v2) {
+		if !consteval {
+			if constexpr (std::is_same_v<T, T2> && detail::simd_enabled<T, elements>) {
+				using simd = detail::simd_ops<T, elements>;
+				simd::store(data.data(), simd::mul(simd::load(data.data()), simd::load(v2.data.data())));
+				return *this;
+			}
+		}
 		for (size_t i = 0; i < elements; i++) {
 			data[i] *= static_cast<T>(v2[i]);
 		}
 		return *this;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator * (Vector<T, elements> v1, const Vector<T2, elements>& v2) {
+		inline constexpr Vector<T, elements> operator * (Vector<T, elements> v1, const Vector<T2, elements>& v2) {
 		v1 *= v2;
 		return v1;
 	}
@@ -286,19 +366,26 @@ namespace sml {
 	// Scalar multiplication
 	sml_export template<arithmetic T, size_t elements>
 		template<arithmetic T2>
-	inline Vector<T, elements>& Vector<T, elements>::operator*= (const T2& t) {
+	inline constexpr Vector<T, elements>& Vector<T, elements>::operator*= (const T2& t) {
+		if !consteval {
+			if constexpr (detail::simd_enabled<T, elements>) {
+				using simd = detail::simd_ops<T, elements>;
+				simd::store(data.data(), simd::mul(simd::load(data.data()), simd::broadcast(static_cast<T>(t))));
+				return *this;
+			}
+		}
 		for (size_t i = 0; i < elements; i++) {
 			data[i] *= static_cast<T>(t);
 		}
 		return *this;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator * (Vector<T, elements> v1, const T2& t) {
+		inline constexpr Vector<T, elements> operator * (Vector<T, elements> v1, const T2& t) {
 		v1 *= t;
 		return v1;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator * (const T2& t, Vector<T, elements> v1) {
+		inline constexpr Vector<T, elements> operator * (const T2& t, Vector<T, elements> v1) {
 		v1 *= t;
 		return v1;
 	}
@@ -306,14 +393,21 @@ namespace sml {
 	// Vector division
 	sml_export template<arithmetic T, size_t elements>
 		template<arithmetic T2>
-	inline Vector<T, elements>& Vector<T, elements>::operator /= (const Vector<T2, elements>& v2) {
+	inline constexpr Vector<T, elements>& Vector<T, elements>::operator /= (const Vector<T2, elements>& v2) {
+		if !consteval {
+			if constexpr (std::is_same_v<T, T2> && detail::simd_enabled<T, elements>) {
+				using simd = detail::simd_ops<T, elements>;
+				simd::store(data.data(), simd::div(simd::load(data.data()), simd::load(v2.data.data())));
+				return *this;
+			}
+		}
 		for (size_t i = 0; i < elements; i++) {
 			data[i] /= static_cast<T>(v2[i]);
 		}
 		return *this;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator / (Vector<T, elements> v1, const Vector<T2, elements>& v2) {
+		inline constexpr Vector<T, elements> operator / (Vector<T, elements> v1, const Vector<T2, elements>& v2) {
 		v1 /= v2;
 		return v1;
 	}
@@ -321,20 +415,26 @@ namespace sml {
 	// Scalar division
 	sml_export template<arithmetic T, size_t elements>
 		template<arithmetic T2>
-	inline Vector<T, elements>& Vector<T, elements>::operator /= (const T2& t) {
-		double inverse = 1.0 / static_cast<T>(t);
+	inline constexpr Vector<T, elements>& Vector<T, elements>::operator /= (const T2& t) {
+		if !consteval {
+			if constexpr (detail::simd_enabled<T, elements>) {
+				using simd = detail::simd_ops<T, elements>;
+				simd::store(data.data(), simd::div(simd::load(data.data()), simd::broadcast(static_cast<T>(t))));
+				return *this;
+			}
+		}
 		for (size_t i = 0; i < elements; i++) {
-			data[i] *= inverse;
+			data[i] /= static_cast<T>(t);
 		}
 		return *this;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator / (Vector<T, elements> v1, const T2& t) {
+		inline constexpr Vector<T, elements> operator / (Vector<T, elements> v1, const T2& t) {
 		v1 /= t;
 		return v1;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator / (const T2& t, Vector<T, elements> v1) {
+		inline constexpr Vector<T, elements> operator / (const T2& t, Vector<T, elements> v1) {
 		for (size_t i = 0; i < elements; i++) {
 			v1[i] = static_cast<T>(t) / v1[i];
 		}
@@ -344,14 +444,14 @@ namespace sml {
 	// Vector modulus - requires integer operands
 	sml_export template<arithmetic T, size_t elements>
 		template<arithmetic T2>
-	inline Vector<T, elements>& Vector<T, elements>::operator %= (const Vector<T2, elements>& v2) {
+	inline constexpr Vector<T, elements>& Vector<T, elements>::operator %= (const Vector<T2, elements>& v2) {
 		for (size_t i = 0; i < elements; i++) {
 			data[i] %= static_cast<T>(v2[i]);
 		}
 		return *this;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator % (Vector<T, elements> v1, const Vector<T2, elements>& v2) {
+		inline constexpr Vector<T, elements> operator % (Vector<T, elements> v1, const Vector<T2, elements>& v2) {
 		v1 %= v2;
 		return v1;
 	}
@@ -359,26 +459,32 @@ namespace sml {
 	// Scalar modulus - requires integer operands
 	sml_export template<arithmetic T, size_t elements>
 		template<arithmetic T2>
-	inline Vector<T, elements>& Vector<T, elements>::operator%= (const T2& t) {
+	inline constexpr Vector<T, elements>& Vector<T, elements>::operator%= (const T2& t) {
 		for (size_t i = 0; i < elements; i++) {
 			data[i] %= static_cast<T>(t);
 		}
 		return *this;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator % (Vector<T, elements> v1, const T2& t) {
+		inline constexpr Vector<T, elements> operator % (Vector<T, elements> v1, const T2& t) {
 		v1 %= t;
 		return v1;
 	}
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
-		inline Vector<T, elements> operator % (const T2& t, Vector<T, elements> v1) {
+		inline constexpr Vector<T, elements> operator % (const T2& t, Vector<T, elements> v1) {
 		v1 %= t;
 		return v1;
 	}
 
 	// Perform the dot product on two equal-length vectors
+	// Each product is in the precision of T and their sum is in double, with the SIMD backend as without it
 	sml_export template<arithmetic T, size_t elements, arithmetic T2>
 		double constexpr dot(const Vector<T, elements>& v1, const Vector<T2, elements>& v2) {
+		if !consteval {
+			if constexpr (std::is_same_v<T, T2> && detail::simd_enabled<T, elements>) {
+				return detail::simd_ops<T, elements>::dot_double(&*v1.begin(), &*v2.begin());
+			}
+		}
 		double ret = 0.0;
 		for (int i = 0; i < elements; i++) {
 			ret += v1[i] * static_cast<T>(v2[i]);
@@ -388,13 +494,18 @@ namespace sml {
 
 	// Calculate the length of the vector
 	sml_export template<arithmetic T, size_t elements>
-		double length(const Vector<T, elements>& v) {
-		return std::sqrt(squared_length(v));
+		double constexpr length(const Vector<T, elements>& v) {
+		return detail::constexpr_sqrt(squared_length(v));
 	}
 
 	// Calculate the square of the length of the vector
 	sml_export template<arithmetic T, size_t elements>
-		double squared_length(const Vector<T, elements>& v) {
+		double constexpr squared_length(const Vector<T, elements>& v) {
+		if !consteval {
+			if constexpr (detail::simd_enabled<T, elements>) {
+				return detail::simd_ops<T, elements>::dot_double(&*v.begin(), &*v.begin());
+			}
+		}
 		double ret = 0.0;
 		for (auto i : v) {
 			ret += (i * i);
@@ -404,7 +515,7 @@ namespace sml {
 
 	// Normalise the vector
 	sml_export template<arithmetic T, size_t elements>
-		Vector<T, elements> unit_vector(const Vector<T, elements>& v) {
+		Vector<T, elements> constexpr unit_vector(const Vector<T, elements>& v) {
 		return v / length(v);
 	}
 
@@ -412,40 +523,71 @@ namespace sml {
 	// The cross product only exists in 3 and 7 dimensions
 	sml_export template<arithmetic T>
 		Vector<T, 3> constexpr cross_product(const Vector<T, 3>& v1, const Vector<T, 3>& v2) {
+		if !consteval {
+			if constexpr (std::is_same_v<T, float> && detail::simd_enabled<T, 3>) {
+				using simd = detail::simd_ops<T, 3>;
+				Vector<T, 3> ret;
+				simd::store(&*ret.begin(), simd::cross(simd::load(&*v1.begin()), simd::load(&*v2.begin())));
+				return ret;
+			}
+		}
 		return Vector<T, 3>((v1[1] * v2[2] - v1[2] * v2[1]), (v1[2] * v2[0] - v1[0] * v2[2]), (v1[0] * v2[1] - v1[1] * v2[0]));
 	}
 
+	// Fused multiply-add: returns v1 * v2 + v3, element-wise
+	sml_export template<arithmetic T, size_t elements>
+		Vector<T, elements> constexpr fma(const Vector<T, elements>& v1, const Vector<T, elements>& v2, const Vector<T, elements>& v3) {
+		Vector<T, elements> ret;
+		if !consteval {
+			if constexpr (detail::simd_enabled<T, elements>) {
+				using simd = detail::simd_ops<T, elements>;
+				simd::store(&*ret.begin(), simd::fma(simd::load(&*v1.begin()), simd::load(&*v2.begin()), simd::load(&*v3.begin())));
+				return ret;
+			}
+		}
+		for (size_t i = 0; i < elements; i++) {
+			ret[i] = v1[i] * v2[i] + v3[i];
+		}
+		return ret;
+	}
+
 	using std::abs;
 	sml_export template<arithmetic T>
-		Vector<T, 3> abs(const Vector<T, 3>& v) {
+		Vector<T, 3> constexpr abs(const Vector<T, 3>& v) {
 		return Vector<T, 3>(abs(v[0]), abs(v[1]), abs(v[2]));
 	}
 
 	sml_export template<arithmetic T, size_t elements, arithmetic T2, arithmetic T3>
-		Vector<T, elements> lerp(const Vector<T, elements>& v1, const Vector<T2, elements>& v2, const T3 t) {
-		return (v1 + ((v2 - v1) * static_cast<T>(t)));
+		Vector<T, elements> constexpr lerp(const Vector<T, elements>& v1, const Vector<T2, elements>& v2, const T3 t) {
+		// Evaluated in a single pass rather than through the arithmetic operators, which would create three temporaries
+		Vector<T, elements> ret;
+		const T weight = static_cast<T>(t);
+		for (size_t i = 0; i < elements; i++) {
+			ret[i] = v1[i] + ((static_cast<T>(v2[i]) - v1[i]) * weight);
+		}
+		return ret;
 	}
 
 	// Return the index containing the largest value
 	sml_export template<arithmetic T, size_t elements>
-		size_t max_element(const Vector<T, elements>& v) {
+		size_t constexpr max_element(const Vector<T, elements>& v) {
 		return std::distance(v.begin(), std::max_element(v.begin(), v.end()));
 	}
 
 	// Return the index containing the smallest value
 	sml_export template<arithmetic T, size_t elements>
-		size_t min_element(const Vector<T, elements>& v) {
+		size_t constexpr min_element(const Vector<T, elements>& v) {
 		return std::distance(v.begin(), std::min_element(v.begin(), v.end()));
 	}
 
 	// Return the largest element
 	sml_export template<arithmetic T, size_t elements>
-		T max(const Vector<T, elements>& v) {
+		T constexpr max(const Vector<T, elements>& v) {
 		return *std::max_element(v.begin(), v.end());
 	}
 	// Given two equal-length vectors, return a vector containing the largest value for each dimension, 
 	sml_export template<arithmetic T, size_t elements>
-		Vector<T, elements> max(const Vector<T, elements>& v1, const Vector<T, elements>& v2) {
+		Vector<T, elements> constexpr max(const Vector<T, elements>& v1, const Vector<T, elements>& v2) {
 		Vector<T, elements> ret;
 		for (size_t i = 0; i < elements; i++) {
 			ret[i] = v1[i] > v2[i] ? v1[i] : v2[i];
@@ -454,20 +596,20 @@ namespace sml {
 	}
 	// Given two 2-vectors, return a 2-vector containing the largest value for each dimension
 	sml_export template<arithmetic T>
-		Vector<T, 2> max(const Vector<T, 2>& v1, const Vector<T, 2>& v2) {
+		Vector<T, 2> constexpr max(const Vector<T, 2>& v1, const Vector<T, 2>& v2) {
 		return Vector<T, 2>(v1[0] > v2[0] ? v1[0] : v2[0],
 			v1[1] > v2[1] ? v1[1] : v2[1]);
 	}
 	// Given two 3-vectors, return a 3-vector containing the largest value for each dimension
 	sml_export template<arithmetic T>
-		Vector<T, 3> max(const Vector<T, 3>& v1, const Vector<T, 3>& v2) {
+		Vector<T, 3> constexpr max(const Vector<T, 3>& v1, const Vector<T, 3>& v2) {
 		return Vector<T, 3>(v1[0] > v2[0] ? v1[0] : v2[0],
 			v1[1] > v2[1] ? v1[1] : v2[1],
 			v1[2] > v2[2] ? v1[2] : v2[2]);
 	}
 	// Given two 4-vectors, return a 4-vector containing the smallest value for each dimension
 	sml_export template<arithmetic T>
-		Vector<T, 4> max(const Vector<T, 4>& v1, const Vector<T, 4>& v2) {
+		Vector<T, 4> constexpr max(const Vector<T, 4>& v1, const Vector<T, 4>& v2) {
 		return Vector<T, 4>(v1[0] > v2[0] ? v1[0] : v2[0],
 			v1[1] > v2[1] ? v1[1] : v2[1],
 			v1[2] > v2[2] ? v1[2] : v2[2],
@@ -476,12 +618,12 @@ namespace sml {
 
 	// Return the smallest element
 	sml_export template<arithmetic T, size_t elements>
-		T min(const Vector<T, elements>& v) {
+		T constexpr min(const Vector<T, elements>& v) {
 		return *std::min_element(v.begin(), v.end());
 	}
 	// Given two equal-length vectors, return a vector containing the smallest value for each dimension, 
 	sml_export template<arithmetic T, size_t elements>
-		Vector<T, elements> min(const Vector<T, elements>& v1, const Vector<T, elements>& v2) {
+		Vector<T, elements> constexpr min(const Vector<T, elements>& v1, const Vector<T, elements>& v2) {
 		Vector<T, elements> ret;
 		for (size_t i = 0; i < elements; i++) {
 			ret[i] = v1[i] < v2[i] ? v1[i] : v2[i];
@@ -490,20 +632,20 @@ namespace sml {
 	}
 	// Given two 2-vectors, return a 2-vector containing the smallest value for each dimension
 	sml_export template<arithmetic T>
-		Vector<T, 2> min(const Vector<T, 2>& v1, const Vector<T, 2>& v2) {
+		Vector<T, 2> constexpr min(const Vector<T, 2>& v1, const Vector<T, 2>& v2) {
 		return Vector<T, 2>(v1[0] < v2[0] ? v1[0] : v2[0],
 			v1[1] < v2[1] ? v1[1] : v2[1]);
 	}
 	// Given two 3-vectors, return a 3-vector containing the smallest value for each dimension
 	sml_export template<arithmetic T>
-		Vector<T, 3> min(const Vector<T, 3>& v1, const Vector<T, 3>& v2) {
+		Vector<T, 3> constexpr min(const Vector<T, 3>& v1, const Vector<T, 3>& v2) {
 		return Vector<T, 3>(v1[0] < v2[0] ? v1[0] : v2[0],
 			v1[1] < v2[1] ? v1[1] : v2[1],
 			v1[2] < v2[2] ? v1[2] : v2[2]);
 	}
 	// Given two 4-vectors, return a 4-vector containing the smallest value for each dimension
 	sml_export template<arithmetic T>
-		Vector<T, 4> min(const Vector<T, 4>& v1, const Vector<T, 4>& v2) {
+		Vector<T, 4> constexpr min(const Vector<T, 4>& v1, const Vector<T, 4>& v2) {
 		return Vector<T, 4>(v1[0] < v2[0] ? v1[0] : v2[0],
 			v1[1] < v2[1] ? v1[1] : v2[1],
 			v1[2] < v2[2] ? v1[2] : v2[2],
@@ -512,17 +654,16 @@ namespace sml {
 
 	// Reorder vector indices as desired
 	sml_export template<arithmetic T, size_t elements, arithmetic ...Ts>
-		Vector<T, elements> permute(const Vector<T, elements>& v, Ts ...ts) {
+		Vector<T, elements> constexpr permute(const Vector<T, elements>& v, Ts ...ts) {
 		Vector<T, elements> ret;
-		std::vector<size_t>indices({ static_cast<size_t>(ts)... });
+		const std::array<size_t, sizeof...(Ts)> indices = { static_cast<size_t>(ts)... };
 		for (size_t i = 0; i < indices.size(); i++) {
 			ret[i] = v[indices[i]];
 		}
-		indices.clear();
 		return ret;
 	}
 	sml_export template<arithmetic T, size_t elements>
-		Vector<T, elements> permute(const Vector<T, elements>& v, const Vector<size_t, elements> indices) {
+		Vector<T, elements> constexpr permute(const Vector<T, elements>& v, const Vector<size_t, elements> indices) {
 		Vector<T, elements> ret;
 		for (size_t i = 0; i < indices.size(); i++) {
 			ret[i] = v[indices[i]];
@@ -530,15 +671,15 @@ namespace sml {
 		return ret;
 	}
 	sml_export template<arithmetic T>
-		Vector<T, 2> permute(const Vector<T, 2>& v, size_t x, size_t y) {
+		Vector<T, 2> constexpr permute(const Vector<T, 2>& v, size_t x, size_t y) {
 		return Vector<T, 2>(v[x], v[y]);
 	}
 	sml_export template<arithmetic T>
-		Vector<T, 3> permute(const Vector<T, 3>& v, size_t x, size_t y, size_t z) {
+		Vector<T, 3> constexpr permute(const Vector<T, 3>& v, size_t x, size_t y, size_t z) {
 		return Vector<T, 3>(v[x], v[y], v[z]);
 	}
 	sml_export template<arithmetic T>
-		Vector<T, 4> permute(const Vector<T, 4>& v, size_t x, size_t y, size_t z, size_t w) {
+		Vector<T, 4> constexpr permute(const Vector<T, 4>& v, size_t x, size_t y, size_t z, size_t w) {
 		return Vector<T, 4>(v[x], v[y], v[z], v[w]);
 	}
 
@@ -563,7 +704,7 @@ namespace std {
 		size_t operator()(sml::Vector<T, elements> const& vec) const;
 	};
 
-	void hash_combine(size_t& seed, size_t hash) {
+	inline void hash_combine(size_t& seed, size_t hash) {
 		hash += 0x9e3779b9 + (seed << 6) + (seed >> 2);
 		seed ^= hash;
 	}
@@ -574,7 +715,7 @@ namespace std {
 		hash<double> hasher;
 
 		for (int i = 0; i < elements; i++) {
-			hash_combine(seed, vec.at(i));
+			hash_combine(seed, vec[i]);
 		}
 		return seed;
 	}
@@ -0,0 +1,400 @@
+#ifndef SML_BENCH_HPP
+#define SML_BENCH_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "SML.hpp"
+
+// A small self-contained microbenchmark harness, modelled on Google Benchmark
+//
+//     sml::bench::add("vector/add/float/4", [](sml::bench::State& state) {
+//         while (state.keep_running()) { ... }
+//     });
+//
+// Each benchmark is run for enough iterations to fill the minimum time, and the results are written to the console
+// and optionally as JSON in Google Benchmark's format, so that runs can be archived and compared with
+// sml_bench --compare baseline.json candidate.json (or with Google Benchmark's own compare.py)
+
+namespace sml::bench {
+
+	// Keep the compiler from discarding value, or from assuming anything about it afterwards
+	template<class T>
+	inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+	}
+	template<class T>
+	inline void do_not_optimize(T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : "+r,m"(value) : : "memory");
+#else
+		static volatile void* sink;
+		sink = &value;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+	}
+
+	// Loop control and timing for one run of a benchmark
+	class State {
+	public:
+		explicit State(size_t iterations) : remaining(iterations), iterations_run(iterations) {}
+
+		// True until the requested number of iterations has been run. Timing starts on the first call
+		inline bool keep_running() {
+			if (!started) {
+				started = true;
+				start_real = std::chrono::steady_clock::now();
+				start_cpu = std::clock();
+			}
+			if (remaining-- > 0) {
+				return true;
+			}
+			real_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_real).count();
+			cpu_ns = 1e9 * static_cast<double>(std::clock() - start_cpu) / CLOCKS_PER_SEC;
+			return false;
+		}
+
+		// Work done by each iteration, reported as a rate
+		inline void set_items_per_iteration(size_t n) { items = n; }
+		inline void set_bytes_per_iteration(size_t n) { bytes = n; }
+
+		inline size_t iterations() const { return iterations_run; }
+		inline double real_time() const { return real_ns; }
+		inline double cpu_time() const { return cpu_ns; }
+		inline size_t items_per_iteration() const { return items; }
+		inline size_t bytes_per_iteration() const { return bytes; }
+
+	private:
+		size_t remaining;
+		size_t iterations_run;
+		bool started = false;
+		std::chrono::steady_clock::time_point start_real;
+		std::clock_t start_cpu = 0;
+		double real_ns = 0;
+		double cpu_ns = 0;
+		size_t items = 0;
+		size_t bytes = 0;
+	};
+
+	struct Benchmark {
+		std::string name;
+		std::function<void(State&)> run;
+	};
+
+	inline std::vector<Benchmark>& registry() {
+		static std::vector<Benchmark> benchmarks;
+		return benchmarks;
+	}
+
+	inline void add(std::string name, std::function<void(State&)> run) {
+		registry().push_back({ std::move(name), std::move(run) });
+	}
+
+	// Time f(a) for a fixed input, hiding the input from the optimiser on every iteration
+	template<class A, class F>
+	inline void add_unary(std::string name, const A& a, F f) {
+		add(std::move(name), [a = A(a), f](State& state) mutable {
+			while (state.keep_running()) {
+				do_not_optimize(a);
+				auto r = f(a);
+				do_not_optimize(r);
+			}
+		});
+	}
+
+	// Time f(a, b) for fixed inputs
+	template<class A, class B, class F>
+	inline void add_binary(std::string name, const A& a, const B& b, F f) {
+		add(std::move(name), [a = A(a), b = B(b), f](State& state) mutable {
+			while (state.keep_running()) {
+				do_not_optimize(a);
+				do_not_optimize(b);
+				auto r = f(a, b);
+				do_not_optimize(r);
+			}
+		});
+	}
+
+	// Names of the element types, as they appear in benchmark names
+	template<class T>
+	inline std::string type_name() {
+		if constexpr (std::same_as<T, float>) {
+			return "float";
+		}
+		else if constexpr (std::same_as<T, double>) {
+			return "double";
+		}
+		else {
+			return "int";
+		}
+	}
+
+	// Reproducible inputs: floating-point values in [0.5, 1.5], integers in [1, 9], so that every input can divide
+	template<class T>
+	inline T random_value() {
+		static std::mt19937 engine(12345);
+		if constexpr (std::floating_point<T>) {
+			return std::uniform_real_distribution<T>(T(0.5), T(1.5))(engine);
+		}
+		else {
+			return std::uniform_int_distribution<T>(1, 9)(engine);
+		}
+	}
+
+	template<class T, size_t elements>
+	inline Vector<T, elements> random_vector() {
+		Vector<T, elements> ret;
+		for (size_t i = 0; i < elements; i++) {
+			ret[i] = random_value<T>();
+		}
+		return ret;
+	}
+
+	template<class T, size_t nrows, size_t ncols>
+	inline Matrix<T, nrows, ncols> random_matrix() {
+		Matrix<T, nrows, ncols> ret;
+		for (auto& x : ret) {
+			x = random_value<T>();
+		}
+		// Diagonally dominant, so that square matrices are comfortably invertible
+		for (size_t i = 0; i < std::min(nrows, ncols); i++) {
+			ret[i][i] += static_cast<T>(2 * ncols);
+		}
+		return ret;
+	}
+
+	// Registration functions, one per benchmark source file
+	void register_vector();
+	void register_matrix();
+	void register_quaternion();
+	void register_kernels();
+
+	namespace detail {
+
+		struct Result {
+			std::string name;
+			size_t iterations;
+			double real_time;
+			double cpu_time;
+			double items_per_second;
+			double bytes_per_second;
+		};
+
+		// Run a benchmark with more iterations each time, until one run takes at least min_time seconds
+		inline Result measure(const Benchmark& benchmark, double min_time) {
+			size_t iterations = 1;
+			while (true) {
+				State state(iterations);
+				benchmark.run(state);
+				const double seconds = state.real_time() * 1e-9;
+				if ((seconds >= min_time) || (iterations >= 1'000'000'000)) {
+					const double n = static_cast<double>(state.iterations());
+					return {
+						benchmark.name, state.iterations(), state.real_time() / n, state.cpu_time() / n,
+						(state.items_per_iteration() * n) / seconds, (state.bytes_per_iteration() * n) / seconds
+					};
+				}
+				// Aim 40% past the minimum time, growing by at most a factor of ten per step as Google Benchmark does
+				const double scale = (seconds > 0) ? ((min_time * 1.4) / seconds) : 10.0;
+				iterations = static_cast<size_t>(static_cast<double>(iterations) * std::clamp(scale, 1.1, 10.0)) + 1;
+			}
+		}
+
+		inline std::string json_escape(const std::string& s) {
+			std::string ret;
+			for (char c : s) {
+				if ((c == '"') || (c == '\\')) {
+					ret += '\\';
+				}
+				ret += c;
+			}
+			return ret;
+		}
+
+		// Compile-time configuration of the library, recorded with each run
+		inline const char* simd_backend() {
+#if defined(SML_SIMD_AVX)
+			return "avx";
+#elif defined(SML_SIMD_SSE)
+			return "sse";
+#elif defined(SML_SIMD_NEON)
+			return "neon";
+#else
+			return "none";
+#endif
+		}
+
+		inline void write_json(std::ostream& os, const std::string& executable, const std::vector<Result>& results) {
+			char date[64];
+			const std::time_t now = std::time(nullptr);
+			std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+
+			os << "{\n  \"context\": {\n";
+			os << "    \"date\": \"" << date << "\",\n";
+			os << "    \"executable\": \"" << json_escape(executable) << "\",\n";
+			os << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#if defined(NDEBUG)
+			os << "    \"library_build_type\": \"release\",\n";
+#else
+			os << "    \"library_build_type\": \"debug\",\n";
+#endif
+			os << "    \"sml_simd\": \"" << simd_backend() << "\"\n";
+			os << "  },\n  \"benchmarks\": [\n";
+			for (size_t i = 0; i < results.size(); i++) {
+				const Result& r = results[i];
+				os << "    {\n";
+				os << "      \"name\": \"" << json_escape(r.name) << "\",\n";
+				os << "      \"run_name\": \"" << json_escape(r.name) << "\",\n";
+				os << "      \"run_type\": \"iteration\",\n";
+				os << "      \"repetitions\": 1,\n";
+				os << "      \"repetition_index\": 0,\n";
+				os << "      \"threads\": 1,\n";
+				os << "      \"iterations\": " << r.iterations << ",\n";
+				os << "      \"real_time\": " << r.real_time << ",\n";
+				os << "      \"cpu_time\": " << r.cpu_time << ",\n";
+				if (r.items_per_second > 0) {
+					os << "      \"items_per_second\": " << r.items_per_second << ",\n";
+				}
+				if (r.bytes_per_second > 0) {
+					os << "      \"bytes_per_second\": " << r.bytes_per_second << ",\n";
+				}
+				os << "      \"time_unit\": \"ns\"\n";
+				os << "    }" << ((i + 1 < results.size()) ? "," : "") << "\n";
+			}
+			os << "  ]\n}\n";
+		}
+
+		// Name and cpu_time of every benchmark in a JSON file written by write_json (or by Google Benchmark)
+		inline std::vector<std::pair<std::string, double>> read_json(const std::string& path) {
+			std::ifstream file(path);
+			if (!file) {
+				throw std::runtime_error("cannot open " + path);
+			}
+			std::stringstream buffer;
+			buffer << file.rdbuf();
+			const std::string text = buffer.str();
+
+			std::vector<std::pair<std::string, double>> ret;
+			const std::regex entry("\"name\": \"([^\"]*)\"[^}]*?\"cpu_time\": ([-+0-9.eE]+)");
+			for (auto it = std::sregex_iterator(text.begin(), text.end(), entry); it != std::sregex_iterator(); ++it) {
+				ret.emplace_back((*it)[1].str(), std::stod((*it)[2].str()));
+			}
+			return ret;
+		}
+
+		// Print the change in cpu_time of every benchmark present in both files
+		inline int compare(const std::string& baseline, const std::string& candidate) {
+			const auto before = read_json(baseline);
+			const auto after = read_json(candidate);
+			std::printf("%-56s %14s %14s %9s\n", "Benchmark", "Baseline (ns)", "Candidate (ns)", "Change");
+			for (const auto& [name, time] : after) {
+				const auto match = std::find_if(before.begin(), before.end(), [&](const auto& b) { return b.first == name; });
+				if (match == before.end()) {
+					continue;
+				}
+				std::printf("%-56s %14.2f %14.2f %+8.1f%%\n", name.c_str(), match->second, time, 100.0 * ((time / match->second) - 1.0));
+			}
+			return 0;
+		}
+
+	} // !namespace detail
+
+	// Command line in the style of Google Benchmark:
+	//     --benchmark_filter=<regex>  --benchmark_min_time=<seconds>  --benchmark_list_tests
+	//     --benchmark_format=<console|json>  --benchmark_out=<file>  --compare <baseline.json> <candidate.json>
+	inline int run(int argc, char** argv) {
+		std::string filter = ".";
+		double min_time = 0.1;
+		bool list = false;
+		bool json_to_console = false;
+		std::string out;
+
+		for (int i = 1; i < argc; i++) {
+			const std::string arg = argv[i];
+			const auto value = [&](const char* flag) -> const char* {
+				const size_t n = std::char_traits<char>::length(flag);
+				return (arg.compare(0, n, flag) == 0) ? arg.c_str() + n : nullptr;
+			};
+			if (const char* v = value("--benchmark_filter=")) {
+				filter = v;
+			}
+			else if (const char* v = value("--benchmark_min_time=")) {
+				min_time = std::stod(v);
+			}
+			else if (const char* v = value("--benchmark_format=")) {
+				json_to_console = (std::string(v) == "json");
+			}
+			else if (const char* v = value("--benchmark_out=")) {
+				out = v;
+			}
+			else if (value("--benchmark_out_format=")) {
+				// JSON is the only file format
+			}
+			else if (arg == "--benchmark_list_tests") {
+				list = true;
+			}
+			else if ((arg == "--compare") && (i + 2 < argc)) {
+				return detail::compare(argv[i + 1], argv[i + 2]);
+			}
+			else {
+				std::fprintf(stderr, "unrecognised argument: %s\n", arg.c_str());
+				return 1;
+			}
+		}
+
+		const std::regex pattern(filter);
+		std::vector<detail::Result> results;
+		if (!json_to_console && !list) {
+			std::printf("%-56s %14s %14s %12s\n", "Benchmark", "Time (ns)", "CPU (ns)", "Iterations");
+		}
+		for (const Benchmark& benchmark : registry()) {
+			if (!std::regex_search(benchmark.name, pattern)) {
+				continue;
+			}
+			if (list) {
+				std::printf("%s\n", benchmark.name.c_str());
+				continue;
+			}
+			results.push_back(detail::measure(benchmark, min_time));
+			if (!json_to_console) {
+				const detail::Result& r = results.back();
+				std::printf("%-56s %14.2f %14.2f %12zu", r.name.c_str(), r.real_time, r.cpu_time, r.iterations);
+				// Rates in billions per second, as GFLOP/s for benchmarks that count flops as items
+				if (r.items_per_second > 0) {
+					std::printf(" %10.3fG items/s", r.items_per_second * 1e-9);
+				}
+				std::printf("\n");
+			}
+		}
+
+		if (json_to_console) {
+			detail::write_json(std::cout, argv[0], results);
+		}
+		if (!out.empty()) {
+			std::ofstream file(out);
+			detail::write_json(file, argv[0], results);
+		}
+		return 0;
+	}
+
+}
+#endif // !SML_BENCH_HPP
\ No newline at end of file
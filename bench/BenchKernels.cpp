@@ -0,0 +1,833 @@
+#include "Bench.hpp"
+
+// Kernels over large or runtime-sized data: DynMatrix products, factorisations and transposes, structure-of-arrays
+// batches against the equivalent loops over arrays of Vectors and Quaternions, bulk transforms and matrix products,
+// transform hierarchies, text and binary serialisation, sparse products and iterative solves against their dense
+// equivalents, and element-wise operations and reductions on pools of one to eight threads
+
+namespace sml::bench {
+
+	namespace {
+
+		template<class T>
+		DynMatrix<T> random_dyn_matrix(size_t rows, size_t cols) {
+			DynMatrix<T> ret(rows, cols);
+			for (auto& x : ret.data) {
+				x = random_value<T>();
+			}
+			for (size_t i = 0; i < std::min(rows, cols); i++) {
+				ret[i][i] += static_cast<T>(2 * cols);
+			}
+			return ret;
+		}
+
+		template<class T>
+		void register_dyn_matrix(size_t n) {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(n);
+			const DynMatrix<T> a = random_dyn_matrix<T>(n, n);
+			const DynMatrix<T> b = random_dyn_matrix<T>(n, n);
+
+			add(std::string("dynmatrix/mul") + suffix, [a, b, n](State& state) {
+				state.set_items_per_iteration(2 * n * n * n);
+				while (state.keep_running()) {
+					auto r = a * b;
+					do_not_optimize(r.data.data());
+				}
+			});
+			add(std::string("dynmatrix/transpose") + suffix, [a](State& state) {
+				state.set_bytes_per_iteration(2 * a.data.size() * sizeof(T));
+				while (state.keep_running()) {
+					auto r = transpose(a);
+					do_not_optimize(r.data.data());
+				}
+			});
+			add(std::string("dynmatrix/transpose_inplace") + suffix, [a = DynMatrix<T>(a)](State& state) mutable {
+				state.set_bytes_per_iteration(2 * a.data.size() * sizeof(T));
+				while (state.keep_running()) {
+					transpose_inplace(a);
+					do_not_optimize(a.data.data());
+				}
+			});
+			add(std::string("dynmatrix/det") + suffix, [a](State& state) {
+				while (state.keep_running()) {
+					auto r = det(a);
+					do_not_optimize(r);
+				}
+			});
+			add(std::string("dynmatrix/inverse") + suffix, [a](State& state) {
+				while (state.keep_running()) {
+					auto r = inverse(a);
+					do_not_optimize(r.data.data());
+				}
+			});
+			// LU against the symmetric factorisations, which need half the work for a symmetric positive-definite matrix
+			const DynMatrix<T> spd = a + transpose(a);
+			add(std::string("dynmatrix/LUPDecomposition") + suffix, [spd, n](State& state) {
+				state.set_items_per_iteration(2 * n * n * n / 3);
+				while (state.keep_running()) {
+					auto r = LUPDecomposition(spd);
+					do_not_optimize(std::get<0>(r).data.data());
+				}
+			});
+			add(std::string("dynmatrix/cholesky") + suffix, [spd, n](State& state) {
+				state.set_items_per_iteration(n * n * n / 3);
+				while (state.keep_running()) {
+					auto r = cholesky(spd);
+					do_not_optimize(r.factors().data.data());
+				}
+			});
+			add(std::string("dynmatrix/ldlt") + suffix, [spd, n](State& state) {
+				state.set_items_per_iteration(n * n * n / 3);
+				while (state.keep_running()) {
+					auto r = ldlt(spd);
+					do_not_optimize(r.factors().data.data());
+				}
+			});
+		}
+
+		// Large enough that the batches do not fit in L2
+		constexpr size_t batch_size = size_t(1) << 16;
+
+		template<class T>
+		void register_batches() {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(batch_size);
+			std::vector<Vector<T, 3>> p1(batch_size), p2(batch_size);
+			std::vector<Quaternion<T>> q1(batch_size), q2(batch_size);
+			for (size_t i = 0; i < batch_size; i++) {
+				p1[i] = random_vector<T, 3>();
+				p2[i] = random_vector<T, 3>();
+				q1[i] = Normalise(Quaternion<T>(random_value<T>(), random_vector<T, 3>()));
+				q2[i] = Normalise(Quaternion<T>(random_value<T>(), random_vector<T, 3>()));
+			}
+			const VectorBatch<T, 3> b1(p1), b2(p2);
+			const QuaternionBatch<T> r1(q1), r2(q2);
+
+			add(std::string("batch/dot_aos") + suffix, [p1, p2](State& state) {
+				std::vector<double> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					for (size_t i = 0; i < batch_size; i++) {
+						out[i] = dot(p1[i], p2[i]);
+					}
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("batch/dot_soa") + suffix, [b1, b2](State& state) {
+				DynVector<T> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					dot(b1, b2, out);
+					do_not_optimize(out.data.data());
+				}
+			});
+			add(std::string("batch/cross_product_aos") + suffix, [p1, p2](State& state) {
+				std::vector<Vector<T, 3>> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					for (size_t i = 0; i < batch_size; i++) {
+						out[i] = cross_product(p1[i], p2[i]);
+					}
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("batch/cross_product_soa") + suffix, [b1, b2](State& state) {
+				VectorBatch<T, 3> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					cross_product(b1, b2, out);
+					do_not_optimize(out);
+				}
+			});
+			add(std::string("batch/unit_vector_aos") + suffix, [p1](State& state) {
+				std::vector<Vector<T, 3>> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					for (size_t i = 0; i < batch_size; i++) {
+						out[i] = unit_vector(p1[i]);
+					}
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("batch/unit_vector_soa") + suffix, [b1](State& state) {
+				VectorBatch<T, 3> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					unit_vector(b1, out);
+					do_not_optimize(out);
+				}
+			});
+			add(std::string("batch/RotateActive_aos") + suffix, [p1, q1](State& state) {
+				std::vector<Vector<T, 3>> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					for (size_t i = 0; i < batch_size; i++) {
+						out[i] = RotateActive(p1[i], q1[i]);
+					}
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("batch/RotateActive_soa") + suffix, [b1, r1](State& state) {
+				VectorBatch<T, 3> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					RotateActive(b1, r1, out);
+					do_not_optimize(out);
+				}
+			});
+			add(std::string("batch/RotateActive_span") + suffix, [p1, q1](State& state) {
+				std::vector<Vector<T, 3>> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					RotateActive(p1, std::span<const Quaternion<T>>(q1), out);
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("batch/RotateActiveUnit_span") + suffix, [p1, q1](State& state) {
+				std::vector<Vector<T, 3>> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					RotateActiveUnit(p1, std::span<const Quaternion<T>>(q1), out);
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("batch/RotateActive_one") + suffix, [p1, q1](State& state) {
+				std::vector<Vector<T, 3>> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					RotateActive(p1, q1[0], out);
+					do_not_optimize(out.data());
+				}
+			});
+			std::vector<Matrix<T, 3, 3>> m1(batch_size);
+			QuaternionTo33RotationMatrix(std::span<const Quaternion<T>>(q1), m1);
+			add(std::string("batch/QuaternionTo44RotationMatrix_loop") + suffix, [q1](State& state) {
+				std::vector<Matrix<T, 4, 4>> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					for (size_t i = 0; i < batch_size; i++) {
+						out[i] = QuaternionTo44RotationMatrix(q1[i]);
+					}
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("batch/QuaternionTo44RotationMatrix_span") + suffix, [q1](State& state) {
+				std::vector<Matrix<T, 4, 4>> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					QuaternionTo44RotationMatrix(std::span<const Quaternion<T>>(q1), out);
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("batch/RotationMatrixToQuaternion_loop") + suffix, [m1](State& state) {
+				std::vector<Quaternion<T>> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					for (size_t i = 0; i < batch_size; i++) {
+						out[i] = RotationMatrixToQuaternion(m1[i]);
+					}
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("batch/RotationMatrixToQuaternion_span") + suffix, [m1](State& state) {
+				std::vector<Quaternion<T>> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					RotationMatrixToQuaternion(std::span<const Matrix<T, 3, 3>>(m1), out);
+					do_not_optimize(out.data());
+				}
+			});
+			std::vector<Matrix<T, 4, 4>> m2(batch_size);
+			for (Matrix<T, 4, 4>& m : m2) {
+				m = random_matrix<T, 4, 4>();
+			}
+			add(std::string("batch/det_loop") + suffix, [m2](State& state) {
+				std::vector<T> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					for (size_t i = 0; i < batch_size; i++) {
+						out[i] = det(m2[i]);
+					}
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("batch/det_span") + suffix, [m2](State& state) {
+				std::vector<T> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					det(std::span<const Matrix<T, 4, 4>>(m2), out);
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("batch/multiply_aos") + suffix, [q1, q2](State& state) {
+				std::vector<Quaternion<T>> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					for (size_t i = 0; i < batch_size; i++) {
+						out[i] = q1[i] * q2[i];
+					}
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("batch/multiply_soa") + suffix, [r1, r2](State& state) {
+				QuaternionBatch<T> out(batch_size);
+				state.set_items_per_iteration(batch_size);
+				while (state.keep_running()) {
+					multiply(r1, r2, out);
+					do_not_optimize(out);
+				}
+			});
+		}
+
+		template<class T>
+		void register_transforms(size_t n) {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(n);
+			std::vector<Vector<T, 3>> in(n);
+			for (auto& v : in) {
+				v = random_vector<T, 3>();
+			}
+			const Matrix<T, 4, 4> m = Matrix<T, 4, 4>(RotateX(0.3f) * RotateZ(0.2f));
+
+			add(std::string("transform/points_loop") + suffix, [in, m](State& state) {
+				std::vector<Vector<T, 3>> out(in.size());
+				state.set_items_per_iteration(in.size());
+				while (state.keep_running()) {
+					for (size_t i = 0; i < in.size(); i++) {
+						const auto r = m * Vector<T, 4>(in[i][0], in[i][1], in[i][2], T(1));
+						out[i] = Vector<T, 3>(r[0][0], r[1][0], r[2][0]);
+					}
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("transform/points") + suffix, [in, m](State& state) {
+				std::vector<Vector<T, 3>> out(in.size());
+				state.set_items_per_iteration(in.size());
+				while (state.keep_running()) {
+					transform_points(m, in, out);
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("transform/points_par") + suffix, [in, m](State& state) {
+				std::vector<Vector<T, 3>> out(in.size());
+				state.set_items_per_iteration(in.size());
+				while (state.keep_running()) {
+					transform_points(execution::par, m, in, out);
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("transform/normals") + suffix, [in, m](State& state) {
+				std::vector<Vector<T, 3>> out(in.size());
+				state.set_items_per_iteration(in.size());
+				while (state.keep_running()) {
+					transform_normals(m, in, out);
+					do_not_optimize(out.data());
+				}
+			});
+		}
+
+		// n independent products of 4x4 matrices, as a skeleton or scene graph update makes them
+		template<class T>
+		void register_batch_multiply(size_t n) {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(n);
+			std::vector<Matrix<T, 4, 4>> a(n), b(n);
+			for (size_t i = 0; i < n; i++) {
+				a[i] = random_matrix<T, 4, 4>();
+				b[i] = random_matrix<T, 4, 4>();
+			}
+
+			add(std::string("transform/multiply_loop") + suffix, [a, b](State& state) {
+				std::vector<Matrix<T, 4, 4>> out(a.size());
+				state.set_items_per_iteration(a.size());
+				while (state.keep_running()) {
+					for (size_t i = 0; i < a.size(); i++) {
+						out[i] = a[i] * b[i];
+					}
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("transform/multiply") + suffix, [a, b](State& state) {
+				std::vector<Matrix<T, 4, 4>> out(a.size());
+				state.set_items_per_iteration(a.size());
+				while (state.keep_running()) {
+					batch_multiply(std::span<const Matrix<T, 4, 4>>(a), b, out);
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("transform/multiply_par") + suffix, [a, b](State& state) {
+				std::vector<Matrix<T, 4, 4>> out(a.size());
+				state.set_items_per_iteration(a.size());
+				while (state.keep_running()) {
+					batch_multiply(execution::par, std::span<const Matrix<T, 4, 4>>(a), b, out);
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("transform/multiply_broadcast") + suffix, [a, b](State& state) {
+				std::vector<Matrix<T, 4, 4>> out(a.size());
+				state.set_items_per_iteration(a.size());
+				while (state.keep_running()) {
+					batch_multiply(a[0], b, out);
+					do_not_optimize(out.data());
+				}
+			});
+		}
+
+		// Blending two poses of n bones, against converting to matrices and interpolating those, and sampling n tracks
+		// of 32 keys each at steadily increasing times
+		template<class T>
+		void register_animation(size_t n) {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(n);
+			const auto random_rotation = []() {
+				return Normalise(Quaternion<T>(random_value<T>(), random_value<T>(), random_value<T>(), random_value<T>()));
+			};
+			std::vector<Quaternion<T>> a(n), b(n);
+			auto tracks = std::make_shared<std::vector<RotationTrack<T>>>(n);
+			for (size_t i = 0; i < n; i++) {
+				a[i] = random_rotation();
+				b[i] = random_rotation();
+				for (size_t k = 0; k < 32; k++) {
+					(*tracks)[i].add(static_cast<T>(k) / 32, random_rotation());
+				}
+			}
+
+			add(std::string("animation/matrix_lerp") + suffix, [a, b](State& state) {
+				std::vector<Quaternion<T>> out(a.size());
+				state.set_items_per_iteration(a.size());
+				while (state.keep_running()) {
+					for (size_t i = 0; i < a.size(); i++) {
+						out[i] = RotationMatrixToQuaternion(lerp(QuaternionTo33RotationMatrix(a[i]), QuaternionTo33RotationMatrix(b[i]), T(0.3)));
+					}
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("animation/nlerp") + suffix, [a, b](State& state) {
+				std::vector<Quaternion<T>> out(a.size());
+				state.set_items_per_iteration(a.size());
+				while (state.keep_running()) {
+					nlerp(std::span<const Quaternion<T>>(a), b, T(0.3), out);
+					do_not_optimize(out.data());
+				}
+			});
+			add(std::string("animation/slerp") + suffix, [a, b](State& state) {
+				std::vector<Quaternion<T>> out(a.size());
+				state.set_items_per_iteration(a.size());
+				while (state.keep_running()) {
+					slerp(std::span<const Quaternion<T>>(a), b, T(0.3), out);
+					do_not_optimize(out.data());
+				}
+			});
+			for (interpolation mode : { interpolation::nlerp, interpolation::slerp, interpolation::squad }) {
+				const std::string name = (mode == interpolation::nlerp) ? "nlerp" : (mode == interpolation::slerp) ? "slerp" : "squad";
+				add("animation/sample_search_" + name + suffix, [tracks, mode](State& state) {
+					for (auto& track : *tracks) {
+						track.set_interpolation_mode(mode);
+					}
+					std::vector<Quaternion<T>> pose(tracks->size());
+					state.set_items_per_iteration(tracks->size());
+					T time = 0;
+					while (state.keep_running()) {
+						time = (time < T(1)) ? time + T(1) / 240 : T(0);
+						sample(std::span<const RotationTrack<T>>(*tracks), time, pose);
+						do_not_optimize(pose.data());
+					}
+				});
+				add("animation/sample_cursor_" + name + suffix, [tracks, mode](State& state) {
+					for (auto& track : *tracks) {
+						track.set_interpolation_mode(mode);
+					}
+					std::vector<Quaternion<T>> pose(tracks->size());
+					std::vector<typename RotationTrack<T>::cursor> cursors(tracks->size());
+					state.set_items_per_iteration(tracks->size());
+					T time = 0;
+					while (state.keep_running()) {
+						time = (time < T(1)) ? time + T(1) / 240 : T(0);
+						sample(std::span<const RotationTrack<T>>(*tracks), time, cursors, pose);
+						do_not_optimize(pose.data());
+					}
+				});
+			}
+		}
+
+		// A skeleton-like forest of n nodes, each root with children and grandchildren, updated in full (every root
+		// moved) and after one local change, against composing each node by hand
+		template<class T>
+		void register_hierarchy(size_t n) {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(n);
+			auto h = std::make_shared<TransformHierarchy<T>>();
+			h->reserve(n);
+			while (h->size() < n) {
+				const size_t parent = (h->size() < (n / 16)) ? TransformHierarchy<T>::no_parent : (h->size() - (n / 16)) / 8;
+				h->add(parent, random_vector<T, 3>(), Normalise(Quaternion<T>(random_value<T>(), random_value<T>(), random_value<T>(), random_value<T>())));
+			}
+			h->sort();
+			h->update();
+
+			add(std::string("hierarchy/by_hand") + suffix, [h](State& state) {
+				std::vector<Matrix<T, 4, 4>> world(h->size());
+				state.set_items_per_iteration(h->size());
+				while (state.keep_running()) {
+					for (size_t i = 0; i < h->size(); i++) {
+						Matrix<T, 4, 4> local = QuaternionTo44RotationMatrix(h->rotation(i));
+						const Vector<T, 3> t = h->translation(i);
+						local[0][3] = t[0];
+						local[1][3] = t[1];
+						local[2][3] = t[2];
+						world[i] = (h->parent(i) == TransformHierarchy<T>::no_parent) ? local : world[h->parent(i)] * local;
+					}
+					do_not_optimize(world.data());
+				}
+			});
+			add(std::string("hierarchy/update_all") + suffix, [h](State& state) {
+				state.set_items_per_iteration(h->size());
+				while (state.keep_running()) {
+					for (size_t i = 0; i < (h->size() / 16); i++) {
+						h->mark_dirty(i);
+					}
+					h->update();
+					do_not_optimize(h->world_matrices().data());
+				}
+			});
+			add(std::string("hierarchy/update_all_par") + suffix, [h](State& state) {
+				state.set_items_per_iteration(h->size());
+				while (state.keep_running()) {
+					for (size_t i = 0; i < (h->size() / 16); i++) {
+						h->mark_dirty(i);
+					}
+					h->update(execution::par);
+					do_not_optimize(h->world_matrices().data());
+				}
+			});
+			add(std::string("hierarchy/update_one") + suffix, [h](State& state) {
+				while (state.keep_running()) {
+					h->mark_dirty(h->size() / 32);
+					h->update();
+					do_not_optimize(h->world_matrices().data());
+				}
+			});
+		}
+
+		template<class T>
+		void register_serialization(size_t n) {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(n);
+			std::vector<Matrix<T, 4, 4>> in(n);
+			for (auto& m : in) {
+				m = random_matrix<T, 4, 4>();
+			}
+			const size_t bytes = n * sizeof(Matrix<T, 4, 4>);
+
+			add(std::string("serialize/ostream") + suffix, [in, bytes](State& state) {
+				state.set_bytes_per_iteration(bytes);
+				while (state.keep_running()) {
+					std::ostringstream os;
+					for (const auto& m : in) {
+						os << m;
+					}
+					do_not_optimize(os.tellp());
+				}
+			});
+			add(std::string("serialize/write_text") + suffix, [in, bytes](State& state) {
+				state.set_bytes_per_iteration(bytes);
+				while (state.keep_running()) {
+					std::ostringstream os;
+					write_text(os, std::span<const Matrix<T, 4, 4>>(in));
+					do_not_optimize(os.tellp());
+				}
+			});
+			add(std::string("serialize/read_text") + suffix, [in, bytes](State& state) {
+				std::ostringstream file;
+				write_text(file, std::span<const Matrix<T, 4, 4>>(in));
+				const std::string contents = file.str();
+				state.set_bytes_per_iteration(bytes);
+				while (state.keep_running()) {
+					std::istringstream is(contents);
+					auto r = read_text<Matrix<T, 4, 4>>(is);
+					do_not_optimize(r.data());
+				}
+			});
+			add(std::string("serialize/write_binary") + suffix, [in, bytes](State& state) {
+				state.set_bytes_per_iteration(bytes);
+				while (state.keep_running()) {
+					std::ostringstream os;
+					write_binary(os, std::span<const Matrix<T, 4, 4>>(in));
+					do_not_optimize(os.tellp());
+				}
+			});
+			add(std::string("serialize/read_binary") + suffix, [in, bytes](State& state) {
+				std::stringstream file;
+				write_binary(file, std::span<const Matrix<T, 4, 4>>(in));
+				const std::string contents = file.str();
+				state.set_bytes_per_iteration(bytes);
+				while (state.keep_running()) {
+					std::istringstream is(contents);
+					auto r = read_binary<Matrix<T, 4, 4>>(is);
+					do_not_optimize(r.data());
+				}
+			});
+			// Map a file and touch every matrix in it; after the first run its pages are in the page cache
+			add(std::string("serialize/mapped") + suffix, [in, bytes, suffix](State& state) {
+				std::string name = "sml_bench" + suffix + ".sml";
+				std::replace(name.begin(), name.end(), '/', '_');
+				const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+				write_binary(path, std::span<const Matrix<T, 4, 4>>(in));
+				state.set_bytes_per_iteration(bytes);
+				while (state.keep_running()) {
+					MappedArray<Matrix<T, 4, 4>> mapped(path);
+					T sum = 0;
+					for (const auto& m : mapped) {
+						sum += m[0][0];
+					}
+					do_not_optimize(sum);
+				}
+				std::filesystem::remove(path);
+			});
+		}
+
+		// Five-point Laplacian on a grid of side by side points, the usual shape of a discretised PDE
+		template<class T>
+		CSRMatrix<T> laplacian(size_t side) {
+			const size_t n = side * side;
+			SparseBuilder<T> builder(n, n);
+			builder.reserve(5 * n);
+			for (size_t i = 0; i < side; i++) {
+				for (size_t j = 0; j < side; j++) {
+					const size_t row = i * side + j;
+					builder.add(row, row, T(4));
+					if (i > 0) {
+						builder.add(row, row - side, T(-1));
+					}
+					if (i + 1 < side) {
+						builder.add(row, row + side, T(-1));
+					}
+					if (j > 0) {
+						builder.add(row, row - 1, T(-1));
+					}
+					if (j + 1 < side) {
+						builder.add(row, row + 1, T(-1));
+					}
+				}
+			}
+			return CSRMatrix<T>(builder);
+		}
+
+		// Sparse products of a Laplacian on a side by side grid in both forms and both directions, on the calling thread
+		// and on a pool. When the grid is small enough, against the dense operator * on the same matrix
+		template<class T>
+		void register_sparse(size_t side) {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(side * side);
+			const CSRMatrix<T> csr = laplacian<T>(side);
+			const CSCMatrix<T> csc(csr);
+			const size_t n = csr.rows();
+			const size_t columns = 8;
+			DynVector<T> x(n);
+			for (auto& v : x.data) {
+				v = random_value<T>();
+			}
+			const DynMatrix<T> b = random_dyn_matrix<T>(n, columns);
+			const size_t bytes = csr.nonzeroes() * (sizeof(T) + sizeof(sparse_index)) + 2 * n * sizeof(T);
+			auto pool = std::make_shared<thread_pool>(4);
+
+			add(std::string("sparse/build") + suffix, [side, n](State& state) {
+				state.set_items_per_iteration(5 * n);
+				while (state.keep_running()) {
+					auto a = laplacian<T>(side);
+					do_not_optimize(a.values.data());
+				}
+			});
+			add(std::string("sparse/spmv_csr") + suffix, [csr, x, bytes](State& state) {
+				DynVector<T> y(x.size());
+				state.set_bytes_per_iteration(bytes);
+				while (state.keep_running()) {
+					multiply(csr, std::span<const T>(x.data), std::span<T>(y.data));
+					do_not_optimize(y.data.data());
+				}
+			});
+			add(std::string("sparse/spmv_csr_par") + suffix, [csr, x, bytes, pool](State& state) {
+				DynVector<T> y(x.size());
+				state.set_bytes_per_iteration(bytes);
+				while (state.keep_running()) {
+					multiply(execution::par.on(*pool), csr, std::span<const T>(x.data), std::span<T>(y.data));
+					do_not_optimize(y.data.data());
+				}
+			});
+			add(std::string("sparse/spmv_csc") + suffix, [csc, x, bytes](State& state) {
+				DynVector<T> y(x.size());
+				state.set_bytes_per_iteration(bytes);
+				while (state.keep_running()) {
+					multiply(csc, std::span<const T>(x.data), std::span<T>(y.data));
+					do_not_optimize(y.data.data());
+				}
+			});
+			add(std::string("sparse/spmv_csc_par") + suffix, [csc, x, bytes, pool](State& state) {
+				DynVector<T> y(x.size());
+				state.set_bytes_per_iteration(bytes);
+				while (state.keep_running()) {
+					multiply(execution::par.on(*pool), csc, std::span<const T>(x.data), std::span<T>(y.data));
+					do_not_optimize(y.data.data());
+				}
+			});
+			add(std::string("sparse/spmv_transposed") + suffix, [csr, x, bytes](State& state) {
+				DynVector<T> y(x.size());
+				state.set_bytes_per_iteration(bytes);
+				while (state.keep_running()) {
+					multiply_transposed(csr, std::span<const T>(x.data), std::span<T>(y.data));
+					do_not_optimize(y.data.data());
+				}
+			});
+			add(std::string("sparse/spmm") + suffix + "/" + std::to_string(columns), [csr, b](State& state) {
+				state.set_items_per_iteration(2 * csr.nonzeroes() * b.cols());
+				while (state.keep_running()) {
+					auto r = csr * b;
+					do_not_optimize(r.data.data());
+				}
+			});
+			if (n > 4096) {
+				return;
+			}
+			const DynMatrix<T> dense = csr.to_dense();
+			add(std::string("sparse/spmv_dense") + suffix, [dense, x](State& state) {
+				state.set_bytes_per_iteration(dense.data.size() * sizeof(T));
+				while (state.keep_running()) {
+					auto y = dense * x;
+					do_not_optimize(y.data.data());
+				}
+			});
+			add(std::string("sparse/spmm_dense") + suffix + "/" + std::to_string(columns), [dense, b](State& state) {
+				state.set_items_per_iteration(2 * dense.data.size() * b.cols());
+				while (state.keep_running()) {
+					auto r = dense * b;
+					do_not_optimize(r.data.data());
+				}
+			});
+		}
+
+		// Iterative solves of a Laplacian on a side by side grid, with and without preconditioning, reusing one workspace.
+		// When the grid is small enough, against the dense inverse that was the only way to solve before
+		template<class T>
+		void register_solvers(size_t side) {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(side * side);
+			const CSRMatrix<T> a = laplacian<T>(side);
+			const size_t n = a.rows();
+			std::vector<T> b(n);
+			for (auto& v : b) {
+				v = random_value<T>();
+			}
+			const SolverOptions<T> options{ T(1e-8) };
+			auto work = std::make_shared<SolverWorkspace<T>>();
+			const JacobiPreconditioner<T> jacobi(a);
+			const IncompleteCholesky<T> ic(a);
+
+			const auto solve = [=](const std::string& name, auto solver) {
+				add(std::string("solver/") + name + suffix, [=](State& state) {
+					std::vector<T> x(n);
+					SolverStats<T> stats;
+					while (state.keep_running()) {
+						std::fill(x.begin(), x.end(), T(0));
+						stats = solver(std::span<T>(x));
+						do_not_optimize(x.data());
+					}
+					state.set_items_per_iteration(stats.iterations);
+				});
+			};
+			solve("cg", [=](std::span<T> x) { return conjugate_gradient(a, b, x, IdentityPreconditioner(), *work, options); });
+			solve("cg_jacobi", [=](std::span<T> x) { return conjugate_gradient(a, b, x, jacobi, *work, options); });
+			solve("cg_ic", [=](std::span<T> x) { return conjugate_gradient(a, b, x, ic, *work, options); });
+			solve("bicgstab_ic", [=](std::span<T> x) { return bicgstab(a, b, x, ic, *work, options); });
+			solve("gmres_ic", [=](std::span<T> x) { return gmres(a, b, x, ic, *work, options); });
+
+			if (n > 1024) {
+				return;
+			}
+			const DynMatrix<T> dense = a.to_dense();
+			DynVector<T> rhs(n);
+			std::copy(b.begin(), b.end(), rhs.begin());
+			add(std::string("solver/dense_inverse") + suffix, [dense, rhs](State& state) {
+				while (state.keep_running()) {
+					auto x = inverse(dense) * rhs;
+					do_not_optimize(x.data.data());
+				}
+			});
+		}
+
+		// Element-wise updates and reductions of an n by n DynMatrix, on the calling thread and on pools of increasing
+		// size, for scaling curves
+		template<class T>
+		void register_parallel(size_t n) {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(n);
+			const DynMatrix<T> a = random_dyn_matrix<T>(n, n);
+			const DynMatrix<T> b = random_dyn_matrix<T>(n, n);
+			const size_t bytes = a.data.size() * sizeof(T);
+
+			add(std::string("parallel/add_assign") + suffix + "/seq", [a, b, bytes](State& state) {
+				DynMatrix<T> m = a;
+				state.set_bytes_per_iteration(3 * bytes);
+				while (state.keep_running()) {
+					add_assign(execution::seq, m, b);
+					do_not_optimize(m.data.data());
+				}
+			});
+			add(std::string("parallel/max") + suffix + "/seq", [a, bytes](State& state) {
+				state.set_bytes_per_iteration(bytes);
+				while (state.keep_running()) {
+					do_not_optimize(max(execution::seq, a));
+				}
+			});
+			for (size_t threads : { 1, 2, 4, 8 }) {
+				const std::string name = suffix + "/threads:" + std::to_string(threads);
+				auto pool = std::make_shared<thread_pool>(threads);
+				add(std::string("parallel/add_assign") + name, [a, b, bytes, pool](State& state) {
+					DynMatrix<T> m = a;
+					state.set_bytes_per_iteration(3 * bytes);
+					while (state.keep_running()) {
+						add_assign(execution::par.on(*pool), m, b);
+						do_not_optimize(m.data.data());
+					}
+				});
+				add(std::string("parallel/max") + name, [a, bytes, pool](State& state) {
+					state.set_bytes_per_iteration(bytes);
+					while (state.keep_running()) {
+						do_not_optimize(max(execution::par.on(*pool), a));
+					}
+				});
+			}
+		}
+	}
+
+	void register_kernels() {
+		for (size_t n : { 64, 256, 512 }) {
+			register_dyn_matrix<float>(n);
+			register_dyn_matrix<double>(n);
+		}
+		register_dyn_matrix<float>(1024);
+
+		register_batches<float>();
+		register_batches<double>();
+
+		for (size_t n : { size_t(1) << 12, size_t(1) << 20 }) {
+			register_transforms<float>(n);
+			register_transforms<double>(n);
+		}
+		for (size_t n : { size_t(1) << 12, size_t(1) << 18 }) {
+			register_batch_multiply<float>(n);
+			register_batch_multiply<double>(n);
+		}
+
+		for (size_t n : { size_t(1) << 12, size_t(1) << 16 }) {
+			register_hierarchy<float>(n);
+		}
+
+		register_animation<float>(size_t(1) << 16);
+
+		for (size_t side : { 64, 1024 }) {
+			register_sparse<double>(side);
+		}
+		for (size_t side : { 32, 256 }) {
+			register_solvers<double>(side);
+		}
+
+		register_serialization<float>(size_t(1) << 16);
+		register_serialization<double>(size_t(1) << 16);
+
+		for (size_t n : { 256, 1024, 2048 }) {
+			register_parallel<float>(n);
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "Bench.hpp"
+
+// Every Matrix operator and free function, for float, double and int at each benchmarked (square) size
+
+namespace sml::bench {
+
+	namespace {
+
+		// The i-j-k loop that the generic operator* ran before the blocked kernel, kept as the reference it is measured against
+		template<class T, size_t n>
+		Matrix<T, n, n> multiply_ijk(const Matrix<T, n, n>& a, const Matrix<T, n, n>& b) {
+			Matrix<T, n, n> ret(0);
+			for (size_t i = 0; i < n; i++) {
+				for (size_t j = 0; j < n; j++) {
+					for (size_t k = 0; k < n; k++) {
+						ret[i][j] += a[i][k] * b[k][j];
+					}
+				}
+			}
+			return ret;
+		}
+
+		// Time a square product, counting its 2 n^3 flops as items so that the rate is in FLOP/s
+		template<class T, size_t n, class F>
+		void add_product(std::string name, const Matrix<T, n, n>& a, const Matrix<T, n, n>& b, F f) {
+			add(std::move(name), [a, b, f](State& state) mutable {
+				state.set_items_per_iteration(2 * n * n * n);
+				while (state.keep_running()) {
+					do_not_optimize(a);
+					do_not_optimize(b);
+					auto r = f(a, b);
+					do_not_optimize(r);
+				}
+			});
+		}
+
+		// operator* against the old loop, from the size at which the blocked kernel takes over
+		template<class T, size_t n>
+		void register_matrix_product() {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(n);
+			const Matrix<T, n, n> a = random_matrix<T, n, n>();
+			const Matrix<T, n, n> b = random_matrix<T, n, n>();
+			add_product("matrix/mul" + suffix, a, b, [](const auto& x, const auto& y) { return x * y; });
+			if constexpr (n >= 8) {
+				add_product("matrix/mul_ijk" + suffix, a, b, [](const auto& x, const auto& y) { return multiply_ijk(x, y); });
+			}
+		}
+
+		template<class T, size_t n>
+		void register_matrix_family() {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(n);
+			const Matrix<T, n, n> a = random_matrix<T, n, n>();
+			const Matrix<T, n, n> b = random_matrix<T, n, n>();
+			const Vector<T, n> v = random_vector<T, n>();
+			const Vector<T, n> w = random_vector<T, n>();
+			const T s = random_value<T>();
+
+			// Element-wise and scalar arithmetic
+			add_binary("matrix/add" + suffix, a, b, [](const auto& x, const auto& y) { return x + y; });
+			add_binary("matrix/add_scalar" + suffix, a, s, [](const auto& x, const auto& y) { return x + y; });
+			add_binary("matrix/add_assign" + suffix, a, b, [](auto x, const auto& y) { x += y; return x; });
+			add_binary("matrix/sub" + suffix, a, b, [](const auto& x, const auto& y) { return x - y; });
+			add_binary("matrix/sub_scalar" + suffix, a, s, [](const auto& x, const auto& y) { return x - y; });
+			add_binary("matrix/sub_assign" + suffix, a, b, [](auto x, const auto& y) { x -= y; return x; });
+			add_binary("matrix/mul_scalar" + suffix, a, s, [](const auto& x, const auto& y) { return x * y; });
+			add_binary("matrix/mul_scalar_assign" + suffix, a, s, [](auto x, const auto& y) { x *= y; return x; });
+			add_binary("matrix/div_scalar" + suffix, a, s, [](const auto& x, const auto& y) { return x / y; });
+			add_binary("matrix/div_scalar_assign" + suffix, a, s, [](auto x, const auto& y) { x /= y; return x; });
+			if constexpr (std::integral<T>) {
+				add_binary("matrix/mod" + suffix, a, b, [](const auto& x, const auto& y) { return x % y; });
+				add_binary("matrix/mod_scalar" + suffix, a, s, [](const auto& x, const auto& y) { return x % y; });
+			}
+			add_unary("matrix/negate" + suffix, a, [](const auto& x) { return -x; });
+			add_binary("matrix/equal" + suffix, a, b, [](const auto& x, const auto& y) { return x == y; });
+			add_binary("matrix/multiply_elements" + suffix, a, b, [](const auto& x, const auto& y) { return multiply_elements(x, y); });
+
+			// Products
+			register_matrix_product<T, n>();
+			add_binary("matrix/mul_assign" + suffix, a, b, [](auto x, const auto& y) { x *= y; return x; });
+			add_binary("matrix/mul_vector" + suffix, a, v, [](const auto& x, const auto& y) { return x * y; });
+			add_binary("matrix/vector_mul" + suffix, v, a, [](const auto& x, const auto& y) { return x * y; });
+			add_binary("matrix/outer_product" + suffix, v, w, [](const auto& x, const auto& y) { return outer_product(x, y); });
+			add_binary("matrix/dot" + suffix, a.row_matrix(0), b.col_matrix(0), [](const auto& x, const auto& y) { return dot(x, y); });
+
+			// Rows and columns
+			add_unary("matrix/row_vector" + suffix, a, [](const auto& x) { return x.row_vector(1); });
+			add_unary("matrix/col_vector" + suffix, a, [](const auto& x) { return x.col_vector(1); });
+			add_binary("matrix/add_row" + suffix, a, v, [](auto x, const auto& y) { x.add_row(y); return x; });
+			add_binary("matrix/sub_row" + suffix, a, v, [](auto x, const auto& y) { x.sub_row(y); return x; });
+			add_binary("matrix/mul_row" + suffix, a, v, [](auto x, const auto& y) { x.mul_row(y); return x; });
+			add_binary("matrix/div_row" + suffix, a, v, [](auto x, const auto& y) { x.div_row(y); return x; });
+			add_binary("matrix/add_col" + suffix, a, v, [](auto x, const auto& y) { x.add_col(y); return x; });
+			add_binary("matrix/sub_col" + suffix, a, v, [](auto x, const auto& y) { x.sub_col(y); return x; });
+			add_binary("matrix/mul_col" + suffix, a, v, [](auto x, const auto& y) { x.mul_col(y); return x; });
+			add_binary("matrix/div_col" + suffix, a, v, [](auto x, const auto& y) { x.div_col(y); return x; });
+			add_unary("matrix/exchange_rows" + suffix, a, [](auto x) { exchange_rows(x, 0, n - 1); return x; });
+			add_unary("matrix/exchange_columns" + suffix, a, [](auto x) { exchange_columns(x, 0, n - 1); return x; });
+			add_unary("matrix/top_left" + suffix, a, [](const auto& x) { return top_left(x); });
+			add_unary("matrix/top_right" + suffix, a, [](const auto& x) { return top_right(x); });
+			add_unary("matrix/bottom_left" + suffix, a, [](const auto& x) { return bottom_left(x); });
+			add_unary("matrix/bottom_right" + suffix, a, [](const auto& x) { return bottom_right(x); });
+
+			// Linear algebra
+			add_unary("matrix/transpose" + suffix, a, [](const auto& x) { return transpose(x); });
+			add_unary("matrix/transpose_inplace" + suffix, a, [](auto x) { transpose_inplace(x); return x; });
+			add_unary("matrix/trace" + suffix, a, [](const auto& x) { return trace(x); });
+			add_unary("matrix/det" + suffix, a, [](const auto& x) { return det(x); });
+			add_unary("matrix/LUPDecomposition" + suffix, a, [](const auto& x) { return LUPDecomposition(x); });
+			add_unary("matrix/inverse" + suffix, a, [](const auto& x) { return inverse(x); });
+			add_unary("matrix/identity" + suffix, s, [](const auto&) { return identity<T, n>(); });
+			add_unary("matrix/LUFactor" + suffix, a, [](const auto& x) { return LUFactor<T, n>(x); });
+			const LUFactor<T, n> lu(a);
+			add_binary("matrix/LUFactor_solve" + suffix, lu, v, [](const auto& x, const auto& y) { return x.solve(y); });
+			add_binary("matrix/LUFactor_solve_multiple" + suffix, lu, b, [](const auto& x, const auto& y) { return x.solve(y); });
+			// The symmetric factorisations, of a symmetric matrix that is diagonally dominant and so positive definite
+			const Matrix<T, n, n> spd = a + transpose(a);
+			add_unary("matrix/CholeskyFactor" + suffix, spd, [](const auto& x) { return CholeskyFactor<T, n>(x); });
+			add_unary("matrix/LDLTFactor" + suffix, spd, [](const auto& x) { return LDLTFactor<T, n>(x); });
+			const CholeskyFactor<T, n> cholesky_factor(spd);
+			const LDLTFactor<T, n> ldlt_factor(spd);
+			add_binary("matrix/CholeskyFactor_solve" + suffix, cholesky_factor, v, [](const auto& x, const auto& y) { return x.solve(y); });
+			add_binary("matrix/CholeskyFactor_solve_multiple" + suffix, cholesky_factor, b, [](const auto& x, const auto& y) { return x.solve(y); });
+			add_binary("matrix/LDLTFactor_solve" + suffix, ldlt_factor, v, [](const auto& x, const auto& y) { return x.solve(y); });
+			add_binary("matrix/CholeskyFactor_update" + suffix, cholesky_factor, v, [](auto x, const auto& y) { x.update(y); return x; });
+			add_unary("matrix/CholeskyFactor_log_det" + suffix, cholesky_factor, [](const auto& x) { return x.log_det(); });
+
+			// Reductions and element-wise functions
+			add_unary("matrix/abs" + suffix, a, [](auto& x) { return abs(x); });
+			add_binary("matrix/lerp" + suffix, a, b, [](const auto& x, const auto& y) { return lerp(x, y, 0.25); });
+			add_unary("matrix/max_element" + suffix, a, [](const auto& x) { return max_element(x); });
+			add_unary("matrix/min_element" + suffix, a, [](const auto& x) { return min_element(x); });
+			add_unary("matrix/max" + suffix, a, [](const auto& x) { return max(x); });
+			add_unary("matrix/min" + suffix, a, [](const auto& x) { return min(x); });
+			add_unary("matrix/clamp" + suffix, a, [](const auto& x) { return clamp(x, T(2), T(5)); });
+
+			// Lazy expressions against the same expression evaluated eagerly
+			add(std::string("matrix/expression_eager") + suffix, [a, b, s](State& state) mutable {
+				while (state.keep_running()) {
+					do_not_optimize(a);
+					do_not_optimize(b);
+					Matrix<T, n, n> r = a + b * s - a;
+					do_not_optimize(r);
+				}
+			});
+			add(std::string("matrix/expression_lazy") + suffix, [a, b, s](State& state) mutable {
+				while (state.keep_running()) {
+					do_not_optimize(a);
+					do_not_optimize(b);
+					Matrix<T, n, n> r = lazy(a) + lazy(b) * s - a;
+					do_not_optimize(r);
+				}
+			});
+		}
+
+		template<class T>
+		void register_matrix_type() {
+			register_matrix_family<T, 2>();
+			register_matrix_family<T, 3>();
+			register_matrix_family<T, 4>();
+			register_matrix_family<T, 8>();
+			register_matrix_family<T, 16>();
+			// Intermediate sizes for the products alone, to follow FLOP/s from 16x16 to 64x64
+			register_matrix_product<T, 24>();
+			register_matrix_product<T, 32>();
+			register_matrix_product<T, 48>();
+			register_matrix_family<T, 64>();
+		}
+
+	}
+
+	void register_matrix() {
+		register_matrix_type<float>();
+		register_matrix_type<double>();
+		register_matrix_type<int>();
+
+		// Functions only defined for particular types or sizes
+		const Matrix<float, 4, 4> affine = RotateX(0.3f) * RotateY(0.2f);
+		const Matrix<double, 4, 4> affine_d(affine);
+		add_unary("matrix/inverse_affine/float/4", affine, [](const auto& x) { return inverse_affine(x); });
+		add_unary("matrix/inverse_affine/double/4", affine_d, [](const auto& x) { return inverse_affine(x); });
+		add_unary("matrix/inverse_transpose/float/4", random_matrix<float, 4, 4>(), [](const auto& x) { return inverse_transpose(x); });
+		add_unary("matrix/RotateX/float/4", 0.3f, [](const auto& x) { return RotateX(x); });
+		add_unary("matrix/RotateY/float/4", 0.3f, [](const auto& x) { return RotateY(x); });
+		add_unary("matrix/RotateZ/float/4", 0.3f, [](const auto& x) { return RotateZ(x); });
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "Bench.hpp"
+
+// Every Quaternion operator and free function. Arithmetic is covered for float, double and int; the functions that
+// normalise or convert rotations only make sense for floating-point types
+
+namespace sml::bench {
+
+	namespace {
+
+		template<class T>
+		Quaternion<T> random_quaternion() {
+			return Quaternion<T>(random_value<T>(), random_value<T>(), random_value<T>(), random_value<T>());
+		}
+
+		template<class T>
+		void register_quaternion_family() {
+			const std::string suffix = "/" + type_name<T>() + "/4";
+			const Quaternion<T> a = random_quaternion<T>();
+			const Quaternion<T> b = random_quaternion<T>();
+			const T s = random_value<T>();
+
+			add_binary("quaternion/add" + suffix, a, b, [](const auto& x, const auto& y) { return x + y; });
+			add_binary("quaternion/add_assign" + suffix, a, b, [](auto x, const auto& y) { x += y; return x; });
+			add_binary("quaternion/sub" + suffix, a, b, [](const auto& x, const auto& y) { return x - y; });
+			add_binary("quaternion/sub_assign" + suffix, a, b, [](auto x, const auto& y) { x -= y; return x; });
+			add_binary("quaternion/mul" + suffix, a, b, [](const auto& x, const auto& y) { return x * y; });
+			add_binary("quaternion/mul_assign" + suffix, a, b, [](auto x, const auto& y) { x *= y; return x; });
+			add_binary("quaternion/mul_scalar" + suffix, a, s, [](const auto& x, const auto& y) { return x * y; });
+			add_binary("quaternion/div_scalar" + suffix, a, s, [](const auto& x, const auto& y) { return x / y; });
+			add_unary("quaternion/negate" + suffix, a, [](const auto& x) { return -x; });
+			add_binary("quaternion/equal" + suffix, a, b, [](const auto& x, const auto& y) { return x == y; });
+			add_unary("quaternion/Conjugate" + suffix, a, [](const auto& x) { return Conjugate(x); });
+			add_unary("quaternion/abs" + suffix, a, [](const auto& x) { return abs(x); });
+			add_unary("quaternion/SquaredLength" + suffix, a, [](const auto& x) { return SquaredLength(x); });
+			add_unary("quaternion/Length" + suffix, a, [](const auto& x) { return Length(x); });
+
+			if constexpr (std::floating_point<T>) {
+				const Quaternion<T> unit = Normalise(a);
+				const Vector<T, 3> p = random_vector<T, 3>();
+				add_binary("quaternion/div" + suffix, a, b, [](const auto& x, const auto& y) { return x / y; });
+				add_unary("quaternion/Inverse" + suffix, a, [](const auto& x) { return Inverse(x); });
+				add_unary("quaternion/Normalise" + suffix, a, [](const auto& x) { return Normalise(x); });
+				add_unary("quaternion/IsNormal" + suffix, unit, [](const auto& x) { return IsNormal(x); });
+				add_binary("quaternion/RotateActive" + suffix, p, unit, [](const auto& x, const auto& y) { return RotateActive(x, y); });
+				add_binary("quaternion/RotatePassive" + suffix, p, unit, [](const auto& x, const auto& y) { return RotatePassive(x, y); });
+				add_binary("quaternion/RotateActiveUnit" + suffix, p, unit, [](const auto& x, const auto& y) { return RotateActiveUnit(x, y); });
+				add_binary("quaternion/RotatePassiveUnit" + suffix, p, unit, [](const auto& x, const auto& y) { return RotatePassiveUnit(x, y); });
+				add_unary("quaternion/QuaternionTo33RotationMatrix" + suffix, unit, [](const auto& x) { return QuaternionTo33RotationMatrix(x); });
+				add_unary("quaternion/QuaternionTo44RotationMatrix" + suffix, unit, [](const auto& x) { return QuaternionTo44RotationMatrix(x); });
+				add_unary("quaternion/RotationMatrixToQuaternion33" + suffix, QuaternionTo33RotationMatrix(unit),
+					[](const auto& x) { return RotationMatrixToQuaternion(x); });
+				add_unary("quaternion/RotationMatrixToQuaternion44" + suffix, QuaternionTo44RotationMatrix(unit),
+					[](const auto& x) { return RotationMatrixToQuaternion(x); });
+			}
+		}
+
+	}
+
+	void register_quaternion() {
+		register_quaternion_family<float>();
+		register_quaternion_family<double>();
+		register_quaternion_family<int>();
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "Bench.hpp"
+
+// Every Vector operator and free function, for float, double and int at each benchmarked size
+
+namespace sml::bench {
+
+	namespace {
+
+		template<class T, size_t n>
+		void register_vector_family() {
+			const std::string suffix = "/" + type_name<T>() + "/" + std::to_string(n);
+			const Vector<T, n> a = random_vector<T, n>();
+			const Vector<T, n> b = random_vector<T, n>();
+			const Vector<T, n> c = random_vector<T, n>();
+			const T s = random_value<T>();
+
+			add_binary("vector/add" + suffix, a, b, [](const auto& x, const auto& y) { return x + y; });
+			add_binary("vector/add_scalar" + suffix, a, s, [](const auto& x, const auto& y) { return x + y; });
+			add_binary("vector/add_assign" + suffix, a, b, [](auto x, const auto& y) { x += y; return x; });
+			add_binary("vector/sub" + suffix, a, b, [](const auto& x, const auto& y) { return x - y; });
+			add_binary("vector/sub_scalar" + suffix, a, s, [](const auto& x, const auto& y) { return x - y; });
+			add_binary("vector/sub_assign" + suffix, a, b, [](auto x, const auto& y) { x -= y; return x; });
+			add_binary("vector/mul" + suffix, a, b, [](const auto& x, const auto& y) { return x * y; });
+			add_binary("vector/mul_scalar" + suffix, a, s, [](const auto& x, const auto& y) { return x * y; });
+			add_binary("vector/mul_assign" + suffix, a, b, [](auto x, const auto& y) { x *= y; return x; });
+			add_binary("vector/div" + suffix, a, b, [](const auto& x, const auto& y) { return x / y; });
+			add_binary("vector/div_scalar" + suffix, a, s, [](const auto& x, const auto& y) { return x / y; });
+			add_binary("vector/div_assign" + suffix, a, b, [](auto x, const auto& y) { x /= y; return x; });
+			if constexpr (std::integral<T>) {
+				add_binary("vector/mod" + suffix, a, b, [](const auto& x, const auto& y) { return x % y; });
+				add_binary("vector/mod_scalar" + suffix, a, s, [](const auto& x, const auto& y) { return x % y; });
+			}
+			add_unary("vector/negate" + suffix, a, [](const auto& x) { return -x; });
+			add_binary("vector/equal" + suffix, a, b, [](const auto& x, const auto& y) { return x == y; });
+
+			add_binary("vector/dot" + suffix, a, b, [](const auto& x, const auto& y) { return dot(x, y); });
+			add_unary("vector/length" + suffix, a, [](const auto& x) { return length(x); });
+			add_unary("vector/squared_length" + suffix, a, [](const auto& x) { return squared_length(x); });
+			add_unary("vector/unit_vector" + suffix, a, [](const auto& x) { return unit_vector(x); });
+			if constexpr (n == 3) {
+				add_binary("vector/cross_product" + suffix, a, b, [](const auto& x, const auto& y) { return cross_product(x, y); });
+				add_unary("vector/abs" + suffix, a, [](const auto& x) { return abs(x); });
+			}
+			add(std::string("vector/fma") + suffix, [a, b, c](State& state) mutable {
+				while (state.keep_running()) {
+					do_not_optimize(a);
+					do_not_optimize(b);
+					do_not_optimize(c);
+					auto r = fma(a, b, c);
+					do_not_optimize(r);
+				}
+			});
+			add_binary("vector/lerp" + suffix, a, b, [](const auto& x, const auto& y) { return lerp(x, y, 0.25); });
+			add_unary("vector/max_element" + suffix, a, [](const auto& x) { return max_element(x); });
+			add_unary("vector/min_element" + suffix, a, [](const auto& x) { return min_element(x); });
+			add_unary("vector/max" + suffix, a, [](const auto& x) { return max(x); });
+			add_unary("vector/min" + suffix, a, [](const auto& x) { return min(x); });
+			add_binary("vector/max_elementwise" + suffix, a, b, [](const auto& x, const auto& y) { return max(x, y); });
+			add_binary("vector/min_elementwise" + suffix, a, b, [](const auto& x, const auto& y) { return min(x, y); });
+
+			Vector<size_t, n> reversed;
+			for (size_t i = 0; i < n; i++) {
+				reversed[i] = n - 1 - i;
+			}
+			add_binary("vector/permute" + suffix, a, reversed, [](const auto& x, const auto& y) { return permute(x, y); });
+
+			// Lazy expressions against the same expression evaluated eagerly
+			add(std::string("vector/expression_eager") + suffix, [a, b, c, s](State& state) mutable {
+				while (state.keep_running()) {
+					do_not_optimize(a);
+					do_not_optimize(b);
+					do_not_optimize(c);
+					Vector<T, n> r = a + b * s - c;
+					do_not_optimize(r);
+				}
+			});
+			add(std::string("vector/expression_lazy") + suffix, [a, b, c, s](State& state) mutable {
+				while (state.keep_running()) {
+					do_not_optimize(a);
+					do_not_optimize(b);
+					do_not_optimize(c);
+					Vector<T, n> r = lazy(a) + lazy(b) * s - c;
+					do_not_optimize(r);
+				}
+			});
+		}
+
+		template<class T>
+		void register_vector_type() {
+			register_vector_family<T, 2>();
+			register_vector_family<T, 3>();
+			register_vector_family<T, 4>();
+			register_vector_family<T, 8>();
+			register_vector_family<T, 16>();
+			register_vector_family<T, 64>();
+		}
+
+	}
+
+	void register_vector() {
+		register_vector_type<float>();
+		register_vector_type<double>();
+		register_vector_type<int>();
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#include "Bench.hpp"
+
+int main(int argc, char** argv) {
+	sml::bench::register_vector();
+	sml::bench::register_matrix();
+	sml::bench::register_quaternion();
+	sml::bench::register_kernels();
+	return sml::bench::run(argc, argv);
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+// Interpolation of rotations: slerp and squad between nearly opposite quaternions, the span nlerp and slerp against
+// the single-quaternion functions, and RotationTrack sampled through cursors against binary search
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+namespace {
+
+	// A unit quaternion from a few numbers, spread well over the hypersphere
+	template<std::floating_point T>
+	Quaternion<T> test_rotation(size_t i) {
+		const Quaternion<T> q(std::sin(T(0.37) * T(i) + T(1)), std::cos(T(1.13) * T(i)), std::sin(T(2.71) * T(i) + T(0.5)), T(0.25) - std::cos(T(0.61) * T(i)));
+		return q / std::sqrt(dot(q, q));
+	}
+
+	template<std::floating_point T>
+	bool is_unit(const Quaternion<T>& q, double tolerance) {
+		return std::isfinite(q[0]) && std::isfinite(q[1]) && std::isfinite(q[2]) && std::isfinite(q[3])
+			&& near(std::sqrt(static_cast<double>(dot(q, q))), 1.0, tolerance);
+	}
+
+	// a and b are the same rotation, if perhaps of opposite signs
+	template<std::floating_point T>
+	bool same_rotation(const Quaternion<T>& a, const Quaternion<T>& b, double tolerance) {
+		return near(a, b, tolerance) || near(a, -b, tolerance);
+	}
+
+	template<std::floating_point T>
+	void check_opposite(double tolerance) {
+		for (size_t i = 0; i < 20; i++) {
+			const Quaternion<T> q = test_rotation<T>(i);
+			expect(same_rotation(squad(q, q, q, -q, T(0.5)), q, tolerance), "squad between q and -q");
+			expect(same_rotation(squad(q, q, -q, -q, T(0.3)), q, tolerance), "squad with opposite control points");
+
+			// Nearly opposite, including dot products rounded just past -1
+			const Quaternion<T> p = -q + Quaternion<T>(T(1e-4), T(0), T(0), T(0));
+			const Quaternion<T> r = p / std::sqrt(dot(p, p));
+			for (T t : { T(0), T(0.25), T(0.5), T(1) }) {
+				expect(is_unit(slerp(q, r, t), tolerance), "slerp between nearly opposite quaternions");
+				expect(is_unit(squad(q, q, r, r, t), tolerance), "squad between nearly opposite quaternions");
+				expect(is_unit(squad(q, q, -q, -q, t), tolerance), "squad between opposite quaternions");
+			}
+			expect(same_rotation(slerp(q, r, T(0.5)), q, 1e-3), "slerp between nearly opposite quaternions stays near both");
+		}
+
+		// Arcs away from the ends are unchanged: a quarter of the way through a rotation of 120 degrees about z is 30
+		const Quaternion<T> a(1, 0, 0, 0);
+		const Quaternion<T> b(std::cos(T(std::numbers::pi / 3)), 0, 0, std::sin(T(std::numbers::pi / 3)));
+		const Quaternion<T> expected(std::cos(T(std::numbers::pi / 12)), 0, 0, std::sin(T(std::numbers::pi / 12)));
+		expect(near(slerp(a, b, T(0.25)), expected, tolerance), "slerp at a quarter");
+		expect(near(slerp(a, -b, T(0.25)), expected, tolerance), "slerp takes the shorter arc");
+	}
+
+	template<std::floating_point T>
+	void check_spans(double tolerance) {
+		// Enough for several threads under par, and not a whole number of SIMD blocks
+		const size_t n = 40003;
+		std::vector<Quaternion<T>> a(n), b(n), out(n + 2, Quaternion<T>(7, 7, 7, 7));
+		for (size_t i = 0; i < n; i++) {
+			a[i] = test_rotation<T>(i);
+			b[i] = test_rotation<T>(i + 5000);
+		}
+
+		const T t = T(0.3);
+		bool nlerp_ok = true, slerp_ok = true, par_ok = true;
+		nlerp(a, b, t, out);
+		for (size_t i = 0; i < n; i++) {
+			nlerp_ok = nlerp_ok && near(out[i], nlerp(a[i], b[i], t), tolerance);
+		}
+		slerp(a, b, t, out);
+		for (size_t i = 0; i < n; i++) {
+			slerp_ok = slerp_ok && near(out[i], slerp(a[i], b[i], t), tolerance);
+		}
+		std::vector<Quaternion<T>> parallel(n);
+		nlerp(execution::par, a, b, t, parallel);
+		for (size_t i = 0; i < n; i++) {
+			par_ok = par_ok && near(parallel[i], nlerp(a[i], b[i], t), tolerance);
+		}
+		slerp(execution::par, std::span<const Quaternion<T>>(a), b, t, std::span<Quaternion<T>>(parallel));
+		for (size_t i = 0; i < n; i++) {
+			par_ok = par_ok && near(parallel[i], slerp(a[i], b[i], t), tolerance);
+		}
+		expect(nlerp_ok, "span nlerp");
+		expect(slerp_ok, "span slerp");
+		expect(par_ok, "parallel span nlerp and slerp");
+		expect(out[n] == Quaternion<T>(7, 7, 7, 7) && out[n + 1] == Quaternion<T>(7, 7, 7, 7), "only the start of out is written");
+
+		std::vector<Quaternion<T>> small(3);
+		expect(throws<std::invalid_argument>([&] { nlerp(a, b, t, small); }), "output too small");
+		expect(throws<std::invalid_argument>([&] { slerp(std::span<const Quaternion<T>>(a).first(4), b, t, out); }), "inputs of different sizes");
+	}
+
+	template<std::floating_point T>
+	void check_tracks(double tolerance) {
+		for (interpolation mode : { interpolation::step, interpolation::nlerp, interpolation::slerp, interpolation::squad }) {
+			RotationTrack<T> track(mode);
+			for (size_t i = 0; i < 40; i++) {
+				// Uneven key times, and every other key on the far side of the hypersphere
+				track.add(T(i) + ((i % 3 == 0) ? T(0.25) : T(0)), (i % 2 == 0) ? test_rotation<T>(i) : -test_rotation<T>(i) * T(3));
+			}
+			bool hemisphere_ok = true;
+			for (size_t i = 1; i < track.size(); i++) {
+				hemisphere_ok = hemisphere_ok && (dot(track.key(i - 1), track.key(i)) >= T(0)) && is_unit(track.key(i), tolerance);
+			}
+			expect(hemisphere_ok, "keys are normalised and on the same side of the hypersphere as the one before");
+
+			// Forward playback in small steps, then jumps forward over several keys, backwards, and outside the track
+			typename RotationTrack<T>::cursor c;
+			bool forward_ok = true, jumps_ok = true;
+			for (T time = T(-1); time < T(41); time += T(0.0625)) {
+				forward_ok = forward_ok && (track.sample(time, c) == track.sample(time));
+			}
+			for (T time : { T(0), T(5.5), T(30), T(2.125), T(39.25), T(39), T(0.25), T(1), T(12), T(11.5), T(-3), T(17), T(100), T(20) }) {
+				jumps_ok = jumps_ok && (track.sample(time, c) == track.sample(time));
+			}
+			expect(forward_ok, "cursor sampling during forward playback");
+			expect(jumps_ok, "cursor sampling after jumps");
+
+			typename RotationTrack<T>::cursor stale{ 1000 };
+			expect(track.sample(T(3.5), stale) == track.sample(T(3.5)), "a cursor from a longer track");
+			expect(track.sample(T(-1)) == track.key(0) && track.sample(T(0.25)) == track.key(0) && track.sample(T(50)) == track.key(39), "times outside the track are clamped");
+			if (mode != interpolation::step) {
+				expect(near(track.sample(T(5)), track.key(5), tolerance), "keys are passed through");
+			}
+		}
+
+		RotationTrack<T> single;
+		expect(single.sample(T(1)) == Quaternion<T>(1, 0, 0, 0), "an empty track is the identity");
+		single.add(T(1), Quaternion<T>(0, 2, 0, 0));
+		typename RotationTrack<T>::cursor c;
+		expect(single.sample(T(0), c) == Quaternion<T>(0, 1, 0, 0) && single.sample(T(2), c) == Quaternion<T>(0, 1, 0, 0), "a track of one key");
+		expect(throws<std::invalid_argument>([&] { single.add(T(1), Quaternion<T>(1, 0, 0, 0)); }), "keys in increasing order of time");
+
+		// Many tracks at once, against each sampled alone
+		std::vector<RotationTrack<T>> tracks(5000, RotationTrack<T>(interpolation::squad));
+		for (size_t i = 0; i < tracks.size(); i++) {
+			for (size_t k = 0; k < 4; k++) {
+				tracks[i].add(T(k), test_rotation<T>(i + k));
+			}
+		}
+		std::vector<typename RotationTrack<T>::cursor> cursors(tracks.size());
+		std::vector<Quaternion<T>> pose(tracks.size()), searched(tracks.size());
+		bool batch_ok = true;
+		for (T time : { T(0.5), T(1.75), T(2.5), T(0.25) }) {
+			sample(execution::par, std::span<const RotationTrack<T>>(tracks), time, cursors, pose);
+			sample(std::span<const RotationTrack<T>>(tracks), time, searched);
+			for (size_t i = 0; i < tracks.size(); i++) {
+				batch_ok = batch_ok && (pose[i] == tracks[i].sample(time)) && (searched[i] == pose[i]);
+			}
+		}
+		expect(batch_ok, "sampling many tracks");
+		cursors.pop_back();
+		expect(throws<std::invalid_argument>([&] { sample(std::span<const RotationTrack<T>>(tracks), T(1), cursors, pose); }), "one cursor per track");
+	}
+
+}
+
+int main() {
+	check_opposite<float>(1e-5);
+	check_opposite<double>(1e-12);
+	check_spans<float>(1e-6);
+	check_spans<double>(1e-14);
+	check_tracks<float>(1e-5);
+	check_tracks<double>(1e-12);
+	return result();
+}
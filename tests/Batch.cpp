@@ -0,0 +1,133 @@
+// Structure-of-arrays batches against the same operations on arrays of Vectors and Quaternions, for empty batches, a
+// single element, and lengths that leave a partial SIMD register at the end
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+namespace {
+
+	template<arithmetic T, size_t n>
+	Vector<T, n> test_vector(size_t i) {
+		Vector<T, n> v;
+		for (size_t c = 0; c < n; c++) {
+			v[c] = static_cast<T>(std::sin((0.7 * static_cast<double>(i)) + (2.1 * static_cast<double>(c)) + 0.4) * 3);
+		}
+		return v;
+	}
+
+	// Not of unit length, as the batch rotations allow
+	template<arithmetic T>
+	Quaternion<T> test_quaternion(size_t i) {
+		const double a = static_cast<double>(i);
+		return Quaternion<T>(static_cast<T>(1.5 + std::cos(a)), static_cast<T>(std::sin(1.3 * a)), static_cast<T>(std::cos(0.4 * a) - 0.2), static_cast<T>(std::sin(2.9 * a + 1)));
+	}
+
+	// Each element of the batch against the AoS result
+	template<class Batch, class Expected>
+	bool matches(const Batch& b, size_t count, Expected expected, double tolerance) {
+		if (b.size() != count) {
+			return false;
+		}
+		for (size_t i = 0; i < count; i++) {
+			if (!near(b[i], expected(i), tolerance)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<std::floating_point T, size_t n>
+	void check_vectors(size_t count, double tolerance) {
+		const std::string name = std::to_string(n) + "-vectors of " + (std::is_same_v<T, float> ? "float" : "double") + ", " + std::to_string(count);
+		std::vector<Vector<T, n>> a(count), b(count);
+		for (size_t i = 0; i < count; i++) {
+			a[i] = test_vector<T, n>(i);
+			b[i] = test_vector<T, n>(i + 1000);
+		}
+		const VectorBatch<T, n> ba(a), bb(b);
+		expect((ba.size() == count) && (ba.to_vectors() == a), "VectorBatch round trip, " + name);
+
+		const DynVector<T> dots = dot(ba, bb);
+		bool dots_ok = dots.size() == count;
+		for (size_t i = 0; dots_ok && (i < count); i++) {
+			dots_ok = near(dots[i], dot(a[i], b[i]), tolerance);
+		}
+		expect(dots_ok, "batch dot, " + name);
+		expect(matches(unit_vector(ba), count, [&](size_t i) { return unit_vector(a[i]); }, tolerance), "batch unit_vector, " + name);
+
+		if constexpr (n == 3) {
+			expect(matches(cross_product(ba, bb), count, [&](size_t i) { return cross_product(a[i], b[i]); }, tolerance), "batch cross_product, " + name);
+
+			std::vector<Quaternion<T>> q(count);
+			for (size_t i = 0; i < count; i++) {
+				q[i] = test_quaternion<T>(i);
+			}
+			const QuaternionBatch<T> bq(q);
+			const Quaternion<T> single = test_quaternion<T>(7);
+			expect(matches(RotateActive(ba, bq), count, [&](size_t i) { return RotateActive(a[i], q[i]); }, tolerance), "batch RotateActive, " + name);
+			expect(matches(RotatePassive(ba, bq), count, [&](size_t i) { return RotatePassive(a[i], q[i]); }, tolerance), "batch RotatePassive, " + name);
+			expect(matches(RotateActive(ba, single), count, [&](size_t i) { return RotateActive(a[i], single); }, tolerance), "batch RotateActive by one rotation, " + name);
+			expect(matches(RotatePassive(ba, single), count, [&](size_t i) { return RotatePassive(a[i], single); }, tolerance), "batch RotatePassive by one rotation, " + name);
+
+			// In place, with the output the same batch as the input
+			VectorBatch<T, 3> inplace(a);
+			RotatePassive(inplace, bq, inplace);
+			expect(matches(inplace, count, [&](size_t i) { return RotatePassive(a[i], q[i]); }, tolerance), "batch RotatePassive in place, " + name);
+		}
+	}
+
+	template<std::floating_point T>
+	void check_quaternions(size_t count, double tolerance) {
+		const std::string name = std::string("Quaternion<") + (std::is_same_v<T, float> ? "float" : "double") + ">, " + std::to_string(count);
+		std::vector<Quaternion<T>> a(count), b(count);
+		for (size_t i = 0; i < count; i++) {
+			a[i] = test_quaternion<T>(i);
+			b[i] = test_quaternion<T>(i + 500);
+		}
+		const QuaternionBatch<T> ba(a), bb(b);
+		expect((ba.size() == count) && (ba.to_quaternions() == a), "QuaternionBatch round trip, " + name);
+		expect(matches(ba * bb, count, [&](size_t i) { return a[i] * b[i]; }, tolerance), "batch Hamilton product, " + name);
+
+		QuaternionBatch<T> inplace(a);
+		multiply(inplace, bb, inplace);
+		expect(matches(inplace, count, [&](size_t i) { return a[i] * b[i]; }, tolerance), "batch Hamilton product in place, " + name);
+	}
+
+	template<std::floating_point T>
+	void check_all(double tolerance) {
+		// Empty, a single element, and a length that is not a multiple of any SIMD width
+		for (size_t count : { size_t(0), size_t(1), size_t(1003) }) {
+			check_vectors<T, 3>(count, tolerance);
+			check_vectors<T, 4>(count, tolerance);
+			check_quaternions<T>(count, tolerance);
+		}
+	}
+
+}
+
+int main() {
+	check_all<float>(1e-5);
+	check_all<double>(1e-12);
+
+	// Element proxies read and write through to the component arrays
+	Vec3fBatch positions(3);
+	positions[1] = Vec3f(1, 2, 3);
+	positions[1].y() += 1;
+	positions[2] = positions[1];
+	const Vec3f p = positions[2];
+	expect((p == Vec3f(1, 3, 3)) && (positions.component(1)[1] == 3), "VectorBatch element proxies");
+	QuatfBatch rotations(2);
+	rotations[0] = Quatf(1, 2, 3, 4);
+	rotations[0].k() = 5;
+	expect(rotations[0].value() == Quatf(1, 2, 3, 5), "QuaternionBatch element proxies");
+
+	expect(throws<std::out_of_range>([&] { positions.at(3); }), "VectorBatch::at out of range");
+	expect(throws<std::invalid_argument>([&] { cross_product(positions, Vec3fBatch(2)); }), "batches of different sizes");
+	return result();
+}
@@ -0,0 +1,316 @@
+// Vector, Matrix and Quaternion in constant expressions. Every check here is a static_assert, so building this file is
+// the test. main() then recomputes some of the same results at run time, where the SIMD kernels are used, and checks
+// that they agree with the ones computed at compile time
+
+#include <array>
+#include <string>
+#include <tuple>
+
+#include "Test.hpp"
+
+namespace {
+
+	using namespace sml;
+	using namespace sml::test;
+
+	constexpr double pi = 3.14159265358979323846;
+
+	// A well conditioned n x n matrix with a known determinant: the product of a unit lower triangle, an upper
+	// triangle with diagonal 2, 3, ..., n + 1, and a permutation that reverses the rows, so that pivoting has work to do
+	template<size_t n>
+	constexpr Matrix<double, n, n> test_matrix() {
+		Matrix<double, n, n> l(0), u(0), p(0);
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < n; j++) {
+				l[i][j] = (i == j) ? 1.0 : (j < i) ? 0.25 * double(i + j) / double(n) : 0.0;
+				u[i][j] = (i == j) ? double(i + 2) : (j > i) ? 0.5 - (0.125 * double(j - i)) : 0.0;
+			}
+			p[i][n - 1 - i] = 1;
+		}
+		return p * (l * u);
+	}
+	template<size_t n>
+	constexpr double test_determinant() {
+		double d = 1;
+		for (size_t i = 0; i < n; i++) {
+			d *= double(i + 2);
+		}
+		// Reversing n rows takes n / 2 exchanges
+		return ((n / 2) % 2 == 0) ? d : -d;
+	}
+
+	template<size_t n>
+	constexpr bool check_det_and_inverse() {
+		constexpr Matrix<double, n, n> m = test_matrix<n>();
+		constexpr Matrix<double, n, n> inv = inverse(m);
+		return near(det(m), test_determinant<n>(), 1e-12)
+			&& near(m * inv, identity<double, n>(), 1e-12)
+			&& near(inv * m, identity<double, n>(), 1e-12)
+			&& near(inverse(inv), m, 1e-12);
+	}
+
+	// P M = L U, with the pivot vector giving the row of M in each row of L U, followed by n plus the number of row
+	// exchanges, whose parity is that of the permutation
+	template<size_t n>
+	constexpr bool check_lu() {
+		constexpr Matrix<double, n, n> m = test_matrix<n>();
+		constexpr auto lu = LUPDecomposition(m);
+		const Matrix<double, n, n>& a = std::get<0>(lu);
+		Matrix<double, n, n> l(0), u(0), pm(0);
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < n; j++) {
+				l[i][j] = (i == j) ? 1.0 : (j < i) ? a[i][j] : 0.0;
+				u[i][j] = (j >= i) ? a[i][j] : 0.0;
+				pm[i][j] = m[std::get<1>(lu)[i]][j];
+			}
+		}
+		const size_t last = std::get<1>(lu)[n];
+		return near(l * u, pm, 1e-12) && (last >= n) && (((last - n) % 2 == 0) == (test_determinant<n>() > 0));
+	}
+
+	// Vector algebra
+
+	constexpr Vec3d a3(1, 2, 3);
+	constexpr Vec3d b3(-2, 0.5, 4);
+	static_assert(a3 + b3 == Vec3d(-1, 2.5, 7));
+	static_assert(a3 - b3 == Vec3d(3, 1.5, -1));
+	static_assert(a3 * 2 == Vec3d(2, 4, 6));
+	static_assert(b3 / 2 == Vec3d(-1, 0.25, 2));
+	static_assert(-a3 == Vec3d(-1, -2, -3));
+	static_assert(dot(a3, b3) == 11);
+	static_assert(cross_product(a3, b3) == Vec3d(6.5, -10, 4.5));
+	static_assert(dot(cross_product(a3, b3), a3) == 0);
+	static_assert(length(Vec3d(3, 4, 12)) == 13);
+	static_assert(near(length(unit_vector(a3)), 1, 1e-15));
+	static_assert(Vec4f(1, 2, 3, 4) * Vec4f(2, 2, 2, 2) == Vec4f(2, 4, 6, 8));
+	static_assert(dot(Vec4f(1, 2, 3, 4), Vec4f(4, 3, 2, 1)) == 20);
+
+	constexpr Vec3d accumulate() {
+		Vec3d v(1);
+		v += a3;
+		v *= 3;
+		v -= b3;
+		v /= 2;
+		return v;
+	}
+	static_assert(accumulate() == Vec3d(4, 4.25, 4));
+
+	// Each compound operator, AddWithWeight and fma applied to a, with w or a scalar. a and w hold small multiples of
+	// powers of two, so every result is exact and the SIMD paths must match the scalar ones to the bit
+	constexpr std::array<const char*, 10> vector_op_names = { "+=", "-=", "*=", "/=", "+= scalar", "-= scalar",
+		"*= scalar", "/= scalar", "AddWithWeight", "fma" };
+	template<arithmetic T, size_t n>
+	constexpr std::array<Vector<T, n>, 10> vector_ops(const Vector<T, n>& a, const Vector<T, n>& w) {
+		std::array<Vector<T, n>, 10> r;
+		r.fill(a);
+		r[0] += w;
+		r[1] -= w;
+		r[2] *= w;
+		r[3] /= w;
+		r[4] += T(0.75);
+		r[5] -= T(0.75);
+		r[6] *= T(-1.5);
+		r[7] /= T(3);
+		r[8].AddWithWeight(w, 0.5f);
+		r[9] = fma(a, w, Vector<T, n>(T(0.75)));
+		return r;
+	}
+
+	// Matrix algebra
+
+	constexpr Mat33d m3(2, -1, 0,
+		-1, 2, -1,
+		0, -1, 2);
+	static_assert(m3 * identity<double, 3>() == m3);
+	static_assert(m3 * m3 == Mat33d(5, -4, 1, -4, 6, -4, 1, -4, 5));
+	static_assert(transpose(Matrix<int, 2, 3>(1, 2, 3, 4, 5, 6)) == Matrix<int, 3, 2>(1, 4, 2, 5, 3, 6));
+	static_assert(Matrix<int, 2, 3>(1, 2, 3, 4, 5, 6) * Matrix<int, 3, 2>(1, 4, 2, 5, 3, 6) == Matrix<int, 2, 2>(14, 32, 32, 77));
+	static_assert(trace(m3) == 6);
+	static_assert(m3 + m3 == m3 * 2);
+	static_assert((m3 - m3) == Mat33d(0));
+	static_assert((m3 * a3) == Matrix<double, 3, 1>(0, 0, 4));
+
+	// det and inverse, up to 6x6
+
+	static_assert(det(Mat22d(4, 7, 2, 6)) == 10);
+	static_assert(det(m3) == 4);
+	static_assert(det(Matrix<int, 3, 3>(2, 0, 1, 1, 3, 2, 1, 1, 2)) == 6);
+	// Odd and above 2^24, so not a float: integer 4x4 matrices are computed in double, and exactly
+	constexpr Matrix<int, 4, 4> m4i(4097, 3, -5, 7, 2, 4097, 2, 1, -6, 1, 1, 9, 5, 0, -3, 1);
+	static_assert(det(m4i) == 469298673);
+	static_assert(near(inverse(Mat22d(4, 7, 2, 6)), Mat22d(0.6, -0.7, -0.2, 0.4), 1e-15));
+	static_assert(near(inverse(m3) * m3, identity<double, 3>(), 1e-15));
+	static_assert(inverse(Mat33d(1, 2, 3, 2, 4, 6, 0, 0, 1)) == Mat33d(0));
+	static_assert(check_det_and_inverse<2>());
+	static_assert(check_det_and_inverse<3>());
+	static_assert(check_det_and_inverse<4>());
+	static_assert(check_det_and_inverse<5>());
+	static_assert(check_det_and_inverse<6>());
+	static_assert(check_lu<5>());
+	static_assert(check_lu<6>());
+
+	// Rotations
+
+	constexpr Mat44f view = RotateY(0.5f) * RotateX(-0.25f);
+	static_assert(near(RotateX(float(pi / 2)) * Vec4f(0, 1, 0, 0), Matrix<float, 4, 1>(0, 0, 1, 0), 1e-6));
+	static_assert(near(RotateY(float(pi / 2)) * Vec4f(0, 0, 1, 0), Matrix<float, 4, 1>(1, 0, 0, 0), 1e-6));
+	static_assert(near(RotateZ(float(pi / 2)) * Vec4f(1, 0, 0, 0), Matrix<float, 4, 1>(0, 1, 0, 0), 1e-6));
+	static_assert(near(RotateZ(0.3f) * RotateZ(0.4f), RotateZ(0.7f), 1e-6));
+	static_assert(near(inverse(view), transpose(view), 1e-6));
+	static_assert(near(inverse_transpose(view), view, 1e-6));
+	static_assert(near(det(view), 1, 1e-6));
+
+	// Quaternions
+
+	constexpr Quatd p(1, 2, 3, 4);
+	constexpr Quatd q(0.5, -1, 2, 0.25);
+	static_assert(p * q == Quatd(-4.5, -7.25, -1, 9.25));
+	static_assert(p + q == Quatd(1.5, 1, 5, 4.25));
+	static_assert(p - q == Quatd(0.5, 3, 1, 3.75));
+	static_assert(Conjugate(p) == Quatd(1, -2, -3, -4));
+	static_assert(dot(p, q) == 5.5);
+	static_assert(SquaredLength(p) == 30);
+	static_assert(near(p * Inverse(p), Quatd(1, 0, 0, 0), 1e-15));
+	static_assert(near(Length(Normalise(q)), 1, 1e-15));
+	static_assert(IsNormal(Normalise(p)));
+#if defined(SML_QUATERNION_LANES)
+	static_assert(p.scalar() == 1 && p.vector() == Vec3d(2, 3, 4));
+
+	// The scalar and vector parts write through to the lanes
+	constexpr Quatd write_parts() {
+		Quatd r(1, 0, 0, 0);
+		r.vector() = Vec3d(2, 3, 4);
+		r.vector()[0] += 1;
+		r.vector() *= 2;
+		r.vector() -= Vec3d(0, 0, 1);
+		r.scalar() = 5;
+		return r;
+	}
+	static_assert(write_parts() == Quatd(5, 6, 6, 7));
+	static_assert(Quatd(p).vector() == Vec3d(2, 3, 4));
+#else
+	static_assert(p.scalar[0] == 1 && p.vector == Vec3d(2, 3, 4));
+
+	// The scalar and vector members are the parts of the quaternion
+	constexpr Quatd write_parts() {
+		Quatd r(1, 0, 0, 0);
+		r.vector = Vec3d(2, 3, 4);
+		r.vector[0] += 1;
+		r.vector *= 2;
+		r.vector -= Vec3d(0, 0, 1);
+		r.scalar[0] = 5;
+		return r;
+	}
+	static_assert(write_parts() == Quatd(5, 6, 6, 7));
+	static_assert(Quatd(p).vector == Vec3d(2, 3, 4));
+#endif
+
+	// A rotation by the unit quaternion u matches the one by its matrix, and each converts back to the other
+	constexpr bool check_rotation(const Quatd& u) {
+		const Vec3d v(0.3, -1.2, 2.5);
+		const Mat33d m = QuaternionTo33RotationMatrix(u);
+		const Matrix<double, 3, 1> mv = m * v;
+		const Vec3d rotated = RotatePassive(v, u);
+		// RotationMatrixToQuaternion gives the quaternion with a non-negative scalar part
+		const Quatd back = RotationMatrixToQuaternion(m);
+		return near(rotated, Vec3d(mv[0][0], mv[1][0], mv[2][0]), 1e-12)
+			&& near(RotatePassiveUnit(v, u), rotated, 1e-12)
+			&& near(RotateActive(rotated, u), v, 1e-12)
+			&& near(RotatePassive(v, u * 3.0), rotated, 1e-12)
+			&& near(back, (u.s() < 0) ? -u : u, 1e-12)
+			&& near(QuaternionTo33RotationMatrix(back), m, 1e-12)
+			&& near(RotationMatrixToQuaternion(QuaternionTo44RotationMatrix(u)), back, 1e-12)
+			&& near(det(m), 1, 1e-12);
+	}
+	// Rotations about each axis, a general one, and ones near 180 degrees, where a different component is the largest
+	static_assert(check_rotation(Quatd(1, 0, 0, 0)));
+	static_assert(check_rotation(Normalise(Quatd(0.9, 0.1, -0.3, 0.2))));
+	static_assert(check_rotation(Normalise(Quatd(-0.2, 0.5, 0.5, -0.7))));
+	static_assert(check_rotation(Normalise(Quatd(0.001, 1, 0.02, 0))));
+	static_assert(check_rotation(Normalise(Quatd(0.001, 0.01, -1, 0.03))));
+	static_assert(check_rotation(Normalise(Quatd(0, 0.02, 0, 1))));
+	static_assert(near(QuaternionTo44RotationMatrix(Quatd(detail::constexpr_cos(0.25), detail::constexpr_sin(0.25), 0, 0)),
+		Matrix<double, 4, 4>(RotateX(0.5f)), 1e-7));
+	static_assert(near(RotationMatrixToQuaternion(top_left(view)), Quatf(RotationMatrixToQuaternion(Matrix<double, 3, 3>(top_left(view)))), 1e-6));
+
+} // !namespace
+
+// Bit patterns cannot be compared at compile time, so a run-time result must be within rounding of the compile-time
+// one: the SIMD kernels may fuse or reorder operations that the scalar paths do not
+int main() {
+	constexpr Quatd pq = p * q;
+	constexpr Quatf pqf = Quatf(1, 2, 3, 4) * Quatf(0.5f, -1, 2, 0.25f);
+	constexpr Quatf unit = Normalise(Quatf(0.9f, 0.1f, -0.3f, 0.2f));
+	constexpr Mat44f inv_view = inverse(view);
+	constexpr Matrix<double, 6, 6> inv6 = inverse(test_matrix<6>());
+	// Not affine, so at run time these take the four-lane cofactor kernel rather than inverse_affine
+	constexpr Mat44d m4 = test_matrix<4>();
+	constexpr Mat44f m4f = Mat44f(m4);
+	static_assert(!detail::is_affine(m4) && !detail::is_affine(m4f));
+	constexpr Mat44d inv4 = inverse(m4);
+	constexpr Mat44f inv4f = inverse(m4f);
+	constexpr Vec3f rotated = RotatePassiveUnit(Vec3f(0.3f, -1.2f, 2.5f), unit);
+
+	expect(near(opaque(p) * opaque(q), pq, 1e-15), "Quatd product");
+	expect(near(opaque(Quatf(1, 2, 3, 4)) * opaque(Quatf(0.5f, -1, 2, 0.25f)), pqf, 1e-6), "Quatf product");
+	expect(near(Normalise(opaque(Quatf(0.9f, 0.1f, -0.3f, 0.2f))), unit, 1e-6), "Quatf Normalise");
+	expect(near(Conjugate(opaque(unit)), Quatf(unit.s(), -unit.i(), -unit.j(), -unit.k()), 0), "Quatf Conjugate");
+	expect(near(inverse(opaque(view)), inv_view, 1e-6), "Mat44f inverse");
+	expect(near(inverse(opaque(m4)), inv4, 1e-12), "Mat44d inverse, not affine");
+	expect(near(m4 * inverse(opaque(m4)), identity<double, 4>(), 1e-12), "Mat44d times its inverse, not affine");
+	expect(near(inverse(opaque(m4f)), inv4f, 1e-5), "Mat44f inverse, not affine");
+	expect(near(m4f * inverse(opaque(m4f)), identity<float, 4>(), 1e-5), "Mat44f times its inverse, not affine");
+	expect(near(inverse(opaque(test_matrix<6>())), inv6, 1e-12), "Matrix<double, 6, 6> inverse");
+	expect(near(det(opaque(test_matrix<6>())), test_determinant<6>(), 1e-12), "Matrix<double, 6, 6> det");
+	expect(det(opaque(m4i)) == 469298673, "Matrix<int, 4, 4> det");
+	expect(near(det(opaque(m4)), det(m4), 1e-15), "Mat44d det");
+	expect(near(RotatePassiveUnit(opaque(Vec3f(0.3f, -1.2f, 2.5f)), opaque(unit)), rotated, 1e-6), "RotatePassiveUnit");
+	expect(near(RotationMatrixToQuaternion(QuaternionTo33RotationMatrix(opaque(unit))), unit, 1e-6), "quaternion round trip");
+
+	// Float dot products sum in double at run time too, so they match the scalar loop exactly: a float sum would lose
+	// the ones next to 1e8
+	constexpr Vec4f big(1e8f, 1, -1e8f, 1);
+	constexpr double big_dot = dot(big, Vec4f(1, 1, 1, 1));
+	constexpr double big_squares = squared_length(big);
+	constexpr Vec3f small(0.1f, -0.7f, 3.3f);
+	constexpr double small_dot = dot(small, Vec3f(2.9f, 0.3f, -1.1f));
+	static_assert(big_dot == 2);
+	expect(dot(opaque(big), opaque(Vec4f(1, 1, 1, 1))) == big_dot, "Vec4f dot accumulates in double");
+	expect(squared_length(opaque(big)) == big_squares, "Vec4f squared_length accumulates in double");
+	expect(dot(opaque(small), opaque(Vec3f(2.9f, 0.3f, -1.1f))) == small_dot, "Vec3f dot accumulates in double");
+
+	// The SIMD compound operators, AddWithWeight, fma and the float cross product at run time
+	const auto check_vector_ops = [](const auto& got, const auto& want, const std::string& type) {
+		for (size_t i = 0; i < got.size(); i++) {
+			expect(got[i] == want[i], type + " " + vector_op_names[i]);
+		}
+	};
+	constexpr Vec3f a3f(1.5f, -2, 0.25f), w3f(2, -0.5f, 4);
+	constexpr Vec4f a4f(1.5f, -2, 0.25f, 3), w4f(2, -0.5f, 4, 0.25f);
+	constexpr Vec4d a4d(1.5, -2, 0.25, 3), w4d(2, -0.5, 4, 0.25);
+	constexpr auto ops3f = vector_ops(a3f, w3f);
+	constexpr auto ops4f = vector_ops(a4f, w4f);
+	constexpr auto ops4d = vector_ops(a4d, w4d);
+	check_vector_ops(vector_ops(opaque(a3f), opaque(w3f)), ops3f, "Vec3f");
+	check_vector_ops(vector_ops(opaque(a4f), opaque(w4f)), ops4f, "Vec4f");
+	check_vector_ops(vector_ops(opaque(a4d), opaque(w4d)), ops4d, "Vec4d");
+	// Division by a scalar that has no exact reciprocal, element by element against the scalar operator
+	bool divided = true;
+	for (int k = -200; k <= 200; k++) {
+		const Vec4f vf = opaque(Vec4f(0.1f * static_cast<float>(k), static_cast<float>(k), 1e7f + static_cast<float>(k), 1.0f / static_cast<float>(k + 1000)));
+		const Vec4d vd = opaque(Vec4d(0.1 * k, k, 1e15 + k, 1.0 / (k + 1000)));
+		const Vec4f qf = vf / 3.0f;
+		const Vec4d qd = vd / 3.0;
+		for (size_t i = 0; i < 4; i++) {
+			divided = divided && (qf[i] == vf[i] / 3.0f) && (qd[i] == vd[i] / 3.0);
+		}
+	}
+	expect(divided, "Vec4f and Vec4d divided by 3");
+	expect(opaque(Vector<int, 3>(9, -7, 6)) / 3 == Vector<int, 3>(3, -2, 2), "integer Vector divided by 3");
+
+	constexpr Vec3f cross3f = cross_product(a3f, w3f);
+	static_assert(cross3f == Vec3f(-7.875f, -5.5f, 3.25f));
+	expect(cross_product(opaque(a3f), opaque(w3f)) == cross3f, "Vec3f cross_product");
+
+	return result();
+}
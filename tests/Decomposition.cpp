@@ -0,0 +1,249 @@
+// Cholesky and LDL^T factorisations of fixed-size and dynamic matrices: reconstruction of A from the factors, solves,
+// determinants, rank-1 updates, and matrices that are not positive definite
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+namespace {
+
+	// A symmetric positive-definite n x n matrix, row-major: B^T B + I for a B with entries in [-1, 1]
+	std::vector<double> spd_elements(size_t n) {
+		std::vector<double> b(n * n), a(n * n, 0);
+		for (size_t i = 0; i < n * n; i++) {
+			b[i] = std::sin(1.7 * static_cast<double>(i) + 0.3);
+		}
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < n; j++) {
+				for (size_t k = 0; k < n; k++) {
+					a[(i * n) + j] += b[(k * n) + i] * b[(k * n) + j];
+				}
+			}
+			a[(i * n) + i] += 1;
+		}
+		return a;
+	}
+
+	// Largest element of |x - y| relative to the largest of |y|
+	double relative_error(const double* x, const double* y, size_t count) {
+		double error = 0, size = 0;
+		for (size_t i = 0; i < count; i++) {
+			error = std::max(error, magnitude(x[i] - y[i]));
+			size = std::max(size, magnitude(y[i]));
+		}
+		return error / size;
+	}
+
+	// transpose(U) D U for the packed factors of size n, with D the identity (Cholesky) or on the diagonal (LDL^T)
+	std::vector<double> reconstruct(const double* factors, size_t n, bool ldlt) {
+		std::vector<double> a(n * n, 0);
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < n; j++) {
+				for (size_t k = 0; k <= std::min(i, j); k++) {
+					const double uki = (ldlt && (k == i)) ? 1 : factors[(k * n) + i];
+					const double ukj = (ldlt && (k == j)) ? 1 : factors[(k * n) + j];
+					a[(i * n) + j] += uki * (ldlt ? factors[(k * n) + k] : 1) * ukj;
+				}
+			}
+		}
+		return a;
+	}
+
+	bool lower_triangle_zero(const double* factors, size_t n) {
+		for (size_t i = 1; i < n; i++) {
+			for (size_t j = 0; j < i; j++) {
+				if (factors[(i * n) + j] != 0) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	// |A x - b| relative to |b|, for A given by its elements
+	double solve_error(const std::vector<double>& a, const double* x, const double* b, size_t n) {
+		std::vector<double> ax(n, 0);
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < n; j++) {
+				ax[i] += a[(i * n) + j] * x[j];
+			}
+		}
+		return relative_error(ax.data(), b, n);
+	}
+
+	// The same checks of a factorisation for Matrix and DynMatrix: make(elements) builds the matrix, vector(elements)
+	// a vector, and Factor is the factorisation
+	template<class Factor, bool ldlt, class Make, class MakeVector>
+	void check_factor(size_t n, Make make, MakeVector vector, const std::string& name) {
+		const std::vector<double> elements = spd_elements(n);
+		const auto a = make(elements);
+		const Factor f(a);
+		const double* u = f.factors().data.data();
+		const double tolerance = 1e-12;
+
+		if constexpr (ldlt) {
+			expect(!f.singular(), name + ": not singular");
+		}
+		else {
+			expect(f.positive_definite(), name + ": positive definite");
+		}
+		expect(lower_triangle_zero(u, n), name + ": zeroes below the diagonal");
+		expect(relative_error(reconstruct(u, n, ldlt).data(), elements.data(), n * n) <= tolerance, name + ": reconstructs A");
+
+		std::vector<double> b(n);
+		for (size_t i = 0; i < n; i++) {
+			b[i] = static_cast<double>(i % 5) - 1.5;
+		}
+		const auto x = f.solve(vector(b));
+		expect(solve_error(elements, &*x.begin(), b.data(), n) <= tolerance, name + ": solve");
+
+		const auto inv = f.inverse();
+		bool inverse_ok = true;
+		for (size_t j = 0; j < n; j++) {
+			std::vector<double> e(n, 0), column(n);
+			e[j] = 1;
+			for (size_t i = 0; i < n; i++) {
+				column[i] = inv.data[(i * n) + j];
+			}
+			inverse_ok = inverse_ok && (solve_error(elements, column.data(), e.data(), n) <= 1e-10);
+		}
+		expect(inverse_ok, name + ": inverse");
+
+		// The determinant is the product of the pivots of an LU factorisation of the same matrix
+		double log_det = 0;
+		{
+			std::vector<double> lu = elements;
+			for (size_t k = 0; k < n; k++) {
+				log_det += std::log(lu[(k * n) + k]);
+				for (size_t i = k + 1; i < n; i++) {
+					const double l = lu[(i * n) + k] / lu[(k * n) + k];
+					for (size_t j = k; j < n; j++) {
+						lu[(i * n) + j] -= l * lu[(k * n) + j];
+					}
+				}
+			}
+		}
+		expect(near(f.log_det(), log_det, 1e-10), name + ": log_det");
+		expect(near(std::log(f.det()), log_det, 1e-10) || !std::isfinite(std::log(f.det())), name + ": det");
+
+		// Only the upper triangle is read
+		std::vector<double> upper = elements;
+		for (size_t i = 1; i < n; i++) {
+			for (size_t j = 0; j < i; j++) {
+				upper[(i * n) + j] = 1e6;
+			}
+		}
+		const Factor g(make(upper));
+		expect(std::equal(g.factors().data.begin(), g.factors().data.end(), f.factors().data.begin()), name + ": reads only the upper triangle");
+
+		// A + v v^T and back again, against factoring A + v v^T afresh
+		std::vector<double> v(n), updated = elements;
+		for (size_t i = 0; i < n; i++) {
+			v[i] = std::cos(static_cast<double>(i));
+		}
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < n; j++) {
+				updated[(i * n) + j] += v[i] * v[j];
+			}
+		}
+		Factor h(a);
+		expect(h.update(vector(v)), name + ": update");
+		const Factor fresh(make(updated));
+		expect(relative_error(h.factors().data.data(), fresh.factors().data.data(), n * n) <= 1e-10, name + ": update matches refactoring");
+		expect(h.downdate(vector(v)) && (relative_error(h.factors().data.data(), u, n * n) <= 1e-10), name + ": downdate undoes update");
+
+		// Downdating by a vector larger than A allows leaves a matrix that is not positive definite
+		std::vector<double> big(n, 0);
+		big[0] = 2 * std::sqrt(elements[0]);
+		Factor k(a);
+		const bool downdated = k.downdate(vector(big));
+		if constexpr (ldlt) {
+			// LDL^T still factors it, with a negative pivot
+			expect(downdated && (k.diagonal()[0] < 0), name + ": downdate past definiteness");
+		}
+		else {
+			expect(!downdated && !k.positive_definite(), name + ": downdate past definiteness");
+		}
+	}
+
+	template<size_t n>
+	void check_fixed() {
+		const auto make = [](const std::vector<double>& e) {
+			Matrix<double, n, n> m;
+			std::copy(e.begin(), e.end(), m.data.begin());
+			return m;
+		};
+		const auto vector = [](const std::vector<double>& e) {
+			Vector<double, n> v;
+			std::copy(e.begin(), e.end(), v.begin());
+			return v;
+		};
+		const std::string size = std::to_string(n) + "x" + std::to_string(n);
+		check_factor<CholeskyFactor<double, n>, false>(n, make, vector, "Cholesky " + size);
+		check_factor<LDLTFactor<double, n>, true>(n, make, vector, "LDL^T " + size);
+
+		// Multiple right-hand sides at once
+		const Matrix<double, n, n> a = make(spd_elements(n));
+		Matrix<double, n, 2> B;
+		for (size_t i = 0; i < n; i++) {
+			B[i][0] = static_cast<double>(i);
+			B[i][1] = 1;
+		}
+		expect(near(a * cholesky(a).solve(B), B, 1e-12) && near(a * ldlt(a).solve(B), B, 1e-12), "solve for a Matrix of right-hand sides " + size);
+	}
+
+	void check_dynamic(size_t n) {
+		const auto make = [n](const std::vector<double>& e) {
+			DynMatrix<double> m(n, n);
+			std::copy(e.begin(), e.end(), m.data.begin());
+			return m;
+		};
+		const auto vector = [](const std::vector<double>& e) {
+			DynVector<double> v(e.size());
+			std::copy(e.begin(), e.end(), v.data.begin());
+			return v;
+		};
+		const std::string size = "dynamic " + std::to_string(n) + "x" + std::to_string(n);
+		check_factor<DynCholeskyFactor<double>, false>(n, make, vector, "Cholesky " + size);
+		check_factor<DynLDLTFactor<double>, true>(n, make, vector, "LDL^T " + size);
+	}
+
+}
+
+int main() {
+	check_fixed<1>();
+	check_fixed<3>();
+	check_fixed<4>();
+	check_fixed<6>();
+	// Larger than a panel of the blocked factorisation
+	check_fixed<40>();
+	check_dynamic(1);
+	check_dynamic(5);
+	check_dynamic(32);
+	check_dynamic(33);
+	check_dynamic(100);
+
+	// Not positive definite: indefinite, negative definite and singular
+	const Mat33d indefinite(1, 2, 0, 2, 1, 0, 0, 0, 3);
+	expect(!CholeskyFactor<double, 3>(indefinite).positive_definite(), "Cholesky rejects an indefinite matrix");
+	expect(!cholesky(Mat22d(-2, 0, 0, -1)).positive_definite(), "Cholesky rejects a negative-definite matrix");
+	expect(!cholesky(Mat22d(1, 1, 1, 1)).positive_definite(), "Cholesky rejects a singular matrix");
+	expect(!DynCholeskyFactor<double>(DynMatrix<double>(2, 2, { 1, 3, 3, 1 })).positive_definite(), "DynCholeskyFactor rejects an indefinite matrix");
+
+	// LDL^T factors symmetric indefinite matrices that need no pivoting, with a negative pivot, and reports zero pivots
+	const LDLTFactor<double, 3> l(indefinite);
+	const std::vector<double> indefinite_elements(indefinite.data.begin(), indefinite.data.end());
+	const std::vector<double> b = { 1, 2, 3 };
+	const Vec3d x = l.solve(Vec3d(1, 2, 3));
+	expect(!l.singular() && (l.diagonal()[1] < 0) && (solve_error(indefinite_elements, &*x.begin(), b.data(), 3) <= 1e-12), "LDL^T of an indefinite matrix");
+	expect(ldlt(Mat22d(1, 1, 1, 1)).singular() && DynLDLTFactor<double>(DynMatrix<double>(2, 2, { 0, 1, 1, 0 })).singular(), "LDL^T reports a zero pivot");
+
+	expect(throws<std::invalid_argument>([] { DynCholeskyFactor<double>(DynMatrix<double>(2, 3, 1.0)); }), "DynCholeskyFactor of a matrix that is not square");
+	expect(throws<std::invalid_argument>([] { DynLDLTFactor<double>(DynMatrix<double>(3, 3, { 2, 0, 0, 0, 2, 0, 0, 0, 2 })).solve(DynVector<double>(2, 1.0)); }), "DynLDLTFactor::solve dimensions");
+	return result();
+}
@@ -0,0 +1,41 @@
+// Lazy expressions against the same arithmetic evaluated eagerly, including expressions kept in auto variables after
+// the temporaries they were built from have gone
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+int main() {
+	const Vec4f a(1, 2, 3, 4);
+	const Vec4f b(2, -1, 0.5f, 8);
+	const Vec4f c(0.5f, 0.25f, -2, 1);
+	const float s = 3;
+	const Vec4f expected = a + b * s - c;
+
+	expect(Vec4f(lazy(a) + lazy(b) * s - c) == expected, "lazy(a) + lazy(b) * s - c");
+	expect(Vec4f(lazy(a) + b * s - c) == expected, "lazy(a) + b * s - c");
+	expect(evaluate(s * lazy(b) + a - c) == expected, "evaluate(s * lazy(b) + a - c)");
+	expect(Vec4f(lazy(a) * b / lazy(b) + 1.0f) == a + 1.0f, "element-wise product and quotient");
+	expect(Vec4f(2.0f - lazy(a) / 2.0f) == 2.0f - a / 2.0f, "scalars on the left");
+
+	// b * s and a + b are temporaries that end with the statements creating e and f, so the expressions must own them
+	auto e = lazy(a) + b * s - c;
+	auto f = lazy(a + b) * 2.0f;
+	auto g = c - (a + b);
+	expect(Vec4f(e) == expected, "expression holding a temporary Vector");
+	expect(Vec4f(f) == (a + b) * 2.0f, "lazy() of a temporary Vector");
+	expect(Vec4f(lazy(g) + 1.0f) == c - (a + b) + 1.0f, "lazy() of a variable");
+
+	const Mat33d m(1, 2, 3, 4, 5, 6, 7, 8, 9);
+	const Mat33d n(0.5, -1, 2, 0, 3, -2, 1, 1, 1);
+	auto h = lazy(m * 2.0) - n;
+	expect(Mat33d(h) == (m * 2.0) - n, "expression holding a temporary Matrix");
+	expect(Mat33d(lazy(m) + n * 0.5 - 1.0) == m + n * 0.5 - 1.0, "Matrix expression");
+
+	// The element type of the left-most operand is kept, as with the regular operators
+	const Vec3i k(1, 2, 3);
+	expect(Vec3i(lazy(k) + Vec3d(0.5, 0.5, 0.5)) == k + Vec3d(0.5, 0.5, 0.5), "mixed element types");
+
+	return result();
+}
\ No newline at end of file
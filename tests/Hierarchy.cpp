@@ -0,0 +1,140 @@
+// TransformHierarchy on a random forest: every world matrix against its parent's times its local transform, after a
+// full update and after a parallel update of a few dirtied subtrees, which must leave every other node as it was
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+namespace {
+
+	// Deterministic pseudo-random numbers, so that a failure can be repeated
+	struct lcg {
+		uint64_t state = 12345;
+		uint32_t next() {
+			state = (state * 6364136223846793005ull) + 1442695040888963407ull;
+			return static_cast<uint32_t>(state >> 33);
+		}
+		// In [0, n)
+		size_t below(size_t n) { return next() % n; }
+		// In [a, b]
+		double between(double a, double b) { return a + ((b - a) * (next() / 4294967295.0)); }
+	};
+
+	template<std::floating_point T>
+	Quaternion<T> random_rotation(lcg& random) {
+		const Quaternion<T> q(static_cast<T>(random.between(-1, 1)), static_cast<T>(random.between(-1, 1)), static_cast<T>(random.between(-1, 1)), static_cast<T>(random.between(-1, 1)));
+		return q / std::sqrt(dot(q, q));
+	}
+
+	template<std::floating_point T>
+	Vector<T, 3> random_vector(lcg& random, double a, double b) {
+		return Vector<T, 3>(static_cast<T>(random.between(a, b)), static_cast<T>(random.between(a, b)), static_cast<T>(random.between(a, b)));
+	}
+
+	// world(i) = world(parent(i)) * local(i) for every node, and world(i) = local(i) for the roots
+	template<std::floating_point T>
+	bool consistent(const TransformHierarchy<T>& h, double tolerance) {
+		for (size_t i = 0; i < h.size(); i++) {
+			const size_t p = h.parent(i);
+			const Matrix<T, 4, 4> expected = (p == h.no_parent) ? h.local(i) : h.world(p) * h.local(i);
+			if (!near(h.world(i), expected, tolerance)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<std::floating_point T>
+	void check_hierarchy(double tolerance) {
+		const std::string type = std::is_same_v<T, float> ? "float" : "double";
+		lcg random;
+		// Each node hangs from a random earlier node, or is a root, so the nodes start out depth-first rather than
+		// breadth-first. Enough nodes for the widest levels (over 2000) to be shared among threads
+		const size_t count = 20000;
+		TransformHierarchy<T> h;
+		for (size_t i = 0; i < count; i++) {
+			const size_t parent = ((i == 0) || (random.below(50) == 0)) ? h.no_parent : random.below(i);
+			h.add(parent, random_vector<T>(random, -1, 1), random_rotation<T>(random), random_vector<T>(random, 0.8, 1.2));
+		}
+		expect(!h.is_sorted(), "random forest is not breadth-first, " + type);
+		h.update();
+		expect(consistent(h, tolerance), "update of a random forest, " + type);
+
+		// Sorting keeps every node's parent and world matrix, under its new index
+		const std::vector<Matrix<T, 4, 4>> unsorted(h.world_matrices().begin(), h.world_matrices().end());
+		std::vector<size_t> unsorted_parents(count);
+		for (size_t i = 0; i < count; i++) {
+			unsorted_parents[i] = h.parent(i);
+		}
+		const std::vector<size_t> remap = h.sort();
+		bool sorted_ok = h.is_sorted();
+		for (size_t i = 0; i < count; i++) {
+			const size_t p = unsorted_parents[i];
+			sorted_ok = sorted_ok && (h.world(remap[i]) == unsorted[i]) && (h.parent(remap[i]) == ((p == h.no_parent) ? p : remap[p]));
+			sorted_ok = sorted_ok && ((remap[i] == 0) || (h.depth(remap[i] - 1) <= h.depth(remap[i])));
+		}
+		expect(sorted_ok, "sort into breadth-first order, " + type);
+
+		// Dirty a few subtrees, including a root, and mark which nodes lie in them
+		const std::vector<Matrix<T, 4, 4>> before(h.world_matrices().begin(), h.world_matrices().end());
+		std::vector<unsigned char> changed(count, 0);
+		const size_t edits[] = { 0, count / 3, count / 2, count - 1 };
+		for (size_t e : edits) {
+			changed[e] = 1;
+		}
+		h.set_rotation(edits[0], random_rotation<T>(random));
+		h.set_translation(edits[1], random_vector<T>(random, -1, 1));
+		h.set_scale(edits[2], random_vector<T>(random, 0.8, 1.2));
+		h.set_local(edits[3], random_vector<T>(random, -1, 1), random_rotation<T>(random), random_vector<T>(random, 0.8, 1.2));
+		// Parents come before their children, so one forward pass finds the whole of each subtree
+		for (size_t i = 0; i < count; i++) {
+			if ((h.parent(i) != h.no_parent) && changed[h.parent(i)]) {
+				changed[i] = 1;
+			}
+		}
+
+		h.update(execution::par);
+		expect(consistent(h, tolerance), "parallel update of dirtied subtrees, " + type);
+		bool untouched = true, moved = true;
+		for (size_t i = 0; i < count; i++) {
+			if (!changed[i]) {
+				untouched = untouched && (h.world(i) == before[i]);
+			}
+		}
+		for (size_t e : edits) {
+			moved = moved && !(h.world(e) == before[e]);
+		}
+		expect(untouched, "nodes outside the dirtied subtrees keep their world matrices, " + type);
+		expect(moved, "dirtied nodes are recomputed, " + type);
+
+		// Nothing is dirty now, so another update changes nothing
+		const std::vector<Matrix<T, 4, 4>> settled(h.world_matrices().begin(), h.world_matrices().end());
+		h.update(execution::par);
+		expect(std::equal(settled.begin(), settled.end(), h.world_matrices().begin()), "update with nothing dirty, " + type);
+
+		// A node changed through the local batches is only recomputed once marked dirty
+		const size_t node = count - 2;
+		h.local_translations()[node] = Vector<T, 3>(T(5), T(6), T(7));
+		h.update();
+		expect(h.world(node) == settled[node], "batch edits wait for mark_dirty, " + type);
+		h.mark_dirty(node);
+		h.update(execution::par);
+		expect(consistent(h, tolerance), "update after mark_dirty, " + type);
+
+		expect(throws<std::out_of_range>([&] { h.add(count + 5); }), "parent index out of range");
+	}
+
+}
+
+int main() {
+	check_hierarchy<float>(1e-5);
+	check_hierarchy<double>(1e-12);
+	return result();
+}
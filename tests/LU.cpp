@@ -0,0 +1,187 @@
+// LU factorisations with partial pivoting: LUFactor solves, determinants and inverses against an unblocked reference
+// factorisation, and LUPDecomposition against P A = L U, for sizes within one panel of the blocked kernel and beyond
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+namespace {
+
+	// An n x n matrix, row-major, with a zero diagonal so that every column needs a row exchange
+	std::vector<double> pivoting_elements(size_t n) {
+		std::vector<double> a(n * n);
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < n; j++) {
+				a[(i * n) + j] = (i == j) ? 0 : std::sin((1.3 * static_cast<double>(i)) + (0.7 * static_cast<double>(j * j)) + 0.2);
+			}
+		}
+		return a;
+	}
+
+	// Unblocked Doolittle factorisation with partial pivoting, as the textbook has it, returning det(A) and writing
+	// the packed factors and the row exchanged at each step
+	double reference_lu(std::vector<double>& a, std::vector<size_t>& pivots, size_t n) {
+		double det = 1;
+		pivots.resize(n);
+		for (size_t k = 0; k < n; k++) {
+			size_t p = k;
+			for (size_t i = k + 1; i < n; i++) {
+				if (std::abs(a[(i * n) + k]) > std::abs(a[(p * n) + k])) {
+					p = i;
+				}
+			}
+			pivots[k] = p;
+			if (p != k) {
+				for (size_t j = 0; j < n; j++) {
+					std::swap(a[(k * n) + j], a[(p * n) + j]);
+				}
+				det = -det;
+			}
+			det *= a[(k * n) + k];
+			for (size_t i = k + 1; i < n; i++) {
+				const double l = (a[(i * n) + k] /= a[(k * n) + k]);
+				for (size_t j = k + 1; j < n; j++) {
+					a[(i * n) + j] -= l * a[(k * n) + j];
+				}
+			}
+		}
+		return det;
+	}
+
+	// Solve A x = b with the factors of reference_lu
+	std::vector<double> reference_solve(const std::vector<double>& lu, const std::vector<size_t>& pivots, std::vector<double> b, size_t n) {
+		for (size_t k = 0; k < n; k++) {
+			std::swap(b[k], b[pivots[k]]);
+		}
+		for (size_t i = 0; i < n; i++) {
+			for (size_t k = 0; k < i; k++) {
+				b[i] -= lu[(i * n) + k] * b[k];
+			}
+		}
+		for (size_t i = n; i-- > 0;) {
+			for (size_t k = i + 1; k < n; k++) {
+				b[i] -= lu[(i * n) + k] * b[k];
+			}
+			b[i] /= lu[(i * n) + i];
+		}
+		return b;
+	}
+
+	// Largest element of |x - y| relative to the largest of |y|
+	double relative_error(const double* x, const double* y, size_t count) {
+		double error = 0, size = 0;
+		for (size_t i = 0; i < count; i++) {
+			error = std::max(error, magnitude(x[i] - y[i]));
+			size = std::max(size, magnitude(y[i]));
+		}
+		return error / size;
+	}
+
+	template<std::floating_point T, size_t n>
+	void check_lu(double tolerance) {
+		const std::string name = std::string(std::is_same_v<T, float> ? "float " : "double ") + std::to_string(n) + "x" + std::to_string(n);
+		const std::vector<double> elements = pivoting_elements(n);
+		// Matrices of the larger sizes are too big for the stack
+		const auto a = std::make_unique<Matrix<T, n, n>>();
+		for (size_t i = 0; i < n * n; i++) {
+			a->data[i] = static_cast<T>(elements[i]);
+		}
+		const auto f = std::make_unique<LUFactor<T, n>>(*a);
+		expect(!f->singular() && (f->row_exchanges() > 0), name + ": factored, with row exchanges");
+
+		std::vector<double> lu(a->data.begin(), a->data.end());
+		std::vector<size_t> pivots;
+		const double det = reference_lu(lu, pivots, n);
+		expect(std::equal(pivots.begin(), pivots.end(), f->pivots().begin()), name + ": pivots match the unblocked factorisation");
+		expect(near(static_cast<double>(f->det()) / det, 1, tolerance), name + ": det against the unblocked factorisation");
+
+		// A x = b, for one right-hand side and for several at once
+		Vector<T, n> b;
+		std::vector<double> bd(n);
+		for (size_t i = 0; i < n; i++) {
+			b[i] = static_cast<T>(static_cast<double>(i % 7) - 2.5);
+			bd[i] = static_cast<double>(b[i]);
+		}
+		const Vector<T, n> x = f->solve(b);
+		std::vector<double> ax(n, 0);
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < n; j++) {
+				ax[i] += static_cast<double>((*a)[i][j]) * static_cast<double>(x[j]);
+			}
+		}
+		expect(relative_error(ax.data(), bd.data(), n) <= tolerance, name + ": solve gives A x = b");
+
+		Matrix<T, n, 3> B;
+		for (size_t i = 0; i < n; i++) {
+			B[i][0] = b[i];
+			B[i][1] = T(1);
+			B[i][2] = static_cast<T>(i);
+		}
+		const Matrix<T, n, 3> X = f->solve(B);
+		bool columns_ok = true;
+		for (size_t i = 0; i < n; i++) {
+			columns_ok = columns_ok && (X[i][0] == x[i]);
+		}
+		expect(columns_ok && near(*a * X, B, tolerance * n), name + ": solve for a Matrix of right-hand sides");
+
+		// Each column of the inverse against solving for that column of the identity with the unblocked factors
+		const auto inv = std::make_unique<Matrix<T, n, n>>(f->inverse());
+		bool inverse_ok = true;
+		for (size_t j = 0; j < n; j++) {
+			std::vector<double> e(n, 0), column(n);
+			e[j] = 1;
+			const std::vector<double> expected = reference_solve(lu, pivots, e, n);
+			for (size_t i = 0; i < n; i++) {
+				column[i] = static_cast<double>((*inv)[i][j]);
+			}
+			inverse_ok = inverse_ok && (relative_error(column.data(), expected.data(), n) <= tolerance);
+		}
+		expect(inverse_ok, name + ": inverse against the unblocked factorisation");
+
+		// LUPDecomposition: P A = L U, and det from the diagonal of U and the count of row exchanges it keeps
+		const auto [packed, permutation] = LUPDecomposition(*a);
+		expect(packed == f->factors() && (permutation[n] == n + f->row_exchanges()), name + ": LUPDecomposition matches LUFactor");
+		double product = ((permutation[n] - n) % 2 == 0) ? 1 : -1;
+		double reconstruction = 0, size = 0;
+		for (size_t i = 0; i < n; i++) {
+			product *= static_cast<double>(packed[i][i]);
+			for (size_t j = 0; j < n; j++) {
+				double lu_ij = 0;
+				for (size_t k = 0; k <= std::min(i, j); k++) {
+					lu_ij += ((k == i) ? 1.0 : static_cast<double>(packed[i][k])) * static_cast<double>(packed[k][j]);
+				}
+				reconstruction = std::max(reconstruction, magnitude(lu_ij - static_cast<double>((*a)[permutation[i]][j])));
+				size = std::max(size, magnitude(static_cast<double>((*a)[i][j])));
+			}
+		}
+		expect(reconstruction <= tolerance * size, name + ": LUPDecomposition gives P A = L U");
+		expect(near(product / det, 1, tolerance) && near(static_cast<double>(sml::det(*a)) / det, 1, tolerance), name + ": det from LUPDecomposition");
+	}
+
+}
+
+int main() {
+	// Within one panel of the blocked factorisation, and over two and three panels
+	check_lu<double, 5>(1e-12);
+	check_lu<double, 40>(1e-11);
+	check_lu<double, 70>(1e-10);
+	check_lu<float, 5>(1e-4);
+	check_lu<float, 40>(1e-3);
+
+	// A matrix that has no LU factorisation without pivoting
+	const LUFactor<double, 3> p(Mat33d(0, 2, 1, 1, 1, 0, 3, 0, 1));
+	const Vec3d x = p.solve(Vec3d(5, 3, 4));
+	expect(!p.singular() && near(x, Vec3d(1, 2, 1), 1e-14) && near(p.det(), -5, 1e-14), "LUFactor of a matrix with a zero leading pivot");
+	expect(near(p.inverse() * Mat33d(0, 2, 1, 1, 1, 0, 3, 0, 1), identity<double, 3>(), 1e-14), "LUFactor inverse with a zero leading pivot");
+
+	// Singular matrices are reported, and invert to zeroes
+	const LUFactor<double, 3> s(Mat33d(1, 2, 3, 2, 4, 6, 1, 0, 1));
+	expect(s.singular() && (s.det() == 0) && (s.inverse() == Matrix<double, 3, 3>(0)), "LUFactor of a singular matrix");
+	return result();
+}
@@ -0,0 +1,311 @@
+// Run-time Matrix kernels against plain loops: transpose and transpose_inplace through the SIMD 4x4 tiles, the
+// recursive split and the parallel path, on sizes that are and are not multiples of the tile, and matrix products
+// through the tiled kernel, on shapes that leave partial register blocks and panels, the 4x4 det against its closed
+// form, and DynMatrix products, transposes, LU, det, inverse, trace and identity against the same operations on Matrix,
+// along with the fixed-size views and copies of DynVector and DynMatrix. Built with SML_CHECKED, it also checks that
+// out-of-range indices throw
+
+#include <cmath>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+namespace {
+
+	// A matrix of distinct elements, so that any element out of place is noticed
+	template<arithmetic T, size_t rows, size_t cols>
+	std::unique_ptr<Matrix<T, rows, cols>> numbered() {
+		auto m = std::make_unique<Matrix<T, rows, cols>>();
+		for (size_t i = 0; i < rows * cols; i++) {
+			m->data[i] = static_cast<T>(i) + T(0.5);
+		}
+		return m;
+	}
+
+	template<arithmetic T, size_t rows, size_t cols>
+	bool is_transpose(const Matrix<T, cols, rows>& t, const Matrix<T, rows, cols>& m) {
+		for (size_t i = 0; i < rows; i++) {
+			for (size_t j = 0; j < cols; j++) {
+				if (t[j][i] != m[i][j]) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	template<arithmetic T, size_t rows, size_t cols>
+	void check_transpose(const std::string& type) {
+		const std::string name = type + " " + std::to_string(rows) + "x" + std::to_string(cols);
+		const auto m = numbered<T, rows, cols>();
+		// Large matrices are built in place rather than returned through the stack
+		const auto t = std::make_unique<Matrix<T, cols, rows>>();
+		*t = transpose(*m);
+		expect(is_transpose(*t, *m), "transpose " + name);
+
+		if constexpr (rows == cols) {
+			const auto s = std::make_unique<Matrix<T, rows, cols>>(*m);
+			transpose_inplace(*s);
+			expect(is_transpose(*s, *m), "transpose_inplace " + name);
+			transpose_inplace(*s);
+			expect(*s == *m, "transpose_inplace twice " + name);
+		}
+	}
+
+	template<std::floating_point T>
+	void check_transposes(const std::string& type) {
+		// A single SIMD tile, tiles with ragged edges, and blocks around the 32-wide recursion tile
+		check_transpose<T, 4, 4>(type);
+		check_transpose<T, 5, 7>(type);
+		check_transpose<T, 7, 5>(type);
+		check_transpose<T, 37, 37>(type);
+		check_transpose<T, 33, 70>(type);
+		check_transpose<T, 100, 100>(type);
+		// 512 x 512 elements and more are split between threads
+		check_transpose<T, 513, 700>(type);
+		check_transpose<T, 515, 515>(type);
+	}
+
+	// An r x c matrix of small whole numbers, in quarters for floating-point types, so that every product and sum in
+	// the shapes below is exact and the kernels must agree with the reference to the last bit
+	template<arithmetic T, size_t r, size_t c>
+	std::unique_ptr<Matrix<T, r, c>> small_values(size_t seed) {
+		auto m = std::make_unique<Matrix<T, r, c>>();
+		for (size_t i = 0; i < r * c; i++) {
+			m->data[i] = static_cast<T>(static_cast<int>(((i * 37) + (seed * 11)) % 19) - 9);
+			if constexpr (std::floating_point<T>) {
+				m->data[i] /= T(4);
+			}
+		}
+		return m;
+	}
+
+	// a * b against the i-j-k loop, after converting b to T as the product does
+	template<arithmetic T, arithmetic T2, size_t m, size_t k, size_t n>
+	void check_product() {
+		const std::string name = std::to_string(m) + "x" + std::to_string(k) + " * " + std::to_string(k) + "x" + std::to_string(n)
+			+ " (" + typeid(T).name() + ", " + typeid(T2).name() + ")";
+		const auto a = small_values<T, m, k>(1);
+		const auto b = small_values<T2, k, n>(2);
+		const auto c = std::make_unique<Matrix<T, m, n>>();
+		*c = *a * *b;
+		bool ok = true;
+		for (size_t i = 0; i < m; i++) {
+			for (size_t j = 0; j < n; j++) {
+				T expected = 0;
+				for (size_t p = 0; p < k; p++) {
+					expected += (*a)[i][p] * static_cast<T>((*b)[p][j]);
+				}
+				ok = ok && ((*c)[i][j] == expected);
+			}
+		}
+		expect(ok, "product " + name);
+	}
+
+	template<std::floating_point T>
+	void check_products() {
+		// Below the tiling threshold, at it and just above it, with rows and columns left over from the register block
+		check_product<T, T, 3, 5, 4>();
+		check_product<T, T, 8, 8, 8>();
+		check_product<T, T, 8, 8, 9>();
+		check_product<T, T, 9, 13, 7>();
+		check_product<T, T, 9, 13, 17>();
+		check_product<T, T, 65, 65, 65>();
+		// Deeper than one packed panel of the right-hand matrix
+		check_product<T, T, 6, 300, 33>();
+		// Rectangular results, wider and taller than the block
+		check_product<T, T, 70, 20, 5>();
+		check_product<T, T, 5, 20, 70>();
+	}
+
+	// The float 4x4 det, a row per register with the SIMD backend, against the scalar closed form and against the
+	// double det of the same elements
+	void check_det4() {
+		bool ok = true;
+		for (size_t k = 0; k < 2000; k++) {
+			Mat44f m;
+			Matrix<double, 4, 4> md;
+			for (size_t i = 0; i < 16; i++) {
+				m.data[i] = static_cast<float>(std::sin((1.7 * static_cast<double>(k)) + (0.9 * static_cast<double>(i))) * 3);
+				md.data[i] = static_cast<double>(m.data[i]);
+			}
+			const float d = det(opaque(m));
+			ok = ok && near(d, detail::det4(m.data.data()), 1e-4) && near(d, det(md), 1e-4);
+		}
+		expect(ok, "float 4x4 det against the closed form");
+
+		// Exact cases: small whole numbers, a permutation, and rows that are not independent
+		expect(det(opaque(identity<float, 4>())) == 1, "det of the identity");
+		expect(det(opaque(Mat44f(0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0))) == 1, "det of a permutation");
+		expect(det(opaque(Mat44f(2, 0, 1, 3, 1, 1, 0, 2, 0, 3, 1, 1, 4, 0, 2, 1))) == -25, "det of whole numbers");
+		expect(det(opaque(Mat44f(1, 2, 3, 4, 2, 4, 6, 8, 0, 1, 0, 1, 5, 0, 2, 1))) == 0, "det of a singular matrix");
+	}
+
+	template<arithmetic T>
+	bool near_elements(const DynMatrix<T>& a, const DynMatrix<T>& b, double tolerance) {
+		if ((a.rows() != b.rows()) || (a.cols() != b.cols())) {
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); i++) {
+			if (!near(a.data[i], b.data[i], tolerance)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// An n x n matrix of small values with a dominant diagonal, so that it is well conditioned but still pivoted,
+	// scaled so that the diagonal is near 1 and the det stays in the range of float
+	template<std::floating_point T, size_t n>
+	std::unique_ptr<Matrix<T, n, n>> invertible(size_t seed) {
+		auto m = small_values<T, n, n>(seed);
+		for (size_t i = 0; i < n; i++) {
+			(*m)[i][i] += T(n) / T(2);
+		}
+		*m /= T(n) / T(2);
+		return m;
+	}
+
+	// Each DynMatrix operation against the same operation on a Matrix of the same elements, and the errors for
+	// matrices of the wrong shape
+	template<std::floating_point T>
+	void check_dyn_matrix(const std::string& type) {
+		// Non-square products, through the tiled kernel, with both operands dynamic and with either one fixed
+		const auto a = small_values<T, 9, 13>(1);
+		const auto b = small_values<T, 13, 17>(2);
+		const DynMatrix<T> da(*a), db(*b);
+		const DynMatrix<T> ab(*a * *b);
+		expect(da * db == ab, "DynMatrix product " + type);
+		expect(da * *b == ab, "DynMatrix times Matrix " + type);
+		expect(*a * db == ab, "Matrix times DynMatrix " + type);
+		const DynMatrix<T, aligned_allocator<T, 128>> aligned_b(*b);
+		const auto product = *a * aligned_b;
+		static_assert(std::is_same_v<decltype(product), const DynMatrix<T, aligned_allocator<T, 128>>>, "Matrix times DynMatrix keeps the allocator");
+		expect(product == ab, "Matrix times DynMatrix with its own allocator " + type);
+		DynMatrix<T> dc = da;
+		dc *= db;
+		expect(dc == ab, "DynMatrix operator*= " + type);
+		const auto sa = small_values<T, 3, 5>(3);
+		const auto sb = small_values<T, 5, 4>(4);
+		expect(DynMatrix<T>(*sa) * DynMatrix<T>(*sb) == DynMatrix<T>(*sa * *sb), "small DynMatrix product " + type);
+
+		const auto wide = numbered<T, 33, 70>();
+		expect(transpose(DynMatrix<T>(*wide)) == DynMatrix<T>(transpose(*wide)), "DynMatrix transpose " + type);
+		const auto square = numbered<T, 37, 37>();
+		DynMatrix<T> ds(*square);
+		transpose_inplace(ds);
+		expect(ds == DynMatrix<T>(transpose(*square)), "DynMatrix transpose_inplace " + type);
+
+		// LU, det and inverse, within one panel of the blocked kernel and beyond it
+		const auto m = invertible<T, 37>(5);
+		const DynMatrix<T> dm(*m);
+		const double tolerance = std::is_same_v<T, float> ? 1e-4 : 1e-12;
+		const auto [packed, pivots] = LUPDecomposition(dm);
+		const auto [fixed_packed, fixed_pivots] = LUPDecomposition(*m);
+		bool same_pivots = pivots.size() == fixed_pivots.size();
+		for (size_t i = 0; same_pivots && (i < pivots.size()); i++) {
+			same_pivots = pivots[i] == fixed_pivots[i];
+		}
+		expect(same_pivots && near_elements(packed, DynMatrix<T>(fixed_packed), tolerance), "DynMatrix LUPDecomposition " + type);
+		expect(near(det(dm), det(*m), tolerance), "DynMatrix det " + type);
+		expect(near_elements(inverse(dm), DynMatrix<T>(inverse(*m)), tolerance), "DynMatrix inverse " + type);
+		const auto small = invertible<T, 6>(6);
+		expect(near_elements(inverse(DynMatrix<T>(*small)), DynMatrix<T>(inverse(*small)), tolerance), "small DynMatrix inverse " + type);
+
+		expect(trace(dm) == trace(*m), "DynMatrix trace " + type);
+		expect(identity<T>(37) == DynMatrix<T>(identity<T, 37>()), "DynMatrix identity " + type);
+
+		// Shapes that do not fit
+		expect(throws<std::invalid_argument>([&] { return da * da; }), "DynMatrix product of mismatched shapes " + type);
+		expect(throws<std::invalid_argument>([&] { return da * *a; }), "DynMatrix times a Matrix of mismatched shape " + type);
+		expect(throws<std::invalid_argument>([&] { return *a * da; }), "Matrix times a DynMatrix of mismatched shape " + type);
+		expect(throws<std::invalid_argument>([&] { DynMatrix<T> copy = da; copy *= da; }), "DynMatrix operator*= of mismatched shapes " + type);
+		expect(throws<std::invalid_argument>([&] { DynMatrix<T> copy = da; transpose_inplace(copy); }), "transpose_inplace of a DynMatrix that is not square " + type);
+		expect(throws<std::invalid_argument>([&] { return det(da); }), "det of a DynMatrix that is not square " + type);
+		expect(throws<std::invalid_argument>([&] { return inverse(da); }), "inverse of a DynMatrix that is not square " + type);
+		expect(throws<std::invalid_argument>([&] { return LUPDecomposition(da); }), "LUPDecomposition of a DynMatrix that is not square " + type);
+		expect(throws<std::invalid_argument>([&] { return trace(da); }), "trace of a DynMatrix that is not square " + type);
+	}
+
+#if defined(SML_CHECKED)
+	// With SML_CHECKED, operator[] throws std::out_of_range for an index past the end, as at() does, and the rotation
+	// matrix of a quaternion that is not of unit length throws std::invalid_argument
+	void check_checked_access() {
+		Vec3f v(1, 2, 3);
+		Mat33d m = identity<double, 3>();
+		Quatf q(1, 0, 0, 0);
+		DynVector<float> dv = { 1, 2, 3 };
+		DynMatrix<double> dm(2, 3, 0);
+		expect((v[2] == 3) && (m[2][2] == 1) && (q[3] == 0) && (dv[2] == 3) && (dm[1][2] == 0), "in-range indices with SML_CHECKED");
+		expect(throws<std::out_of_range>([&] { return v[3]; }), "Vector index out of range");
+		expect(throws<std::out_of_range>([&] { return std::as_const(v)[3]; }), "const Vector index out of range");
+		expect(throws<std::out_of_range>([&] { return m[3]; }), "Matrix row out of range");
+		expect(throws<std::out_of_range>([&] { return std::as_const(m)[3]; }), "const Matrix row out of range");
+		expect(throws<std::out_of_range>([&] { return q[4]; }), "Quaternion index out of range");
+		expect(throws<std::out_of_range>([&] { return std::as_const(q)[4]; }), "const Quaternion index out of range");
+		expect(throws<std::out_of_range>([&] { return dv[3]; }), "DynVector index out of range");
+		expect(throws<std::out_of_range>([&] { return dm[2]; }), "DynMatrix row out of range");
+#if defined(SML_QUATERNION_LANES)
+		expect(throws<std::out_of_range>([&] { return q.vector()[3]; }), "Quaternion vector part index out of range");
+#endif
+		expect(throws<std::invalid_argument>([&] { return QuaternionTo33RotationMatrix(Quatf(2, 0, 0, 0)); }), "rotation matrix of a quaternion that is not of unit length");
+	}
+#endif
+
+}
+
+int main() {
+	check_transposes<float>("float");
+	check_transposes<double>("double");
+
+	check_products<float>();
+	check_products<double>();
+	// Mixed element types, with the right-hand matrix converted to the type of the left
+	check_product<float, double, 65, 65, 65>();
+	check_product<double, float, 9, 13, 17>();
+	check_product<double, int, 9, 13, 7>();
+	check_product<int, int, 12, 12, 12>();
+	check_product<int, short, 33, 10, 20>();
+
+	// operator*= by a square matrix, through the tiled kernel
+	const auto a = small_values<float, 12, 16>(3);
+	const auto b = small_values<float, 16, 16>(4);
+	Matrix<float, 12, 16> c = *a;
+	c *= *b;
+	expect(c == *a * *b, "operator*= by a square matrix");
+
+	check_det4();
+
+	check_dyn_matrix<float>("float");
+	check_dyn_matrix<double>("double");
+
+	// Odd and of magnitude above 2^24, so not a float: as for Matrix, an integer DynMatrix det is computed in double
+	const DynMatrix<int> di(5, 5, { 4097, 3, -5, 7, 2, 2, 4097, 2, 1, -1, -6, 1, 1, 9, 3, 5, 0, -3, 1, 4, 1, -2, 0, 3, 1 });
+	static_assert(std::is_same_v<decltype(det(di)), double>);
+	expect((std::round(det(di)) == -182166301) && near(det(di), -182166301, 1e-12), "integer DynMatrix det");
+
+#if defined(SML_CHECKED)
+	check_checked_access();
+#endif
+
+	// Views write through to the buffer, and copies come out as fixed-size Vectors and Matrices
+	DynVector<float> dv = { 1, 2, 3 };
+	const std::span<float, 3> sv = dv.view<3>();
+	sv[1] = 5;
+	expect((dv[1] == 5) && (dv.to_vector<3>() == Vec3f(1, 5, 3)), "DynVector view and to_vector");
+	DynMatrix<double> dm(2, 3, { 1, 2, 3, 4, 5, 6 });
+	dm.view<2, 3>()[4] = 7;
+	const std::span<const double, 6> sm = std::as_const(dm).view<2, 3>();
+	expect((dm.at(1, 1) == 7) && (sm[5] == 6) && (dm.to_matrix<2, 3>() == Matrix<double, 2, 3>(1, 2, 3, 4, 7, 6)), "DynMatrix view and to_matrix");
+	expect(throws<std::invalid_argument>([&] { dv.view<4>(); }) && throws<std::invalid_argument>([&] { dm.to_matrix<3, 2>(); }), "views of the wrong size");
+	return result();
+}
@@ -0,0 +1,172 @@
+// The thread pool and the bulk Matrix operations that take an execution policy: results on a pool of four threads
+// and on the default pool against the sequential ones, with reductions that must not depend on the size of the pool.
+// Also run under ThreadSanitizer in CI
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+namespace {
+
+	// Large enough to be split into several chunks: each thread takes at least 64 KiB
+	constexpr size_t rows = 301;
+	constexpr size_t cols = 257;
+
+	template<arithmetic T, size_t r, size_t c>
+	std::unique_ptr<Matrix<T, r, c>> test_matrix(size_t seed) {
+		auto m = std::make_unique<Matrix<T, r, c>>();
+		for (size_t i = 0; i < r * c; i++) {
+			m->data[i] = static_cast<T>(((i * 7919) + (seed * 104729)) % 2003) - T(1000);
+		}
+		return m;
+	}
+
+	void check_pool() {
+		thread_pool pool(4);
+		expect(pool.size() == 4, "thread_pool size");
+
+		// Every index once, whichever thread takes it
+		std::vector<std::atomic<int>> calls(1000);
+		pool.run(calls.size(), [&](size_t i) { calls[i]++; });
+		bool once = true;
+		for (const auto& c : calls) {
+			once = once && (c == 1);
+		}
+		expect(once, "thread_pool::run calls every index once");
+
+		// Nested calls run on the calling thread, and exceptions reach the caller once all calls have finished
+		std::atomic<size_t> nested = 0;
+		pool.run(8, [&](size_t) { pool.run(8, [&](size_t) { nested++; }); });
+		expect(nested == 64, "nested thread_pool::run");
+		std::atomic<size_t> finished = 0;
+		expect(throws<std::runtime_error>([&] {
+			pool.run(100, [&](size_t i) {
+				finished++;
+				if (i == 37) {
+					throw std::runtime_error("task");
+				}
+			});
+		}) && (finished == 100), "thread_pool::run rethrows an exception from a task");
+
+		// Callers on several threads at once take turns
+		std::atomic<size_t> total = 0;
+		std::vector<std::thread> callers;
+		for (size_t t = 0; t < 3; t++) {
+			callers.emplace_back([&] {
+				for (size_t k = 0; k < 20; k++) {
+					pool.run(16, [&](size_t) { total++; });
+				}
+			});
+		}
+		for (auto& c : callers) {
+			c.join();
+		}
+		expect(total == 3 * 20 * 16, "thread_pool::run from several threads");
+	}
+
+	// op(policy, m) for the sequential, default parallel and four-thread policies gives the same matrix
+	template<class Op>
+	void check_update(thread_pool& pool, const std::string& name, Op op) {
+		auto seq = test_matrix<int, rows, cols>(1);
+		auto par = std::make_unique<Matrix<int, rows, cols>>(*seq);
+		auto on_pool = std::make_unique<Matrix<int, rows, cols>>(*seq);
+		op(execution::seq, *seq);
+		op(execution::par, *par);
+		op(execution::par_unseq.on(pool), *on_pool);
+		expect((*par == *seq) && (*on_pool == *seq), "parallel " + name);
+	}
+
+	void check_element_wise() {
+		thread_pool pool(4);
+		const auto other = test_matrix<int, rows, cols>(2);
+		const auto divisor = std::make_unique<Matrix<int, rows, cols>>(*other);
+		for (auto& d : divisor->data) {
+			d = (d == 0) ? 1 : d;
+		}
+		Vector<int, cols> row;
+		Vector<int, rows> col;
+		for (size_t j = 0; j < cols; j++) {
+			row[j] = static_cast<int>(j % 13) + 1;
+		}
+		for (size_t i = 0; i < rows; i++) {
+			col[i] = static_cast<int>(i % 11) + 1;
+		}
+
+		check_update(pool, "add_assign", [&](auto p, auto& m) { add_assign(p, m, *other); });
+		check_update(pool, "sub_assign", [&](auto p, auto& m) { sub_assign(p, m, *other); });
+		check_update(pool, "mod_assign", [&](auto p, auto& m) { mod_assign(p, m, *divisor); });
+		check_update(pool, "scalar add_assign", [&](auto p, auto& m) { add_assign(p, m, 3); });
+		check_update(pool, "scalar sub_assign", [&](auto p, auto& m) { sub_assign(p, m, 3); });
+		check_update(pool, "scalar mul_assign", [&](auto p, auto& m) { mul_assign(p, m, -2); });
+		check_update(pool, "scalar div_assign", [&](auto p, auto& m) { div_assign(p, m, 7); });
+		check_update(pool, "scalar mod_assign", [&](auto p, auto& m) { mod_assign(p, m, 9); });
+		check_update(pool, "add_row", [&](auto p, auto& m) { add_row(p, m, row); });
+		check_update(pool, "sub_row", [&](auto p, auto& m) { sub_row(p, m, row); });
+		check_update(pool, "mul_row", [&](auto p, auto& m) { mul_row(p, m, row); });
+		check_update(pool, "div_row", [&](auto p, auto& m) { div_row(p, m, row); });
+		check_update(pool, "add_col", [&](auto p, auto& m) { add_col(p, m, col); });
+		check_update(pool, "sub_col", [&](auto p, auto& m) { sub_col(p, m, col); });
+		check_update(pool, "mul_col", [&](auto p, auto& m) { mul_col(p, m, col); });
+		check_update(pool, "div_col", [&](auto p, auto& m) { div_col(p, m, col); });
+		check_update(pool, "multiply_elements", [&](auto p, auto& m) { m = multiply_elements(p, m, *other); });
+		check_update(pool, "clamp", [&](auto p, auto& m) { m = clamp(p, m, -300, 500); });
+		check_update(pool, "abs", [&](auto p, auto& m) { m = abs(p, m); });
+
+		// The sequential forms agree with the member operators
+		auto member = test_matrix<int, rows, cols>(1);
+		auto policy = std::make_unique<Matrix<int, rows, cols>>(*member);
+		*member += *other;
+		member->mul_row(row);
+		add_assign(execution::seq, *policy, *other);
+		mul_row(execution::seq, *policy, row);
+		expect(*member == *policy, "sequential policy forms against the member operators");
+	}
+
+	void check_reductions() {
+		thread_pool four(4), one(1);
+
+		// The largest and smallest values appear several times, in different chunks, and the first must be found
+		auto m = test_matrix<float, rows, cols>(3);
+		const size_t n = rows * cols;
+		for (size_t i : { n / 5, n / 2, n - 3 }) {
+			m->data[i] = 5000;
+		}
+		for (size_t i : { n / 3, (2 * n) / 3 }) {
+			m->data[i] = -5000;
+		}
+		const size_t max_i = max_element(*m), min_i = min_element(*m);
+		expect((max_i == n / 5) && (min_i == n / 3), "sequential max_element and min_element find the first");
+		expect((max_element(execution::par, *m) == max_i) && (max_element(execution::par.on(four), *m) == max_i)
+			&& (max_element(execution::par.on(one), *m) == max_i), "parallel max_element");
+		expect((min_element(execution::par, *m) == min_i) && (min_element(execution::par_unseq.on(four), *m) == min_i), "parallel min_element");
+		expect((max(execution::par.on(four), *m) == 5000) && (min(execution::par.on(four), *m) == -5000), "parallel max and min");
+
+		// A trace long enough to be split: the ranges are fixed by the size of the matrix and combined in order, so
+		// the sum is the same to the last bit on any pool, although it may round differently from the sequential sum
+		constexpr size_t dim = 2500;
+		auto square = std::make_unique<Matrix<float, dim, dim>>(0.0f);
+		for (size_t i = 0; i < dim; i++) {
+			(*square)[i][i] = 1.0f / static_cast<float>(i + 1);
+		}
+		const float seq = trace(execution::seq, *square);
+		const float par = trace(execution::par, *square);
+		expect((trace(execution::par.on(four), *square) == par) && (trace(execution::par.on(one), *square) == par), "parallel trace is the same on any pool");
+		expect(near(par, seq, 1e-6) && (trace(*square) == seq), "parallel trace against the sequential sum");
+	}
+
+}
+
+int main() {
+	check_pool();
+	check_element_wise();
+	check_reductions();
+	return result();
+}
@@ -0,0 +1,236 @@
+// Binary files: the 64-byte header, round trips through streams, files and mapped files, and the rejection of files
+// that are from a newer version, of another type, cut short, or that claim more objects than they hold
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <system_error>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+namespace {
+
+	template<class F>
+	bool fails_with(F f, const std::string& message) {
+		try {
+			f();
+		}
+		catch (const std::runtime_error& e) {
+			return std::string(e.what()).find(message) != std::string::npos;
+		}
+		return false;
+	}
+
+	template<class Object>
+	std::string binary(const std::vector<Object>& objects) {
+		std::ostringstream os(std::ios::binary);
+		write_binary(os, std::span<const Object>(objects));
+		return os.str();
+	}
+
+	template<class Object>
+	std::vector<Object> from_binary(const std::string& bytes) {
+		std::istringstream is(bytes, std::ios::binary);
+		return read_binary<Object>(is);
+	}
+
+	// Read from a stream that cannot seek, as from a pipe
+	template<class Object>
+	std::vector<Object> from_pipe(std::string bytes) {
+		struct pipe_buffer : std::streambuf {
+			explicit pipe_buffer(std::string& s) { setg(s.data(), s.data(), s.data() + s.size()); }
+		} buffer(bytes);
+		std::istream is(&buffer);
+		return read_binary<Object>(is);
+	}
+
+	void store_u16(std::string& s, size_t at, uint16_t x) {
+		s[at] = static_cast<char>(x & 0xff);
+		s[at + 1] = static_cast<char>(x >> 8);
+	}
+
+	void store_u64(std::string& s, size_t at, uint64_t x) {
+		for (size_t i = 0; i < 8; i++) {
+			s[at + i] = static_cast<char>((x >> (8 * i)) & 0xff);
+		}
+	}
+
+	template<class Object>
+	std::vector<Object> test_objects(size_t n) {
+		std::vector<Object> ret(n);
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < detail::serial_scalars<Object>; j++) {
+				detail::serial_traits<Object>::set(ret[i], j, static_cast<typename detail::serial_traits<Object>::value_type>((i * 31 + j * 7) % 101) / 4);
+			}
+		}
+		return ret;
+	}
+
+	template<class Object>
+	bool round_trips(size_t n) {
+		const std::vector<Object> objects = test_objects<Object>(n);
+		return from_binary<Object>(binary(objects)) == objects;
+	}
+
+	void check_header() {
+		const std::string bytes = binary(test_objects<Mat23f>(5));
+		const auto u8 = [&](size_t at) { return static_cast<unsigned>(static_cast<unsigned char>(bytes[at])); };
+		const auto u32 = [&](size_t at) { return u8(at) | (u8(at + 1) << 8) | (u8(at + 2) << 16) | (u8(at + 3) << 24); };
+		expect(bytes.size() == 64 + (5 * 6 * sizeof(float)), "file size");
+		expect(bytes.compare(0, 4, "SMLB") == 0, "magic");
+		expect((u8(4) | (u8(5) << 8)) == binary_format_version, "version");
+		expect(u8(6) == 2 && u8(7) == 3 && u8(8) == 4, "object kind, scalar kind and scalar size");
+		expect(u32(12) == 2 && u32(16) == 3 && u32(20) == 64, "rows, columns and data offset");
+		expect(u32(24) == 5 && u32(28) == 0, "object count");
+
+		// Elements are little-endian, row by row
+		float first;
+		std::memcpy(&first, bytes.data() + 64 + sizeof(float), sizeof(float));
+		expect(first == test_objects<Mat23f>(1)[0][0][1], "first row stored first");
+	}
+
+	void check_round_trips() {
+		expect(round_trips<Vec3f>(1000), "Vec3f");
+		expect(round_trips<Vec4d>(17), "Vec4d");
+		expect(round_trips<Mat44f>(300), "Mat44f");
+		expect(round_trips<Mat33d>(3), "Mat33d");
+		expect(round_trips<Quatf>(5000), "Quatf");
+		expect(round_trips<Vector<int16_t, 3>>(10), "short integers");
+		expect(round_trips<Vec2d>(0), "no objects");
+
+		// A BinaryWriter that could not seek leaves the count unknown, and readers read up to the end
+		std::string unknown = binary(test_objects<Vec3f>(9));
+		for (size_t i = 24; i < 32; i++) {
+			unknown[i] = static_cast<char>(0xff);
+		}
+		expect(from_binary<Vec3f>(unknown) == test_objects<Vec3f>(9), "unknown count");
+		// Several chunks, from a stream that cannot seek
+		expect(from_pipe<Vec3f>(binary(test_objects<Vec3f>(3000))) == test_objects<Vec3f>(3000), "stream that cannot seek");
+
+		std::istringstream is(binary(test_objects<Quatd>(10)), std::ios::binary);
+		BinaryReader<Quatd> reader(is);
+		std::vector<Quatd> part(4);
+		const size_t first = reader.read(part);
+		expect(reader.size() == 10 && first == 4 && part[3] == test_objects<Quatd>(10)[3], "BinaryReader a span at a time");
+		expect(reader.read(part) == 4 && reader.read(part) == 2 && reader.read(part) == 0, "BinaryReader to the end");
+	}
+
+	void check_rejection() {
+		const std::string bytes = binary(test_objects<Vec3f>(4));
+
+		std::string newer = bytes;
+		store_u16(newer, 4, binary_format_version + 1);
+		expect(fails_with([&] { from_binary<Vec3f>(newer); }, "newer version of the format"), "newer version");
+
+		std::string older = bytes;
+		store_u16(older, 4, 0);
+		expect(from_binary<Vec3f>(older) == test_objects<Vec3f>(4), "older versions are read");
+
+		std::string magic = bytes;
+		magic[0] = 'X';
+		expect(fails_with([&] { from_binary<Vec3f>(magic); }, "not an SML binary file"), "magic");
+		expect(fails_with([&] { from_binary<Vec3d>(bytes); }, "different type of object"), "scalar type");
+		expect(fails_with([&] { from_binary<Vec4f>(bytes); }, "different type of object"), "dimensions");
+		expect(fails_with([&] { from_binary<Quatf>(binary(test_objects<Vec4f>(1))); }, "different type of object"), "object kind");
+
+		std::string offset = bytes;
+		offset[20] = 32;
+		expect(fails_with([&] { from_binary<Vec3f>(offset); }, "corrupt binary file header"), "data offset inside the header");
+
+		expect(fails_with([&] { from_binary<Vec3f>(bytes.substr(0, 40)); }, "too short for its header"), "truncated header");
+		expect(fails_with([&] { from_binary<Vec3f>(bytes.substr(0, bytes.size() - 1)); }, "ended early"), "truncated data");
+		expect(fails_with([&] { from_binary<Mat33d>(binary(test_objects<Mat33d>(2)).substr(0, 64 + 100)); }, "ended early"), "truncated data, packed");
+
+		// A count far beyond the data fails before memory is allocated for it, whether or not the stream can seek
+		std::string huge = bytes;
+		store_u64(huge, 24, uint64_t(1) << 60);
+		expect(fails_with([&] { from_binary<Vec3f>(huge); }, "ended early"), "count larger than the stream");
+		expect(fails_with([&] { from_pipe<Vec3f>(huge); }, "ended early"), "count larger than a stream that cannot seek");
+		expect(fails_with([&] { from_pipe<Vec3f>(bytes.substr(0, bytes.size() - 1)); }, "ended early"), "truncated data from a stream that cannot seek");
+	}
+
+	// A file of this process's own, as the scalar and SIMD builds of this test may run at the same time, removed
+	// however the checks that use it end
+	struct TempFile {
+		std::filesystem::path path;
+
+		TempFile() {
+#if defined(_WIN32)
+			const long pid = _getpid();
+#else
+			const long pid = getpid();
+#endif
+#if defined(SML_SIMD)
+			const char* variant = "simd";
+#else
+			const char* variant = "scalar";
+#endif
+			path = std::filesystem::temp_directory_path() / ("sml_test_serialize_" + std::string(variant) + "_" + std::to_string(pid) + ".sml");
+		}
+		TempFile(const TempFile&) = delete;
+		TempFile& operator=(const TempFile&) = delete;
+		~TempFile() {
+			std::error_code ignored;
+			std::filesystem::remove(path, ignored);
+		}
+	};
+
+	void check_files() {
+		const TempFile file;
+		const std::filesystem::path& path = file.path;
+		const std::vector<Mat44f> poses = test_objects<Mat44f>(2000);
+		write_binary(path, std::span<const Mat44f>(poses));
+		expect(read_binary<Mat44f>(path) == poses, "file round trip");
+
+		{
+			MappedArray<Mat44f> mapped(path);
+			expect(mapped.size() == poses.size() && std::equal(mapped.begin(), mapped.end(), poses.begin()), "mapped file");
+			MappedArray<Mat44f> moved(std::move(mapped));
+			expect(!mapped.is_open() && moved.is_open() && moved[1999] == poses[1999], "moved mapping");
+		}
+		expect(fails_with([&] { MappedArray<Vec4f> wrong(path); }, "different type of object"), "mapped file of another type");
+
+		// Cut short, or no longer than a header
+		std::filesystem::resize_file(path, 64 + (sizeof(Mat44f) * 10) + 1);
+		expect(fails_with([&] { MappedArray<Mat44f> cut(path); }, "shorter than its header says"), "mapped file cut short");
+		std::filesystem::resize_file(path, 20);
+		expect(fails_with([&] { MappedArray<Mat44f> cut(path); }, "too short for its header"), "mapped file without a header");
+
+		// A file with an unknown count maps every whole object it holds
+		std::string unknown = binary(test_objects<Vec4f>(6));
+		for (size_t i = 24; i < 32; i++) {
+			unknown[i] = static_cast<char>(0xff);
+		}
+		std::ofstream(path, std::ios::binary | std::ios::trunc).write(unknown.data(), static_cast<std::streamsize>(unknown.size() - 3));
+		{
+			MappedArray<Vec4f> mapped(path);
+			expect(mapped.size() == 5 && mapped[4] == test_objects<Vec4f>(6)[4], "mapped file with an unknown count");
+		}
+
+		std::filesystem::remove(path);
+		expect(fails_with([&] { MappedArray<Mat44f> missing(path); }, "cannot open"), "missing file");
+	}
+
+}
+
+int main() {
+	check_header();
+	check_round_trips();
+	check_rejection();
+	check_files();
+	return result();
+}
@@ -0,0 +1,177 @@
+// Iterative solvers against a dense solve of the same systems: conjugate gradients on a symmetric positive-definite
+// system, BiCGSTAB and GMRES on a non-symmetric one, each with and without the Jacobi and IC(0) preconditioners
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+namespace {
+
+	// The five-point Laplacian on a side x side grid, symmetric positive definite, with convection added by upwind
+	// differences if convection is nonzero, which makes it non-symmetric
+	CSRMatrix<double> grid_matrix(size_t side, double convection) {
+		SparseBuilder<double> builder(side * side, side * side);
+		for (size_t y = 0; y < side; y++) {
+			for (size_t x = 0; x < side; x++) {
+				const size_t i = (y * side) + x;
+				builder.add(i, i, 4 + convection);
+				if (x > 0) {
+					builder.add(i, i - 1, -1 - convection);
+				}
+				if (x + 1 < side) {
+					builder.add(i, i + 1, -1);
+				}
+				if (y > 0) {
+					builder.add(i, i - side, -1);
+				}
+				if (y + 1 < side) {
+					builder.add(i, i + side, -1);
+				}
+			}
+		}
+		return CSRMatrix<double>(builder);
+	}
+
+	std::vector<double> dense_solve(const CSRMatrix<double>& a, const std::vector<double>& b) {
+		const DynMatrix<double> inv = inverse(a.to_dense());
+		std::vector<double> x(b.size(), 0);
+		for (size_t i = 0; i < b.size(); i++) {
+			for (size_t j = 0; j < b.size(); j++) {
+				x[i] += inv.data[(i * b.size()) + j] * b[j];
+			}
+		}
+		return x;
+	}
+
+	// |b - a x| / |b|, computed afresh
+	double residual(const CSRMatrix<double>& a, const std::vector<double>& b, const std::vector<double>& x) {
+		std::vector<double> ax(b.size());
+		multiply(a, std::span<const double>(x), ax);
+		double r = 0, bb = 0;
+		for (size_t i = 0; i < b.size(); i++) {
+			r += (b[i] - ax[i]) * (b[i] - ax[i]);
+			bb += b[i] * b[i];
+		}
+		return std::sqrt(r / bb);
+	}
+
+	// x agrees with the dense solution to about the tolerance, scaled by the size of the solution
+	bool agrees(const std::vector<double>& x, const std::vector<double>& expected, double tolerance) {
+		double error = 0, size = 0;
+		for (size_t i = 0; i < x.size(); i++) {
+			error = std::max(error, magnitude(x[i] - expected[i]));
+			size = std::max(size, magnitude(expected[i]));
+		}
+		return error <= tolerance * size;
+	}
+
+	std::vector<double> right_hand_side(size_t n) {
+		std::vector<double> b(n);
+		for (size_t i = 0; i < n; i++) {
+			b[i] = std::sin(0.1 * static_cast<double>(i)) + 0.5;
+		}
+		return b;
+	}
+
+	template<class Solve>
+	void check_solve(const CSRMatrix<double>& a, const std::vector<double>& b, const std::vector<double>& expected, Solve solve, const std::string& name) {
+		std::vector<double> x(b.size(), 0);
+		const SolverStats<double> stats = solve(std::span<double>(x));
+		const double r = residual(a, b, x);
+		expect(stats.converged && stats.residual <= 1e-10, name + ": converged");
+		expect(r <= 1e-9, name + ": residual " + std::to_string(r));
+		expect(agrees(x, expected, 1e-7), name + ": agrees with a dense solve");
+		expect(stats.iterations > 0 && stats.products >= stats.iterations, name + ": counts");
+	}
+
+	void check_symmetric() {
+		const CSRMatrix<double> a = grid_matrix(20, 0);
+		const std::vector<double> b = right_hand_side(a.rows());
+		const std::vector<double> expected = dense_solve(a, b);
+		const std::span<const double> bs(b);
+		SolverOptions<double> options;
+		options.tolerance = 1e-11;
+		SolverWorkspace<double> work;
+		const JacobiPreconditioner<double> jacobi(a);
+		const IncompleteCholesky<double> ic(a);
+
+		check_solve(a, b, expected, [&](std::span<double> x) { return conjugate_gradient(a, bs, x, options); }, "CG");
+		check_solve(a, b, expected, [&](std::span<double> x) { return conjugate_gradient(a, bs, x, jacobi, work, options); }, "CG with Jacobi");
+		check_solve(a, b, expected, [&](std::span<double> x) { return conjugate_gradient(a, bs, x, ic, work, options); }, "CG with IC(0)");
+		check_solve(a, b, expected, [&](std::span<double> x) { return gmres(a, bs, x, ic, work, options); }, "GMRES with IC(0)");
+		check_solve(a, b, expected, [&](std::span<double> x) { return conjugate_gradient(CSCMatrix<double>(a), bs, x, options); }, "CG with CSC");
+		check_solve(a, b, expected, [&](std::span<double> x) { return conjugate_gradient(a.to_dense(), bs, x, options); }, "CG with a DynMatrix");
+		const auto op = [&](std::span<const double> in, std::span<double> out) { multiply(a, in, out); };
+		check_solve(a, b, expected, [&](std::span<double> x) { return conjugate_gradient<double>(op, bs, x, options); }, "CG with an operator");
+
+		// IC(0) reduces the iterations, and is the exact Cholesky factor of a tridiagonal matrix, whose factor has no fill
+		std::vector<double> x(a.rows(), 0);
+		const size_t plain = conjugate_gradient(a, bs, std::span<double>(x), options).iterations;
+		std::fill(x.begin(), x.end(), 0.0);
+		const size_t preconditioned = conjugate_gradient(a, bs, std::span<double>(x), ic, work, options).iterations;
+		expect(preconditioned < plain && ic.breakdowns() == 0, "IC(0) takes fewer iterations");
+
+		SparseBuilder<double> builder(50, 50);
+		for (size_t i = 0; i < 50; i++) {
+			builder.add(i, i, 2.5);
+			if (i > 0) {
+				builder.add(i, i - 1, -1);
+				builder.add(i - 1, i, -1);
+			}
+		}
+		const CSRMatrix<double> tridiagonal(builder);
+		const std::vector<double> bt = right_hand_side(50);
+		std::vector<double> xt(50, 0);
+		const SolverStats<double> exact = conjugate_gradient(tridiagonal, std::span<const double>(bt), std::span<double>(xt), IncompleteCholesky<double>(tridiagonal), work, options);
+		expect(exact.converged && exact.iterations == 1 && agrees(xt, dense_solve(tridiagonal, bt), 1e-12), "IC(0) of a tridiagonal matrix is exact");
+
+		// The same steps under par, whatever the number of threads
+		std::vector<double> xs(a.rows(), 0), xp(a.rows(), 0);
+		const SolverStats<double> s = conjugate_gradient(a, bs, std::span<double>(xs), jacobi, work, options);
+		const SolverStats<double> p = conjugate_gradient(execution::par, a, bs, std::span<double>(xp), jacobi, work, options);
+		expect(s.iterations == p.iterations && xs == xp, "CG under par");
+
+		// Giving up, and an initial guess that is already the solution
+		SolverOptions<double> few = options;
+		few.max_iterations = 3;
+		std::fill(x.begin(), x.end(), 0.0);
+		const SolverStats<double> stopped = conjugate_gradient(a, bs, std::span<double>(x), few);
+		expect(!stopped.converged && stopped.iterations == 3 && stopped.residual > options.tolerance, "CG stops at max_iterations");
+		x = expected;
+		expect(conjugate_gradient(a, bs, std::span<double>(x), options).iterations <= 1, "CG from the solution");
+
+		std::vector<double> wrong(a.rows() - 1);
+		expect(throws<std::invalid_argument>([&] { conjugate_gradient(a, bs, std::span<double>(wrong)); }), "CG dimensions");
+	}
+
+	void check_nonsymmetric() {
+		const CSRMatrix<double> a = grid_matrix(20, 2);
+		const std::vector<double> b = right_hand_side(a.rows());
+		const std::vector<double> expected = dense_solve(a, b);
+		const std::span<const double> bs(b);
+		SolverOptions<double> options;
+		options.tolerance = 1e-11;
+		SolverWorkspace<double> work;
+		const JacobiPreconditioner<double> jacobi(a);
+
+		expect(a.at(1, 0) != a.at(0, 1), "the convection-diffusion matrix is not symmetric");
+		check_solve(a, b, expected, [&](std::span<double> x) { return bicgstab(a, bs, x, options); }, "BiCGSTAB");
+		check_solve(a, b, expected, [&](std::span<double> x) { return bicgstab(execution::par, a, bs, x, jacobi, work, options); }, "BiCGSTAB with Jacobi");
+		check_solve(a, b, expected, [&](std::span<double> x) { return gmres(a, bs, x, options); }, "GMRES");
+		check_solve(a, b, expected, [&](std::span<double> x) { return gmres(a, bs, x, jacobi, work, options); }, "GMRES with Jacobi");
+		options.restart = 5;
+		check_solve(a, b, expected, [&](std::span<double> x) { return gmres(execution::par, a, bs, x, jacobi, work, options); }, "GMRES restarted every 5 iterations");
+	}
+
+}
+
+int main() {
+	check_symmetric();
+	check_nonsymmetric();
+	return result();
+}
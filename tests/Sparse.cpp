@@ -0,0 +1,157 @@
+// Sparse matrices: building CSR and CSC from entries in any order, conversions between the forms and to and from dense
+// matrices, and their products against the same products of dense matrices
+
+#include <stdexcept>
+#include <vector>
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+namespace {
+
+	// Small integers, so that every product is exact whatever order its terms are summed in
+	double entry_value(size_t k) {
+		return static_cast<double>(static_cast<int>((k * 37) % 11) - 5);
+	}
+
+	// rows x cols entries in scrambled order, with repeated positions, a few empty rows and one nearly full row
+	SparseBuilder<double> test_builder(size_t rows, size_t cols, DynMatrix<double>& dense) {
+		SparseBuilder<double> builder(rows, cols);
+		dense = DynMatrix<double>(rows, cols, 0);
+		const auto add = [&](size_t r, size_t c, double v) {
+			builder.add(r, c, v);
+			dense.data[(r * cols) + c] += v;
+		};
+		for (size_t k = 0; k < 8 * rows; k++) {
+			const size_t r = (k * 7919) % rows;
+			if (r % 10 == 4) {
+				continue;
+			}
+			add(r, (k * 104729 + r * 13) % cols, entry_value(k));
+		}
+		for (size_t c = 0; c < cols; c++) {
+			add(rows / 2, cols - 1 - c, entry_value(c + 1));
+		}
+		// Entries that cancel leave a stored zero, as summing does not drop them
+		add(1, 1, 2);
+		add(1, 1, -dense.data[cols + 1]);
+		return builder;
+	}
+
+	template<sparse_format format>
+	bool well_formed(const SparseMatrix<double, format>& a) {
+		if ((a.offsets.size() != a.outer_size() + 1) || (a.offsets[0] != 0) || (a.offsets.back() != a.nonzeroes()) || (a.indices.size() != a.nonzeroes())) {
+			return false;
+		}
+		for (size_t o = 0; o < a.outer_size(); o++) {
+			if (a.offsets[o] > a.offsets[o + 1]) {
+				return false;
+			}
+			for (size_t k = a.offsets[o]; k < a.offsets[o + 1]; k++) {
+				if ((a.indices[k] >= a.inner_size()) || ((k > a.offsets[o]) && !(a.indices[k - 1] < a.indices[k]))) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	DynMatrix<double> column(const std::vector<double>& v) {
+		DynMatrix<double> ret(v.size(), 1);
+		std::copy(v.begin(), v.end(), ret.data.begin());
+		return ret;
+	}
+
+	template<sparse_format format>
+	void check_products(const SparseMatrix<double, format>& a, const DynMatrix<double>& dense, const std::string& name) {
+		std::vector<double> x(a.cols()), xt(a.rows());
+		for (size_t i = 0; i < x.size(); i++) {
+			x[i] = entry_value(i + 3);
+		}
+		for (size_t i = 0; i < xt.size(); i++) {
+			xt[i] = entry_value(i + 5);
+		}
+		const DynMatrix<double> expected = dense * column(x);
+		const DynMatrix<double> expected_t = transpose(dense) * column(xt);
+
+		// One more element than needed, which must be left alone
+		std::vector<double> y(a.rows() + 1, 99), yt(a.cols() + 1, 99);
+		multiply(a, std::span<const double>(x), y);
+		expect(std::equal(expected.data.begin(), expected.data.end(), y.begin()) && (y.back() == 99), name + ": a * x");
+		std::fill(y.begin(), y.end() - 1, 0.0);
+		multiply(execution::par, a, std::span<const double>(x), y);
+		expect(std::equal(expected.data.begin(), expected.data.end(), y.begin()), name + ": parallel a * x");
+
+		multiply_transposed(a, std::span<const double>(xt), yt);
+		expect(std::equal(expected_t.data.begin(), expected_t.data.end(), yt.begin()) && (yt.back() == 99), name + ": transpose(a) * x");
+		std::fill(yt.begin(), yt.end() - 1, 0.0);
+		multiply_transposed(execution::par, a, std::span<const double>(xt), yt);
+		expect(std::equal(expected_t.data.begin(), expected_t.data.end(), yt.begin()), name + ": parallel transpose(a) * x");
+
+		DynVector<double> v(a.cols());
+		std::copy(x.begin(), x.end(), v.data.begin());
+		const DynVector<double> av = a * v;
+		expect(std::equal(expected.data.begin(), expected.data.end(), av.data.begin()), name + ": a * DynVector");
+
+		DynMatrix<double> b(a.cols(), 3), c(3, a.rows());
+		for (size_t i = 0; i < b.data.size(); i++) {
+			b.data[i] = entry_value(i + 7);
+		}
+		for (size_t i = 0; i < c.data.size(); i++) {
+			c.data[i] = entry_value(i + 2);
+		}
+		expect((a * b).data == (dense * b).data, name + ": a * DynMatrix");
+		expect(multiply(execution::par, a, b).data == (dense * b).data, name + ": parallel a * DynMatrix");
+		expect((c * a).data == (c * dense).data, name + ": DynMatrix * a");
+
+		expect(throws<std::invalid_argument>([&] { multiply(a, std::span<const double>(xt), y); }), name + ": x of the wrong size");
+		expect(throws<std::invalid_argument>([&] { multiply(a, std::span<const double>(x), std::span<double>(y).first(a.rows() - 1)); }), name + ": y too small");
+	}
+
+	void check_sparse(size_t rows, size_t cols) {
+		const std::string shape = std::to_string(rows) + "x" + std::to_string(cols);
+		DynMatrix<double> dense;
+		const SparseBuilder<double> builder = test_builder(rows, cols, dense);
+		const CSRMatrix<double> csr(builder);
+		const CSCMatrix<double> csc(builder);
+
+		expect(well_formed(csr) && well_formed(csc), shape + ": sorted lists without repeats");
+		expect(csr.to_dense().data == dense.data && csc.to_dense().data == dense.data, shape + ": built from entries");
+		expect(csr.nonzeroes() == csc.nonzeroes() && csr.nonzeroes() < builder.size(), shape + ": repeated entries are summed");
+		expect(csr.at(1, 1) == 0 && csr.nonzeroes() > CSRMatrix<double>(dense).nonzeroes(), shape + ": cancelled entries stay stored");
+		expect(csr.at(rows / 2, 0) == dense.data[(rows / 2) * cols] && csc.at(rows - 1, cols - 1) == dense.data.back(), shape + ": at");
+		expect(csr.at(4, 0) == 0 && csr.offsets[4] == csr.offsets[5], shape + ": empty rows");
+		expect(throws<std::out_of_range>([&] { csr.at(rows, 0); }), shape + ": at out of range");
+
+		const CSCMatrix<double> converted(csr);
+		const CSRMatrix<double> back(csc);
+		expect(converted.offsets == csc.offsets && converted.indices == csc.indices && converted.values == csc.values, shape + ": CSR to CSC");
+		expect(back.offsets == csr.offsets && back.indices == csr.indices && back.values == csr.values, shape + ": CSC to CSR");
+		expect(transpose(csr).to_dense().data == transpose(dense).data && transpose(csc).to_dense().data == transpose(dense).data, shape + ": transpose");
+		expect(CSCMatrix<double>(dense).to_dense().data == dense.data && well_formed(CSCMatrix<double>(dense)), shape + ": from a dense matrix");
+
+		check_products(csr, dense, shape + " CSR");
+		check_products(csc, dense, shape + " CSC");
+	}
+
+}
+
+int main() {
+	check_sparse(7, 5);
+	// Enough nonzeroes for par to split the products between threads
+	check_sparse(3000, 2500);
+
+	const Mat33d m(1, 0, 2, 0, 0, 0, 3, 0, 4);
+	const CSRMatrix<double> fixed(m);
+	expect(fixed.nonzeroes() == 4 && fixed.at(2, 0) == 3 && fixed.offsets[2] == fixed.offsets[1], "from a Matrix");
+	const CSRMatrix<double> empty(4, 6);
+	std::vector<double> y(4, 1);
+	multiply(empty, std::span<const double>(std::vector<double>(6, 1)), y);
+	expect(empty.nonzeroes() == 0 && y == std::vector<double>(4, 0), "an empty matrix");
+
+	SparseBuilder<double> builder(3, 3);
+	expect(throws<std::out_of_range>([&] { builder.add(0, 3, 1); }), "SparseBuilder index out of range");
+	return result();
+}
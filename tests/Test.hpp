@@ -0,0 +1,87 @@
+#ifndef SML_TEST_HPP
+#define SML_TEST_HPP
+
+// Checks shared by the tests. A test is a program that runs its checks, prints each one that fails, and returns
+// nonzero from main() if any did
+
+#include <cstdio>
+#include <string>
+
+#include "SML.hpp"
+
+namespace sml::test {
+
+	constexpr double magnitude(double d) { return (d < 0) ? -d : d; }
+
+	// a and b agree to within tolerance, relative to the size of b once that is above 1
+	constexpr bool near(double a, double b, double tolerance) {
+		return magnitude(a - b) <= tolerance * ((magnitude(b) > 1) ? magnitude(b) : 1);
+	}
+	template<arithmetic T, size_t n>
+	constexpr bool near(const Vector<T, n>& a, const Vector<T, n>& b, double tolerance) {
+		for (size_t i = 0; i < n; i++) {
+			if (!near(a[i], b[i], tolerance)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	template<arithmetic T, size_t rows, size_t cols>
+	constexpr bool near(const Matrix<T, rows, cols>& a, const Matrix<T, rows, cols>& b, double tolerance) {
+		for (size_t i = 0; i < rows; i++) {
+			for (size_t j = 0; j < cols; j++) {
+				if (!near(a[i][j], b[i][j], tolerance)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+	template<arithmetic T>
+	constexpr bool near(const Quaternion<T>& a, const Quaternion<T>& b, double tolerance) {
+		for (size_t i = 0; i < 4; i++) {
+			if (!near(a[i], b[i], tolerance)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	inline int failures = 0;
+
+	inline void expect(bool ok, const std::string& what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what.c_str());
+			failures++;
+		}
+	}
+
+	// f() throws an E
+	template<class E, class F>
+	bool throws(F f) {
+		try {
+			f();
+		}
+		catch (const E&) {
+			return true;
+		}
+		catch (...) {
+			return false;
+		}
+		return false;
+	}
+
+	// Stops the compiler from folding run-time computations in to constants
+	template<class T>
+	T opaque(const T& t) {
+		volatile bool keep = true;
+		return keep ? t : T();
+	}
+
+	inline int result() {
+		return (failures == 0) ? 0 : 1;
+	}
+
+} // !namespace sml::test
+
+#endif // !SML_TEST_HPP
\ No newline at end of file
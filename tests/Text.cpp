@@ -0,0 +1,160 @@
+// Text output and input: the element format spec used by std::format, to_chars and from_chars, and read_text from
+// strings and from streams long enough to be read in several blocks
+
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+namespace {
+
+	// Format o with spec as std::format("{:spec}", o) does, or return "invalid" if the spec is rejected
+	template<class Object, class CharT = char>
+	std::basic_string<CharT> format(const Object& o, std::basic_string_view<CharT> spec) {
+		detail::element_format<typename detail::serial_traits<Object>::value_type, CharT> f;
+		const CharT* end = f.parse(spec.data(), spec.data() + spec.size());
+		if ((end == nullptr) || (end != spec.data() + spec.size())) {
+			const CharT invalid[] = { 'i', 'n', 'v', 'a', 'l', 'i', 'd' };
+			return std::basic_string<CharT>(invalid, invalid + 7);
+		}
+		std::basic_string<CharT> ret;
+		detail::format_elements(o, f, std::back_inserter(ret));
+		return ret;
+	}
+
+	template<class Object>
+	std::string format(const Object& o, const char* spec) {
+		return format<Object, char>(o, std::string_view(spec));
+	}
+
+	template<class Object>
+	std::string text(const Object& o) {
+		std::array<char, 512> buffer;
+		const auto result = sml::to_chars(buffer.data(), buffer.data() + buffer.size(), o);
+		return std::string(buffer.data(), result.ptr);
+	}
+
+	template<class Object>
+	bool fails_with(std::string_view text, const std::string& message) {
+		try {
+			read_text<Object>(text);
+		}
+		catch (const std::runtime_error& e) {
+			return std::string(e.what()).find(message) != std::string::npos;
+		}
+		return false;
+	}
+
+	template<class Object>
+	bool stream_fails_with(const std::string& text, const std::string& message) {
+		std::istringstream is(text);
+		try {
+			read_text<Object>(is);
+		}
+		catch (const std::runtime_error& e) {
+			return std::string(e.what()).find(message) != std::string::npos;
+		}
+		return false;
+	}
+
+	void check_format() {
+		const Vec3d v(1.5, -0.25, 100);
+		expect(format(v, "") == "1.5 -0.25 100", "shortest form without a spec");
+		expect(format(v, ".3f") == "1.500 -0.250 100.000", ".3f");
+		expect(format(v, "8.2f") == "    1.50    -0.25   100.00", "width and precision");
+		expect(format(v, "<6") == "1.5    -0.25  100   ", "left alignment");
+		expect(format(v, "*^7") == "**1.5** *-0.25* **100**", "fill and centring");
+		expect(format(v, "+") == "+1.5 -0.25 +100", "sign");
+		expect(format(v, " .1e") == " 1.5e+00 -2.5e-01  1.0e+02", "space sign and scientific");
+		expect(format(v, "E") == "1.500000E+00 -2.500000E-01 1.000000E+02", "upper case");
+		expect(format(v, ".2") == "1.5 -0.25 1e+02", "precision without a type");
+		expect(format(Vec2f(0.1f, 3), "") == "0.1 3", "float shortest form");
+
+		const Mat23i m(1, -2, 3, 10, 255, 0);
+		expect(format(m, "") == "1 -2 3\n10 255 0", "Matrix rows on lines of their own");
+		expect(format(m, "3") == "  1  -2   3\n 10 255   0", "integer width");
+		expect(format(m, "x") == "1 -2 3\na ff 0", "hexadecimal");
+		expect(format(m, "#X") == "invalid", "the # flag is not supported");
+		expect(format(m, ".2") == "invalid", "no precision for integers");
+		expect(format(m, "f") == "invalid", "no floating-point type for integers");
+		expect(format(v, "d") == "invalid", "no integer type for floating point");
+		expect(format(v, "08.3f") == "invalid", "the 0 flag is not supported");
+		expect(format(v, ".f") == "invalid", "a precision needs digits");
+
+		expect(format(Quatd(1, 0, -0.5, 2), ">5") == "    1     0  -0.5     2", "Quaternion");
+		expect(format(Vector<bool, 2>(true, false), "") == "1 0", "bool as an integer");
+		expect(format(Vec2d(1, 2), ".400f").size() == 2 * 402 + 1, "a precision longer than the fixed buffer");
+
+		const std::wstring wide = format<Vec2d, wchar_t>(Vec2d(0.5, -2), std::wstring_view(L"5.1f"));
+		expect(wide == L"  0.5  -2.0", "wide characters");
+
+#if defined(__cpp_lib_format)
+		expect(std::format("{:8.2f}", v) == format(v, "8.2f"), "std::format of a Vector");
+		expect(std::format("{}", m) == format(m, ""), "std::format of a Matrix");
+		expect(std::format(L"{:.1f}", Quatd(1, 0, -0.5, 2)) == L"1.0 0.0 -0.5 2.0", "std::format of a Quaternion");
+#elif defined(SML_REQUIRE_FORMAT)
+#error "SML_REQUIRE_FORMAT is defined but the standard library does not provide std::format"
+#endif
+	}
+
+	void check_chars() {
+		const Mat22d m(0.1, -1e-300, 3.0 / 7.0, 1e20);
+		Mat22d back;
+		const std::string s = text(m);
+		expect(sml::from_chars(s.data(), s.data() + s.size(), back).ec == std::errc() && back == m, "to_chars round trip");
+
+		std::array<char, 8> small;
+		expect(sml::to_chars(small.data(), small.data() + small.size(), m).ec == std::errc::value_too_large, "to_chars into too small a buffer");
+
+		Vec3f v(9, 9, 9);
+		const std::string_view separated = " +1, 2\n\t-3 ";
+		const auto read = sml::from_chars(separated.data(), separated.data() + separated.size(), v);
+		expect(read.ec == std::errc() && v == Vec3f(1, 2, -3) && *read.ptr == ' ', "from_chars with separators and a leading +");
+
+		const std::string_view bad = "1, 2, z";
+		const auto failed = sml::from_chars(bad.data(), bad.data() + bad.size(), v);
+		expect(failed.ec == std::errc::invalid_argument && *failed.ptr == 'z' && v == Vec3f(1, 2, -3), "failed from_chars leaves the object unchanged");
+	}
+
+	void check_read_text() {
+		expect(read_text<Vec2d>("1 2\n3,4\r\n5\n6") == std::vector<Vec2d>{ Vec2d(1, 2), Vec2d(3, 4), Vec2d(5, 6) }, "read_text from a string");
+		expect(read_text<Vec2d>(" \n ").empty(), "read_text of separators alone");
+		expect(fails_with<Vec2d>("1 2 1.5x 3", "cannot read a number from \"1.5x\""), "1.5x is not a number");
+		expect(fails_with<Vec2d>("1 2 3", "text ends part way through an object"), "truncated object");
+		expect(stream_fails_with<Vec2d>("1 2 1.5x 3", "cannot read a number from \"1.5x\""), "1.5x is not a number in a stream");
+		expect(stream_fails_with<Vec2d>("1 2 3", "text ends part way through an object"), "truncated object in a stream");
+
+		// More than one block of Vec3ds, shifted so that a number straddles the end of the first block
+		std::vector<Vec3d> points;
+		std::string s;
+		for (size_t i = 0; s.size() < detail::text_chunk_bytes + 4096; i++) {
+			points.push_back(Vec3d(static_cast<double>(i) / 7, -static_cast<double>(i), 1e-3 * static_cast<double>(i)));
+			s += text(points.back()) + '\n';
+		}
+		while (detail::is_text_separator(s[detail::text_chunk_bytes - 1]) || detail::is_text_separator(s[detail::text_chunk_bytes])) {
+			s.insert(s.begin(), ' ');
+		}
+		std::istringstream is(s);
+		expect(read_text<Vec3d>(is) == points, "a number carried over between blocks");
+		expect(read_text<Vec3d>(s) == points, "the same text from a string");
+
+		// A single number longer than a block makes the buffer grow
+		std::string zeros(detail::text_chunk_bytes + 10, '0');
+		std::istringstream long_number("1 " + zeros + "2.5 3\n");
+		expect(read_text<Vec3d>(long_number) == std::vector<Vec3d>{ Vec3d(1, 2.5, 3) }, "a number longer than a block");
+		expect(stream_fails_with<Vec3d>(s + "1 2", "text ends part way through an object"), "truncated object after several blocks");
+	}
+
+}
+
+int main() {
+	check_format();
+	check_chars();
+	check_read_text();
+	return result();
+}
@@ -0,0 +1,309 @@
+// Buffers of rotations and matrices against the single-object functions: the span conversions from rotation matrices
+// to quaternions, which use a SIMD form of Shepperd's method for float, the span RotateActive and RotatePassive, the
+// span transforms of points, directions and normals, span det, and batch_multiply
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "Test.hpp"
+
+using namespace sml;
+using namespace sml::test;
+
+namespace {
+
+	// Rotations covering every case of Shepperd's method: the trace largest, each diagonal element largest (trace
+	// below zero, half turns and near them), and ties between diagonal elements. Seven, so that consecutive groups of
+	// four mix the cases differently
+	template<std::floating_point T>
+	Quaternion<T> test_rotation(size_t i) {
+		const T r = T(0.01) * T(i % 97);
+		Quaternion<T> q;
+		switch (i % 7) {
+		case 0: q = Quaternion<T>(T(0.9), T(0.1) + r, T(0.3), T(-0.2)); break;
+		case 1: q = Quaternion<T>(T(0.1) - r, T(0.9), T(0.2), T(0.3)); break;
+		case 2: q = Quaternion<T>(T(-0.05), T(0.2), T(-0.9) - r, T(0.3)); break;
+		case 3: q = Quaternion<T>(T(0.1), T(-0.3) + r, T(0.2), T(0.9)); break;
+		case 4: q = Quaternion<T>(T(0), T(0), T(0), T(1)); break;
+		case 5: q = Quaternion<T>(T(0), T(1), T(1), T(0)); break;
+		default: q = Quaternion<T>(T(1), T(0), T(0), T(0)); break;
+		}
+		return q / std::sqrt(dot(q, q));
+	}
+
+	// a and b are the same rotation, of the same sign unless their scalar parts are both about zero
+	template<std::floating_point T>
+	bool same_quaternion(const Quaternion<T>& a, const Quaternion<T>& b, double tolerance) {
+		return near(a, b, tolerance) || ((magnitude(a.s()) <= tolerance) && near(a, -b, tolerance));
+	}
+
+	template<std::floating_point T, size_t n>
+	void check_to_quaternions(double tolerance) {
+		// Not a whole number of groups of four, so that the SIMD loop has a tail
+		const size_t count = 4 * 50 + 3;
+		std::vector<Matrix<T, n, n>> matrices(count);
+		for (size_t i = 0; i < count; i++) {
+			if constexpr (n == 4) {
+				matrices[i] = QuaternionTo44RotationMatrix(test_rotation<T>(i));
+			}
+			else {
+				matrices[i] = QuaternionTo33RotationMatrix(test_rotation<T>(i));
+			}
+		}
+		std::vector<Quaternion<T>> out(count);
+		RotationMatrixToQuaternion(std::span<const Matrix<T, n, n>>(matrices), out);
+		bool ok = true, round_trip = true, sign = true;
+		for (size_t i = 0; i < count; i++) {
+			ok = ok && same_quaternion(out[i], RotationMatrixToQuaternion(matrices[i]), tolerance);
+			round_trip = round_trip && same_quaternion(out[i], (test_rotation<T>(i).s() < T(0)) ? -test_rotation<T>(i) : test_rotation<T>(i), tolerance);
+			sign = sign && (out[i].s() >= T(0));
+		}
+		expect(ok, "span RotationMatrixToQuaternion against the single conversion, " + std::to_string(n) + "x" + std::to_string(n));
+		expect(round_trip, "span RotationMatrixToQuaternion recovers the quaternions, " + std::to_string(n) + "x" + std::to_string(n));
+		expect(sign, "span RotationMatrixToQuaternion has non-negative scalar parts");
+
+		std::vector<Quaternion<T>> parallel(count);
+		RotationMatrixToQuaternion(execution::par, std::span<const Matrix<T, n, n>>(matrices), parallel);
+		expect(parallel == out, "parallel span RotationMatrixToQuaternion");
+
+		std::vector<Matrix<T, n, n>> back(count);
+		if constexpr (n == 4) {
+			QuaternionTo44RotationMatrix(std::span<const Quaternion<T>>(out), back);
+		}
+		else {
+			QuaternionTo33RotationMatrix(std::span<const Quaternion<T>>(out), back);
+		}
+		bool matrices_ok = true;
+		for (size_t i = 0; i < count; i++) {
+			matrices_ok = matrices_ok && near(back[i], matrices[i], tolerance);
+		}
+		expect(matrices_ok, "span QuaternionToRotationMatrix");
+	}
+
+	template<std::floating_point T>
+	void check_rotate(double tolerance) {
+		// Enough for several threads under par
+		const size_t count = 20003;
+		std::vector<Vector<T, 3>> in(count), out(count);
+		std::vector<Quaternion<T>> rots(count), units(count);
+		for (size_t i = 0; i < count; i++) {
+			in[i] = Vector<T, 3>(std::sin(T(i)), T(2) * std::cos(T(0.3) * T(i)), T(i % 17) - T(8));
+			units[i] = test_rotation<T>(i);
+			// Not normalised, as RotateActive and RotatePassive allow
+			rots[i] = units[i] * (T(0.5) + T(i % 5));
+		}
+		const auto all = [&](auto expected) {
+			for (size_t i = 0; i < count; i++) {
+				if (!near(out[i], expected(i), tolerance)) {
+					return false;
+				}
+			}
+			return true;
+		};
+		const auto in_span = std::span<const Vector<T, 3>>(in);
+		const auto rots_span = std::span<const Quaternion<T>>(rots);
+		const auto units_span = std::span<const Quaternion<T>>(units);
+
+		RotateActive(in_span, rots_span, out);
+		expect(all([&](size_t i) { return RotateActive(in[i], rots[i]); }), "span RotateActive, one rotation each");
+		RotatePassive(in_span, rots_span, out);
+		expect(all([&](size_t i) { return RotatePassive(in[i], rots[i]); }), "span RotatePassive, one rotation each");
+		RotateActiveUnit(in_span, units_span, out);
+		expect(all([&](size_t i) { return RotateActive(in[i], units[i]); }), "span RotateActiveUnit");
+		RotatePassiveUnit(execution::par, in_span, units_span, out);
+		expect(all([&](size_t i) { return RotatePassive(in[i], units[i]); }), "parallel span RotatePassiveUnit");
+		RotateActive(execution::par, in_span, rots_span, out);
+		expect(all([&](size_t i) { return RotateActive(in[i], rots[i]); }), "parallel span RotateActive");
+
+		const Quaternion<T> rot = rots[3];
+		RotateActive(in_span, rot, out);
+		expect(all([&](size_t i) { return RotateActive(in[i], rot); }), "span RotateActive, one rotation for all");
+		RotatePassive(execution::par, in_span, rot, out);
+		expect(all([&](size_t i) { return RotatePassive(in[i], rot); }), "parallel span RotatePassive, one rotation for all");
+
+		expect(throws<std::invalid_argument>([&] { RotateActive(in_span, rots_span.first(10), out); }), "one rotation per vector");
+	}
+
+
+	// An n x n matrix with elements in [-2, 2], different for each i
+	template<arithmetic T, size_t n>
+	Matrix<T, n, n> test_matrix(size_t i) {
+		Matrix<T, n, n> m;
+		for (size_t k = 0; k < n * n; k++) {
+			m.data[k] = T(2) * static_cast<T>(std::sin((0.37 * static_cast<double>(i)) + (1.9 * static_cast<double>(k))));
+		}
+		return m;
+	}
+
+	template<arithmetic T, size_t n>
+	void check_batch_multiply(double tolerance) {
+		const std::string name = std::to_string(n) + "x" + std::to_string(n);
+		// Not a multiple of any SIMD width, and enough for several threads under par
+		const size_t count = 10007;
+		std::vector<Matrix<T, n, n>> a(count), b(count), out(count);
+		for (size_t i = 0; i < count; i++) {
+			a[i] = test_matrix<T, n>(i);
+			b[i] = test_matrix<T, n>(i + count);
+		}
+		const auto all = [&](auto expected) {
+			for (size_t i = 0; i < count; i++) {
+				if (!near(out[i], expected(i), tolerance)) {
+					return false;
+				}
+			}
+			return true;
+		};
+		const auto a_span = std::span<const Matrix<T, n, n>>(a);
+		const auto b_span = std::span<const Matrix<T, n, n>>(b);
+		const Matrix<T, n, n> single = test_matrix<T, n>(3);
+
+		batch_multiply(a_span, b_span, out);
+		expect(all([&](size_t i) { return a[i] * b[i]; }), "batch_multiply of pairs, " + name);
+		batch_multiply(single, b_span, out);
+		expect(all([&](size_t i) { return single * b[i]; }), "batch_multiply with one matrix on the left, " + name);
+		batch_multiply(a_span, single, out);
+		expect(all([&](size_t i) { return a[i] * single; }), "batch_multiply with one matrix on the right, " + name);
+
+		const std::vector<Matrix<T, n, n>> sequential = out;
+		batch_multiply(execution::par, a_span, single, out);
+		expect(out == sequential, "parallel batch_multiply with one matrix on the right, " + name);
+		batch_multiply(execution::par, a_span, b_span, out);
+		expect(all([&](size_t i) { return a[i] * b[i]; }), "parallel batch_multiply of pairs, " + name);
+		batch_multiply(execution::par, single, b_span, out);
+		expect(all([&](size_t i) { return single * b[i]; }), "parallel batch_multiply with one matrix on the left, " + name);
+
+		// A few products, fewer than a SIMD register of them, written over the left-hand inputs
+		std::vector<Matrix<T, n, n>> in_place(a.begin(), a.begin() + 3);
+		batch_multiply(std::span<const Matrix<T, n, n>>(in_place), b_span.first(3), in_place);
+		expect(near(in_place[0], a[0] * b[0], tolerance) && near(in_place[2], a[2] * b[2], tolerance), "batch_multiply in place, " + name);
+
+		expect(throws<std::invalid_argument>([&] { batch_multiply(a_span, b_span.first(10), out); }), "batch_multiply of spans that differ in size");
+		expect(throws<std::invalid_argument>([&] { batch_multiply(a_span, b_span, std::span<Matrix<T, n, n>>(out).first(10)); }), "batch_multiply into a short span");
+	}
+
+
+	// m * (v, w) as a column vector, divided through by the resulting w when w is 1
+	template<std::floating_point T>
+	Vector<T, 3> apply(const Matrix<T, 4, 4>& m, const Vector<T, 3>& v, T w) {
+		const Matrix<T, 4, 1> r = m * Vector<T, 4>(v[0], v[1], v[2], w);
+		const T d = (w == T(0)) ? T(1) : r[3][0];
+		return Vector<T, 3>(r[0][0] / d, r[1][0] / d, r[2][0] / d);
+	}
+
+	template<std::floating_point T>
+	void check_transform(size_t count, double tolerance) {
+		const std::string name = std::string(std::is_same_v<T, float> ? "float" : "double") + ", " + std::to_string(count);
+		std::vector<Vector<T, 3>> in(count), out(count);
+		for (size_t i = 0; i < count; i++) {
+			in[i] = Vector<T, 3>(std::sin(T(i)), T(2) * std::cos(T(0.3) * T(i)), T(i % 17) - T(8));
+		}
+		const auto all = [&](auto expected) {
+			for (size_t i = 0; i < count; i++) {
+				if (!near(out[i], expected(i), tolerance)) {
+					return false;
+				}
+			}
+			return true;
+		};
+		const auto in_span = std::span<const Vector<T, 3>>(in);
+
+		// An affine transform with rotation, non-uniform scale and translation, and one with a projective bottom row
+		Matrix<T, 4, 4> m = QuaternionTo44RotationMatrix(test_rotation<T>(2));
+		for (size_t j = 0; j < 3; j++) {
+			m[0][j] *= T(2);
+			m[2][j] *= T(0.5);
+		}
+		m[0][3] = T(1);
+		m[1][3] = T(-2);
+		m[2][3] = T(3);
+		Matrix<T, 4, 4> projective = m;
+		projective[3][0] = T(0.01);
+		projective[3][2] = T(0.02);
+		projective[3][3] = T(2);
+		const Matrix<T, 4, 4> normal = transpose(inverse(m));
+
+		transform_points(m, in_span, out);
+		expect(all([&](size_t i) { return apply(m, in[i], T(1)); }), "transform_points, " + name);
+		transform_points(execution::par, m, in_span, out);
+		expect(all([&](size_t i) { return apply(m, in[i], T(1)); }), "parallel transform_points, " + name);
+		transform_points(projective, in_span, out);
+		expect(all([&](size_t i) { return apply(projective, in[i], T(1)); }), "transform_points with a projective matrix, " + name);
+		transform_directions(m, in_span, out);
+		expect(all([&](size_t i) { return apply(m, in[i], T(0)); }), "transform_directions, " + name);
+		transform_directions(execution::par, m, in_span, out);
+		expect(all([&](size_t i) { return apply(m, in[i], T(0)); }), "parallel transform_directions, " + name);
+		transform_normals(m, in_span, out);
+		expect(all([&](size_t i) { return apply(normal, in[i], T(0)); }), "transform_normals, " + name);
+		transform_normals(execution::par, m, in_span, out);
+		expect(all([&](size_t i) { return apply(normal, in[i], T(0)); }), "parallel transform_normals, " + name);
+
+		// In place, and to an output that starts off a 16-byte boundary, so the streaming stores begin part way in
+		out = in;
+		transform_points(m, std::span<const Vector<T, 3>>(out), out);
+		expect(all([&](size_t i) { return apply(m, in[i], T(1)); }), "transform_points in place, " + name);
+		std::vector<Vector<T, 3>> offset(count + 1);
+		transform_points(m, in_span, std::span<Vector<T, 3>>(offset).subspan(1));
+		bool offset_ok = true;
+		for (size_t i = 0; i < count; i++) {
+			offset_ok = offset_ok && near(offset[i + 1], apply(m, in[i], T(1)), tolerance);
+		}
+		expect(offset_ok, "transform_points to an offset output, " + name);
+
+		expect(throws<std::invalid_argument>([&] { transform_points(m, in_span, std::span<Vector<T, 3>>(out).first(count / 2)); }), "transform_points into a short span");
+	}
+
+
+	template<std::floating_point T, size_t n>
+	void check_det(double tolerance) {
+		const std::string name = std::to_string(n) + "x" + std::to_string(n) + " " + (std::is_same_v<T, float> ? "float" : "double");
+		// Not a multiple of four, and enough for several threads under par. Every seventh matrix is singular
+		const size_t count = 20003;
+		std::vector<Matrix<T, n, n>> in(count);
+		for (size_t i = 0; i < count; i++) {
+			in[i] = test_matrix<T, n>(i);
+			if (i % 7 == 0) {
+				for (size_t j = 0; j < n; j++) {
+					in[i][1][j] = T(2) * in[i][0][j];
+				}
+			}
+		}
+		std::vector<T> out(count);
+		// The single-matrix det works in double, so the span det in float only agrees with it to a tolerance
+		const auto all = [&] {
+			for (size_t i = 0; i < count; i++) {
+				if (!near(out[i], det(opaque(in[i])), tolerance)) {
+					return false;
+				}
+			}
+			return true;
+		};
+		det(std::span<const Matrix<T, n, n>>(in), out);
+		expect(all(), "span det, " + name);
+		const std::vector<T> sequential = out;
+		det(execution::par, std::span<const Matrix<T, n, n>>(in), out);
+		expect(all() && (out == sequential), "parallel span det, " + name);
+		expect(throws<std::invalid_argument>([&] { det(std::span<const Matrix<T, n, n>>(in), std::span<T>(out).first(3)); }), "span det into a short span");
+	}
+
+}
+
+int main() {
+	check_to_quaternions<float, 3>(1e-5);
+	check_to_quaternions<float, 4>(1e-5);
+	check_to_quaternions<double, 3>(1e-12);
+	check_to_quaternions<double, 4>(1e-12);
+	check_rotate<float>(1e-5);
+	check_rotate<double>(1e-12);
+	// A few points, and enough to fill over 4 MiB of output, which is written with non-temporal stores
+	check_transform<float>(7, 1e-5);
+	check_transform<float>(400003, 1e-5);
+	check_transform<double>(7, 1e-12);
+	check_transform<double>(400003, 1e-12);
+	check_det<double, 3>(1e-12);
+	check_det<float, 4>(1e-5);
+	check_det<double, 4>(1e-12);
+	check_batch_multiply<float, 4>(1e-5);
+	check_batch_multiply<double, 3>(1e-12);
+	return result();
+}